@@ -0,0 +1,447 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmark.cpp
+// ============
+// play a camera path for a fixed number of frames and report the frame times
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Benchmark.h"
+#include "ViewManager.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	const int g_DefaultFrameCount = 1000;
+	const int g_DefaultWarmupFrames = 60;
+
+	// the scripted orbit circles the props while rising and
+	// falling twice, looking at the middle of the table
+	const glm::vec3 g_OrbitTarget = glm::vec3(0.0f, 4.0f, 0.0f);
+	const float g_OrbitRadius = 22.0f;
+	const float g_OrbitHeight = 9.0f;
+	const float g_OrbitBob = 4.0f;
+	const float g_Pi = 3.14159265f;
+}
+
+/***********************************************************
+ *  Benchmark()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+Benchmark::Benchmark(ResourceManager* pResources)
+{
+	m_pResources = pResources;
+	m_bEnabled = false;
+	m_bOffscreen = false;
+	m_frameCount = g_DefaultFrameCount;
+	m_warmupFrames = g_DefaultWarmupFrames;
+	m_budgetMs = 0.0;
+	m_stressCopies = 1;
+	m_frame = 0;
+	m_measuredFrames = 0;
+	m_bTiming = false;
+}
+
+/***********************************************************
+ *  ~Benchmark()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+Benchmark::~Benchmark()
+{
+}
+
+/***********************************************************
+ *  ParseArguments()
+ *
+ *  This method is used for reading the benchmark options
+ *  from the command line.
+ ***********************************************************/
+void Benchmark::ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		bool bHasValue = (i + 1 < argc);
+
+		if (strcmp(argv[i], "--benchmark") == 0)
+		{
+			m_bEnabled = true;
+		}
+		else if (strcmp(argv[i], "--offscreen") == 0)
+		{
+			m_bOffscreen = true;
+		}
+		else if ((strcmp(argv[i], "--benchmark-frames") == 0) && bHasValue)
+		{
+			m_frameCount = std::max(1, atoi(argv[++i]));
+		}
+		else if ((strcmp(argv[i], "--benchmark-warmup") == 0) && bHasValue)
+		{
+			m_warmupFrames = std::max(0, atoi(argv[++i]));
+		}
+		else if ((strcmp(argv[i], "--benchmark-budget") == 0) && bHasValue)
+		{
+			m_budgetMs = atof(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--stress") == 0) && bHasValue)
+		{
+			m_stressCopies = std::max(1, atoi(argv[++i]));
+		}
+		else if ((strcmp(argv[i], "--camera-path") == 0) && bHasValue)
+		{
+			m_cameraPathFile = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--record-camera") == 0) && bHasValue)
+		{
+			m_recordFile = argv[++i];
+		}
+	}
+
+	if (m_bEnabled && (m_cameraPathFile.empty() == false))
+	{
+		LoadCameraPath(m_cameraPathFile.c_str());
+	}
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the offscreen color and
+ *  depth buffers, the same size as the window's framebuffer.
+ ***********************************************************/
+bool Benchmark::Create(int width, int height)
+{
+	if (Offscreen() == false)
+	{
+		return(true);
+	}
+
+	m_colorBuffer = m_pResources->CreateRenderbuffer(ResourceManager::CATEGORY_RENDER_TARGETS, "benchmark color buffer");
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer.Name());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	m_colorBuffer.SetSize((size_t)width * height * 4);
+	m_depthBuffer = m_pResources->CreateRenderbuffer(ResourceManager::CATEGORY_RENDER_TARGETS, "benchmark depth buffer");
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer.Name());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	m_depthBuffer.SetSize((size_t)width * height * 4);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	m_framebuffer = m_pResources->CreateFramebuffer("benchmark framebuffer");
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.Name());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer.Name());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer.Name());
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (GL_FRAMEBUFFER_COMPLETE != status)
+	{
+		std::cout << "Benchmark: offscreen framebuffer is incomplete, rendering to the window" << std::endl;
+		m_framebuffer.Reset();
+		m_colorBuffer.Reset();
+		m_depthBuffer.Reset();
+		m_bOffscreen = false;
+		return(false);
+	}
+
+	glViewport(0, 0, width, height);
+
+	return(true);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for placing the camera at the pose of
+ *  the current frame.  The warm-up frames hold the first
+ *  pose, so the measured frames always cover the whole path.
+ ***********************************************************/
+void Benchmark::BeginFrame(ViewManager* pViewManager)
+{
+	if ((m_bEnabled == false) || (NULL == pViewManager))
+	{
+		return;
+	}
+
+	float t = 0.0f;
+	if (m_bTiming && (m_frameCount > 1))
+	{
+		t = (float)m_measuredFrames / (float)(m_frameCount - 1);
+	}
+
+	CAMERA_KEY pose = PathPose(t);
+	pViewManager->SetCameraPose(pose.position, pose.yaw, pose.pitch);
+}
+
+/***********************************************************
+ *  Present()
+ *
+ *  This method is used for showing the rendered frame.
+ *  Nothing is shown offscreen, so the GPU is waited for
+ *  instead - otherwise the CPU could queue frames ahead and
+ *  the frame times would not include the GPU work.
+ ***********************************************************/
+void Benchmark::Present(GLFWwindow* window) const
+{
+	if (Offscreen())
+	{
+		glFinish();
+		return;
+	}
+
+	glfwSwapBuffers(window);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for measuring the time since the last
+ *  frame and recording the camera pose.  Timing starts once
+ *  the scene has finished loading and the warm-up frames are
+ *  done.
+ ***********************************************************/
+bool Benchmark::EndFrame(ViewManager* pViewManager, bool bSceneReady)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	if ((m_recordFile.empty() == false) && (m_bEnabled == false) && (NULL != pViewManager))
+	{
+		CAMERA_KEY key;
+		pViewManager->GetCameraPose(key.position, key.yaw, key.pitch);
+		m_recordedPath.push_back(key);
+	}
+
+	if (m_bEnabled == false)
+	{
+		return(false);
+	}
+
+	if (m_bTiming)
+	{
+		m_frameTimesMs.push_back(std::chrono::duration<double, std::milli>(now - m_lastFrameTime).count());
+		m_measuredFrames++;
+	}
+	else if (bSceneReady)
+	{
+		m_frame++;
+		if (m_frame >= m_warmupFrames)
+		{
+			m_bTiming = true;
+		}
+	}
+	m_lastFrameTime = now;
+
+	return(m_measuredFrames >= m_frameCount);
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for printing the frame time summary
+ *  and the profiler averages, and for saving a recorded
+ *  camera path.  The last line holds every number on one
+ *  line for scripts to read.
+ ***********************************************************/
+bool Benchmark::Finish(const Profiler* pProfiler)
+{
+	if (m_recordFile.empty() == false)
+	{
+		SaveCameraPath(m_recordFile.c_str());
+	}
+
+	if ((m_bEnabled == false) || m_frameTimesMs.empty())
+	{
+		return(true);
+	}
+
+	std::vector<double> sortedTimes = m_frameTimesMs;
+	std::sort(sortedTimes.begin(), sortedTimes.end());
+	double totalMs = 0.0;
+	for (double frameMs : sortedTimes)
+	{
+		totalMs += frameMs;
+	}
+	double averageMs = totalMs / (double)sortedTimes.size();
+	double p50 = Percentile(sortedTimes, 0.50);
+	double p95 = Percentile(sortedTimes, 0.95);
+	double p99 = Percentile(sortedTimes, 0.99);
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Benchmark: " << sortedTimes.size() << " frames, " << m_stressCopies << "x props"
+		<< (Offscreen() ? ", offscreen" : "") << std::endl;
+	std::cout << "  average: " << averageMs << " ms (" << (1000.0 / averageMs) << " fps)" << std::endl;
+	std::cout << "  min: " << sortedTimes.front() << " ms, max: " << sortedTimes.back() << " ms" << std::endl;
+	std::cout << "  p50: " << p50 << " ms, p95: " << p95 << " ms, p99: " << p99 << " ms" << std::endl;
+	std::cout.unsetf(std::ios::floatfield);
+	std::cout << std::setprecision(6);
+
+	if (NULL != pProfiler)
+	{
+		std::cout << "Profiler averages:" << std::endl;
+		pProfiler->Print();
+	}
+
+	bool bPassed = (m_budgetMs <= 0.0) || (p99 <= m_budgetMs);
+	std::cout << "BENCHMARK frames=" << sortedTimes.size() << " stress=" << m_stressCopies
+		<< " avg_ms=" << averageMs << " p50_ms=" << p50 << " p95_ms=" << p95 << " p99_ms=" << p99
+		<< " result=" << (bPassed ? "pass" : "fail") << std::endl;
+	if (bPassed == false)
+	{
+		std::cout << "Benchmark: p99 of " << p99 << " ms is over the budget of " << m_budgetMs << " ms" << std::endl;
+	}
+
+	return(bPassed);
+}
+
+/***********************************************************
+ *  PathPose()
+ *
+ *  This method is used for getting the camera pose along the
+ *  path.  A loaded path is interpolated between its keys,
+ *  which are spread evenly over the run - otherwise the
+ *  scripted orbit is used.
+ ***********************************************************/
+Benchmark::CAMERA_KEY Benchmark::PathPose(float t) const
+{
+	if (m_cameraPath.empty())
+	{
+		return(OrbitPose(t));
+	}
+	if (m_cameraPath.size() == 1)
+	{
+		return(m_cameraPath[0]);
+	}
+
+	float position = std::max(0.0f, std::min(t, 1.0f)) * (float)(m_cameraPath.size() - 1);
+	size_t key = std::min((size_t)position, m_cameraPath.size() - 2);
+	float blend = position - (float)key;
+
+	const CAMERA_KEY& from = m_cameraPath[key];
+	const CAMERA_KEY& to = m_cameraPath[key + 1];
+	CAMERA_KEY pose;
+	pose.position = glm::mix(from.position, to.position, blend);
+	pose.yaw = from.yaw + (to.yaw - from.yaw) * blend;
+	pose.pitch = from.pitch + (to.pitch - from.pitch) * blend;
+
+	return(pose);
+}
+
+/***********************************************************
+ *  OrbitPose()
+ *
+ *  This method is used for getting a pose on the scripted
+ *  orbit - one lap around the props, rising and falling
+ *  twice, always looking at the middle of the table.
+ ***********************************************************/
+Benchmark::CAMERA_KEY Benchmark::OrbitPose(float t)
+{
+	float angle = 2.0f * g_Pi * t;
+
+	CAMERA_KEY pose;
+	pose.position = g_OrbitTarget + glm::vec3(
+		g_OrbitRadius * std::sin(angle),
+		g_OrbitHeight + g_OrbitBob * std::sin(2.0f * angle),
+		g_OrbitRadius * std::cos(angle));
+
+	glm::vec3 direction = glm::normalize(g_OrbitTarget - pose.position);
+	pose.yaw = glm::degrees(std::atan2(direction.z, direction.x));
+	pose.pitch = glm::degrees(std::asin(direction.y));
+
+	return(pose);
+}
+
+/***********************************************************
+ *  LoadCameraPath()
+ *
+ *  This method is used for reading a camera path, one key
+ *  per line as "x y z yaw pitch".  Empty lines and lines
+ *  starting with # are skipped.
+ ***********************************************************/
+bool Benchmark::LoadCameraPath(const char* filename)
+{
+	std::ifstream file(filename);
+	if (!file)
+	{
+		std::cout << "Benchmark: could not open camera path " << filename << ", using the orbit" << std::endl;
+		return(false);
+	}
+
+	m_cameraPath.clear();
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (line.empty() || (line[0] == '#'))
+		{
+			continue;
+		}
+
+		std::istringstream values(line);
+		CAMERA_KEY key;
+		if (values >> key.position.x >> key.position.y >> key.position.z >> key.yaw >> key.pitch)
+		{
+			m_cameraPath.push_back(key);
+		}
+	}
+
+	std::cout << "Benchmark: loaded " << m_cameraPath.size() << " camera keys from " << filename << std::endl;
+
+	return(m_cameraPath.empty() == false);
+}
+
+/***********************************************************
+ *  SaveCameraPath()
+ *
+ *  This method is used for writing the recorded camera path
+ *  in the format read by LoadCameraPath().
+ ***********************************************************/
+bool Benchmark::SaveCameraPath(const char* filename) const
+{
+	std::ofstream file(filename);
+	if (!file)
+	{
+		std::cout << "Benchmark: could not write camera path " << filename << std::endl;
+		return(false);
+	}
+
+	file << "# x y z yaw pitch - one key per frame\n";
+	for (const CAMERA_KEY& key : m_recordedPath)
+	{
+		file << key.position.x << " " << key.position.y << " " << key.position.z << " "
+			<< key.yaw << " " << key.pitch << "\n";
+	}
+
+	std::cout << "Benchmark: recorded " << m_recordedPath.size() << " camera keys to " << filename << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Percentile()
+ *
+ *  This method is used for getting the frame time below
+ *  which the passed in fraction of the sorted frames fall,
+ *  using the nearest rank.
+ ***********************************************************/
+double Benchmark::Percentile(const std::vector<double>& sortedTimes, double fraction)
+{
+	if (sortedTimes.empty())
+	{
+		return(0.0);
+	}
+
+	size_t rank = (size_t)std::ceil(fraction * (double)sortedTimes.size());
+	rank = std::max((size_t)1, std::min(rank, sortedTimes.size()));
+
+	return(sortedTimes[rank - 1]);
+}
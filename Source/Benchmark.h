@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmark.h
+// ============
+// play a camera path for a fixed number of frames and report the frame times
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include "GLFW/glfw3.h"
+
+#include <glm/glm.hpp>
+
+#include "ResourceManager.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+class ViewManager;
+class Profiler;
+
+/***********************************************************
+ *  Benchmark
+ *
+ *  This class runs the application as a reproducible
+ *  benchmark.  The camera follows a path - an orbit around
+ *  the props, or one recorded earlier with --record-camera -
+ *  spread over a fixed number of frames, so every run draws
+ *  the same pictures.  Rendering can go to an offscreen
+ *  framebuffer in a hidden window.  When the run is done the
+ *  frame time percentiles and the profiler averages are
+ *  printed, and a frame time budget can fail the run.
+ ***********************************************************/
+class Benchmark
+{
+public:
+	// constructor
+	Benchmark(ResourceManager* pResources);
+	// destructor
+	~Benchmark();
+
+	// read the options from the command line:
+	//   --benchmark              run the benchmark
+	//   --benchmark-frames <n>   frames to measure (default 1000)
+	//   --benchmark-warmup <n>   frames to skip first (default 60)
+	//   --benchmark-budget <ms>  fail when p99 is slower than this
+	//   --offscreen              render to a framebuffer, hide the window
+	//   --stress <n>             copies of the props, 1 to 10000
+	//   --camera-path <file>     play a recorded camera path
+	//   --record-camera <file>   record the live camera path
+	void ParseArguments(int argc, char* argv[]);
+
+	bool Enabled() const { return(m_bEnabled); }
+	bool Offscreen() const { return(m_bEnabled && m_bOffscreen); }
+	int StressCopies() const { return(m_stressCopies); }
+
+	// create the offscreen framebuffer - needs the OpenGL context
+	bool Create(int width, int height);
+
+	// move the camera to the pose of the current frame
+	void BeginFrame(ViewManager* pViewManager);
+	// the framebuffer the scene is rendered into - the window's
+	// when rendering on screen
+	GLuint TargetFramebuffer() const { return(Offscreen() ? m_framebuffer.Name() : 0); }
+	// show the frame - waits for the GPU instead when offscreen
+	void Present(GLFWwindow* window) const;
+	// measure the frame and record the camera - returns true once
+	// every benchmark frame has been measured
+	bool EndFrame(ViewManager* pViewManager, bool bSceneReady);
+
+	// print the results and save a recorded camera path - returns
+	// false when the frame time budget was missed
+	bool Finish(const Profiler* pProfiler);
+
+private:
+	// a point on the camera path
+	struct CAMERA_KEY
+	{
+		glm::vec3 position;
+		float yaw;
+		float pitch;
+	};
+
+	bool m_bEnabled;
+	bool m_bOffscreen;
+	int m_frameCount;
+	int m_warmupFrames;
+	double m_budgetMs;
+	int m_stressCopies;
+	std::string m_cameraPathFile;
+	std::string m_recordFile;
+
+	std::vector<CAMERA_KEY> m_cameraPath;
+	std::vector<CAMERA_KEY> m_recordedPath;
+
+	ResourceManager* m_pResources;
+	ResourceManager::Handle m_framebuffer;
+	ResourceManager::Handle m_colorBuffer;
+	ResourceManager::Handle m_depthBuffer;
+
+	// frames seen so far, and the measured ones
+	int m_frame;
+	int m_measuredFrames;
+	bool m_bTiming;
+	std::chrono::steady_clock::time_point m_lastFrameTime;
+	std::vector<double> m_frameTimesMs;
+
+	// pose along the path, from 0 at the start to 1 at the end
+	CAMERA_KEY PathPose(float t) const;
+	static CAMERA_KEY OrbitPose(float t);
+	bool LoadCameraPath(const char* filename);
+	bool SaveCameraPath(const char* filename) const;
+	// value below which the passed in share of frames fall
+	static double Percentile(const std::vector<double>& sortedTimes, double fraction);
+};
@@ -0,0 +1,389 @@
+///////////////////////////////////////////////////////////////////////////////
+// clusteredlights.cpp
+// ============
+// assign point lights to view-space clusters for clustered forward shading
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ClusteredLights.h"
+
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	const int g_ClusterCount = CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_COUNT_Z;
+	// vec4 texels written for every light
+	const int g_TexelsPerLight = 4;
+
+	/***********************************************************
+	 *  ViewPointAtDepth()
+	 *
+	 *  Unproject a point in normalized device coordinates at
+	 *  both clip planes and return the point on the line
+	 *  between them at the passed in view depth.  This works
+	 *  for both perspective and orthographic projections.
+	 ***********************************************************/
+	glm::vec3 ViewPointAtDepth(const glm::mat4& inverseProjection, float ndcX, float ndcY, float depth)
+	{
+		glm::vec4 nearPoint = inverseProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+		glm::vec4 farPoint = inverseProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+		glm::vec3 a = glm::vec3(nearPoint) / nearPoint.w;
+		glm::vec3 b = glm::vec3(farPoint) / farPoint.w;
+
+		// view space looks down -Z
+		float t = (-depth - a.z) / (b.z - a.z);
+		return(a + (b - a) * t);
+	}
+
+	/***********************************************************
+	 *  SphereTouchesBox()
+	 *
+	 *  Test a sphere against an axis aligned box.
+	 ***********************************************************/
+	bool SphereTouchesBox(const glm::vec3& center, float radius, const glm::vec3& minPoint, const glm::vec3& maxPoint)
+	{
+		glm::vec3 closest = glm::clamp(center, minPoint, maxPoint);
+		glm::vec3 offset = closest - center;
+		return(glm::dot(offset, offset) <= radius * radius);
+	}
+}
+
+/***********************************************************
+ *  ClusteredLights()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ClusteredLights::ClusteredLights(ResourceManager* pResources)
+{
+	m_pResources = pResources;
+	m_bLightsDirty = true;
+	m_view = glm::mat4(1.0f);
+	m_projection = glm::mat4(1.0f);
+	m_viewportWidth = 0;
+	m_viewportHeight = 0;
+	m_nearPlane = 0.1f;
+	m_farPlane = 100.0f;
+	m_clusterScale = glm::vec4(0.0f);
+	m_bValid = false;
+}
+
+/***********************************************************
+ *  ~ClusteredLights()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ClusteredLights::~ClusteredLights()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for allocating the texture buffers
+ *  that carry the lights and the cluster lists to the shader.
+ ***********************************************************/
+void ClusteredLights::Create()
+{
+	if (m_lightBuffer.IsValid())
+	{
+		return;
+	}
+
+	m_lightBuffer = m_pResources->CreateBuffer(ResourceManager::CATEGORY_BUFFERS, "cluster lights");
+	m_gridBuffer = m_pResources->CreateBuffer(ResourceManager::CATEGORY_BUFFERS, "cluster grid");
+	m_indexBuffer = m_pResources->CreateBuffer(ResourceManager::CATEGORY_BUFFERS, "cluster light indices");
+	m_lightTexture = m_pResources->CreateTexture(ResourceManager::CATEGORY_BUFFERS, "cluster lights");
+	m_gridTexture = m_pResources->CreateTexture(ResourceManager::CATEGORY_BUFFERS, "cluster grid");
+	m_indexTexture = m_pResources->CreateTexture(ResourceManager::CATEGORY_BUFFERS, "cluster light indices");
+
+	// a texture buffer needs storage before it can be attached
+	GLuint empty[4] = { 0, 0, 0, 0 };
+	Upload(m_lightBuffer, empty, sizeof(empty));
+	Upload(m_gridBuffer, empty, sizeof(empty));
+	Upload(m_indexBuffer, empty, sizeof(empty));
+
+	glBindTexture(GL_TEXTURE_BUFFER, m_lightTexture.Name());
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_lightBuffer.Name());
+	glBindTexture(GL_TEXTURE_BUFFER, m_gridTexture.Name());
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, m_gridBuffer.Name());
+	glBindTexture(GL_TEXTURE_BUFFER, m_indexTexture.Name());
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, m_indexBuffer.Name());
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+	m_bLightsDirty = true;
+	m_bValid = false;
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the texture buffers.
+ ***********************************************************/
+void ClusteredLights::Destroy()
+{
+	if (m_lightBuffer.IsValid() == false)
+	{
+		return;
+	}
+
+	m_lightTexture.Reset();
+	m_gridTexture.Reset();
+	m_indexTexture.Reset();
+	m_lightBuffer.Reset();
+	m_gridBuffer.Reset();
+	m_indexBuffer.Reset();
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every light.
+ ***********************************************************/
+void ClusteredLights::Clear()
+{
+	m_lights.clear();
+	m_bLightsDirty = true;
+}
+
+/***********************************************************
+ *  AddPointLight()
+ *
+ *  This method is used for adding a point light and
+ *  returning its index.
+ ***********************************************************/
+int ClusteredLights::AddPointLight(const POINT_LIGHT& light)
+{
+	m_lights.push_back(light);
+	m_bLightsDirty = true;
+
+	return((int)m_lights.size() - 1);
+}
+
+/***********************************************************
+ *  SetPointLight()
+ *
+ *  This method is used for changing a light that was added
+ *  before, for example to move it.
+ ***********************************************************/
+void ClusteredLights::SetPointLight(int index, const POINT_LIGHT& light)
+{
+	if ((index < 0) || (index >= (int)m_lights.size()))
+	{
+		return;
+	}
+
+	m_lights[index] = light;
+	m_bLightsDirty = true;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for assigning every light to the
+ *  clusters its range touches.  It is called once per frame;
+ *  when the camera, the viewport and the lights are all the
+ *  same as last time, the previous assignment is kept.
+ ***********************************************************/
+void ClusteredLights::Update(const glm::mat4& view, const glm::mat4& projection, int viewportWidth, int viewportHeight)
+{
+	if ((m_lightBuffer.IsValid() == false) || (viewportWidth <= 0) || (viewportHeight <= 0))
+	{
+		return;
+	}
+
+	bool bBoundsChanged = (m_bValid == false) || (projection != m_projection) ||
+		(viewportWidth != m_viewportWidth) || (viewportHeight != m_viewportHeight);
+	if ((bBoundsChanged == false) && (view == m_view) && (m_bLightsDirty == false))
+	{
+		return;
+	}
+
+	m_view = view;
+	m_projection = projection;
+	m_viewportWidth = viewportWidth;
+	m_viewportHeight = viewportHeight;
+	if (bBoundsChanged)
+	{
+		BuildBounds();
+	}
+
+	if (m_bLightsDirty)
+	{
+		// four texels per light: position and range, then the colors
+		std::vector<glm::vec4> texels;
+		texels.reserve(m_lights.size() * g_TexelsPerLight + 1);
+		for (size_t i = 0; i < m_lights.size(); i++)
+		{
+			texels.push_back(glm::vec4(m_lights[i].position, m_lights[i].range));
+			texels.push_back(glm::vec4(m_lights[i].ambient, 0.0f));
+			texels.push_back(glm::vec4(m_lights[i].diffuse, 0.0f));
+			texels.push_back(glm::vec4(m_lights[i].specular, 0.0f));
+		}
+		if (texels.empty())
+		{
+			texels.push_back(glm::vec4(0.0f));
+		}
+		Upload(m_lightBuffer, &texels[0], texels.size() * sizeof(glm::vec4));
+		m_bLightsDirty = false;
+	}
+
+	// move the light spheres into view space once
+	std::vector<glm::vec4> viewLights(m_lights.size());
+	for (size_t i = 0; i < m_lights.size(); i++)
+	{
+		viewLights[i] = glm::vec4(glm::vec3(view * glm::vec4(m_lights[i].position, 1.0f)), m_lights[i].range);
+	}
+
+	m_grid.assign(g_ClusterCount * 2, 0);
+	m_indices.clear();
+
+	for (int cluster = 0; cluster < g_ClusterCount; cluster++)
+	{
+		m_grid[cluster * 2] = (GLuint)m_indices.size();
+
+		const CLUSTER_BOUNDS& bounds = m_bounds[cluster];
+		for (size_t i = 0; i < viewLights.size(); i++)
+		{
+			// a light without a range reaches every cluster
+			if ((viewLights[i].w <= 0.0f) ||
+				SphereTouchesBox(glm::vec3(viewLights[i]), viewLights[i].w, bounds.minPoint, bounds.maxPoint))
+			{
+				m_indices.push_back((GLuint)i);
+			}
+		}
+
+		m_grid[cluster * 2 + 1] = (GLuint)m_indices.size() - m_grid[cluster * 2];
+	}
+
+	if (m_indices.empty())
+	{
+		// keep the buffer non-empty so it stays attached
+		m_indices.push_back(0);
+	}
+
+	Upload(m_gridBuffer, &m_grid[0], m_grid.size() * sizeof(GLuint));
+	Upload(m_indexBuffer, &m_indices[0], m_indices.size() * sizeof(GLuint));
+
+	m_bValid = true;
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used for binding the buffer textures to
+ *  their texture units.
+ ***********************************************************/
+void ClusteredLights::Bind() const
+{
+	glActiveTexture(GL_TEXTURE0 + LIGHT_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, m_lightTexture.Name());
+	glActiveTexture(GL_TEXTURE0 + GRID_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, m_gridTexture.Name());
+	glActiveTexture(GL_TEXTURE0 + INDEX_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, m_indexTexture.Name());
+	glActiveTexture(GL_TEXTURE0);
+}
+
+/***********************************************************
+ *  BuildBounds()
+ *
+ *  This method is used for working out the view-space box
+ *  around every cluster.  The depth slices are spaced
+ *  exponentially between the near and far planes, so that
+ *  the clusters keep roughly the same shape with distance.
+ ***********************************************************/
+void ClusteredLights::BuildBounds()
+{
+	// read the clip planes back out of the projection matrix
+	if (m_projection[3][3] == 0.0f)
+	{
+		// perspective
+		m_nearPlane = m_projection[3][2] / (m_projection[2][2] - 1.0f);
+		m_farPlane = m_projection[3][2] / (m_projection[2][2] + 1.0f);
+	}
+	else
+	{
+		// orthographic
+		m_nearPlane = (m_projection[3][2] + 1.0f) / m_projection[2][2];
+		m_farPlane = (m_projection[3][2] - 1.0f) / m_projection[2][2];
+	}
+	// the exponential slices need a positive near plane
+	if (m_nearPlane < 0.01f)
+	{
+		m_nearPlane = 0.01f;
+	}
+	if (m_farPlane <= m_nearPlane)
+	{
+		m_farPlane = m_nearPlane + 1.0f;
+	}
+
+	float logDepthRatio = std::log(m_farPlane / m_nearPlane);
+	// slice = log(depth) * scale + bias
+	m_clusterScale.x = (float)CLUSTER_COUNT_X / (float)m_viewportWidth;
+	m_clusterScale.y = (float)CLUSTER_COUNT_Y / (float)m_viewportHeight;
+	m_clusterScale.z = (float)CLUSTER_COUNT_Z / logDepthRatio;
+	m_clusterScale.w = -(float)CLUSTER_COUNT_Z * std::log(m_nearPlane) / logDepthRatio;
+
+	glm::mat4 inverseProjection = glm::inverse(m_projection);
+	m_bounds.resize(g_ClusterCount);
+
+	for (int z = 0; z < CLUSTER_COUNT_Z; z++)
+	{
+		float sliceNear = m_nearPlane * std::pow(m_farPlane / m_nearPlane, (float)z / CLUSTER_COUNT_Z);
+		float sliceFar = m_nearPlane * std::pow(m_farPlane / m_nearPlane, (float)(z + 1) / CLUSTER_COUNT_Z);
+
+		for (int y = 0; y < CLUSTER_COUNT_Y; y++)
+		{
+			float ndcBottom = -1.0f + 2.0f * (float)y / CLUSTER_COUNT_Y;
+			float ndcTop = -1.0f + 2.0f * (float)(y + 1) / CLUSTER_COUNT_Y;
+
+			for (int x = 0; x < CLUSTER_COUNT_X; x++)
+			{
+				float ndcLeft = -1.0f + 2.0f * (float)x / CLUSTER_COUNT_X;
+				float ndcRight = -1.0f + 2.0f * (float)(x + 1) / CLUSTER_COUNT_X;
+
+				// the box around the eight corners of the cluster
+				glm::vec3 corners[8] =
+				{
+					ViewPointAtDepth(inverseProjection, ndcLeft, ndcBottom, sliceNear),
+					ViewPointAtDepth(inverseProjection, ndcRight, ndcBottom, sliceNear),
+					ViewPointAtDepth(inverseProjection, ndcLeft, ndcTop, sliceNear),
+					ViewPointAtDepth(inverseProjection, ndcRight, ndcTop, sliceNear),
+					ViewPointAtDepth(inverseProjection, ndcLeft, ndcBottom, sliceFar),
+					ViewPointAtDepth(inverseProjection, ndcRight, ndcBottom, sliceFar),
+					ViewPointAtDepth(inverseProjection, ndcLeft, ndcTop, sliceFar),
+					ViewPointAtDepth(inverseProjection, ndcRight, ndcTop, sliceFar)
+				};
+
+				CLUSTER_BOUNDS& bounds = m_bounds[x + CLUSTER_COUNT_X * (y + CLUSTER_COUNT_Y * z)];
+				bounds.minPoint = corners[0];
+				bounds.maxPoint = corners[0];
+				for (int i = 1; i < 8; i++)
+				{
+					bounds.minPoint = glm::min(bounds.minPoint, corners[i]);
+					bounds.maxPoint = glm::max(bounds.maxPoint, corners[i]);
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  Upload()
+ *
+ *  This method is used for replacing the contents of a
+ *  texture buffer.  The old storage is orphaned, so the
+ *  write does not wait for draws still reading it.
+ ***********************************************************/
+void ClusteredLights::Upload(ResourceManager::Handle& buffer, const void* data, size_t size)
+{
+	glBindBuffer(GL_TEXTURE_BUFFER, buffer.Name());
+	glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)size, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_TEXTURE_BUFFER, 0, (GLsizeiptr)size, data);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	buffer.SetSize(size);
+}
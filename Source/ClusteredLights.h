@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////////////
+// clusteredlights.h
+// ============
+// assign point lights to view-space clusters for clustered forward shading
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "ResourceManager.h"
+
+#include <vector>
+
+// must match the CLUSTER_COUNT defines in the fragment shader
+#define CLUSTER_COUNT_X 16
+#define CLUSTER_COUNT_Y 9
+#define CLUSTER_COUNT_Z 24
+
+/***********************************************************
+ *  ClusteredLights
+ *
+ *  This class splits the view frustum into a grid of
+ *  clusters - screen tiles in X and Y and exponential depth
+ *  slices in Z - and works out on the CPU which point lights
+ *  reach each cluster.  The fragment shader finds its
+ *  cluster from gl_FragCoord and its view depth and loops
+ *  only over the lights listed there, so any number of lights
+ *  can be in the scene.
+ *
+ *  The lights, the per-cluster ranges and the light index
+ *  list are kept in texture buffers, which work on the
+ *  OpenGL 3.3 context as well as the 4.6 one.
+ ***********************************************************/
+class ClusteredLights
+{
+public:
+	// constructor
+	ClusteredLights(ResourceManager* pResources);
+	// destructor
+	~ClusteredLights();
+
+	// texture units the buffers are bound to - above the texture arrays
+	enum TextureUnit
+	{
+		LIGHT_TEXTURE_UNIT = 13,
+		GRID_TEXTURE_UNIT = 14,
+		INDEX_TEXTURE_UNIT = 15
+	};
+
+	struct POINT_LIGHT
+	{
+		glm::vec3 position;
+		// distance at which the light has faded to nothing
+		float range;
+		glm::vec3 ambient;
+		glm::vec3 diffuse;
+		glm::vec3 specular;
+	};
+
+	// create the buffers - needs a current OpenGL context
+	void Create();
+	// free the buffers
+	void Destroy();
+
+	// edit the list of lights
+	void Clear();
+	int AddPointLight(const POINT_LIGHT& light);
+	void SetPointLight(int index, const POINT_LIGHT& light);
+	int Count() const { return((int)m_lights.size()); }
+
+	// assign the lights to the clusters for the camera - skipped
+	// when nothing has changed since the last call
+	void Update(const glm::mat4& view, const glm::mat4& projection, int viewportWidth, int viewportHeight);
+	// bind the buffer textures to their texture units
+	void Bind() const;
+
+	// values the shader uses to find its cluster: 1 / tile width,
+	// 1 / tile height, depth slice scale and depth slice bias
+	glm::vec4 ClusterScale() const { return(m_clusterScale); }
+	// light references written into the clusters by the last update
+	int IndexCount() const { return((int)m_indices.size()); }
+
+private:
+	// view-space bounds of one cluster
+	struct CLUSTER_BOUNDS
+	{
+		glm::vec3 minPoint;
+		glm::vec3 maxPoint;
+	};
+
+	std::vector<POINT_LIGHT> m_lights;
+	bool m_bLightsDirty;
+
+	std::vector<CLUSTER_BOUNDS> m_bounds;
+	// offset and count into m_indices for every cluster
+	std::vector<GLuint> m_grid;
+	std::vector<GLuint> m_indices;
+
+	// camera values used for the current assignment
+	glm::mat4 m_view;
+	glm::mat4 m_projection;
+	int m_viewportWidth;
+	int m_viewportHeight;
+	float m_nearPlane;
+	float m_farPlane;
+	glm::vec4 m_clusterScale;
+	bool m_bValid;
+
+	ResourceManager* m_pResources;
+	ResourceManager::Handle m_lightBuffer;
+	ResourceManager::Handle m_lightTexture;
+	ResourceManager::Handle m_gridBuffer;
+	ResourceManager::Handle m_gridTexture;
+	ResourceManager::Handle m_indexBuffer;
+	ResourceManager::Handle m_indexTexture;
+
+	// rebuild the cluster bounds for a new projection or viewport
+	void BuildBounds();
+	// write the data into a texture buffer
+	static void Upload(ResourceManager::Handle& buffer, const void* data, size_t size);
+};
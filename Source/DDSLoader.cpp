@@ -0,0 +1,223 @@
+///////////////////////////////////////////////////////////////////////////////
+// ddsloader.cpp
+// ============
+// read precompressed, pre-mipmapped BCn textures from DDS files
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DDSLoader.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// "DDS " magic number followed by the 124 byte header
+	const uint32_t g_DDSMagic = 0x20534444;
+	const size_t g_DDSHeaderSize = 4 + 124;
+	// the optional DX10 header that follows the main header
+	const size_t g_DX10HeaderSize = 20;
+
+	// byte offsets into the file
+	const size_t g_HeightOffset = 12;
+	const size_t g_WidthOffset = 16;
+	const size_t g_MipCountOffset = 28;
+	const size_t g_FourCCOffset = 84;
+	const size_t g_DXGIFormatOffset = 128;
+
+	// DXGI_FORMAT values used in the DX10 header
+	const uint32_t g_DXGI_BC1_UNORM = 71;
+	const uint32_t g_DXGI_BC1_UNORM_SRGB = 72;
+	const uint32_t g_DXGI_BC3_UNORM = 77;
+	const uint32_t g_DXGI_BC3_UNORM_SRGB = 78;
+	const uint32_t g_DXGI_BC7_UNORM = 98;
+	const uint32_t g_DXGI_BC7_UNORM_SRGB = 99;
+
+	// larger than any texture a driver accepts, so the level
+	// sizes cannot overflow
+	const uint32_t g_MaxDimension = 65536;
+
+	uint32_t MakeFourCC(char a, char b, char c, char d)
+	{
+		return((uint32_t)(unsigned char)a | ((uint32_t)(unsigned char)b << 8) |
+			((uint32_t)(unsigned char)c << 16) | ((uint32_t)(unsigned char)d << 24));
+	}
+
+	uint32_t ReadUInt32(const unsigned char* bytes, size_t offset)
+	{
+		return((uint32_t)bytes[offset] | ((uint32_t)bytes[offset + 1] << 8) |
+			((uint32_t)bytes[offset + 2] << 16) | ((uint32_t)bytes[offset + 3] << 24));
+	}
+}
+
+/***********************************************************
+ *  ReadHeader()
+ *
+ *  This method is used for reading the header of a DDS file
+ *  and working out the compressed format, the size of the
+ *  image and where its pixel data is.  The sRGB formats are
+ *  loaded like the plain ones, since the PNG textures are
+ *  not treated as sRGB either.
+ ***********************************************************/
+bool DDSLoader::ReadHeader(const char* filename, DDS_INFO& info)
+{
+	FILE* file = fopen(filename, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	unsigned char header[g_DDSHeaderSize + g_DX10HeaderSize] = { 0 };
+	size_t headerBytes = fread(header, 1, sizeof(header), file);
+	fseek(file, 0, SEEK_END);
+	long fileSize = ftell(file);
+	fclose(file);
+
+	if ((headerBytes < g_DDSHeaderSize) || (ReadUInt32(header, 0) != g_DDSMagic))
+	{
+		std::cout << "Not a DDS file:" << filename << std::endl;
+		return false;
+	}
+
+	uint32_t height = ReadUInt32(header, g_HeightOffset);
+	uint32_t width = ReadUInt32(header, g_WidthOffset);
+	uint32_t mipCount = ReadUInt32(header, g_MipCountOffset);
+	if ((width == 0) || (height == 0) || (width > g_MaxDimension) || (height > g_MaxDimension))
+	{
+		std::cout << "DDS file has an invalid size:" << filename << std::endl;
+		return false;
+	}
+
+	// a full chain goes down to 1x1 - floor(log2(largest side)) + 1 levels
+	uint32_t maxMipLevels = 1;
+	for (uint32_t side = (width > height) ? width : height; side > 1; side >>= 1)
+	{
+		maxMipLevels++;
+	}
+	if (mipCount > maxMipLevels)
+	{
+		std::cout << "DDS file has more mip levels than its size allows:" << filename << std::endl;
+		return false;
+	}
+
+	info.height = (int)height;
+	info.width = (int)width;
+	info.mipLevels = (mipCount < 1) ? 1 : (int)mipCount;
+	info.dataOffset = g_DDSHeaderSize;
+	info.format = 0;
+
+	uint32_t fourCC = ReadUInt32(header, g_FourCCOffset);
+	if (fourCC == MakeFourCC('D', 'X', 'T', '1'))
+	{
+		info.format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	}
+	else if (fourCC == MakeFourCC('D', 'X', 'T', '5'))
+	{
+		info.format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	}
+	else if ((fourCC == MakeFourCC('D', 'X', '1', '0')) && (headerBytes >= g_DDSHeaderSize + g_DX10HeaderSize))
+	{
+		info.dataOffset = g_DDSHeaderSize + g_DX10HeaderSize;
+		uint32_t dxgiFormat = ReadUInt32(header, g_DXGIFormatOffset);
+		if ((dxgiFormat == g_DXGI_BC1_UNORM) || (dxgiFormat == g_DXGI_BC1_UNORM_SRGB))
+		{
+			info.format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		}
+		else if ((dxgiFormat == g_DXGI_BC3_UNORM) || (dxgiFormat == g_DXGI_BC3_UNORM_SRGB))
+		{
+			info.format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		}
+		else if ((dxgiFormat == g_DXGI_BC7_UNORM) || (dxgiFormat == g_DXGI_BC7_UNORM_SRGB))
+		{
+			info.format = GL_COMPRESSED_RGBA_BPTC_UNORM;
+		}
+	}
+
+	if (info.format == 0)
+	{
+		std::cout << "Only BC1, BC3 and BC7 DDS files are supported:" << filename << std::endl;
+		return false;
+	}
+
+	info.blockBytes = (info.format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16;
+
+	info.dataSize = 0;
+	for (int level = 0; level < info.mipLevels; level++)
+	{
+		info.dataSize += LevelSize(info, level);
+	}
+
+	if ((fileSize < 0) || ((size_t)fileSize < info.dataOffset + info.dataSize))
+	{
+		std::cout << "DDS file is too short for its mip levels:" << filename << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/***********************************************************
+ *  ReadData()
+ *
+ *  This method is used for reading the compressed pixel data
+ *  of every mip level into memory.  It is safe to call from
+ *  a worker thread.
+ ***********************************************************/
+unsigned char* DDSLoader::ReadData(const char* filename, const DDS_INFO& info)
+{
+	FILE* file = fopen(filename, "rb");
+	if (file == NULL)
+	{
+		return(NULL);
+	}
+
+	unsigned char* data = new unsigned char[info.dataSize];
+	bool bRead = (fseek(file, (long)info.dataOffset, SEEK_SET) == 0) &&
+		(fread(data, 1, info.dataSize, file) == info.dataSize);
+	fclose(file);
+
+	if (bRead == false)
+	{
+		delete[] data;
+		return(NULL);
+	}
+
+	return(data);
+}
+
+/***********************************************************
+ *  LevelSize()
+ *
+ *  This method is used for getting the number of bytes in
+ *  one mip level - the image is stored as 4x4 pixel blocks.
+ ***********************************************************/
+size_t DDSLoader::LevelSize(const DDS_INFO& info, int level)
+{
+	int width = info.width >> level;
+	int height = info.height >> level;
+	width = (width > 0) ? width : 1;
+	height = (height > 0) ? height : 1;
+
+	return((size_t)((width + 3) / 4) * (size_t)((height + 3) / 4) * (size_t)info.blockBytes);
+}
+
+/***********************************************************
+ *  IsFormatSupported()
+ *
+ *  This method is used for checking that the OpenGL context
+ *  supports a compressed format.  BC1 and BC3 need S3TC, and
+ *  BC7 needs BPTC, which is core only from OpenGL 4.2.
+ ***********************************************************/
+bool DDSLoader::IsFormatSupported(GLenum format)
+{
+	if (format == GL_COMPRESSED_RGBA_BPTC_UNORM)
+	{
+		return(GLEW_ARB_texture_compression_bptc != 0);
+	}
+
+	return(GLEW_EXT_texture_compression_s3tc != 0);
+}
@@ -0,0 +1,52 @@
+///////////////////////////////////////////////////////////////////////////////
+// ddsloader.h
+// ============
+// read precompressed, pre-mipmapped BCn textures from DDS files
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+/***********************************************************
+ *  DDSLoader
+ *
+ *  This class reads DDS files holding BC1, BC3 or BC7 block
+ *  compressed images, with either the legacy DXT1/DXT5 four
+ *  character codes or the DX10 extended header.  The pixel
+ *  data is returned exactly as stored, with every mip level
+ *  one after the other, ready for glCompressedTexSubImage3D().
+ *  Use tools/convert_textures.bat to make the files.
+ ***********************************************************/
+class DDSLoader
+{
+public:
+	struct DDS_INFO
+	{
+		int width;
+		int height;
+		int mipLevels;
+		// OpenGL compressed internal format
+		GLenum format;
+		// bytes in one 4x4 block - 8 for BC1, 16 for BC3 and BC7
+		int blockBytes;
+		// where the pixel data starts in the file
+		size_t dataOffset;
+		// bytes of pixel data for all mip levels
+		size_t dataSize;
+	};
+
+	// read and check the header only
+	static bool ReadHeader(const char* filename, DDS_INFO& info);
+	// read the pixel data for all mip levels - free with delete[]
+	static unsigned char* ReadData(const char* filename, const DDS_INFO& info);
+	// bytes of one mip level
+	static size_t LevelSize(const DDS_INFO& info, int level);
+	// whether the current OpenGL context can sample the format
+	static bool IsFormatSupported(GLenum format);
+};
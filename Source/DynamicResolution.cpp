@@ -0,0 +1,358 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.cpp
+// ============
+// render the scene below the window's resolution to hold a target frame time
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const double g_DefaultTargetMs = 16.0;
+	const float g_DefaultMinScale = 0.5f;
+	const float g_LowestMinScale = 0.25f;
+	const float g_MaxScale = 1.0f;
+	// the scale moves in steps, so it does not change a little
+	// every frame with the noise in the timings
+	const float g_ScaleStep = 0.05f;
+	// share of the new GPU time mixed into the smoothed value
+	const double g_Smoothing = 0.2;
+	// frames measured at a scale before it is lowered or raised
+	const int g_LowerAfterFrames = 2;
+	const int g_RaiseAfterFrames = 30;
+	// the scale is only raised when the frames are this far
+	// under the target, and lowered to land this far under it
+	const double g_RaiseHeadroom = 0.8;
+	const double g_LowerHeadroom = 0.9;
+}
+
+/***********************************************************
+ *  DynamicResolution()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DynamicResolution::DynamicResolution(ResourceManager* pResources)
+{
+	m_pResources = pResources;
+	m_bEnabled = false;
+	m_targetMs = g_DefaultTargetMs;
+	m_minScale = g_DefaultMinScale;
+	m_scale = g_MaxScale;
+	m_gpuFrameMs = 0.0;
+	m_framesSinceChange = 0;
+
+	m_bufferWidth = 0;
+	m_bufferHeight = 0;
+
+	m_outputFramebuffer = 0;
+	m_outputWidth = 0;
+	m_outputHeight = 0;
+	m_renderWidth = 0;
+	m_renderHeight = 0;
+
+	for (int i = 0; i < QUERY_FRAMES; i++)
+	{
+		m_queryFrames[i].queries[0] = 0;
+		m_queryFrames[i].queries[1] = 0;
+		m_queryFrames[i].scale = g_MaxScale;
+		m_queryFrames[i].bIssued = false;
+	}
+	m_queryFrame = 0;
+}
+
+/***********************************************************
+ *  ~DynamicResolution()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DynamicResolution::~DynamicResolution()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  ParseArguments()
+ *
+ *  This method is used for reading the dynamic resolution
+ *  options from the command line.
+ ***********************************************************/
+void DynamicResolution::ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--dynamic-resolution") == 0)
+		{
+			m_bEnabled = true;
+		}
+		else if ((strcmp(argv[i], "--target-frame-ms") == 0) && (i + 1 < argc))
+		{
+			double targetMs = atof(argv[++i]);
+			if (targetMs > 0.0)
+			{
+				m_targetMs = targetMs;
+			}
+		}
+		else if ((strcmp(argv[i], "--min-render-scale") == 0) && (i + 1 < argc))
+		{
+			float minScale = (float)atof(argv[++i]);
+			m_minScale = std::max(g_LowestMinScale, std::min(minScale, g_MaxScale));
+		}
+	}
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the timestamp queries.
+ *  The framebuffer is allocated by the first frame, once the
+ *  size of the output is known.
+ ***********************************************************/
+void DynamicResolution::Create()
+{
+	if ((m_bEnabled == false) || (m_queryFrames[0].queries[0] != 0))
+	{
+		return;
+	}
+
+	for (int i = 0; i < QUERY_FRAMES; i++)
+	{
+		glGenQueries(2, m_queryFrames[i].queries);
+	}
+
+	std::cout << "Dynamic resolution: target " << m_targetMs << " ms, scale " << m_minScale << " to " << g_MaxScale << std::endl;
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the framebuffer and the
+ *  queries.
+ ***********************************************************/
+void DynamicResolution::Destroy()
+{
+	DestroyBuffers();
+
+	for (int i = 0; i < QUERY_FRAMES; i++)
+	{
+		if (m_queryFrames[i].queries[0] != 0)
+		{
+			glDeleteQueries(2, m_queryFrames[i].queries);
+			m_queryFrames[i].queries[0] = 0;
+			m_queryFrames[i].queries[1] = 0;
+		}
+		m_queryFrames[i].bIssued = false;
+	}
+}
+
+/***********************************************************
+ *  CreateBuffers()
+ *
+ *  This method is used for allocating the color and depth
+ *  buffers the scene is drawn into.  They are the full size
+ *  of the output, the most the scale can ask for.
+ ***********************************************************/
+bool DynamicResolution::CreateBuffers(int width, int height)
+{
+	DestroyBuffers();
+
+	m_colorBuffer = m_pResources->CreateRenderbuffer(ResourceManager::CATEGORY_RENDER_TARGETS, "dynamic resolution color buffer");
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer.Name());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	m_colorBuffer.SetSize((size_t)width * height * 4);
+	m_depthBuffer = m_pResources->CreateRenderbuffer(ResourceManager::CATEGORY_RENDER_TARGETS, "dynamic resolution depth buffer");
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer.Name());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	m_depthBuffer.SetSize((size_t)width * height * 4);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	m_framebuffer = m_pResources->CreateFramebuffer("dynamic resolution framebuffer");
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.Name());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer.Name());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer.Name());
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (GL_FRAMEBUFFER_COMPLETE != status)
+	{
+		std::cout << "Dynamic resolution framebuffer is incomplete - drawing at full resolution" << std::endl;
+		DestroyBuffers();
+		return(false);
+	}
+
+	m_bufferWidth = width;
+	m_bufferHeight = height;
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyBuffers()
+ *
+ *  This method is used for freeing the framebuffer.
+ ***********************************************************/
+void DynamicResolution::DestroyBuffers()
+{
+	m_framebuffer.Reset();
+	m_colorBuffer.Reset();
+	m_depthBuffer.Reset();
+	m_bufferWidth = 0;
+	m_bufferHeight = 0;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for binding the framebuffer the scene
+ *  is drawn into.  The buffers follow the output's size, so
+ *  they are allocated again after the window is resized.
+ ***********************************************************/
+void DynamicResolution::BeginFrame(GLuint outputFramebuffer, int outputWidth, int outputHeight)
+{
+	m_outputFramebuffer = outputFramebuffer;
+	m_outputWidth = outputWidth;
+	m_outputHeight = outputHeight;
+	m_renderWidth = outputWidth;
+	m_renderHeight = outputHeight;
+
+	if (m_bEnabled && ((m_bufferWidth != outputWidth) || (m_bufferHeight != outputHeight)))
+	{
+		if (CreateBuffers(outputWidth, outputHeight) == false)
+		{
+			m_bEnabled = false;
+		}
+	}
+
+	if (m_bEnabled == false)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+		glViewport(0, 0, outputWidth, outputHeight);
+		return;
+	}
+
+	// the slot about to be used again holds the oldest frame
+	ReadQueries();
+
+	m_renderWidth = std::max(1, (int)(outputWidth * m_scale + 0.5f));
+	m_renderHeight = std::max(1, (int)(outputHeight * m_scale + 0.5f));
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.Name());
+	glViewport(0, 0, m_renderWidth, m_renderHeight);
+
+	QUERY_FRAME& queryFrame = m_queryFrames[m_queryFrame];
+	glQueryCounter(queryFrame.queries[0], GL_TIMESTAMP);
+	queryFrame.scale = m_scale;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for stretching the drawn part of the
+ *  framebuffer over the output.  The output is left bound at
+ *  its full size, for anything drawn over the scene.
+ ***********************************************************/
+void DynamicResolution::EndFrame()
+{
+	if (m_bEnabled == false)
+	{
+		return;
+	}
+
+	QUERY_FRAME& queryFrame = m_queryFrames[m_queryFrame];
+	glQueryCounter(queryFrame.queries[1], GL_TIMESTAMP);
+	queryFrame.bIssued = true;
+	m_queryFrame = (m_queryFrame + 1) % QUERY_FRAMES;
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer.Name());
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_outputFramebuffer);
+	glBlitFramebuffer(
+		0, 0, m_renderWidth, m_renderHeight,
+		0, 0, m_outputWidth, m_outputHeight,
+		GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_outputFramebuffer);
+	glViewport(0, 0, m_outputWidth, m_outputHeight);
+}
+
+/***********************************************************
+ *  ReadQueries()
+ *
+ *  This method is used for reading the GPU time of the
+ *  oldest frame in flight.  Results that are not ready yet
+ *  are dropped rather than waited for, and frames drawn at
+ *  an older scale say nothing about the current one.
+ ***********************************************************/
+void DynamicResolution::ReadQueries()
+{
+	QUERY_FRAME& queryFrame = m_queryFrames[m_queryFrame];
+	if (queryFrame.bIssued == false)
+	{
+		return;
+	}
+	queryFrame.bIssued = false;
+
+	GLint available = 0;
+	glGetQueryObjectiv(queryFrame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if ((available == 0) || (queryFrame.scale != m_scale))
+	{
+		return;
+	}
+
+	GLuint64 start = 0;
+	GLuint64 end = 0;
+	glGetQueryObjectui64v(queryFrame.queries[0], GL_QUERY_RESULT, &start);
+	glGetQueryObjectui64v(queryFrame.queries[1], GL_QUERY_RESULT, &end);
+	double frameMs = (double)(end - start) / 1000000.0;
+
+	if (m_framesSinceChange == 0)
+	{
+		m_gpuFrameMs = frameMs;
+	}
+	else
+	{
+		m_gpuFrameMs += (frameMs - m_gpuFrameMs) * g_Smoothing;
+	}
+	m_framesSinceChange++;
+
+	AdjustScale();
+}
+
+/***********************************************************
+ *  AdjustScale()
+ *
+ *  This method is used for picking the scale of the next
+ *  frames.  The GPU time is taken to grow with the number of
+ *  pixels drawn, the square of the scale, so a slow frame
+ *  jumps straight to the scale that should fit the target.
+ *  Going back up is one step at a time.
+ ***********************************************************/
+void DynamicResolution::AdjustScale()
+{
+	float scale = m_scale;
+
+	if ((m_gpuFrameMs > m_targetMs) && (m_framesSinceChange >= g_LowerAfterFrames))
+	{
+		float fitted = m_scale * (float)std::sqrt(m_targetMs * g_LowerHeadroom / m_gpuFrameMs);
+		fitted = std::floor(fitted / g_ScaleStep) * g_ScaleStep;
+		scale = std::min(fitted, m_scale - g_ScaleStep);
+	}
+	else if ((m_gpuFrameMs < m_targetMs * g_RaiseHeadroom) && (m_framesSinceChange >= g_RaiseAfterFrames))
+	{
+		scale = m_scale + g_ScaleStep;
+	}
+
+	scale = std::max(m_minScale, std::min(scale, g_MaxScale));
+	if (scale != m_scale)
+	{
+		m_scale = scale;
+		m_framesSinceChange = 0;
+	}
+}
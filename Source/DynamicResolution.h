@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.h
+// ============
+// render the scene below the window's resolution to hold a target frame time
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "ResourceManager.h"
+
+/***********************************************************
+ *  DynamicResolution
+ *
+ *  This class draws the scene into an offscreen framebuffer
+ *  and stretches it over the window with a filtered blit.
+ *  When enabled, only the lower left part of the buffer is
+ *  drawn - a share of the window's size set by the render
+ *  scale - so changing the scale never reallocates anything.
+ *
+ *  The GPU time of each frame is measured with timestamp
+ *  queries, which are read a few frames later so the CPU
+ *  never waits on them and which do not get in the way of
+ *  the profiler's elapsed time queries.  The scale is lowered
+ *  as soon as the frames take longer than the target, and
+ *  raised again slowly while there is room to spare.
+ ***********************************************************/
+class DynamicResolution
+{
+public:
+	// constructor
+	DynamicResolution(ResourceManager* pResources);
+	// destructor
+	~DynamicResolution();
+
+	// frames of timestamp queries in flight
+	static const int QUERY_FRAMES = 3;
+
+	// read the options from the command line:
+	//   --dynamic-resolution      scale the resolution to the target
+	//   --target-frame-ms <ms>    GPU time to hold (default 16.0)
+	//   --min-render-scale <s>    lowest scale, 0.25 to 1 (default 0.5)
+	void ParseArguments(int argc, char* argv[]);
+
+	bool Enabled() const { return(m_bEnabled); }
+	// share of the output's width and height that is drawn
+	float Scale() const { return(m_scale); }
+	// smoothed GPU time of the frames, in milliseconds
+	double GpuFrameMs() const { return(m_gpuFrameMs); }
+
+	// create the queries - needs a current OpenGL context
+	void Create();
+	// free the framebuffer and the queries
+	void Destroy();
+
+	// bind the framebuffer the scene is drawn into and set the
+	// viewport - the output is drawn to directly when disabled
+	void BeginFrame(GLuint outputFramebuffer, int outputWidth, int outputHeight);
+	// upscale the frame to the output, leave the output bound and
+	// adjust the scale from the measured frames
+	void EndFrame();
+
+private:
+	// the timestamps of one frame
+	struct QUERY_FRAME
+	{
+		GLuint queries[2];
+		float scale;
+		bool bIssued;
+	};
+
+	bool m_bEnabled;
+	double m_targetMs;
+	float m_minScale;
+	float m_scale;
+	double m_gpuFrameMs;
+	// frames drawn since the scale last changed
+	int m_framesSinceChange;
+
+	ResourceManager* m_pResources;
+	ResourceManager::Handle m_framebuffer;
+	ResourceManager::Handle m_colorBuffer;
+	ResourceManager::Handle m_depthBuffer;
+	int m_bufferWidth;
+	int m_bufferHeight;
+
+	GLuint m_outputFramebuffer;
+	int m_outputWidth;
+	int m_outputHeight;
+	int m_renderWidth;
+	int m_renderHeight;
+
+	QUERY_FRAME m_queryFrames[QUERY_FRAMES];
+	int m_queryFrame;
+
+	// allocate the buffers for the size of the output
+	bool CreateBuffers(int width, int height);
+	void DestroyBuffers();
+	// read the oldest frame's timestamps when they are ready
+	void ReadQueries();
+	// pick the scale for the next frames from the GPU time
+	void AdjustScale();
+};
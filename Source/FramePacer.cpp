@@ -0,0 +1,269 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacer.cpp
+// ============
+// control how often frames are presented - vsync modes, frame cap and idle
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FramePacer.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+// declaration of global variables
+namespace
+{
+	const double g_DefaultFrameCap = 60.0;
+	// the last part of a frame cap sleep is spun, since the
+	// scheduler can wake the thread late by about this much
+	const std::chrono::microseconds g_SpinMargin(1500);
+	// longest wait for events in idle mode, so the loop still
+	// notices a closed window or finished background work
+	const double g_IdleWaitSeconds = 0.25;
+
+	// set by the window refresh callback
+	bool g_bRefreshRequested = false;
+}
+
+/***********************************************************
+ *  FramePacer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FramePacer::FramePacer()
+{
+	m_presentMode = PresentMode::VSYNC;
+	m_bIdleMode = false;
+	// the first frame is always drawn
+	m_bInvalidated = true;
+	m_bFrameDrawn = true;
+	SetFrameCap(g_DefaultFrameCap);
+	m_nextFrameTime = std::chrono::steady_clock::now();
+
+#ifdef _WIN32
+	// the default timer resolution of about 15 ms is too coarse
+	// for sleeping between frames
+	timeBeginPeriod(1);
+#endif
+}
+
+/***********************************************************
+ *  ~FramePacer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+/***********************************************************
+ *  ParseArguments()
+ *
+ *  This method is used for reading the frame pacing options
+ *  from the command line.  Unknown arguments are ignored.
+ ***********************************************************/
+void FramePacer::ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--vsync") == 0)
+		{
+			m_presentMode = PresentMode::VSYNC;
+		}
+		else if (strcmp(argv[i], "--adaptive-vsync") == 0)
+		{
+			m_presentMode = PresentMode::ADAPTIVE_VSYNC;
+		}
+		else if (strcmp(argv[i], "--uncapped") == 0)
+		{
+			m_presentMode = PresentMode::UNCAPPED;
+		}
+		else if ((strcmp(argv[i], "--fps-cap") == 0) && (i + 1 < argc))
+		{
+			m_presentMode = PresentMode::FRAME_CAP;
+			SetFrameCap(atof(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--idle") == 0)
+		{
+			m_bIdleMode = true;
+		}
+	}
+}
+
+/***********************************************************
+ *  SetFrameCap()
+ *
+ *  This method is used for setting the frame rate kept by
+ *  the FRAME_CAP mode.
+ ***********************************************************/
+void FramePacer::SetFrameCap(double framesPerSecond)
+{
+	if (framesPerSecond <= 0.0)
+	{
+		std::cout << "FramePacer: invalid frame cap " << framesPerSecond << ", using " << g_DefaultFrameCap << std::endl;
+		framesPerSecond = g_DefaultFrameCap;
+	}
+
+	m_framePeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		std::chrono::duration<double>(1.0 / framesPerSecond));
+}
+
+/***********************************************************
+ *  Apply()
+ *
+ *  This method is used for setting the swap interval of the
+ *  window's context for the present mode.  Adaptive vsync
+ *  needs a swap control tear extension and falls back to
+ *  plain vsync without one.
+ ***********************************************************/
+void FramePacer::Apply(GLFWwindow* window)
+{
+	if (NULL == window)
+	{
+		return;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetWindowRefreshCallback(window, &FramePacer::Window_Refresh_Callback);
+
+	int interval = 1;
+	switch (m_presentMode)
+	{
+	case PresentMode::VSYNC:
+		std::cout << "Present mode: vsync";
+		break;
+	case PresentMode::ADAPTIVE_VSYNC:
+		if (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+		{
+			interval = -1;
+			std::cout << "Present mode: adaptive vsync";
+		}
+		else
+		{
+			std::cout << "Present mode: vsync (adaptive vsync is not supported)";
+		}
+		break;
+	case PresentMode::UNCAPPED:
+		interval = 0;
+		std::cout << "Present mode: uncapped";
+		break;
+	case PresentMode::FRAME_CAP:
+		interval = 0;
+		std::cout << "Present mode: capped at " << (1.0 / std::chrono::duration<double>(m_framePeriod).count()) << " fps";
+		break;
+	}
+	std::cout << (m_bIdleMode ? ", idle when nothing changes" : "") << std::endl;
+
+	glfwSwapInterval(interval);
+	m_nextFrameTime = std::chrono::steady_clock::now() + m_framePeriod;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for deciding whether to draw a frame.
+ *  Every frame is drawn unless idle mode is on, which only
+ *  draws when something changed or a redraw was asked for.
+ ***********************************************************/
+bool FramePacer::BeginFrame(bool bChanged)
+{
+	m_bFrameDrawn = (m_bIdleMode == false) || bChanged || m_bInvalidated || g_bRefreshRequested;
+	m_bInvalidated = false;
+	g_bRefreshRequested = false;
+
+	return(m_bFrameDrawn);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for holding the frame rate in the
+ *  FRAME_CAP mode.  A frame that runs late moves the schedule
+ *  instead of making the next frames hurry to catch up.
+ ***********************************************************/
+void FramePacer::EndFrame()
+{
+	if ((m_presentMode != PresentMode::FRAME_CAP) || (m_bFrameDrawn == false))
+	{
+		return;
+	}
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (now < m_nextFrameTime)
+	{
+		SleepUntil(m_nextFrameTime);
+		m_nextFrameTime += m_framePeriod;
+	}
+	else
+	{
+		m_nextFrameTime = now + m_framePeriod;
+	}
+}
+
+/***********************************************************
+ *  ProcessEvents()
+ *
+ *  This method is used for handling the waiting window
+ *  events.  In idle mode, after a skipped frame, the thread
+ *  sleeps until an event arrives.  Returns true when it
+ *  waited, so the caller can restart its frame timing.
+ ***********************************************************/
+bool FramePacer::ProcessEvents()
+{
+	if (m_bIdleMode && (m_bFrameDrawn == false))
+	{
+		glfwWaitEventsTimeout(g_IdleWaitSeconds);
+		return(true);
+	}
+
+	glfwPollEvents();
+	return(false);
+}
+
+/***********************************************************
+ *  Window_Refresh_Callback()
+ *
+ *  This method is called by GLFW when the contents of the
+ *  window were damaged and have to be drawn again.
+ ***********************************************************/
+void FramePacer::Window_Refresh_Callback(GLFWwindow* window)
+{
+	g_bRefreshRequested = true;
+}
+
+/***********************************************************
+ *  SleepUntil()
+ *
+ *  This method is used for sleeping until the passed in
+ *  time.  The thread sleeps for most of the wait and yields
+ *  in a loop for the last g_SpinMargin, which keeps the
+ *  wake-up accurate without spinning for the whole frame.
+ ***********************************************************/
+void FramePacer::SleepUntil(std::chrono::steady_clock::time_point wakeTime)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (wakeTime - now > g_SpinMargin)
+	{
+		std::this_thread::sleep_for(wakeTime - now - g_SpinMargin);
+	}
+
+	while (std::chrono::steady_clock::now() < wakeTime)
+	{
+		std::this_thread::yield();
+	}
+}
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacer.h
+// ============
+// control how often frames are presented - vsync modes, frame cap and idle
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// GLFW library
+#include "GLFW/glfw3.h"
+
+#include <chrono>
+
+/***********************************************************
+ *  FramePacer
+ *
+ *  This class decides when the main loop draws and presents
+ *  a frame.  The present mode sets the swap interval of the
+ *  window: synchronized to the display, adaptive (tears
+ *  instead of waiting a whole refresh when a frame is late),
+ *  uncapped, or uncapped with a fixed frame rate enforced by
+ *  sleeping the thread until the next frame is due.
+ *
+ *  In idle mode nothing is drawn while the picture would not
+ *  change, and the loop blocks in glfwWaitEventsTimeout()
+ *  until input arrives, so a static scene uses no CPU or GPU
+ *  time.
+ ***********************************************************/
+class FramePacer
+{
+public:
+	// constructor
+	FramePacer();
+	// destructor
+	~FramePacer();
+
+	// how frames are presented
+	enum class PresentMode
+	{
+		VSYNC,
+		ADAPTIVE_VSYNC,
+		UNCAPPED,
+		FRAME_CAP
+	};
+
+	// read the pacing options from the command line:
+	// --vsync, --adaptive-vsync, --uncapped, --fps-cap <n>, --idle
+	void ParseArguments(int argc, char* argv[]);
+
+	void SetPresentMode(PresentMode mode) { m_presentMode = mode; }
+	PresentMode GetPresentMode() const { return(m_presentMode); }
+	// frames per second used by the FRAME_CAP mode
+	void SetFrameCap(double framesPerSecond);
+	void SetIdleMode(bool bEnabled) { m_bIdleMode = bEnabled; }
+	bool IdleMode() const { return(m_bIdleMode); }
+
+	// set the swap interval of the window for the present mode
+	void Apply(GLFWwindow* window);
+
+	// ask for the next frame to be drawn even in idle mode
+	void Invalidate() { m_bInvalidated = true; }
+	// whether to draw this frame - bChanged is set when the view or
+	// the scene moved since the last frame
+	bool BeginFrame(bool bChanged);
+	// sleep until the next frame is due in the FRAME_CAP mode
+	void EndFrame();
+	// handle window events - blocks in idle mode when the last frame
+	// was skipped, and returns true when it did
+	bool ProcessEvents();
+
+	// window needs to be drawn again, e.g. after being uncovered
+	static void Window_Refresh_Callback(GLFWwindow* window);
+
+private:
+	PresentMode m_presentMode;
+	bool m_bIdleMode;
+	bool m_bInvalidated;
+	bool m_bFrameDrawn;
+	// time between frames in the FRAME_CAP mode
+	std::chrono::steady_clock::duration m_framePeriod;
+	std::chrono::steady_clock::time_point m_nextFrameTime;
+
+	// sleep with better than scheduler precision
+	static void SleepUntil(std::chrono::steady_clock::time_point wakeTime);
+};
@@ -0,0 +1,314 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustumculler.cpp
+// ============
+// test bounding spheres against the camera frustum to skip off-screen draws
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define FRUSTUM_CULLER_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FRUSTUM_CULLER_NEON 1
+#include <arm_neon.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	const int g_PlaneCount = 6;
+	// spheres tested by one job - enough that a job takes longer
+	// than handing it to another thread
+	const int g_CullGrainSize = 1024;
+	// a radius this negative fails every plane test, wherever the
+	// center is
+	const float g_EmptyRadius = -1.0e30f;
+
+	/***********************************************************
+	 *  ExtractPlanes()
+	 *
+	 *  Get the six frustum planes out of a view-projection
+	 *  matrix (Gribb/Hartmann), normalized so the plane
+	 *  distance of a point is in world units.
+	 ***********************************************************/
+	void ExtractPlanes(const glm::mat4& m, glm::vec4 planes[g_PlaneCount])
+	{
+		// glm matrices are column major, so m[column][row]
+		glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+		glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+		glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+		glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+		planes[0] = row3 + row0;  // left
+		planes[1] = row3 - row0;  // right
+		planes[2] = row3 + row1;  // bottom
+		planes[3] = row3 - row1;  // top
+		planes[4] = row3 + row2;  // near
+		planes[5] = row3 - row2;  // far
+
+		for (int i = 0; i < g_PlaneCount; i++)
+		{
+			float length = glm::length(glm::vec3(planes[i]));
+			if (length > 0.0f)
+			{
+				planes[i] /= length;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  FrustumCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrustumCuller::FrustumCuller()
+{
+	m_visibleCount = 0;
+	m_bCulled = false;
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every object.
+ ***********************************************************/
+void FrustumCuller::Clear()
+{
+	m_centerX.clear();
+	m_centerY.clear();
+	m_centerZ.clear();
+	m_radius.clear();
+	m_visible.clear();
+	m_visibleCount = 0;
+	m_bCulled = false;
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method is used for adding the bounding sphere of an
+ *  object and returning its index.
+ ***********************************************************/
+int FrustumCuller::Add(const glm::vec3& center, float radius)
+{
+	m_centerX.push_back(center.x);
+	m_centerY.push_back(center.y);
+	m_centerZ.push_back(center.z);
+	m_radius.push_back(radius);
+	m_visible.push_back(1);
+	m_visibleCount++;
+
+	return((int)m_radius.size() - 1);
+}
+
+/***********************************************************
+ *  Set()
+ *
+ *  This method is used for changing the bounding sphere of
+ *  an object that has moved.
+ ***********************************************************/
+void FrustumCuller::Set(int index, const glm::vec3& center, float radius)
+{
+	if ((index < 0) || (index >= (int)m_radius.size()))
+	{
+		return;
+	}
+
+	m_centerX[index] = center.x;
+	m_centerY[index] = center.y;
+	m_centerZ[index] = center.z;
+	m_radius[index] = radius;
+}
+
+/***********************************************************
+ *  SetEmpty()
+ *
+ *  This method is used for giving an object bounds that no
+ *  frustum can see.
+ ***********************************************************/
+void FrustumCuller::SetEmpty(int index)
+{
+	Set(index, glm::vec3(0.0f, 0.0f, 0.0f), g_EmptyRadius);
+}
+
+/***********************************************************
+ *  TransformBounds()
+ *
+ *  This method is used for getting a world-space bounding
+ *  sphere for a local box.  The radius is grown by the
+ *  largest scale in the model matrix, so it stays around the
+ *  object for any rotation or non-uniform scale.
+ ***********************************************************/
+void FrustumCuller::TransformBounds(const BOUNDS& bounds, const glm::mat4& model, glm::vec3& center, float& radius)
+{
+	glm::vec3 localCenter = (bounds.minPoint + bounds.maxPoint) * 0.5f;
+	float localRadius = glm::length(bounds.maxPoint - localCenter);
+
+	float scale = std::max(glm::length(glm::vec3(model[0])),
+		std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+	center = glm::vec3(model * glm::vec4(localCenter, 1.0f));
+	radius = localRadius * scale;
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method is used for testing every sphere against the
+ *  frustum planes.  A sphere is culled as soon as it is
+ *  completely behind any one plane.
+ ***********************************************************/
+void FrustumCuller::Cull(const glm::mat4& viewProjection, JobSystem* pJobSystem)
+{
+	glm::vec4 planes[g_PlaneCount];
+	ExtractPlanes(viewProjection, planes);
+
+	int count = (int)m_radius.size();
+	PadArrays();
+	int paddedCount = (int)m_radius.size();
+
+	// every job gets whole blocks of four, so no two threads write
+	// into the same part of the vector loop
+	if (NULL != pJobSystem)
+	{
+		pJobSystem->ParallelFor(paddedCount / 4, g_CullGrainSize / 4,
+			[this, &planes](int begin, int end, int)
+			{
+				CullRange(planes, begin * 4, end * 4);
+			});
+	}
+	else
+	{
+		CullRange(planes, 0, paddedCount);
+	}
+
+	// drop the padding again so Count() stays the object count
+	m_centerX.resize(count);
+	m_centerY.resize(count);
+	m_centerZ.resize(count);
+	m_radius.resize(count);
+	m_visible.resize(count);
+
+	m_visibleCount = 0;
+	for (int i = 0; i < count; i++)
+	{
+		m_visibleCount += m_visible[i];
+	}
+	m_bCulled = true;
+}
+
+/***********************************************************
+ *  CullRange()
+ *
+ *  This method is used for testing the spheres from first up
+ *  to last against the frustum planes and storing whether
+ *  each one is visible.
+ ***********************************************************/
+void FrustumCuller::CullRange(const glm::vec4 planes[], int first, int last)
+{
+#if defined(FRUSTUM_CULLER_SSE)
+	for (int i = first; i < last; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(&m_centerX[i]);
+		__m128 y = _mm_loadu_ps(&m_centerY[i]);
+		__m128 z = _mm_loadu_ps(&m_centerZ[i]);
+		__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&m_radius[i]));
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+		for (int p = 0; p < g_PlaneCount; p++)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(planes[p].x)), _mm_mul_ps(y, _mm_set1_ps(planes[p].y))),
+				_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(planes[p].z)), _mm_set1_ps(planes[p].w)));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		m_visible[i] = (uint8_t)(mask & 1);
+		m_visible[i + 1] = (uint8_t)((mask >> 1) & 1);
+		m_visible[i + 2] = (uint8_t)((mask >> 2) & 1);
+		m_visible[i + 3] = (uint8_t)((mask >> 3) & 1);
+	}
+#elif defined(FRUSTUM_CULLER_NEON)
+	for (int i = first; i < last; i += 4)
+	{
+		float32x4_t x = vld1q_f32(&m_centerX[i]);
+		float32x4_t y = vld1q_f32(&m_centerY[i]);
+		float32x4_t z = vld1q_f32(&m_centerZ[i]);
+		float32x4_t negativeRadius = vnegq_f32(vld1q_f32(&m_radius[i]));
+		uint32x4_t inside = vdupq_n_u32(0xFFFFFFFFu);
+
+		for (int p = 0; p < g_PlaneCount; p++)
+		{
+			float32x4_t distance = vdupq_n_f32(planes[p].w);
+			distance = vmlaq_n_f32(distance, x, planes[p].x);
+			distance = vmlaq_n_f32(distance, y, planes[p].y);
+			distance = vmlaq_n_f32(distance, z, planes[p].z);
+			inside = vandq_u32(inside, vcgeq_f32(distance, negativeRadius));
+		}
+
+		uint32_t lanes[4];
+		vst1q_u32(lanes, inside);
+		for (int lane = 0; lane < 4; lane++)
+		{
+			m_visible[i + lane] = (uint8_t)(lanes[lane] != 0);
+		}
+	}
+#else
+	for (int i = first; i < last; i++)
+	{
+		bool bInside = true;
+		for (int p = 0; (p < g_PlaneCount) && bInside; p++)
+		{
+			float distance = planes[p].x * m_centerX[i] + planes[p].y * m_centerY[i] +
+				planes[p].z * m_centerZ[i] + planes[p].w;
+			bInside = (distance >= -m_radius[i]);
+		}
+		m_visible[i] = (uint8_t)(bInside ? 1 : 0);
+	}
+#endif
+}
+
+/***********************************************************
+ *  IsVisible()
+ *
+ *  This method is used for getting whether an object was
+ *  inside the frustum in the last Cull().  Unknown indices
+ *  are treated as visible, so nothing is lost by mistake.
+ ***********************************************************/
+bool FrustumCuller::IsVisible(int index) const
+{
+	if ((m_bCulled == false) || (index < 0) || (index >= (int)m_visible.size()))
+	{
+		return(true);
+	}
+
+	return(m_visible[index] != 0);
+}
+
+/***********************************************************
+ *  PadArrays()
+ *
+ *  This method is used for growing the sphere arrays to a
+ *  multiple of four with spheres that are never visible, so
+ *  the vector loop needs no scalar tail.
+ ***********************************************************/
+void FrustumCuller::PadArrays()
+{
+	size_t paddedCount = (m_radius.size() + 3) & ~((size_t)3);
+
+	m_centerX.resize(paddedCount, 0.0f);
+	m_centerY.resize(paddedCount, 0.0f);
+	m_centerZ.resize(paddedCount, 0.0f);
+	m_radius.resize(paddedCount, g_EmptyRadius);
+	m_visible.resize(paddedCount, 0);
+}
@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustumculler.h
+// ============
+// test bounding spheres against the camera frustum to skip off-screen draws
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+/***********************************************************
+ *  FrustumCuller
+ *
+ *  This class keeps a world-space bounding sphere for every
+ *  object in the scene and tests all of them against the
+ *  six planes of the camera frustum once per frame.
+ *
+ *  The spheres are stored as separate arrays of x, y, z and
+ *  radius (structure of arrays), which lets the tests run on
+ *  four spheres at a time with SSE or NEON where available.
+ *  With a job system the arrays are split into blocks that
+ *  are tested on every core.
+ ***********************************************************/
+class FrustumCuller
+{
+public:
+	// constructor
+	FrustumCuller();
+
+	// axis aligned box in the local space of a mesh
+	struct BOUNDS
+	{
+		glm::vec3 minPoint;
+		glm::vec3 maxPoint;
+	};
+
+	// remove every object
+	void Clear();
+	// add an object and get the index of its bounds
+	int Add(const glm::vec3& center, float radius);
+	// change the bounds of an object after it has moved
+	void Set(int index, const glm::vec3& center, float radius);
+	// give an object bounds that are never visible, for one with
+	// nothing to draw
+	void SetEmpty(int index);
+	int Count() const { return((int)m_radius.size()); }
+	glm::vec3 Center(int index) const { return(glm::vec3(m_centerX[index], m_centerY[index], m_centerZ[index])); }
+	float Radius(int index) const { return(m_radius[index]); }
+
+	// world-space sphere around a local box placed by a model matrix
+	static void TransformBounds(const BOUNDS& bounds, const glm::mat4& model, glm::vec3& center, float& radius);
+
+	// test every object against the frustum of the camera, spread
+	// over the threads of the job system when one is passed in
+	void Cull(const glm::mat4& viewProjection, JobSystem* pJobSystem = NULL);
+	// results of the last Cull() - everything is visible before the first
+	bool IsVisible(int index) const;
+	int VisibleCount() const { return(m_visibleCount); }
+	int CulledCount() const { return(Count() - m_visibleCount); }
+
+private:
+	// sphere arrays, padded to a multiple of four with empty spheres
+	std::vector<float> m_centerX;
+	std::vector<float> m_centerY;
+	std::vector<float> m_centerZ;
+	std::vector<float> m_radius;
+	std::vector<uint8_t> m_visible;
+	int m_visibleCount;
+	bool m_bCulled;
+
+	// keep the arrays a multiple of four long for the vector loop
+	void PadArrays();
+	// test the spheres from first up to last - both multiples of four
+	void CullRange(const glm::vec4 planes[], int first, int last);
+};
@@ -0,0 +1,254 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.cpp
+// ============
+// run the data-parallel parts of a frame across every core
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+/***********************************************************
+ *  JobSystem()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+JobSystem::JobSystem()
+{
+	// 0 picks one thread per core
+	m_requestedThreads = 0;
+	m_queuedJobs = 0;
+	m_bStopping = false;
+
+	// ranges run on the calling thread until Start() is called
+	m_queues.push_back(std::unique_ptr<WORK_QUEUE>(new WORK_QUEUE()));
+}
+
+/***********************************************************
+ *  ~JobSystem()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+JobSystem::~JobSystem()
+{
+	Stop();
+}
+
+/***********************************************************
+ *  ParseArguments()
+ *
+ *  This method is used for reading the thread count from the
+ *  command line.  Unknown arguments are ignored.
+ ***********************************************************/
+void JobSystem::ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--threads") == 0) && (i + 1 < argc))
+		{
+			m_requestedThreads = std::max(1, std::min(atoi(argv[++i]), MAX_THREADS));
+		}
+	}
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for starting a worker thread for every
+ *  core but the one the calling thread runs on.
+ ***********************************************************/
+void JobSystem::Start()
+{
+	if (m_workers.empty() == false)
+	{
+		return;
+	}
+
+	int threadCount = m_requestedThreads;
+	if (threadCount <= 0)
+	{
+		// hardware_concurrency() is 0 when it cannot tell
+		threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+	}
+	threadCount = std::min(threadCount, MAX_THREADS);
+
+	m_bStopping = false;
+	for (int thread = 1; thread < threadCount; thread++)
+	{
+		m_queues.push_back(std::unique_ptr<WORK_QUEUE>(new WORK_QUEUE()));
+	}
+	for (int thread = 1; thread < threadCount; thread++)
+	{
+		m_workers.push_back(std::thread(&JobSystem::WorkerLoop, this, thread));
+	}
+
+	std::cout << "Job system: " << threadCount << " threads" << std::endl;
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for waking the worker threads so they
+ *  finish, and waiting for them.
+ ***********************************************************/
+void JobSystem::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_wakeLock);
+		m_bStopping = true;
+	}
+	m_wake.notify_all();
+
+	for (std::thread& worker : m_workers)
+	{
+		worker.join();
+	}
+	m_workers.clear();
+	m_queues.resize(1);
+}
+
+/***********************************************************
+ *  ParallelFor()
+ *
+ *  This method is used for running a function over a range
+ *  of items on every thread.  The ranges are dealt out to
+ *  the queues in turn, then the calling thread runs jobs -
+ *  its own first, then stolen ones - until the last range
+ *  is done.  Small loops run straight on the calling thread.
+ ***********************************************************/
+void JobSystem::ParallelFor(int count, int grainSize, const RangeFunction& function)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	grainSize = std::max(1, grainSize);
+	int threadCount = ThreadCount();
+	if ((threadCount == 1) || (count <= grainSize))
+	{
+		function(0, count, 0);
+		return;
+	}
+
+	// at least a few ranges per thread, so there is work to steal
+	int jobCount = (count + grainSize - 1) / grainSize;
+	jobCount = std::min(jobCount, threadCount * 8);
+	int rangeSize = (count + jobCount - 1) / jobCount;
+	jobCount = (count + rangeSize - 1) / rangeSize;
+
+	std::atomic<int> remaining(jobCount);
+	for (int i = 0; i < jobCount; i++)
+	{
+		JOB job;
+		job.pFunction = &function;
+		job.begin = i * rangeSize;
+		job.end = std::min(count, job.begin + rangeSize);
+		job.pRemaining = &remaining;
+
+		WORK_QUEUE& queue = *m_queues[i % threadCount];
+		std::lock_guard<std::mutex> lock(queue.lock);
+		queue.jobs.push_back(job);
+	}
+	{
+		// counted under the lock, so a worker about to sleep sees it
+		std::lock_guard<std::mutex> lock(m_wakeLock);
+		m_queuedJobs += jobCount;
+	}
+	m_wake.notify_all();
+
+	while (remaining.load() > 0)
+	{
+		JOB job;
+		if (PopJob(0, job))
+		{
+			RunJob(job, 0);
+		}
+		else
+		{
+			// the last ranges are running on other threads
+			std::this_thread::yield();
+		}
+	}
+}
+
+/***********************************************************
+ *  PopJob()
+ *
+ *  This method is used for taking the newest job from the
+ *  thread's own queue, or else the oldest job from another
+ *  thread's queue.
+ ***********************************************************/
+bool JobSystem::PopJob(int thread, JOB& job)
+{
+	int threadCount = ThreadCount();
+	for (int i = 0; i < threadCount; i++)
+	{
+		int victim = (thread + i) % threadCount;
+		WORK_QUEUE& queue = *m_queues[victim];
+		std::lock_guard<std::mutex> lock(queue.lock);
+		if (queue.jobs.empty())
+		{
+			continue;
+		}
+
+		if (victim == thread)
+		{
+			job = queue.jobs.back();
+			queue.jobs.pop_back();
+		}
+		else
+		{
+			job = queue.jobs.front();
+			queue.jobs.pop_front();
+		}
+		m_queuedJobs--;
+		return(true);
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  RunJob()
+ *
+ *  This method is used for running one range of a loop.
+ ***********************************************************/
+void JobSystem::RunJob(const JOB& job, int thread)
+{
+	(*job.pFunction)(job.begin, job.end, thread);
+	job.pRemaining->fetch_sub(1);
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is used for running jobs on a worker thread
+ *  until the job system stops, sleeping while nothing is
+ *  queued.
+ ***********************************************************/
+void JobSystem::WorkerLoop(int thread)
+{
+	while (true)
+	{
+		JOB job;
+		if (PopJob(thread, job))
+		{
+			RunJob(job, thread);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_wakeLock);
+		m_wake.wait(lock, [this]() { return(m_bStopping || (m_queuedJobs > 0)); });
+		if (m_bStopping)
+		{
+			return;
+		}
+	}
+}
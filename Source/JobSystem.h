@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.h
+// ============
+// run the data-parallel parts of a frame across every core
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  JobSystem
+ *
+ *  This class keeps a pool of worker threads for splitting
+ *  loops over many independent objects.  ParallelFor() cuts a
+ *  loop into ranges and deals them out to a queue per thread.
+ *  Each thread works through its own queue and then steals
+ *  from the others, so the work stays balanced when some
+ *  ranges take longer.  The calling thread works on the loop
+ *  too and returns once every range is done.
+ *
+ *  Jobs must not touch OpenGL - only the thread that owns the
+ *  context can - and must not start another ParallelFor().
+ ***********************************************************/
+class JobSystem
+{
+public:
+	// constructor
+	JobSystem();
+	// destructor
+	~JobSystem();
+
+	// threads used at most, counting the calling thread
+	static const int MAX_THREADS = 32;
+
+	// work on the items from begin up to end, on the passed in
+	// thread - 0 is the calling thread
+	typedef std::function<void(int begin, int end, int thread)> RangeFunction;
+
+	// read the options from the command line:
+	//   --threads <n>   threads to use, 1 runs everything on the
+	//                   calling thread (default: one per core)
+	void ParseArguments(int argc, char* argv[]);
+
+	// start the worker threads
+	void Start();
+	// finish the worker threads
+	void Stop();
+
+	// threads that run jobs, counting the calling thread
+	int ThreadCount() const { return((int)m_queues.size()); }
+
+	// run the function over the items from 0 up to count, in
+	// ranges of about grainSize items, and wait for all of them
+	void ParallelFor(int count, int grainSize, const RangeFunction& function);
+
+private:
+	struct JOB
+	{
+		const RangeFunction* pFunction;
+		int begin;
+		int end;
+		// ranges of the loop not finished yet
+		std::atomic<int>* pRemaining;
+	};
+
+	struct WORK_QUEUE
+	{
+		std::mutex lock;
+		std::deque<JOB> jobs;
+	};
+
+	int m_requestedThreads;
+	// one queue per thread, the first one for the calling thread
+	std::vector<std::unique_ptr<WORK_QUEUE>> m_queues;
+	std::vector<std::thread> m_workers;
+
+	// workers sleep here while there is nothing queued
+	std::mutex m_wakeLock;
+	std::condition_variable m_wake;
+	std::atomic<int> m_queuedJobs;
+	std::atomic<bool> m_bStopping;
+
+	// take a job from the thread's own queue, or steal one
+	bool PopJob(int thread, JOB& job);
+	void RunJob(const JOB& job, int thread);
+	void WorkerLoop(int thread);
+};
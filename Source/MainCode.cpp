@@ -22,6 +22,14 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "UniformBlocks.h"
+#include "ShaderPermutations.h"
+#include "FramePacer.h"
+#include "Profiler.h"
+#include "Benchmark.h"
+#include "DynamicResolution.h"
+#include "ResourceManager.h"
+#include "JobSystem.h"
 #include "sw_version.h"
 
 // Namespace for declaring global variables
@@ -30,6 +38,10 @@ namespace
 	// Macro for window title
 	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
 
+	// shader source files - also compiled as permutations
+	const char* const VERTEX_SHADER_PATH = "shaders/vertexShader.glsl";
+	const char* const FRAGMENT_SHADER_PATH = "shaders/fragmentShader.glsl";
+
 	// Main GLFW window
 	GLFWwindow* g_Window = nullptr;
 
@@ -39,6 +51,22 @@ namespace
 	ShaderManager* g_ShaderManager = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+	// uniform buffers shared by every shader program
+	UniformBlocks* g_UniformBlocks = nullptr;
+	// variants of the shaders compiled with #defines
+	ShaderPermutations* g_ShaderPermutations = nullptr;
+	// owns the OpenGL objects of the scene and counts their memory
+	ResourceManager* g_ResourceManager = nullptr;
+	// decides when frames are drawn and presented
+	FramePacer* g_FramePacer = nullptr;
+	// times the parts of each frame
+	Profiler* g_Profiler = nullptr;
+	// reproducible benchmark runs with a scripted camera
+	Benchmark* g_Benchmark = nullptr;
+	// worker threads for the parallel parts of each frame
+	JobSystem* g_JobSystem = nullptr;
+	// scales the rendered resolution to hold a frame time
+	DynamicResolution* g_DynamicResolution = nullptr;
 }
 
 // Function declarations - all functions that are called manually
@@ -61,11 +89,30 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
+	// textures, buffers and programs are released through handles
+	// and deleted once the GPU has finished the frames using them -
+	// no OpenGL object is created until the first handle is asked for
+	g_ResourceManager = new ResourceManager();
+
+	// a benchmark has to be known before the window is created,
+	// to hide it and leave the cursor free
+	g_Benchmark = new Benchmark(g_ResourceManager);
+	g_Benchmark->ParseArguments(argc, argv);
+	if (g_Benchmark->Offscreen())
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
+
 	// try to create a new shader manager object
 	g_ShaderManager = new ShaderManager();
+	// create the shared uniform buffers - the GL objects are
+	// allocated once the OpenGL context is ready
+	g_UniformBlocks = new UniformBlocks();
 	// try to create a new view manager object
 	g_ViewManager = new ViewManager(
-		g_ShaderManager);
+		g_ShaderManager,
+		g_UniformBlocks);
+	g_ViewManager->SetScriptedCamera(g_Benchmark->Enabled());
 
 	// try to create the main display window
 	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
@@ -78,58 +125,235 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"shaders/vertexShader.glsl",
-		"shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
+	// allocate the uniform buffers - the blocks in each shader
+	// program are attached to them as it is compiled
+	g_UniformBlocks->Create();
+
+	// the permutations are compiled as the scene asks for them
+	g_ShaderPermutations = new ShaderPermutations(
+		VERTEX_SHADER_PATH,
+		FRAGMENT_SHADER_PATH,
+		g_UniformBlocks,
+		g_ResourceManager);
+	// compiled programs are loaded from the binary cache on the
+	// next launch, and rebuilt when the files change if asked to
+	g_ShaderPermutations->ParseArguments(argc, argv);
+	g_ShaderPermutations->Create();
+
+	// load the shader code from the external GLSL files - the base
+	// program is built like the variants, so it comes from the
+	// binary cache and is swapped by a hot reload as well
+	int basePermutation = g_ShaderPermutations->Request(ShaderPermutations::BASE_KEY);
+	glUseProgram(g_ShaderPermutations->Program(basePermutation));
+
+	// the profiler records every frame when asked to export it
+	g_Profiler = new Profiler();
+	g_Profiler->ParseArguments(argc, argv);
+	g_Profiler->Create();
+
+	// the workers update and record the scene, the GL calls all
+	// stay on this thread
+	g_JobSystem = new JobSystem();
+	g_JobSystem->ParseArguments(argc, argv);
+	g_JobSystem->Start();
 
 	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
+	g_SceneManager = new SceneManager(g_ShaderManager, g_UniformBlocks, g_ShaderPermutations, g_Profiler, g_ResourceManager, g_JobSystem);
+	g_SceneManager->ParseArguments(argc, argv);
+	g_SceneManager->SetStressCopies(g_Benchmark->StressCopies());
 	g_SceneManager->PrepareScene();
 
+	// set the swap interval and frame cap from the command line -
+	// a benchmark always runs as fast as it can
+	g_FramePacer = new FramePacer();
+	g_FramePacer->ParseArguments(argc, argv);
+	if (g_Benchmark->Enabled())
+	{
+		g_FramePacer->SetPresentMode(FramePacer::PresentMode::UNCAPPED);
+		g_FramePacer->SetIdleMode(false);
+	}
+	g_FramePacer->Apply(g_Window);
+
+	int framebufferWidth = 0;
+	int framebufferHeight = 0;
+	glfwGetFramebufferSize(g_Window, &framebufferWidth, &framebufferHeight);
+	g_Benchmark->Create(framebufferWidth, framebufferHeight);
+
+	// the scene can be drawn at a lower resolution and stretched
+	// over the window when the GPU cannot keep up
+	g_DynamicResolution = new DynamicResolution(g_ResourceManager);
+	g_DynamicResolution->ParseArguments(argc, argv);
+	g_DynamicResolution->Create();
+
+	// Enable z-depth - this state never changes, so it is set
+	// once instead of every frame
+	glEnable(GL_DEPTH_TEST);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
 	// loop will keep running until the application is closed 
 	// or until an error has occurred
 	while (!glfwWindowShouldClose(g_Window))
 	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
+		// nothing is drawn while the window is minimized, so wait
+		// for it to come back instead of spinning
+		g_ViewManager->GetFramebufferSize(framebufferWidth, framebufferHeight);
+		if ((framebufferWidth == 0) || (framebufferHeight == 0))
+		{
+			glfwWaitEvents();
+			g_ViewManager->ResetFrameTimer();
+			continue;
+		}
+
+		g_Profiler->BeginFrame();
 
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		// a benchmark moves the camera along its path
+		g_Benchmark->BeginFrame(g_ViewManager);
 
 		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
+		{
+			Profiler::CpuScope scope(g_Profiler, "PrepareSceneView");
+			g_ViewManager->PrepareSceneView();
+		}
+
+		// pass on the render toggles set from the keyboard
+		g_SceneManager->SetDepthPrePass(g_ViewManager->DepthPrePassEnabled());
+		g_SceneManager->SetOverdrawView(g_ViewManager->OverdrawViewEnabled());
+		g_Profiler->SetOverlay(g_ViewManager->ProfilerOverlayEnabled());
+
+		// swap in the shaders rebuilt since the last frame
+		bool bShadersReloaded = g_ShaderPermutations->Update();
+
+		// in idle mode the frame is only drawn when something moved
+		if (g_FramePacer->BeginFrame(g_ViewManager->ViewChanged() || g_SceneManager->NeedsRedraw() || bShadersReloaded))
+		{
+			// Clear the frame and z buffers - of the scaled down
+			// framebuffer when the resolution is dynamic
+			g_DynamicResolution->BeginFrame(g_Benchmark->TargetFramebuffer(), framebufferWidth, framebufferHeight);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			// refresh the 3D scene
+			{
+				Profiler::CpuScope scope(g_Profiler, "RenderScene");
+				g_SceneManager->RenderScene();
+			}
+
+			// stretch the scene over the window, and draw the
+			// overlay over it at full resolution
+			g_DynamicResolution->EndFrame();
+			if (g_DynamicResolution->Enabled())
+			{
+				g_Profiler->SetCounter("render scale", g_DynamicResolution->Scale());
+			}
+			g_Profiler->DrawOverlay(g_Window, WINDOW_TITLE);
+
+			// Flips the the back buffer with the front buffer every frame.
+			{
+				Profiler::CpuScope scope(g_Profiler, "SwapBuffers");
+				g_Benchmark->Present(g_Window);
+			}
+		}
 
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
+		// hold the frame cap
+		{
+			Profiler::CpuScope scope(g_Profiler, "FrameCap");
+			g_FramePacer->EndFrame();
+		}
 
+		// query the latest GLFW events - waits for them when idle
+		bool bWaited = false;
+		{
+			Profiler::CpuScope scope(g_Profiler, "PollEvents");
+			bWaited = g_FramePacer->ProcessEvents();
+		}
+		if (bWaited)
+		{
+			g_ViewManager->ResetFrameTimer();
+		}
 
-		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
+		// delete what the GPU has finished with, and count the
+		// memory that is still in use
+		g_ResourceManager->EndFrame();
+		g_ResourceManager->ReportCounters(g_Profiler);
 
-		// query the latest GLFW events
-		glfwPollEvents();
+		g_Profiler->EndFrame();
+
+		// stop once the benchmark has measured all of its frames
+		if (g_Benchmark->EndFrame(g_ViewManager, g_SceneManager->IsLoading() == false))
+		{
+			glfwSetWindowShouldClose(g_Window, true);
+		}
 	}
 
+	// write the recorded frames before the GL objects go away
+	g_Profiler->Export();
+	bool bBenchmarkPassed = g_Benchmark->Finish(g_Profiler);
+	g_ResourceManager->Print();
+
 	// clear the allocated manager objects from memory
+	if (NULL != g_DynamicResolution)
+	{
+		delete g_DynamicResolution;
+		g_DynamicResolution = NULL;
+	}
+	if (NULL != g_FramePacer)
+	{
+		delete g_FramePacer;
+		g_FramePacer = NULL;
+	}
 	if (NULL != g_SceneManager)
 	{
 		delete g_SceneManager;
 		g_SceneManager = NULL;
 	}
+	if (NULL != g_JobSystem)
+	{
+		delete g_JobSystem;
+		g_JobSystem = NULL;
+	}
+	if (NULL != g_Profiler)
+	{
+		delete g_Profiler;
+		g_Profiler = NULL;
+	}
+	if (NULL != g_Benchmark)
+	{
+		delete g_Benchmark;
+		g_Benchmark = NULL;
+	}
 	if (NULL != g_ViewManager)
 	{
 		delete g_ViewManager;
 		g_ViewManager = NULL;
 	}
+	if (NULL != g_ShaderPermutations)
+	{
+		delete g_ShaderPermutations;
+		g_ShaderPermutations = NULL;
+	}
+	// after everything holding a handle, so nothing is reported
+	// as leaked that was only waiting for its owner to go
+	if (NULL != g_ResourceManager)
+	{
+		delete g_ResourceManager;
+		g_ResourceManager = NULL;
+	}
+	if (NULL != g_UniformBlocks)
+	{
+		delete g_UniformBlocks;
+		g_UniformBlocks = NULL;
+	}
 	if (NULL != g_ShaderManager)
 	{
 		delete g_ShaderManager;
 		g_ShaderManager = NULL;
 	}
 
+	// a benchmark over its frame time budget fails the run
+	if (bBenchmarkPassed == false)
+	{
+		exit(EXIT_FAILURE);
+	}
+
 	// Terminates the program successfully
 	exit(EXIT_SUCCESS); 
 }
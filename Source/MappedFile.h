@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// map a whole file read-only into memory
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/***********************************************************
+ *  MappedFile
+ *
+ *  This class maps a file read-only into the address space
+ *  of the process, so its contents can be used in place
+ *  without being read or copied.  The pages are loaded by
+ *  the operating system as they are first touched.
+ ***********************************************************/
+class MappedFile
+{
+public:
+	// constructor
+	MappedFile();
+	// destructor
+	~MappedFile();
+
+	// map the file - any earlier mapping is closed first
+	bool Open(const char* filename);
+	void Close();
+
+	bool IsOpen() const { return(NULL != m_pData); }
+	const unsigned char* Data() const { return(m_pData); }
+	size_t Size() const { return(m_size); }
+
+	// size and last write time of a file, without opening it
+	static bool GetFileStamp(const char* filename, uint64_t& size, uint64_t& writeTime);
+
+private:
+	const unsigned char* m_pData;
+	size_t m_size;
+#ifdef _WIN32
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#endif
+
+	// a mapping cannot be shared between two owners
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+};
@@ -0,0 +1,972 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshlibrary.cpp
+// ============
+// generate indexed 3D shape meshes that support instanced drawing
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshLibrary.h"
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// number of slices around the round shapes at each level of
+	// detail - level 0 matches ShapeMeshes
+	const int g_LodRoundSlices[MeshLibrary::LOD_COUNT] = { 36, 16, 8 };
+	// number of segments around the tube of the torus
+	const int g_LodTorusTubeSlices[MeshLibrary::LOD_COUNT] = { 18, 10, 6 };
+	// number of rings from pole to pole of the sphere
+	const int g_LodSphereStacks[MeshLibrary::LOD_COUNT] = { 18, 9, 5 };
+	// a shape smaller than this radius on screen, in pixels, uses
+	// the next coarser level
+	const float g_LodScreenRadius[MeshLibrary::LOD_COUNT - 1] = { 60.0f, 15.0f };
+
+	const float g_Pi = 3.14159265358979f;
+
+	// vertex attribute locations used by the vertex shader
+	const GLuint g_PositionLocation = 0;
+	const GLuint g_NormalLocation = 1;
+	const GLuint g_UVLocation = 2;
+	const GLuint g_FaceLocation = 12;
+	const GLuint g_InstanceModelLocation = 3;   // uses locations 3 - 6
+	const GLuint g_InstanceColorLocation = 7;
+	const GLuint g_InstanceNormalLocation = 8;  // uses locations 8 - 10
+	const GLuint g_InstanceMaterialLocation = 11;
+}
+
+/***********************************************************
+ *  MeshLibrary()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshLibrary::MeshLibrary(ResourceManager* pResources)
+{
+	m_pResources = pResources;
+	for (int i = 0; i < (int)ShapeType::COUNT; i++)
+	{
+		m_meshes[i].boundsMin = glm::vec3(0.0f, 0.0f, 0.0f);
+		m_meshes[i].boundsMax = glm::vec3(0.0f, 0.0f, 0.0f);
+		m_meshes[i].bLoaded = false;
+		for (int lod = 0; lod < LOD_COUNT; lod++)
+		{
+			for (int p = 0; p < 3; p++)
+			{
+				m_meshes[i].parts[lod][p].firstIndex = 0;
+				m_meshes[i].parts[lod][p].indexCount = 0;
+			}
+		}
+	}
+
+	m_bMultiDraw = false;
+	m_multiDrawInstanceCapacity = 0;
+	m_drawCommandCapacity = 0;
+	m_triangleCount = 0;
+}
+
+/***********************************************************
+ *  ~MeshLibrary()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshLibrary::~MeshLibrary()
+{
+	// the handles hand the buffers back to the resource manager
+	m_batches.clear();
+	m_multiDrawVao.Reset();
+	m_multiDrawInstanceBuffer.Reset();
+	m_indirectBuffer.Reset();
+	m_atlasVao.Reset();
+	m_atlasVbo.Reset();
+	m_atlasIbo.Reset();
+
+	for (int i = 0; i < (int)ShapeType::COUNT; i++)
+	{
+		m_meshes[i].bLoaded = false;
+	}
+}
+
+/***********************************************************
+ *  CreateAtlas()
+ *
+ *  This method is used for creating the shared vertex and
+ *  index buffers, and the multi-draw buffers when the driver
+ *  supports indirect drawing with a base instance (OpenGL
+ *  4.3, or the ARB extensions).
+ ***********************************************************/
+void MeshLibrary::CreateAtlas()
+{
+	m_atlasVbo = m_pResources->CreateBuffer(ResourceManager::CATEGORY_MESHES, "mesh atlas vertices");
+	m_atlasIbo = m_pResources->CreateBuffer(ResourceManager::CATEGORY_MESHES, "mesh atlas indices");
+
+	// vertex array for drawing single copies
+	m_atlasVao = m_pResources->CreateVertexArray(ResourceManager::CATEGORY_MESHES, "mesh atlas");
+	glBindVertexArray(m_atlasVao.Name());
+	SetVertexAttributes();
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	m_bMultiDraw = (GLEW_VERSION_4_3 != 0) ||
+		((GLEW_ARB_multi_draw_indirect != 0) && (GLEW_ARB_base_instance != 0));
+	if (m_bMultiDraw == false)
+	{
+		std::cout << "MeshLibrary: multi-draw indirect is not supported, drawing objects one at a time" << std::endl;
+		return;
+	}
+
+	// each draw of a multi-draw is one instance, and its base
+	// instance picks its values out of the instance buffer
+	m_multiDrawInstanceBuffer = m_pResources->CreateBuffer(ResourceManager::CATEGORY_MESHES, "multi-draw instances");
+	m_indirectBuffer = m_pResources->CreateBuffer(ResourceManager::CATEGORY_MESHES, "multi-draw commands");
+	m_multiDrawVao = m_pResources->CreateVertexArray(ResourceManager::CATEGORY_MESHES, "multi-draw");
+	glBindVertexArray(m_multiDrawVao.Name());
+	SetVertexAttributes();
+	SetInstanceAttributes(m_multiDrawInstanceBuffer.Name());
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/***********************************************************
+ *  LoadMesh()
+ *
+ *  This method is used for generating the vertex and index
+ *  data for the passed in shape, adding it to the atlas and
+ *  loading the atlas into GPU memory.
+ ***********************************************************/
+bool MeshLibrary::LoadMesh(ShapeType shape)
+{
+	if ((shape < ShapeType::CYLINDER) || (shape >= ShapeType::COUNT))
+	{
+		std::cout << "MeshLibrary: unknown shape type " << (int)shape << std::endl;
+		return(false);
+	}
+
+	GL_MESH& mesh = m_meshes[(int)shape];
+	if (mesh.bLoaded)
+	{
+		return(true);
+	}
+
+	if (m_atlasVao.IsValid() == false)
+	{
+		CreateAtlas();
+	}
+
+	// the shape goes on the end of the atlas, and the builders
+	// write indices that already point at the atlas vertices
+	size_t firstVertex = m_atlasVertices.size();
+	for (int lod = 0; lod < LOD_COUNT; lod++)
+	{
+		int slices = g_LodRoundSlices[lod];
+		switch (shape)
+		{
+		case ShapeType::CYLINDER:         BuildCylinder(1.0f, 1.0f, slices, m_atlasVertices, m_atlasIndices, mesh.parts[lod]); break;
+		case ShapeType::TAPERED_CYLINDER: BuildCylinder(1.0f, 0.5f, slices, m_atlasVertices, m_atlasIndices, mesh.parts[lod]); break;
+		case ShapeType::TORUS:            BuildTorus(1.0f, 0.1f, slices, g_LodTorusTubeSlices[lod], m_atlasVertices, m_atlasIndices, mesh.parts[lod]); break;
+		case ShapeType::SPHERE:           BuildSphere(1.0f, slices, g_LodSphereStacks[lod], m_atlasVertices, m_atlasIndices, mesh.parts[lod]); break;
+		case ShapeType::BOX:
+		case ShapeType::PLANE:
+			// flat shapes only have one level, which every level uses
+			if (lod == 0)
+			{
+				if (shape == ShapeType::BOX)
+				{
+					BuildBox(m_atlasVertices, m_atlasIndices, mesh.parts[lod]);
+				}
+				else
+				{
+					BuildPlane(m_atlasVertices, m_atlasIndices, mesh.parts[lod]);
+				}
+			}
+			else
+			{
+				for (int p = 0; p < 3; p++)
+				{
+					mesh.parts[lod][p] = mesh.parts[0][p];
+				}
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	// keep the bounds for culling
+	mesh.boundsMin = m_atlasVertices[firstVertex].position;
+	mesh.boundsMax = m_atlasVertices[firstVertex].position;
+	for (size_t i = firstVertex + 1; i < m_atlasVertices.size(); i++)
+	{
+		mesh.boundsMin = glm::min(mesh.boundsMin, m_atlasVertices[i].position);
+		mesh.boundsMax = glm::max(mesh.boundsMax, m_atlasVertices[i].position);
+	}
+
+	// loading the whole atlas again keeps the buffer names, so every
+	// vertex array that points at them stays valid
+	glBindBuffer(GL_ARRAY_BUFFER, m_atlasVbo.Name());
+	glBufferData(GL_ARRAY_BUFFER, m_atlasVertices.size() * sizeof(VERTEX), m_atlasVertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	m_atlasVbo.SetSize(m_atlasVertices.size() * sizeof(VERTEX));
+
+	// the element binding belongs to whichever vertex array is
+	// bound, so the indices go in through a generic binding point
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_atlasIbo.Name());
+	glBufferData(GL_COPY_WRITE_BUFFER, m_atlasIndices.size() * sizeof(GLuint), m_atlasIndices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	m_atlasIbo.SetSize(m_atlasIndices.size() * sizeof(GLuint));
+
+	mesh.bLoaded = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsLoaded()
+ *
+ *  This method is used for checking whether a shape has been
+ *  loaded into GPU memory.
+ ***********************************************************/
+bool MeshLibrary::IsLoaded(ShapeType shape) const
+{
+	if ((shape < ShapeType::CYLINDER) || (shape >= ShapeType::COUNT))
+	{
+		return(false);
+	}
+
+	return(m_meshes[(int)shape].bLoaded);
+}
+
+/***********************************************************
+ *  GetLocalBounds()
+ *
+ *  This method is used for getting the box around the
+ *  vertices of a loaded shape, in the shape's own space.
+ ***********************************************************/
+bool MeshLibrary::GetLocalBounds(ShapeType shape, glm::vec3& minPoint, glm::vec3& maxPoint) const
+{
+	if ((shape < ShapeType::CYLINDER) || (shape >= ShapeType::COUNT) || (m_meshes[(int)shape].bLoaded == false))
+	{
+		return(false);
+	}
+
+	minPoint = m_meshes[(int)shape].boundsMin;
+	maxPoint = m_meshes[(int)shape].boundsMax;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateInstanceBatch()
+ *
+ *  This method is used for creating a vertex array object
+ *  that combines the atlas vertex data with a dedicated
+ *  per-instance buffer.  Returns the batch index, or -1 if
+ *  the shape could not be loaded.
+ ***********************************************************/
+int MeshLibrary::CreateInstanceBatch(ShapeType shape)
+{
+	if (LoadMesh(shape) == false)
+	{
+		return(-1);
+	}
+
+	INSTANCE_BATCH batch;
+	batch.shape = shape;
+	batch.instanceCount = 0;
+	batch.instanceCapacity = 0;
+
+	batch.vao = m_pResources->CreateVertexArray(ResourceManager::CATEGORY_MESHES, "instance batch");
+	glBindVertexArray(batch.vao.Name());
+
+	// per-vertex attributes
+	SetVertexAttributes();
+
+	// per-instance attributes
+	batch.instanceBuffer = m_pResources->CreateBuffer(ResourceManager::CATEGORY_MESHES, "instance batch instances");
+	SetInstanceAttributes(batch.instanceBuffer.Name());
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	m_batches.push_back(batch);
+	return((int)m_batches.size() - 1);
+}
+
+/***********************************************************
+ *  UpdateInstanceBatch()
+ *
+ *  This method is used for copying the passed in instance
+ *  values into the batch's instance buffer.  The buffer is
+ *  only reallocated when it needs to grow.
+ ***********************************************************/
+void MeshLibrary::UpdateInstanceBatch(int batch, const INSTANCE_DATA* instances, int count)
+{
+	if ((batch < 0) || (batch >= (int)m_batches.size()))
+	{
+		return;
+	}
+
+	INSTANCE_BATCH& instanceBatch = m_batches[batch];
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBatch.instanceBuffer.Name());
+	if (count > instanceBatch.instanceCapacity)
+	{
+		glBufferData(GL_ARRAY_BUFFER, count * sizeof(INSTANCE_DATA), instances, GL_DYNAMIC_DRAW);
+		instanceBatch.instanceBuffer.SetSize(count * sizeof(INSTANCE_DATA));
+		instanceBatch.instanceCapacity = count;
+	}
+	else if (count > 0)
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(INSTANCE_DATA), instances);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	instanceBatch.instanceCount = count;
+}
+
+/***********************************************************
+ *  SetVertexAttributes()
+ *
+ *  This method is used for pointing the per-vertex
+ *  attributes of the bound vertex array at the atlas.
+ ***********************************************************/
+void MeshLibrary::SetVertexAttributes() const
+{
+	glBindBuffer(GL_ARRAY_BUFFER, m_atlasVbo.Name());
+	glEnableVertexAttribArray(g_PositionLocation);
+	glVertexAttribPointer(g_PositionLocation, 3, GL_FLOAT, GL_FALSE, sizeof(VERTEX), (void*)offsetof(VERTEX, position));
+	glEnableVertexAttribArray(g_NormalLocation);
+	glVertexAttribPointer(g_NormalLocation, 3, GL_FLOAT, GL_FALSE, sizeof(VERTEX), (void*)offsetof(VERTEX, normal));
+	glEnableVertexAttribArray(g_UVLocation);
+	glVertexAttribPointer(g_UVLocation, 2, GL_FLOAT, GL_FALSE, sizeof(VERTEX), (void*)offsetof(VERTEX, uv));
+	glEnableVertexAttribArray(g_FaceLocation);
+	glVertexAttribPointer(g_FaceLocation, 1, GL_FLOAT, GL_FALSE, sizeof(VERTEX), (void*)offsetof(VERTEX, face));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_atlasIbo.Name());
+}
+
+/***********************************************************
+ *  SetInstanceAttributes()
+ *
+ *  This method is used for pointing the per-instance
+ *  attributes of the bound vertex array at an instance
+ *  buffer.
+ ***********************************************************/
+void MeshLibrary::SetInstanceAttributes(GLuint instanceBuffer)
+{
+	// a mat4 takes up four vec4 locations
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	for (GLuint column = 0; column < 4; column++)
+	{
+		GLuint location = g_InstanceModelLocation + column;
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(INSTANCE_DATA),
+			(void*)(offsetof(INSTANCE_DATA, model) + column * sizeof(glm::vec4)));
+		glVertexAttribDivisor(location, 1);
+	}
+	glEnableVertexAttribArray(g_InstanceColorLocation);
+	glVertexAttribPointer(g_InstanceColorLocation, 4, GL_FLOAT, GL_FALSE, sizeof(INSTANCE_DATA), (void*)offsetof(INSTANCE_DATA, color));
+	glVertexAttribDivisor(g_InstanceColorLocation, 1);
+	// a mat3 takes up three vec3 locations
+	for (GLuint column = 0; column < 3; column++)
+	{
+		GLuint location = g_InstanceNormalLocation + column;
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, sizeof(INSTANCE_DATA),
+			(void*)(offsetof(INSTANCE_DATA, normalMatrix) + column * sizeof(glm::vec3)));
+		glVertexAttribDivisor(location, 1);
+	}
+	// integer attribute, so it uses the I variant of the pointer call
+	glEnableVertexAttribArray(g_InstanceMaterialLocation);
+	glVertexAttribIPointer(g_InstanceMaterialLocation, 1, GL_INT, sizeof(INSTANCE_DATA), (void*)offsetof(INSTANCE_DATA, materialIndex));
+	glVertexAttribDivisor(g_InstanceMaterialLocation, 1);
+}
+
+/***********************************************************
+ *  SelectLod()
+ *
+ *  This method is used for picking the level of detail for a
+ *  shape from how large it is on screen.
+ ***********************************************************/
+int MeshLibrary::SelectLod(float screenRadius)
+{
+	int lod = 0;
+	while ((lod < LOD_COUNT - 1) && (screenRadius < g_LodScreenRadius[lod]))
+	{
+		lod++;
+	}
+
+	return(lod);
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing one copy of a shape at
+ *  the passed in level of detail, using the model matrix
+ *  already set in the shader.  Returns the number of draw
+ *  calls that were issued.
+ ***********************************************************/
+int MeshLibrary::DrawMesh(ShapeType shape, int partMask, int lod)
+{
+	if (IsLoaded(shape) == false)
+	{
+		return(0);
+	}
+
+	glBindVertexArray(m_atlasVao.Name());
+	int drawCalls = DrawParts(m_meshes[(int)shape], lod, partMask, 1);
+	glBindVertexArray(0);
+
+	return(drawCalls);
+}
+
+/***********************************************************
+ *  DrawInstanceBatch()
+ *
+ *  This method is used for drawing every instance in the
+ *  batch at the passed in level of detail.  Returns the
+ *  number of draw calls that were issued.
+ ***********************************************************/
+int MeshLibrary::DrawInstanceBatch(int batch, int partMask, int lod)
+{
+	if ((batch < 0) || (batch >= (int)m_batches.size()))
+	{
+		return(0);
+	}
+
+	const INSTANCE_BATCH& instanceBatch = m_batches[batch];
+	if (instanceBatch.instanceCount == 0)
+	{
+		return(0);
+	}
+
+	const GL_MESH& mesh = m_meshes[(int)instanceBatch.shape];
+
+	glBindVertexArray(instanceBatch.vao.Name());
+	int drawCalls = DrawParts(mesh, lod, partMask, instanceBatch.instanceCount);
+	glBindVertexArray(0);
+
+	return(drawCalls);
+}
+
+/***********************************************************
+ *  BeginMultiDraw()
+ *
+ *  This method is used for starting a new list of shapes to
+ *  be drawn together by SubmitMultiDraw().
+ ***********************************************************/
+void MeshLibrary::BeginMultiDraw()
+{
+	m_multiDraw.commands.clear();
+	m_multiDraw.instances.clear();
+}
+
+/***********************************************************
+ *  AddMultiDraw()
+ *
+ *  This method is used for adding one copy of a shape to the
+ *  multi-draw.
+ ***********************************************************/
+void MeshLibrary::AddMultiDraw(ShapeType shape, int partMask, int lod, const INSTANCE_DATA& instance)
+{
+	RecordMultiDraw(m_multiDraw, shape, partMask, lod, instance);
+}
+
+/***********************************************************
+ *  RecordMultiDraw()
+ *
+ *  This method is used for recording one copy of a shape
+ *  into a list.  Neighbouring parts become one command, and
+ *  every command of the copy reads the same instance values.
+ *  Only the loaded mesh ranges are read, so lists can be
+ *  recorded on several threads at once.
+ ***********************************************************/
+void MeshLibrary::RecordMultiDraw(MULTI_DRAW_LIST& list, ShapeType shape, int partMask, int lod, const INSTANCE_DATA& instance) const
+{
+	if (IsLoaded(shape) == false)
+	{
+		return;
+	}
+
+	if (lod < 0)
+	{
+		lod = 0;
+	}
+	if (lod >= LOD_COUNT)
+	{
+		lod = LOD_COUNT - 1;
+	}
+
+	const GL_MESH& mesh = m_meshes[(int)shape];
+	GLuint baseInstance = (GLuint)list.instances.size();
+	bool bAdded = false;
+
+	int part = 0;
+	while (part < 3)
+	{
+		if ((partMask & (1 << part)) == 0)
+		{
+			part++;
+			continue;
+		}
+
+		int lastPart = part;
+		while ((lastPart + 1 < 3) && ((partMask & (1 << (lastPart + 1))) != 0))
+		{
+			lastPart++;
+		}
+
+		DRAW_COMMAND command;
+		command.indexCount = 0;
+		for (int p = part; p <= lastPart; p++)
+		{
+			command.indexCount += mesh.parts[lod][p].indexCount;
+		}
+		if (command.indexCount > 0)
+		{
+			command.instanceCount = 1;
+			command.firstIndex = mesh.parts[lod][part].firstIndex;
+			command.baseVertex = 0;
+			command.baseInstance = baseInstance;
+			list.commands.push_back(command);
+			bAdded = true;
+		}
+		part = lastPart + 1;
+	}
+
+	if (bAdded)
+	{
+		list.instances.push_back(instance);
+	}
+}
+
+/***********************************************************
+ *  AddRecordedMultiDraw()
+ *
+ *  This method is used for copying the commands of one
+ *  recorded copy into the multi-draw, pointing them at the
+ *  copy's instance values once those are added too.
+ ***********************************************************/
+void MeshLibrary::AddRecordedMultiDraw(const MULTI_DRAW_LIST& list, int firstCommand, int commandCount, int instance)
+{
+	if (commandCount <= 0)
+	{
+		return;
+	}
+
+	GLuint baseInstance = (GLuint)m_multiDraw.instances.size();
+	m_multiDraw.instances.push_back(list.instances[instance]);
+	for (int i = firstCommand; i < firstCommand + commandCount; i++)
+	{
+		DRAW_COMMAND command = list.commands[i];
+		command.baseInstance = baseInstance;
+		m_multiDraw.commands.push_back(command);
+	}
+}
+
+/***********************************************************
+ *  SubmitMultiDraw()
+ *
+ *  This method is used for uploading the collected instance
+ *  values and draw commands and drawing all of them with one
+ *  glMultiDrawElementsIndirect() call.  The buffers are only
+ *  reallocated when they need to grow.
+ ***********************************************************/
+int MeshLibrary::SubmitMultiDraw()
+{
+	if ((m_bMultiDraw == false) || m_multiDraw.commands.empty())
+	{
+		return(0);
+	}
+
+	int instanceCount = (int)m_multiDraw.instances.size();
+	glBindBuffer(GL_ARRAY_BUFFER, m_multiDrawInstanceBuffer.Name());
+	if (instanceCount > m_multiDrawInstanceCapacity)
+	{
+		glBufferData(GL_ARRAY_BUFFER, instanceCount * sizeof(INSTANCE_DATA), m_multiDraw.instances.data(), GL_DYNAMIC_DRAW);
+		m_multiDrawInstanceBuffer.SetSize(instanceCount * sizeof(INSTANCE_DATA));
+		m_multiDrawInstanceCapacity = instanceCount;
+	}
+	else
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, 0, instanceCount * sizeof(INSTANCE_DATA), m_multiDraw.instances.data());
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	int commandCount = (int)m_multiDraw.commands.size();
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer.Name());
+	if (commandCount > m_drawCommandCapacity)
+	{
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, commandCount * sizeof(DRAW_COMMAND), m_multiDraw.commands.data(), GL_DYNAMIC_DRAW);
+		m_indirectBuffer.SetSize(commandCount * sizeof(DRAW_COMMAND));
+		m_drawCommandCapacity = commandCount;
+	}
+	else
+	{
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commandCount * sizeof(DRAW_COMMAND), m_multiDraw.commands.data());
+	}
+
+	glBindVertexArray(m_multiDrawVao.Name());
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, commandCount, 0);
+	glBindVertexArray(0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	for (const DRAW_COMMAND& command : m_multiDraw.commands)
+	{
+		m_triangleCount += (int)(command.indexCount / 3 * command.instanceCount);
+	}
+
+	return(1);
+}
+
+/***********************************************************
+ *  DrawParts()
+ *
+ *  This method is used for drawing the parts in the mask
+ *  with the bound vertex array.  Neighbouring parts are
+ *  merged into a single glDrawElementsInstanced() call.
+ ***********************************************************/
+int MeshLibrary::DrawParts(const GL_MESH& mesh, int lod, int partMask, int instanceCount)
+{
+	if (lod < 0)
+	{
+		lod = 0;
+	}
+	if (lod >= LOD_COUNT)
+	{
+		lod = LOD_COUNT - 1;
+	}
+
+	// walk the parts in index order and draw each run of
+	// consecutive requested parts together
+	int drawCalls = 0;
+	int part = 0;
+	while (part < 3)
+	{
+		if ((partMask & (1 << part)) == 0)
+		{
+			part++;
+			continue;
+		}
+
+		int lastPart = part;
+		while ((lastPart + 1 < 3) && ((partMask & (1 << (lastPart + 1))) != 0))
+		{
+			lastPart++;
+		}
+
+		if (DrawPartRange(mesh, lod, part, lastPart, instanceCount))
+		{
+			drawCalls++;
+		}
+		part = lastPart + 1;
+	}
+
+	return(drawCalls);
+}
+
+/***********************************************************
+ *  DrawPartRange()
+ *
+ *  This method is used for issuing the instanced draw call
+ *  for the indices from firstPart through lastPart.  Parts
+ *  with no indices are skipped and return false.
+ ***********************************************************/
+bool MeshLibrary::DrawPartRange(const GL_MESH& mesh, int lod, int firstPart, int lastPart, int instanceCount)
+{
+	GLuint firstIndex = mesh.parts[lod][firstPart].firstIndex;
+	GLuint indexCount = 0;
+	for (int part = firstPart; part <= lastPart; part++)
+	{
+		indexCount += mesh.parts[lod][part].indexCount;
+	}
+
+	if (indexCount == 0)
+	{
+		return(false);
+	}
+
+	glDrawElementsInstanced(
+		GL_TRIANGLES,
+		indexCount,
+		GL_UNSIGNED_INT,
+		(void*)(firstIndex * sizeof(GLuint)),
+		instanceCount);
+	m_triangleCount += (int)(indexCount / 3) * instanceCount;
+
+	return(true);
+}
+
+/***********************************************************
+ *  BuildCylinder()
+ *
+ *  This method is used for generating a cylinder that runs
+ *  from y = 0 to y = 1.  Passing a smaller top radius makes
+ *  a tapered cylinder.  The caps are tagged as the bottom and
+ *  top box faces and the sides as the front, so each part
+ *  can sample its own texture layer in one draw.
+ ***********************************************************/
+void MeshLibrary::BuildCylinder(float bottomRadius, float topRadius, int slices, std::vector<VERTEX>& vertices, std::vector<GLuint>& indices, MESH_PART parts[3])
+{
+	// slope of the side normals for tapered cylinders
+	float slope = bottomRadius - topRadius;
+
+	// --- bottom cap ---
+	parts[0].firstIndex = (GLuint)indices.size();
+	GLuint center = (GLuint)vertices.size();
+	vertices.push_back({ glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec2(0.5f, 0.5f), (float)BOX_FACE_BOTTOM });
+	for (int i = 0; i <= slices; i++)
+	{
+		float angle = 2.0f * g_Pi * i / slices;
+		float x = std::cos(angle);
+		float z = std::sin(angle);
+		vertices.push_back({ glm::vec3(x * bottomRadius, 0.0f, z * bottomRadius), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec2(0.5f + 0.5f * x, 0.5f + 0.5f * z), (float)BOX_FACE_BOTTOM });
+	}
+	for (int i = 0; i < slices; i++)
+	{
+		indices.push_back(center);
+		indices.push_back(center + 1 + i);
+		indices.push_back(center + 2 + i);
+	}
+	parts[0].indexCount = (GLuint)indices.size() - parts[0].firstIndex;
+
+	// --- sides ---
+	parts[1].firstIndex = (GLuint)indices.size();
+	GLuint sideStart = (GLuint)vertices.size();
+	for (int i = 0; i <= slices; i++)
+	{
+		float angle = 2.0f * g_Pi * i / slices;
+		float x = std::cos(angle);
+		float z = std::sin(angle);
+		float u = (float)i / slices;
+		glm::vec3 normal = glm::normalize(glm::vec3(x, slope, z));
+		vertices.push_back({ glm::vec3(x * bottomRadius, 0.0f, z * bottomRadius), normal, glm::vec2(u, 0.0f), (float)BOX_FACE_FRONT });
+		vertices.push_back({ glm::vec3(x * topRadius, 1.0f, z * topRadius), normal, glm::vec2(u, 1.0f), (float)BOX_FACE_FRONT });
+	}
+	for (int i = 0; i < slices; i++)
+	{
+		GLuint bottom0 = sideStart + i * 2;
+		GLuint top0 = bottom0 + 1;
+		GLuint bottom1 = bottom0 + 2;
+		GLuint top1 = bottom0 + 3;
+		indices.push_back(bottom0);
+		indices.push_back(top0);
+		indices.push_back(bottom1);
+		indices.push_back(bottom1);
+		indices.push_back(top0);
+		indices.push_back(top1);
+	}
+	parts[1].indexCount = (GLuint)indices.size() - parts[1].firstIndex;
+
+	// --- top cap ---
+	parts[2].firstIndex = (GLuint)indices.size();
+	center = (GLuint)vertices.size();
+	vertices.push_back({ glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.5f, 0.5f), (float)BOX_FACE_TOP });
+	for (int i = 0; i <= slices; i++)
+	{
+		float angle = 2.0f * g_Pi * i / slices;
+		float x = std::cos(angle);
+		float z = std::sin(angle);
+		vertices.push_back({ glm::vec3(x * topRadius, 1.0f, z * topRadius), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.5f + 0.5f * x, 0.5f + 0.5f * z), (float)BOX_FACE_TOP });
+	}
+	for (int i = 0; i < slices; i++)
+	{
+		indices.push_back(center);
+		indices.push_back(center + 2 + i);
+		indices.push_back(center + 1 + i);
+	}
+	parts[2].indexCount = (GLuint)indices.size() - parts[2].firstIndex;
+}
+
+/***********************************************************
+ *  BuildTorus()
+ *
+ *  This method is used for generating a torus that lies in
+ *  the XY plane, centered on the origin.  The whole torus
+ *  is stored as the sides part.
+ ***********************************************************/
+void MeshLibrary::BuildTorus(float mainRadius, float tubeRadius, int slices, int tubeSlices, std::vector<VERTEX>& vertices, std::vector<GLuint>& indices, MESH_PART parts[3])
+{
+	parts[0].firstIndex = (GLuint)indices.size();
+	parts[0].indexCount = 0;
+
+	parts[1].firstIndex = (GLuint)indices.size();
+	GLuint start = (GLuint)vertices.size();
+	for (int i = 0; i <= slices; i++)
+	{
+		float mainAngle = 2.0f * g_Pi * i / slices;
+		glm::vec3 ringCenter(std::cos(mainAngle) * mainRadius, std::sin(mainAngle) * mainRadius, 0.0f);
+		for (int j = 0; j <= tubeSlices; j++)
+		{
+			float tubeAngle = 2.0f * g_Pi * j / tubeSlices;
+			glm::vec3 normal(
+				std::cos(mainAngle) * std::cos(tubeAngle),
+				std::sin(mainAngle) * std::cos(tubeAngle),
+				std::sin(tubeAngle));
+			vertices.push_back({ ringCenter + normal * tubeRadius, normal,
+				glm::vec2((float)i / slices, (float)j / tubeSlices), 0.0f });
+		}
+	}
+	GLuint ringSize = tubeSlices + 1;
+	for (int i = 0; i < slices; i++)
+	{
+		for (int j = 0; j < tubeSlices; j++)
+		{
+			GLuint a = start + i * ringSize + j;
+			GLuint b = a + ringSize;
+			indices.push_back(a);
+			indices.push_back(b);
+			indices.push_back(a + 1);
+			indices.push_back(a + 1);
+			indices.push_back(b);
+			indices.push_back(b + 1);
+		}
+	}
+	parts[1].indexCount = (GLuint)indices.size() - parts[1].firstIndex;
+
+	parts[2].firstIndex = (GLuint)indices.size();
+	parts[2].indexCount = 0;
+}
+
+/***********************************************************
+ *  BuildSphere()
+ *
+ *  This method is used for generating a sphere centered on
+ *  the origin.  The whole sphere is stored as the sides
+ *  part.
+ ***********************************************************/
+void MeshLibrary::BuildSphere(float radius, int slices, int stacks, std::vector<VERTEX>& vertices, std::vector<GLuint>& indices, MESH_PART parts[3])
+{
+	parts[0].firstIndex = (GLuint)indices.size();
+	parts[0].indexCount = 0;
+
+	parts[1].firstIndex = (GLuint)indices.size();
+	GLuint start = (GLuint)vertices.size();
+	for (int i = 0; i <= stacks; i++)
+	{
+		// from the top pole down to the bottom pole
+		float stackAngle = g_Pi * i / stacks;
+		float y = std::cos(stackAngle);
+		float ringRadius = std::sin(stackAngle);
+		for (int j = 0; j <= slices; j++)
+		{
+			float sliceAngle = 2.0f * g_Pi * j / slices;
+			glm::vec3 normal(ringRadius * std::cos(sliceAngle), y, ringRadius * std::sin(sliceAngle));
+			vertices.push_back({ normal * radius, normal,
+				glm::vec2((float)j / slices, 1.0f - (float)i / stacks), 0.0f });
+		}
+	}
+	GLuint ringSize = slices + 1;
+	for (int i = 0; i < stacks; i++)
+	{
+		for (int j = 0; j < slices; j++)
+		{
+			GLuint a = start + i * ringSize + j;
+			GLuint b = a + ringSize;
+			indices.push_back(a);
+			indices.push_back(a + 1);
+			indices.push_back(b);
+			indices.push_back(b);
+			indices.push_back(a + 1);
+			indices.push_back(b + 1);
+		}
+	}
+	parts[1].indexCount = (GLuint)indices.size() - parts[1].firstIndex;
+
+	parts[2].firstIndex = (GLuint)indices.size();
+	parts[2].indexCount = 0;
+}
+
+/***********************************************************
+ *  BuildBox()
+ *
+ *  This method is used for generating a 1 x 1 x 1 box
+ *  centered on the origin, with every face mapped to the
+ *  whole texture and tagged with its BoxFace, so one draw
+ *  can sample a different texture layer per face.  The
+ *  bottom and top faces are stored as the bottom and top
+ *  parts, the other four as the sides.
+ ***********************************************************/
+void MeshLibrary::BuildBox(std::vector<VERTEX>& vertices, std::vector<GLuint>& indices, MESH_PART parts[3])
+{
+	const glm::vec3 bottom[4] = {
+		glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(0.5f, -0.5f, -0.5f), glm::vec3(0.5f, -0.5f, 0.5f), glm::vec3(-0.5f, -0.5f, 0.5f) };
+	const glm::vec3 front[4] = {
+		glm::vec3(-0.5f, -0.5f, 0.5f), glm::vec3(0.5f, -0.5f, 0.5f), glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3(-0.5f, 0.5f, 0.5f) };
+	const glm::vec3 back[4] = {
+		glm::vec3(0.5f, -0.5f, -0.5f), glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(-0.5f, 0.5f, -0.5f), glm::vec3(0.5f, 0.5f, -0.5f) };
+	const glm::vec3 right[4] = {
+		glm::vec3(0.5f, -0.5f, 0.5f), glm::vec3(0.5f, -0.5f, -0.5f), glm::vec3(0.5f, 0.5f, -0.5f), glm::vec3(0.5f, 0.5f, 0.5f) };
+	const glm::vec3 left[4] = {
+		glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(-0.5f, -0.5f, 0.5f), glm::vec3(-0.5f, 0.5f, 0.5f), glm::vec3(-0.5f, 0.5f, -0.5f) };
+	const glm::vec3 top[4] = {
+		glm::vec3(-0.5f, 0.5f, 0.5f), glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3(0.5f, 0.5f, -0.5f), glm::vec3(-0.5f, 0.5f, -0.5f) };
+
+	parts[0].firstIndex = (GLuint)indices.size();
+	AddQuad(bottom, glm::vec3(0.0f, -1.0f, 0.0f), (float)BOX_FACE_BOTTOM, vertices, indices);
+	parts[0].indexCount = (GLuint)indices.size() - parts[0].firstIndex;
+
+	parts[1].firstIndex = (GLuint)indices.size();
+	AddQuad(front, glm::vec3(0.0f, 0.0f, 1.0f), (float)BOX_FACE_FRONT, vertices, indices);
+	AddQuad(back, glm::vec3(0.0f, 0.0f, -1.0f), (float)BOX_FACE_BACK, vertices, indices);
+	AddQuad(right, glm::vec3(1.0f, 0.0f, 0.0f), (float)BOX_FACE_RIGHT, vertices, indices);
+	AddQuad(left, glm::vec3(-1.0f, 0.0f, 0.0f), (float)BOX_FACE_LEFT, vertices, indices);
+	parts[1].indexCount = (GLuint)indices.size() - parts[1].firstIndex;
+
+	parts[2].firstIndex = (GLuint)indices.size();
+	AddQuad(top, glm::vec3(0.0f, 1.0f, 0.0f), (float)BOX_FACE_TOP, vertices, indices);
+	parts[2].indexCount = (GLuint)indices.size() - parts[2].firstIndex;
+}
+
+/***********************************************************
+ *  BuildPlane()
+ *
+ *  This method is used for generating a 2 x 2 plane in the
+ *  XZ plane facing up, centered on the origin.  The plane
+ *  is stored as the sides part.
+ ***********************************************************/
+void MeshLibrary::BuildPlane(std::vector<VERTEX>& vertices, std::vector<GLuint>& indices, MESH_PART parts[3])
+{
+	const glm::vec3 corners[4] = {
+		glm::vec3(-1.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, -1.0f), glm::vec3(-1.0f, 0.0f, -1.0f) };
+
+	parts[0].firstIndex = (GLuint)indices.size();
+	parts[0].indexCount = 0;
+
+	parts[1].firstIndex = (GLuint)indices.size();
+	AddQuad(corners, glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, vertices, indices);
+	parts[1].indexCount = (GLuint)indices.size() - parts[1].firstIndex;
+
+	parts[2].firstIndex = (GLuint)indices.size();
+	parts[2].indexCount = 0;
+}
+
+/***********************************************************
+ *  AddQuad()
+ *
+ *  This method is used for adding a face from four corners
+ *  given counter-clockwise as seen from outside.  The first
+ *  corner maps to the bottom left of the texture.
+ ***********************************************************/
+void MeshLibrary::AddQuad(const glm::vec3 corners[4], const glm::vec3& normal, float face, std::vector<VERTEX>& vertices, std::vector<GLuint>& indices)
+{
+	const glm::vec2 uvs[4] = {
+		glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 0.0f), glm::vec2(1.0f, 1.0f), glm::vec2(0.0f, 1.0f) };
+
+	GLuint start = (GLuint)vertices.size();
+	for (int i = 0; i < 4; i++)
+	{
+		vertices.push_back({ corners[i], normal, uvs[i], face });
+	}
+
+	indices.push_back(start);
+	indices.push_back(start + 1);
+	indices.push_back(start + 2);
+	indices.push_back(start);
+	indices.push_back(start + 2);
+	indices.push_back(start + 3);
+}
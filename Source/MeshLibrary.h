@@ -0,0 +1,232 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshlibrary.h
+// ============
+// generate indexed 3D shape meshes that support instanced drawing
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "ResourceManager.h"
+
+#include <vector>
+
+/***********************************************************
+ *  MeshLibrary
+ *
+ *  This class generates indexed versions of the basic shape
+ *  meshes (same dimensions as ShapeMeshes) and manages the
+ *  per-instance buffers used to draw many copies of a shape
+ *  with one glDrawElementsInstanced() call.
+ *
+ *  Every shape is generated at LOD_COUNT levels of detail,
+ *  from the full ShapeMeshes tessellation down to a coarse
+ *  one.  All shapes and levels share one vertex buffer and
+ *  one index buffer (the mesh atlas), so a shape and level
+ *  is picked per draw by index range alone, and a whole list
+ *  of different shapes can be drawn with a single
+ *  glMultiDrawElementsIndirect() call where it is supported.
+ ***********************************************************/
+class MeshLibrary
+{
+public:
+	// constructor
+	MeshLibrary(ResourceManager* pResources);
+	// destructor
+	~MeshLibrary();
+
+	// shapes that can be generated by the library
+	enum class ShapeType
+	{
+		CYLINDER,
+		TAPERED_CYLINDER,
+		TORUS,
+		SPHERE,
+		BOX,
+		PLANE,
+		COUNT
+	};
+
+	// levels of detail generated for every shape, 0 is the finest
+	enum { LOD_COUNT = 3 };
+
+	// faces of the box, in the same order as the BoxSide values of
+	// ShapeMeshes - every box vertex carries the index of its face
+	enum BoxFace
+	{
+		BOX_FACE_FRONT,
+		BOX_FACE_BACK,
+		BOX_FACE_BOTTOM,
+		BOX_FACE_TOP,
+		BOX_FACE_RIGHT,
+		BOX_FACE_LEFT,
+		BOX_FACE_COUNT
+	};
+
+	// parts of a shape that can be drawn - the index data for
+	// each shape is stored as bottom, sides, top so that any
+	// neighbouring parts can be drawn with a single call
+	enum ShapePart
+	{
+		PART_BOTTOM = 1,
+		PART_SIDES = 2,
+		PART_TOP = 4,
+		PART_ALL = PART_BOTTOM | PART_SIDES | PART_TOP
+	};
+
+	// per-instance values uploaded to the instance buffer
+	struct INSTANCE_DATA
+	{
+		glm::mat4 model;
+		glm::vec4 color;
+		// computed on the CPU so the shader never inverts a matrix
+		glm::mat3 normalMatrix;
+		// index into the material block
+		GLint materialIndex;
+	};
+
+	// one draw of a multi-draw, in the layout OpenGL reads from
+	// the indirect buffer
+	struct DRAW_COMMAND
+	{
+		GLuint indexCount;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		// the per-instance values of the draw start here
+		GLuint baseInstance;
+	};
+
+	// draw commands and the instance values they read, recorded
+	// without touching OpenGL so any thread can fill one
+	struct MULTI_DRAW_LIST
+	{
+		std::vector<DRAW_COMMAND> commands;
+		std::vector<INSTANCE_DATA> instances;
+	};
+
+	// load the generated shape into GPU memory
+	bool LoadMesh(ShapeType shape);
+	bool IsLoaded(ShapeType shape) const;
+	// local box around the vertices of a loaded shape
+	bool GetLocalBounds(ShapeType shape, glm::vec3& minPoint, glm::vec3& maxPoint) const;
+	// pick the level of detail for a shape covering the passed
+	// in radius on screen, in pixels
+	static int SelectLod(float screenRadius);
+	// draw one copy of a loaded shape with the model matrix set in
+	// the shader, returns the number of draw calls issued
+	int DrawMesh(ShapeType shape, int partMask = PART_ALL, int lod = 0);
+
+	// create a new instance batch for drawing the passed in shape
+	int CreateInstanceBatch(ShapeType shape);
+	// copy the instance values into the batch's instance buffer
+	void UpdateInstanceBatch(int batch, const INSTANCE_DATA* instances, int count);
+	// draw every instance in the batch with one call per part range,
+	// returns the number of draw calls issued
+	int DrawInstanceBatch(int batch, int partMask = PART_ALL, int lod = 0);
+
+	// whether the driver can draw a list of shapes with one call
+	bool MultiDrawSupported() const { return(m_bMultiDraw); }
+	// start collecting a new multi-draw
+	void BeginMultiDraw();
+	// add one copy of a loaded shape to the multi-draw
+	void AddMultiDraw(ShapeType shape, int partMask, int lod, const INSTANCE_DATA& instance);
+	// record one copy of a loaded shape into a list of its own,
+	// safe to call from any thread
+	void RecordMultiDraw(MULTI_DRAW_LIST& list, ShapeType shape, int partMask, int lod, const INSTANCE_DATA& instance) const;
+	// add commands recorded with RecordMultiDraw() to the multi-draw,
+	// with the one instance value they read
+	void AddRecordedMultiDraw(const MULTI_DRAW_LIST& list, int firstCommand, int commandCount, int instance);
+	// draw everything added since BeginMultiDraw() with one call,
+	// returns the number of draw calls issued
+	int SubmitMultiDraw();
+
+	// triangles drawn since the last reset, counting every instance
+	int TriangleCount() const { return(m_triangleCount); }
+	void ResetTriangleCount() { m_triangleCount = 0; }
+
+private:
+	struct VERTEX
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 uv;
+		// BoxFace of the vertex - cylinder caps use the bottom and
+		// top faces, and every other surface the front face
+		float face;
+	};
+
+	// range of indices that make up one part of a shape
+	struct MESH_PART
+	{
+		GLuint firstIndex;
+		GLuint indexCount;
+	};
+
+	// ranges of one shape in the atlas index buffer
+	struct GL_MESH
+	{
+		MESH_PART parts[LOD_COUNT][3];
+		// box around the generated vertices
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		bool bLoaded;
+	};
+
+	struct INSTANCE_BATCH
+	{
+		ShapeType shape;
+		ResourceManager::Handle vao;
+		ResourceManager::Handle instanceBuffer;
+		int instanceCount;
+		int instanceCapacity;
+	};
+
+	ResourceManager* m_pResources;
+	GL_MESH m_meshes[(int)ShapeType::COUNT];
+	std::vector<INSTANCE_BATCH> m_batches;
+
+	// every loaded shape, kept so the atlas can be uploaded again
+	// when another shape is added
+	std::vector<VERTEX> m_atlasVertices;
+	std::vector<GLuint> m_atlasIndices;
+	ResourceManager::Handle m_atlasVbo;
+	ResourceManager::Handle m_atlasIbo;
+	// vertex array without instance attributes, for DrawMesh()
+	ResourceManager::Handle m_atlasVao;
+
+	// multi-draw values
+	bool m_bMultiDraw;
+	ResourceManager::Handle m_multiDrawVao;
+	ResourceManager::Handle m_multiDrawInstanceBuffer;
+	ResourceManager::Handle m_indirectBuffer;
+	int m_multiDrawInstanceCapacity;
+	int m_drawCommandCapacity;
+	MULTI_DRAW_LIST m_multiDraw;
+	int m_triangleCount;
+
+	// create the atlas buffers on the first load
+	void CreateAtlas();
+
+	// generate the vertex and index data for a shape
+	void BuildCylinder(float bottomRadius, float topRadius, int slices, std::vector<VERTEX>& vertices, std::vector<GLuint>& indices, MESH_PART parts[3]);
+	void BuildTorus(float mainRadius, float tubeRadius, int slices, int tubeSlices, std::vector<VERTEX>& vertices, std::vector<GLuint>& indices, MESH_PART parts[3]);
+	void BuildSphere(float radius, int slices, int stacks, std::vector<VERTEX>& vertices, std::vector<GLuint>& indices, MESH_PART parts[3]);
+	void BuildBox(std::vector<VERTEX>& vertices, std::vector<GLuint>& indices, MESH_PART parts[3]);
+	void BuildPlane(std::vector<VERTEX>& vertices, std::vector<GLuint>& indices, MESH_PART parts[3]);
+	// add a four-corner face, corners counter-clockwise from outside
+	static void AddQuad(const glm::vec3 corners[4], const glm::vec3& normal, float face, std::vector<VERTEX>& vertices, std::vector<GLuint>& indices);
+	// point the per-vertex attributes of the bound vertex array at the atlas
+	void SetVertexAttributes() const;
+	// point the per-instance attributes of the bound vertex array at a buffer
+	static void SetInstanceAttributes(GLuint instanceBuffer);
+	// draw the part ranges in the mask with the bound vertex array
+	int DrawParts(const GL_MESH& mesh, int lod, int partMask, int instanceCount);
+	// issue the instanced draw for one contiguous range of parts
+	bool DrawPartRange(const GL_MESH& mesh, int lod, int firstPart, int lastPart, int instanceCount);
+};
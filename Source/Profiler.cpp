@@ -0,0 +1,722 @@
+///////////////////////////////////////////////////////////////////////////////
+// profiler.cpp
+// ============
+// time the CPU and GPU work of each frame and report it on screen or to file
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// weight of the newest frame in the running averages
+	const double g_AverageWeight = 0.05;
+	// frames kept for the export - about ten minutes at 60 fps
+	const size_t g_MaxRecordedFrames = 36000;
+	// how often the numbers in the window title are refreshed
+	const double g_TitleIntervalMs = 500.0;
+
+	// overlay layout in pixels - a bar as wide as the window
+	// stands for g_OverlayFullScaleMs
+	const int g_OverlayMargin = 8;
+	const int g_OverlayRowHeight = 6;
+	const int g_OverlayRowGap = 3;
+	const double g_OverlayFullScaleMs = 33.3;
+	const double g_OverlayTargetMs = 1000.0 / 60.0;
+
+	// bar colors, picked by the section index
+	const float g_OverlayColors[][3] =
+	{
+		{ 0.90f, 0.30f, 0.25f },
+		{ 0.25f, 0.70f, 0.95f },
+		{ 0.95f, 0.80f, 0.20f },
+		{ 0.40f, 0.85f, 0.40f },
+		{ 0.80f, 0.45f, 0.90f },
+		{ 0.95f, 0.55f, 0.15f },
+		{ 0.30f, 0.90f, 0.80f },
+		{ 0.70f, 0.70f, 0.70f }
+	};
+	const int g_OverlayColorCount = sizeof(g_OverlayColors) / sizeof(g_OverlayColors[0]);
+
+	/***********************************************************
+	 *  FillRect()
+	 *
+	 *  Fill a rectangle of the framebuffer with a flat color
+	 *  by clearing it through the scissor box, which needs no
+	 *  shader or vertex data.  The origin is the top left.
+	 ***********************************************************/
+	void FillRect(int x, int y, int width, int height, int framebufferHeight, const float color[3])
+	{
+		if ((width <= 0) || (height <= 0))
+		{
+			return;
+		}
+
+		glScissor(x, framebufferHeight - y - height, width, height);
+		glClearColor(color[0], color[1], color[2], 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+	}
+}
+
+/***********************************************************
+ *  CpuScope()
+ *
+ *  The constructor for the class - starts the scope
+ ***********************************************************/
+Profiler::CpuScope::CpuScope(Profiler* pProfiler, const char* name)
+{
+	m_pProfiler = pProfiler;
+	m_sample = -1;
+	if (NULL != m_pProfiler)
+	{
+		m_sample = m_pProfiler->BeginCpu(name);
+	}
+}
+
+/***********************************************************
+ *  ~CpuScope()
+ *
+ *  The destructor for the class - ends the scope
+ ***********************************************************/
+Profiler::CpuScope::~CpuScope()
+{
+	if (NULL != m_pProfiler)
+	{
+		m_pProfiler->EndCpu(m_sample);
+	}
+}
+
+/***********************************************************
+ *  Profiler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+Profiler::Profiler()
+{
+	m_startTime = std::chrono::steady_clock::now();
+	m_frame = -1;
+	m_averageFrameMs = 0.0;
+	m_current.frame = -1;
+	m_current.startMs = 0.0;
+	m_current.durationMs = 0.0;
+	m_bGpuTimers = false;
+	m_bGpuActive = false;
+	for (int i = 0; i < GPU_QUERY_FRAMES; i++)
+	{
+		memset(m_gpuFrames[i].queries, 0, sizeof(m_gpuFrames[i].queries));
+		m_gpuFrames[i].count = 0;
+		m_gpuFrames[i].frame = -1;
+	}
+	m_bOverlay = false;
+	m_bTitleShown = false;
+	m_lastTitleMs = 0.0;
+}
+
+/***********************************************************
+ *  ~Profiler()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+Profiler::~Profiler()
+{
+	if (m_bGpuTimers)
+	{
+		for (int i = 0; i < GPU_QUERY_FRAMES; i++)
+		{
+			glDeleteQueries(MAX_GPU_SCOPES, m_gpuFrames[i].queries);
+		}
+	}
+}
+
+/***********************************************************
+ *  ParseArguments()
+ *
+ *  This method is used for reading the export files from
+ *  the command line.  Frames are only kept in memory when a
+ *  file is going to be written.
+ ***********************************************************/
+void Profiler::ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (strcmp(argv[i], "--profile-csv") == 0)
+		{
+			m_csvPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--profile-trace") == 0)
+		{
+			m_tracePath = argv[++i];
+		}
+	}
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the timer queries.  The
+ *  GPU scopes are skipped on drivers without timer queries.
+ ***********************************************************/
+void Profiler::Create()
+{
+	m_bGpuTimers = (GLEW_VERSION_3_3 || GLEW_ARB_timer_query);
+	if (m_bGpuTimers == false)
+	{
+		std::cout << "Profiler: timer queries are not supported, GPU scopes are off" << std::endl;
+		return;
+	}
+
+	for (int i = 0; i < GPU_QUERY_FRAMES; i++)
+	{
+		glGenQueries(MAX_GPU_SCOPES, m_gpuFrames[i].queries);
+	}
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting a new frame.  The GPU
+ *  queries about to be reused hold the results of the frame
+ *  before last, which are read first.
+ ***********************************************************/
+void Profiler::BeginFrame()
+{
+	m_frame++;
+	m_current.frame = m_frame;
+	m_current.startMs = NowMs();
+	m_current.durationMs = 0.0;
+	m_current.samples.clear();
+	m_current.counters.assign(m_counters.size(), 0.0);
+
+	GPU_FRAME& gpuFrame = m_gpuFrames[m_frame % GPU_QUERY_FRAMES];
+	ReadGpuFrame(gpuFrame, false);
+	gpuFrame.count = 0;
+	gpuFrame.frame = m_frame;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for finishing the frame - the CPU
+ *  averages are updated and the frame is kept for export.
+ ***********************************************************/
+void Profiler::EndFrame()
+{
+	if (m_frame < 0)
+	{
+		return;
+	}
+
+	// a GPU scope left open would break the next frame's queries
+	if (m_bGpuActive)
+	{
+		EndGpu();
+	}
+
+	m_current.durationMs = NowMs() - m_current.startMs;
+	m_averageFrameMs = (m_frame == 0) ? m_current.durationMs :
+		m_averageFrameMs + (m_current.durationMs - m_averageFrameMs) * g_AverageWeight;
+
+	// scopes that run more than once add up within the frame
+	std::vector<double> sectionMs(m_sections.size(), -1.0);
+	for (const SAMPLE& sample : m_current.samples)
+	{
+		sectionMs[sample.section] = std::max(sectionMs[sample.section], 0.0) + sample.durationMs;
+	}
+	for (size_t i = 0; i < m_sections.size(); i++)
+	{
+		if ((m_sections[i].bGpu == false) && (sectionMs[i] >= 0.0))
+		{
+			m_sections[i].averageMs += (sectionMs[i] - m_sections[i].averageMs) * g_AverageWeight;
+		}
+	}
+
+	for (size_t i = 0; i < m_counters.size(); i++)
+	{
+		m_counters[i].averageValue += (m_counters[i].value - m_counters[i].averageValue) * g_AverageWeight;
+	}
+
+	if (Recording() && (m_history.size() < g_MaxRecordedFrames))
+	{
+		m_history.push_back(m_current);
+	}
+}
+
+/***********************************************************
+ *  BeginCpu()
+ *
+ *  This method is used for starting a CPU scope.  Returns
+ *  the sample to pass to EndCpu().
+ ***********************************************************/
+int Profiler::BeginCpu(const char* name)
+{
+	if (m_frame < 0)
+	{
+		return(-1);
+	}
+
+	SAMPLE sample;
+	sample.section = AddSection(name, false);
+	sample.startMs = NowMs();
+	sample.durationMs = 0.0;
+	m_current.samples.push_back(sample);
+
+	return((int)m_current.samples.size() - 1);
+}
+
+/***********************************************************
+ *  EndCpu()
+ *
+ *  This method is used for ending a CPU scope.
+ ***********************************************************/
+void Profiler::EndCpu(int sample)
+{
+	if ((sample < 0) || (sample >= (int)m_current.samples.size()))
+	{
+		return;
+	}
+
+	m_current.samples[sample].durationMs = NowMs() - m_current.samples[sample].startMs;
+}
+
+/***********************************************************
+ *  BeginGpu()
+ *
+ *  This method is used for starting a GPU scope.  Only one
+ *  GL_TIME_ELAPSED query can be active, so a scope started
+ *  inside another one is ignored.
+ ***********************************************************/
+void Profiler::BeginGpu(const char* name)
+{
+	if ((m_bGpuTimers == false) || m_bGpuActive || (m_frame < 0))
+	{
+		return;
+	}
+
+	GPU_FRAME& gpuFrame = m_gpuFrames[m_frame % GPU_QUERY_FRAMES];
+	if (gpuFrame.count >= MAX_GPU_SCOPES)
+	{
+		return;
+	}
+
+	gpuFrame.sections[gpuFrame.count] = AddSection(name, true);
+	gpuFrame.startMs[gpuFrame.count] = NowMs();
+	glBeginQuery(GL_TIME_ELAPSED, gpuFrame.queries[gpuFrame.count]);
+	m_bGpuActive = true;
+}
+
+/***********************************************************
+ *  EndGpu()
+ *
+ *  This method is used for ending the active GPU scope.
+ ***********************************************************/
+void Profiler::EndGpu()
+{
+	if (m_bGpuActive == false)
+	{
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_gpuFrames[m_frame % GPU_QUERY_FRAMES].count++;
+	m_bGpuActive = false;
+}
+
+/***********************************************************
+ *  SetCounter()
+ *
+ *  This method is used for setting the value of a counter
+ *  for the current frame.
+ ***********************************************************/
+void Profiler::SetCounter(const char* name, double value)
+{
+	size_t counter = 0;
+	while ((counter < m_counters.size()) && (strcmp(m_counters[counter].name, name) != 0))
+	{
+		counter++;
+	}
+
+	if (counter == m_counters.size())
+	{
+		COUNTER newCounter;
+		newCounter.name = name;
+		newCounter.value = value;
+		newCounter.averageValue = value;
+		m_counters.push_back(newCounter);
+	}
+
+	m_counters[counter].value = value;
+	if (m_current.counters.size() < m_counters.size())
+	{
+		m_current.counters.resize(m_counters.size(), 0.0);
+	}
+	m_current.counters[counter] = value;
+}
+
+/***********************************************************
+ *  AverageMs()
+ *
+ *  This method is used for getting the running average of a
+ *  scope in milliseconds, or 0 for an unknown scope.
+ ***********************************************************/
+double Profiler::AverageMs(const char* name, bool bGpu) const
+{
+	int section = FindSection(name, bGpu);
+	if (section < 0)
+	{
+		return(0.0);
+	}
+
+	return(m_sections[section].averageMs);
+}
+
+/***********************************************************
+ *  Print()
+ *
+ *  This method is used for printing the running averages of
+ *  every scope and counter to the console.
+ ***********************************************************/
+void Profiler::Print() const
+{
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "  frame: " << m_averageFrameMs << " ms" << std::endl;
+	for (const SECTION& section : m_sections)
+	{
+		std::cout << "  " << (section.bGpu ? "gpu " : "cpu ") << section.name << ": " << section.averageMs << " ms" << std::endl;
+	}
+	std::cout << std::setprecision(1);
+	for (const COUNTER& counter : m_counters)
+	{
+		std::cout << "  " << counter.name << ": " << counter.averageValue << std::endl;
+	}
+	std::cout.unsetf(std::ios::floatfield);
+	std::cout << std::setprecision(6);
+}
+
+/***********************************************************
+ *  DrawOverlay()
+ *
+ *  This method is used for drawing the averages as bars in
+ *  the top left corner of the window - the frame first, on a
+ *  scale where the white tick is 60 fps, then each CPU and
+ *  GPU scope in its own color.  No text can be drawn, so the
+ *  numbers go into the window title twice a second.
+ ***********************************************************/
+void Profiler::DrawOverlay(GLFWwindow* window, const char* windowTitle)
+{
+	if (NULL == window)
+	{
+		return;
+	}
+
+	// put the plain title back once the overlay is switched off
+	if (m_bOverlay == false)
+	{
+		if (m_bTitleShown)
+		{
+			glfwSetWindowTitle(window, windowTitle);
+			m_bTitleShown = false;
+		}
+		return;
+	}
+
+	int width = 0;
+	int height = 0;
+	glfwGetFramebufferSize(window, &width, &height);
+	double pixelsPerMs = (double)(width - 2 * g_OverlayMargin) / g_OverlayFullScaleMs;
+
+	GLfloat clearColor[4];
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+	glEnable(GL_SCISSOR_TEST);
+
+	const float frameColor[3] = { 1.0f, 1.0f, 1.0f };
+	const float backgroundColor[3] = { 0.15f, 0.15f, 0.15f };
+	int y = g_OverlayMargin;
+	FillRect(g_OverlayMargin, y, width - 2 * g_OverlayMargin, g_OverlayRowHeight, height, backgroundColor);
+	FillRect(g_OverlayMargin, y, (int)(m_averageFrameMs * pixelsPerMs), g_OverlayRowHeight, height, frameColor);
+	FillRect(g_OverlayMargin + (int)(g_OverlayTargetMs * pixelsPerMs), y - 2, 1, g_OverlayRowHeight + 4, height, frameColor);
+	y += g_OverlayRowHeight + g_OverlayRowGap;
+
+	for (size_t i = 0; i < m_sections.size(); i++)
+	{
+		FillRect(g_OverlayMargin, y, (int)(m_sections[i].averageMs * pixelsPerMs), g_OverlayRowHeight, height,
+			g_OverlayColors[i % g_OverlayColorCount]);
+		y += g_OverlayRowHeight + g_OverlayRowGap;
+	}
+
+	glDisable(GL_SCISSOR_TEST);
+	glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+
+	double now = NowMs();
+	if ((m_bTitleShown == false) || (now - m_lastTitleMs >= g_TitleIntervalMs))
+	{
+		std::ostringstream title;
+		title << std::fixed << std::setprecision(2) << windowTitle << " | frame " << m_averageFrameMs << " ms";
+		for (const SECTION& section : m_sections)
+		{
+			title << " | " << (section.bGpu ? "gpu " : "") << section.name << " " << section.averageMs;
+		}
+		title << std::setprecision(0);
+		for (const COUNTER& counter : m_counters)
+		{
+			title << " | " << counter.name << " " << counter.value;
+		}
+
+		glfwSetWindowTitle(window, title.str().c_str());
+		m_bTitleShown = true;
+		m_lastTitleMs = now;
+	}
+}
+
+/***********************************************************
+ *  Export()
+ *
+ *  This method is used for writing the recorded frames to
+ *  the files passed on the command line.  The queries still
+ *  in flight are waited for so the last frames are complete.
+ ***********************************************************/
+void Profiler::Export()
+{
+	if (Recording() == false)
+	{
+		return;
+	}
+
+	for (int i = 1; i <= GPU_QUERY_FRAMES; i++)
+	{
+		ReadGpuFrame(m_gpuFrames[(m_frame + i) % GPU_QUERY_FRAMES], true);
+	}
+
+	if ((m_csvPath.empty() == false) && WriteCsv(m_csvPath.c_str()))
+	{
+		std::cout << "Profiler: wrote " << m_history.size() << " frames to " << m_csvPath << std::endl;
+	}
+	if ((m_tracePath.empty() == false) && WriteTrace(m_tracePath.c_str()))
+	{
+		std::cout << "Profiler: wrote " << m_history.size() << " frames to " << m_tracePath << std::endl;
+	}
+}
+
+/***********************************************************
+ *  NowMs()
+ *
+ *  This method is used for getting the time since the
+ *  profiler was created, in milliseconds.
+ ***********************************************************/
+double Profiler::NowMs() const
+{
+	return(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count());
+}
+
+/***********************************************************
+ *  FindSection()
+ *
+ *  This method is used for finding a section by name.
+ ***********************************************************/
+int Profiler::FindSection(const char* name, bool bGpu) const
+{
+	for (size_t i = 0; i < m_sections.size(); i++)
+	{
+		if ((m_sections[i].bGpu == bGpu) && (strcmp(m_sections[i].name, name) == 0))
+		{
+			return((int)i);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  AddSection()
+ *
+ *  This method is used for finding a section by name and
+ *  adding it the first time it is used.
+ ***********************************************************/
+int Profiler::AddSection(const char* name, bool bGpu)
+{
+	int section = FindSection(name, bGpu);
+	if (section >= 0)
+	{
+		return(section);
+	}
+
+	SECTION newSection;
+	newSection.name = name;
+	newSection.bGpu = bGpu;
+	newSection.averageMs = 0.0;
+	m_sections.push_back(newSection);
+
+	return((int)m_sections.size() - 1);
+}
+
+/***********************************************************
+ *  ReadGpuFrame()
+ *
+ *  This method is used for reading the elapsed times of a
+ *  frame's GPU queries.  The queries finish in order, so
+ *  when the last one is ready all of them are.
+ ***********************************************************/
+void Profiler::ReadGpuFrame(GPU_FRAME& gpuFrame, bool bWait)
+{
+	if ((m_bGpuTimers == false) || (gpuFrame.count == 0) || (gpuFrame.frame < 0))
+	{
+		return;
+	}
+
+	if (bWait == false)
+	{
+		GLint available = 0;
+		glGetQueryObjectiv(gpuFrame.queries[gpuFrame.count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == 0)
+		{
+			gpuFrame.count = 0;
+			return;
+		}
+	}
+
+	FRAME_RECORD* pRecord = NULL;
+	if (gpuFrame.frame < (int)m_history.size())
+	{
+		pRecord = &m_history[gpuFrame.frame];
+	}
+
+	std::vector<double> sectionMs(m_sections.size(), -1.0);
+	for (int i = 0; i < gpuFrame.count; i++)
+	{
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(gpuFrame.queries[i], GL_QUERY_RESULT, &elapsed);
+
+		SAMPLE sample;
+		sample.section = gpuFrame.sections[i];
+		sample.startMs = gpuFrame.startMs[i];
+		sample.durationMs = (double)elapsed / 1.0e6;
+		sectionMs[sample.section] = std::max(sectionMs[sample.section], 0.0) + sample.durationMs;
+		if (NULL != pRecord)
+		{
+			pRecord->samples.push_back(sample);
+		}
+	}
+
+	for (size_t i = 0; i < m_sections.size(); i++)
+	{
+		if (sectionMs[i] >= 0.0)
+		{
+			m_sections[i].averageMs += (sectionMs[i] - m_sections[i].averageMs) * g_AverageWeight;
+		}
+	}
+
+	gpuFrame.count = 0;
+}
+
+/***********************************************************
+ *  WriteCsv()
+ *
+ *  This method is used for writing one row per frame with
+ *  the time of every section and the value of every counter.
+ *  A section that did not run in a frame is left empty.
+ ***********************************************************/
+bool Profiler::WriteCsv(const char* path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cout << "Profiler: could not write " << path << std::endl;
+		return(false);
+	}
+
+	file << "frame,start_ms,frame_ms";
+	for (const SECTION& section : m_sections)
+	{
+		file << "," << (section.bGpu ? "gpu " : "cpu ") << section.name << " ms";
+	}
+	for (const COUNTER& counter : m_counters)
+	{
+		file << "," << counter.name;
+	}
+	file << "\n";
+
+	file << std::fixed << std::setprecision(3);
+	for (const FRAME_RECORD& record : m_history)
+	{
+		std::vector<double> sectionMs(m_sections.size(), -1.0);
+		for (const SAMPLE& sample : record.samples)
+		{
+			sectionMs[sample.section] = std::max(sectionMs[sample.section], 0.0) + sample.durationMs;
+		}
+
+		file << record.frame << "," << record.startMs << "," << record.durationMs;
+		for (size_t i = 0; i < m_sections.size(); i++)
+		{
+			file << ",";
+			if (sectionMs[i] >= 0.0)
+			{
+				file << sectionMs[i];
+			}
+		}
+		for (size_t i = 0; i < m_counters.size(); i++)
+		{
+			file << "," << ((i < record.counters.size()) ? record.counters[i] : 0.0);
+		}
+		file << "\n";
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteTrace()
+ *
+ *  This method is used for writing the frames in the Chrome
+ *  trace event format.  CPU scopes are on thread 1 and GPU
+ *  scopes on thread 2 - the GPU events start at the time the
+ *  pass was submitted, since elapsed-time queries only give
+ *  a duration.
+ ***********************************************************/
+bool Profiler::WriteTrace(const char* path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cout << "Profiler: could not write " << path << std::endl;
+		return(false);
+	}
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+	for (const FRAME_RECORD& record : m_history)
+	{
+		// trace times are in microseconds
+		file << ",\n{\"name\":\"Frame " << record.frame << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+			<< ",\"ts\":" << record.startMs * 1000.0 << ",\"dur\":" << record.durationMs * 1000.0 << "}";
+
+		for (const SAMPLE& sample : record.samples)
+		{
+			const SECTION& section = m_sections[sample.section];
+			file << ",\n{\"name\":\"" << section.name << "\",\"cat\":\"" << (section.bGpu ? "gpu" : "cpu")
+				<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << (section.bGpu ? 2 : 1)
+				<< ",\"ts\":" << sample.startMs * 1000.0 << ",\"dur\":" << sample.durationMs * 1000.0 << "}";
+		}
+
+		for (size_t i = 0; (i < m_counters.size()) && (i < record.counters.size()); i++)
+		{
+			file << ",\n{\"name\":\"" << m_counters[i].name << "\",\"ph\":\"C\",\"pid\":1"
+				<< ",\"ts\":" << record.startMs * 1000.0 << ",\"args\":{\"value\":" << record.counters[i] << "}}";
+		}
+	}
+
+	file << "\n]}\n";
+
+	return(true);
+}
@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////////
+// profiler.h
+// ============
+// time the CPU and GPU work of each frame and report it on screen or to file
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include "GLFW/glfw3.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  Profiler
+ *
+ *  This class records how long the parts of each frame take.
+ *  CPU scopes are measured with the steady clock and may be
+ *  nested.  GPU scopes wrap a render pass in a GL_TIME_ELAPSED
+ *  query - they cannot nest, and their results are read two
+ *  frames later from a double-buffered set of queries so the
+ *  CPU never waits on the GPU.  Counters hold one value per
+ *  frame, such as the number of draw calls.
+ *
+ *  The averages are shown as bars over the scene, with the
+ *  numbers in the window title, and every frame can be
+ *  written to a CSV file or a Chrome trace (chrome://tracing)
+ *  when the application closes.
+ ***********************************************************/
+class Profiler
+{
+public:
+	// constructor
+	Profiler();
+	// destructor
+	~Profiler();
+
+	// the most GPU scopes timed in one frame
+	static const int MAX_GPU_SCOPES = 8;
+	// frames of GPU queries in flight
+	static const int GPU_QUERY_FRAMES = 2;
+
+	// measures a CPU scope for as long as the object lives
+	class CpuScope
+	{
+	public:
+		CpuScope(Profiler* pProfiler, const char* name);
+		~CpuScope();
+
+	private:
+		Profiler* m_pProfiler;
+		int m_sample;
+	};
+
+	// read the export options from the command line:
+	// --profile-csv <file>, --profile-trace <file>
+	void ParseArguments(int argc, char* argv[]);
+	// create the GPU queries once the OpenGL context is ready
+	void Create();
+
+	// mark the start and end of a frame
+	void BeginFrame();
+	void EndFrame();
+
+	// time a part of the frame on the CPU - names must be string
+	// literals, since only the pointer is kept
+	int BeginCpu(const char* name);
+	void EndCpu(int sample);
+	// time a render pass on the GPU
+	void BeginGpu(const char* name);
+	void EndGpu();
+	// set a per-frame counter
+	void SetCounter(const char* name, double value);
+
+	// average time of a scope in milliseconds
+	double AverageMs(const char* name, bool bGpu) const;
+	double AverageFrameMs() const { return(m_averageFrameMs); }
+	// print the scope averages and counters to the console
+	void Print() const;
+
+	// show the averages over the scene and in the window title
+	void SetOverlay(bool bEnabled) { m_bOverlay = bEnabled; }
+	void DrawOverlay(GLFWwindow* window, const char* windowTitle);
+
+	// write the recorded frames to the files from the command line
+	void Export();
+
+private:
+	// a named part of the frame, shared by every frame
+	struct SECTION
+	{
+		const char* name;
+		bool bGpu;
+		double averageMs;
+	};
+
+	// one measured scope in a frame
+	struct SAMPLE
+	{
+		int section;
+		// milliseconds since the profiler was created
+		double startMs;
+		double durationMs;
+	};
+
+	struct COUNTER
+	{
+		const char* name;
+		double value;
+		double averageValue;
+	};
+
+	// everything measured in one frame
+	struct FRAME_RECORD
+	{
+		int frame;
+		double startMs;
+		double durationMs;
+		std::vector<SAMPLE> samples;
+		std::vector<double> counters;
+	};
+
+	// the GPU queries issued in one frame
+	struct GPU_FRAME
+	{
+		GLuint queries[MAX_GPU_SCOPES];
+		int sections[MAX_GPU_SCOPES];
+		double startMs[MAX_GPU_SCOPES];
+		int count;
+		int frame;
+	};
+
+	std::chrono::steady_clock::time_point m_startTime;
+	std::vector<SECTION> m_sections;
+	std::vector<COUNTER> m_counters;
+	FRAME_RECORD m_current;
+	int m_frame;
+	double m_averageFrameMs;
+
+	bool m_bGpuTimers;
+	bool m_bGpuActive;
+	GPU_FRAME m_gpuFrames[GPU_QUERY_FRAMES];
+
+	// frames kept for the export, starting with frame 0
+	std::vector<FRAME_RECORD> m_history;
+	std::string m_csvPath;
+	std::string m_tracePath;
+
+	bool m_bOverlay;
+	bool m_bTitleShown;
+	double m_lastTitleMs;
+
+	double NowMs() const;
+	// index of a section, or -1 when it has not been seen yet
+	int FindSection(const char* name, bool bGpu) const;
+	// index of a section, adding it when it is new
+	int AddSection(const char* name, bool bGpu);
+	// fold the results of a finished set of GPU queries into the
+	// averages and the history - unfinished ones are dropped
+	// unless bWait is set
+	void ReadGpuFrame(GPU_FRAME& gpuFrame, bool bWait);
+	bool Recording() const { return((m_csvPath.empty() == false) || (m_tracePath.empty() == false)); }
+	bool WriteCsv(const char* path) const;
+	bool WriteTrace(const char* path) const;
+};
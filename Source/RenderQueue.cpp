@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.cpp
+// ============
+// order draw commands by a packed state key to minimize state changes
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderQueue.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  MakeKey()
+ *
+ *  This method is used for packing the draw state into a
+ *  64-bit key.  Negative texture and material values (none)
+ *  sort before every real texture or material.
+ ***********************************************************/
+uint64_t RenderQueue::MakeKey(int shader, int textureKey, int materialIndex, int mesh, uint16_t extra)
+{
+	uint64_t key = 0;
+	key |= ((uint64_t)(shader & 0xFF)) << 56;
+	key |= ((uint64_t)((textureKey + 1) & 0xFFFF)) << 40;
+	key |= ((uint64_t)((materialIndex + 1) & 0xFFFF)) << 24;
+	key |= ((uint64_t)(mesh & 0xFF)) << 16;
+	key |= (uint64_t)extra;
+
+	return(key);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every entry from the
+ *  queue.  The memory is kept for the next frame.
+ ***********************************************************/
+void RenderQueue::Clear()
+{
+	m_entries.clear();
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method is used for adding a reference to a retained
+ *  draw command into the queue.
+ ***********************************************************/
+void RenderQueue::Add(uint64_t key, EntryType type, int index)
+{
+	ENTRY entry;
+	entry.key = key;
+	entry.type = type;
+	entry.index = index;
+	m_entries.push_back(entry);
+}
+
+/***********************************************************
+ *  Sort()
+ *
+ *  This method is used for ordering the entries by key.  A
+ *  stable sort keeps the authoring order of equal keys.
+ ***********************************************************/
+void RenderQueue::Sort()
+{
+	std::stable_sort(m_entries.begin(), m_entries.end(),
+		[](const ENTRY& a, const ENTRY& b) { return(a.key < b.key); });
+}
+
+/***********************************************************
+ *  DepthKey()
+ *
+ *  This method is used for converting a distance from the
+ *  camera into 16 bits for the low end of a key.  Anything
+ *  past maxDistance gets the largest value.
+ ***********************************************************/
+uint16_t RenderQueue::DepthKey(float distance, float maxDistance)
+{
+	if ((distance <= 0.0f) || (maxDistance <= 0.0f))
+	{
+		return(0);
+	}
+	if (distance >= maxDistance)
+	{
+		return(0xFFFF);
+	}
+
+	return((uint16_t)(distance / maxDistance * 65535.0f));
+}
+
+/***********************************************************
+ *  SortFrontToBack()
+ *
+ *  This method is used for getting the entries ordered by
+ *  depth only, for passes that do not change any state
+ *  between draws, such as a depth pre-pass.
+ ***********************************************************/
+void RenderQueue::SortFrontToBack(std::vector<int>& order) const
+{
+	order.resize(m_entries.size());
+	for (int i = 0; i < (int)order.size(); i++)
+	{
+		order[i] = i;
+	}
+
+	const std::vector<ENTRY>& entries = m_entries;
+	std::stable_sort(order.begin(), order.end(),
+		[&entries](int a, int b) { return((entries[a].key & 0xFFFF) < (entries[b].key & 0xFFFF)); });
+}
@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.h
+// ============
+// order draw commands by a packed state key to minimize state changes
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  RenderQueue
+ *
+ *  This class holds references to the retained draw commands
+ *  together with a 64-bit sort key.  Sorting the queue puts
+ *  draws that share a shader, texture, material and mesh
+ *  next to each other, so the renderer can skip setting any
+ *  state that has not changed since the previous draw.
+ *
+ *  Key layout, most significant bits first:
+ *     63-56  shader program
+ *     55-40  texture key + 1    (0 = untextured)
+ *     39-24  material index + 1 (0 = no material)
+ *     23-16  mesh
+ *     15-0   free for the caller (e.g. depth)
+ *
+ *  When the low bits hold a DepthKey(), draws that share all
+ *  of their state are also ordered front-to-back, and
+ *  SortFrontToBack() gives the order by depth alone.
+ ***********************************************************/
+class RenderQueue
+{
+public:
+	// kind of retained command an entry refers to
+	enum class EntryType
+	{
+		DRAW_ITEM,
+		INSTANCE_GROUP
+	};
+
+	struct ENTRY
+	{
+		uint64_t key;
+		EntryType type;
+		int index;
+	};
+
+	// pack the draw state into a sort key
+	static uint64_t MakeKey(int shader, int textureKey, int materialIndex, int mesh, uint16_t extra = 0);
+	// get the shader value back out of a key
+	static int ShaderFromKey(uint64_t key) { return((int)(key >> 56)); }
+	// quantize a distance from the camera into the low key bits
+	static uint16_t DepthKey(float distance, float maxDistance);
+
+	// remove every entry
+	void Clear();
+	// add a reference to a retained command
+	void Add(uint64_t key, EntryType type, int index);
+	// order the entries by key - draws with equal keys keep their order
+	void Sort();
+	// fill order with entry indices sorted nearest first by
+	// the low key bits, leaving the entries themselves alone
+	void SortFrontToBack(std::vector<int>& order) const;
+
+	const std::vector<ENTRY>& Entries() const { return(m_entries); }
+	bool Empty() const { return(m_entries.empty()); }
+
+private:
+	std::vector<ENTRY> m_entries;
+};
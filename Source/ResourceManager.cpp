@@ -0,0 +1,547 @@
+///////////////////////////////////////////////////////////////////////////////
+// resourcemanager.cpp
+// ============
+// own the OpenGL objects of the scene through reference counted handles
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ResourceManager.h"
+#include "Profiler.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* const g_CategoryNames[ResourceManager::CATEGORY_COUNT] =
+	{
+		"textures",
+		"meshes",
+		"shaders",
+		"render targets",
+		"buffers"
+	};
+	// profiler counters need names that are never freed
+	const char* const g_CounterNames[ResourceManager::CATEGORY_COUNT] =
+	{
+		"texture memory MB",
+		"mesh memory MB",
+		"shader memory MB",
+		"render target memory MB",
+		"buffer memory MB"
+	};
+	const double g_BytesPerMegabyte = 1024.0 * 1024.0;
+}
+
+/***********************************************************
+ *  Handle()
+ *
+ *  The constructors for an empty handle, for one sharing
+ *  another handle's object and for one taking it over.
+ ***********************************************************/
+ResourceManager::Handle::Handle()
+{
+	m_pManager = NULL;
+	m_slot = -1;
+}
+
+ResourceManager::Handle::Handle(ResourceManager* pManager, int slot)
+{
+	m_pManager = pManager;
+	m_slot = slot;
+}
+
+ResourceManager::Handle::Handle(const Handle& other)
+{
+	m_pManager = other.m_pManager;
+	m_slot = other.m_slot;
+	if (NULL != m_pManager)
+	{
+		m_pManager->AddReference(m_slot);
+	}
+}
+
+ResourceManager::Handle::Handle(Handle&& other)
+{
+	m_pManager = other.m_pManager;
+	m_slot = other.m_slot;
+	other.m_pManager = NULL;
+	other.m_slot = -1;
+}
+
+/***********************************************************
+ *  ~Handle()
+ *
+ *  The destructor for the handle
+ ***********************************************************/
+ResourceManager::Handle::~Handle()
+{
+	Reset();
+}
+
+/***********************************************************
+ *  operator=()
+ *
+ *  These methods are used for pointing the handle at another
+ *  handle's object, releasing the one it held before.
+ ***********************************************************/
+ResourceManager::Handle& ResourceManager::Handle::operator=(const Handle& other)
+{
+	if (this != &other)
+	{
+		// count the new reference first, in case both handles
+		// share the last reference to the same object
+		if (NULL != other.m_pManager)
+		{
+			other.m_pManager->AddReference(other.m_slot);
+		}
+		Reset();
+		m_pManager = other.m_pManager;
+		m_slot = other.m_slot;
+	}
+
+	return(*this);
+}
+
+ResourceManager::Handle& ResourceManager::Handle::operator=(Handle&& other)
+{
+	if (this != &other)
+	{
+		Reset();
+		m_pManager = other.m_pManager;
+		m_slot = other.m_slot;
+		other.m_pManager = NULL;
+		other.m_slot = -1;
+	}
+
+	return(*this);
+}
+
+/***********************************************************
+ *  Name()
+ *
+ *  This method is used for getting the OpenGL name of the
+ *  object the handle holds.
+ ***********************************************************/
+GLuint ResourceManager::Handle::Name() const
+{
+	if (NULL == m_pManager)
+	{
+		return(0);
+	}
+
+	return(m_pManager->m_resources[m_slot].name);
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for dropping the handle's reference,
+ *  which releases the object when it was the last one.
+ ***********************************************************/
+void ResourceManager::Handle::Reset()
+{
+	if (NULL != m_pManager)
+	{
+		m_pManager->Release(m_slot);
+		m_pManager = NULL;
+		m_slot = -1;
+	}
+}
+
+/***********************************************************
+ *  SetSize()
+ *
+ *  This method is used for recording how much GPU memory the
+ *  object holds.
+ ***********************************************************/
+void ResourceManager::Handle::SetSize(size_t bytes)
+{
+	if (NULL != m_pManager)
+	{
+		m_pManager->SetSize(m_slot, bytes);
+	}
+}
+
+/***********************************************************
+ *  Size()
+ *
+ *  This method is used for getting the recorded GPU memory
+ *  of the object.
+ ***********************************************************/
+size_t ResourceManager::Handle::Size() const
+{
+	if (NULL == m_pManager)
+	{
+		return(0);
+	}
+
+	return(m_pManager->m_resources[m_slot].bytes);
+}
+
+/***********************************************************
+ *  ResourceManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ResourceManager::ResourceManager()
+{
+	m_frame = 0;
+	m_bReleasedThisFrame = false;
+	for (int category = 0; category < CATEGORY_COUNT; category++)
+	{
+		m_liveCounts[category] = 0;
+		m_liveBytes[category] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~ResourceManager()
+ *
+ *  The destructor for the class.  Objects still held by a
+ *  handle at this point were leaked by their owner - they are
+ *  listed and deleted anyway.
+ ***********************************************************/
+ResourceManager::~ResourceManager()
+{
+	Flush();
+
+	int leaked = 0;
+	for (size_t i = 0; i < m_resources.size(); i++)
+	{
+		RESOURCE& resource = m_resources[i];
+		if (resource.references > 0)
+		{
+			std::cout << "ResourceManager: leaked " << g_CategoryNames[resource.category] << " object \"" << resource.label << "\" (" << resource.bytes << " bytes)" << std::endl;
+			DeleteObject(resource);
+			leaked++;
+		}
+	}
+	if (leaked > 0)
+	{
+		std::cout << "ResourceManager: " << leaked << " object(s) were still referenced at shutdown" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  These methods are used for creating an object of each
+ *  kind and handing out the first handle to it.
+ ***********************************************************/
+ResourceManager::Handle ResourceManager::CreateTexture(Category category, const char* label)
+{
+	GLuint name = 0;
+	glGenTextures(1, &name);
+	return(Add(name, OBJECT_TEXTURE, category, label));
+}
+
+ResourceManager::Handle ResourceManager::CreateBuffer(Category category, const char* label)
+{
+	GLuint name = 0;
+	glGenBuffers(1, &name);
+	return(Add(name, OBJECT_BUFFER, category, label));
+}
+
+ResourceManager::Handle ResourceManager::CreateVertexArray(Category category, const char* label)
+{
+	GLuint name = 0;
+	glGenVertexArrays(1, &name);
+	return(Add(name, OBJECT_VERTEX_ARRAY, category, label));
+}
+
+ResourceManager::Handle ResourceManager::CreateFramebuffer(const char* label)
+{
+	GLuint name = 0;
+	glGenFramebuffers(1, &name);
+	return(Add(name, OBJECT_FRAMEBUFFER, CATEGORY_RENDER_TARGETS, label));
+}
+
+ResourceManager::Handle ResourceManager::CreateRenderbuffer(Category category, const char* label)
+{
+	GLuint name = 0;
+	glGenRenderbuffers(1, &name);
+	return(Add(name, OBJECT_RENDERBUFFER, category, label));
+}
+
+ResourceManager::Handle ResourceManager::CreateSampler(const char* label)
+{
+	GLuint name = 0;
+	glGenSamplers(1, &name);
+	return(Add(name, OBJECT_SAMPLER, CATEGORY_TEXTURES, label));
+}
+
+/***********************************************************
+ *  AdoptProgram()
+ *
+ *  This method is used for taking over a linked program.
+ *  Its size is taken from the length of its binary, the
+ *  closest measure OpenGL gives of the memory it holds.
+ ***********************************************************/
+ResourceManager::Handle ResourceManager::AdoptProgram(GLuint program, const char* label)
+{
+	Handle handle = Add(program, OBJECT_PROGRAM, CATEGORY_SHADERS, label);
+
+	GLint binaryLength = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	handle.SetSize((size_t)binaryLength);
+
+	return(handle);
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method is used for recording a new object in a free
+ *  slot, with the one reference of the returned handle.
+ ***********************************************************/
+ResourceManager::Handle ResourceManager::Add(GLuint name, ObjectType type, Category category, const char* label)
+{
+	int slot = 0;
+	if (m_freeSlots.empty())
+	{
+		slot = (int)m_resources.size();
+		m_resources.push_back(RESOURCE());
+	}
+	else
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+
+	RESOURCE& resource = m_resources[slot];
+	resource.name = name;
+	resource.type = type;
+	resource.category = category;
+	resource.references = 1;
+	resource.bytes = 0;
+	resource.label = label;
+	m_liveCounts[category]++;
+
+	return(Handle(this, slot));
+}
+
+/***********************************************************
+ *  AddReference()
+ *
+ *  This method is used for counting another handle to an
+ *  object.
+ ***********************************************************/
+void ResourceManager::AddReference(int slot)
+{
+	m_resources[slot].references++;
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for dropping a reference.  When the
+ *  last one goes, the object stops counting as live and is
+ *  queued for deletion once the current frame is finished.
+ ***********************************************************/
+void ResourceManager::Release(int slot)
+{
+	RESOURCE& resource = m_resources[slot];
+	resource.references--;
+	if (resource.references > 0)
+	{
+		return;
+	}
+
+	m_liveCounts[resource.category]--;
+	m_liveBytes[resource.category] -= resource.bytes;
+
+	PENDING_DELETE pending;
+	pending.slot = slot;
+	pending.frame = m_frame;
+	m_pending.push_back(pending);
+	m_bReleasedThisFrame = true;
+}
+
+/***********************************************************
+ *  SetSize()
+ *
+ *  This method is used for replacing the recorded size of a
+ *  live object.
+ ***********************************************************/
+void ResourceManager::SetSize(int slot, size_t bytes)
+{
+	RESOURCE& resource = m_resources[slot];
+	m_liveBytes[resource.category] -= resource.bytes;
+	resource.bytes = bytes;
+	m_liveBytes[resource.category] += bytes;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for closing the frame.  The fences are
+ *  polled without waiting, oldest first, and the objects of
+ *  every frame the GPU has passed are deleted.
+ ***********************************************************/
+void ResourceManager::EndFrame()
+{
+	if (m_bReleasedThisFrame)
+	{
+		FRAME_FENCE frameFence;
+		frameFence.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		frameFence.frame = m_frame;
+		m_fences.push_back(frameFence);
+		m_bReleasedThisFrame = false;
+	}
+
+	bool bCompleted = false;
+	uint64_t completedFrame = 0;
+	while (m_fences.empty() == false)
+	{
+		GLenum status = glClientWaitSync(m_fences.front().fence, 0, 0);
+		if ((status != GL_ALREADY_SIGNALED) && (status != GL_CONDITION_SATISFIED))
+		{
+			break;
+		}
+
+		completedFrame = m_fences.front().frame;
+		bCompleted = true;
+		glDeleteSync(m_fences.front().fence);
+		m_fences.pop_front();
+	}
+
+	if (bCompleted)
+	{
+		DeletePending(completedFrame);
+	}
+
+	m_frame++;
+}
+
+/***********************************************************
+ *  Flush()
+ *
+ *  This method is used for deleting every released object
+ *  right away, e.g. after a scene has been unloaded or when
+ *  the application closes.
+ ***********************************************************/
+void ResourceManager::Flush()
+{
+	if (m_pending.empty() && m_fences.empty())
+	{
+		return;
+	}
+
+	glFinish();
+	for (size_t i = 0; i < m_fences.size(); i++)
+	{
+		glDeleteSync(m_fences[i].fence);
+	}
+	m_fences.clear();
+	m_bReleasedThisFrame = false;
+
+	DeletePending(m_frame);
+}
+
+/***********************************************************
+ *  DeletePending()
+ *
+ *  This method is used for deleting the objects released up
+ *  to the passed in frame and freeing their slots.
+ ***********************************************************/
+void ResourceManager::DeletePending(uint64_t completedFrame)
+{
+	while ((m_pending.empty() == false) && (m_pending.front().frame <= completedFrame))
+	{
+		int slot = m_pending.front().slot;
+		m_pending.pop_front();
+
+		DeleteObject(m_resources[slot]);
+		m_freeSlots.push_back(slot);
+	}
+}
+
+/***********************************************************
+ *  DeleteObject()
+ *
+ *  This method is used for deleting an OpenGL object with the
+ *  call that matches its kind.
+ ***********************************************************/
+void ResourceManager::DeleteObject(RESOURCE& resource)
+{
+	switch (resource.type)
+	{
+	case OBJECT_TEXTURE:
+		glDeleteTextures(1, &resource.name);
+		break;
+	case OBJECT_BUFFER:
+		glDeleteBuffers(1, &resource.name);
+		break;
+	case OBJECT_VERTEX_ARRAY:
+		glDeleteVertexArrays(1, &resource.name);
+		break;
+	case OBJECT_FRAMEBUFFER:
+		glDeleteFramebuffers(1, &resource.name);
+		break;
+	case OBJECT_RENDERBUFFER:
+		glDeleteRenderbuffers(1, &resource.name);
+		break;
+	case OBJECT_PROGRAM:
+		glDeleteProgram(resource.name);
+		break;
+	case OBJECT_SAMPLER:
+		glDeleteSamplers(1, &resource.name);
+		break;
+	}
+
+	resource.name = 0;
+	resource.references = 0;
+	resource.bytes = 0;
+}
+
+/***********************************************************
+ *  CategoryName()
+ *
+ *  This method is used for getting the printed name of a
+ *  category.
+ ***********************************************************/
+const char* ResourceManager::CategoryName(Category category)
+{
+	return(g_CategoryNames[category]);
+}
+
+/***********************************************************
+ *  Print()
+ *
+ *  This method is used for printing the live objects and
+ *  bytes of each category to the console.
+ ***********************************************************/
+void ResourceManager::Print() const
+{
+	size_t totalBytes = 0;
+	std::cout << "GPU resources:" << std::endl;
+	for (int category = 0; category < CATEGORY_COUNT; category++)
+	{
+		std::cout << "  " << g_CategoryNames[category] << ": " << m_liveCounts[category] << " object(s), "
+			<< (m_liveBytes[category] / g_BytesPerMegabyte) << " MB" << std::endl;
+		totalBytes += m_liveBytes[category];
+	}
+	std::cout << "  total: " << (totalBytes / g_BytesPerMegabyte) << " MB, " << m_pending.size() << " object(s) waiting to be deleted" << std::endl;
+}
+
+/***********************************************************
+ *  ReportCounters()
+ *
+ *  This method is used for passing the memory of each
+ *  category to the profiler for the frame.
+ ***********************************************************/
+void ResourceManager::ReportCounters(Profiler* pProfiler) const
+{
+	if (NULL == pProfiler)
+	{
+		return;
+	}
+
+	for (int category = 0; category < CATEGORY_COUNT; category++)
+	{
+		pProfiler->SetCounter(g_CounterNames[category], m_liveBytes[category] / g_BytesPerMegabyte);
+	}
+}
@@ -0,0 +1,175 @@
+///////////////////////////////////////////////////////////////////////////////
+// resourcemanager.h
+// ============
+// own the OpenGL objects of the scene through reference counted handles
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class Profiler;
+
+/***********************************************************
+ *  ResourceManager
+ *
+ *  This class owns the textures, samplers, buffers, vertex
+ *  arrays, framebuffers and shader programs of the scene.  Each one
+ *  is held through a Handle, which counts its references -
+ *  copies share the object, and it is released when the last
+ *  handle goes away, so an object cannot be leaked or freed
+ *  twice by the classes that use it.
+ *
+ *  A released object is not deleted right away, since the
+ *  frames already queued on the GPU may still use it.  Every
+ *  frame that released something ends with a fence, and the
+ *  objects are deleted once the GPU has passed the fence of
+ *  the frame they were released in.
+ *
+ *  The owners report how many bytes each object holds, so
+ *  the memory in use can be shown by category.  Handles are
+ *  only used on the thread with the OpenGL context, and the
+ *  manager has to outlive all of them.
+ ***********************************************************/
+class ResourceManager
+{
+public:
+	// constructor
+	ResourceManager();
+	// destructor
+	~ResourceManager();
+
+	// what the memory of an object is counted as
+	enum Category
+	{
+		CATEGORY_TEXTURES,
+		CATEGORY_MESHES,
+		CATEGORY_SHADERS,
+		CATEGORY_RENDER_TARGETS,
+		CATEGORY_BUFFERS,
+		CATEGORY_COUNT
+	};
+
+	// kind of OpenGL object, which picks the call that deletes it
+	enum ObjectType
+	{
+		OBJECT_TEXTURE,
+		OBJECT_BUFFER,
+		OBJECT_VERTEX_ARRAY,
+		OBJECT_FRAMEBUFFER,
+		OBJECT_RENDERBUFFER,
+		OBJECT_PROGRAM,
+		OBJECT_SAMPLER
+	};
+
+	// shares one OpenGL object, and releases it when the last
+	// handle to it is destroyed or reset
+	class Handle
+	{
+	public:
+		Handle();
+		Handle(const Handle& other);
+		Handle(Handle&& other);
+		~Handle();
+		Handle& operator=(const Handle& other);
+		Handle& operator=(Handle&& other);
+
+		// OpenGL name of the object - 0 for an empty handle
+		GLuint Name() const;
+		bool IsValid() const { return(NULL != m_pManager); }
+		// drop this reference
+		void Reset();
+
+		// bytes of GPU memory the object holds, set by its owner
+		// whenever the storage is allocated
+		void SetSize(size_t bytes);
+		size_t Size() const;
+
+	private:
+		friend class ResourceManager;
+		Handle(ResourceManager* pManager, int slot);
+
+		ResourceManager* m_pManager;
+		int m_slot;
+	};
+
+	// create an object - the label is shown when it leaks, and
+	// has to be a string literal since only the pointer is kept
+	Handle CreateTexture(Category category, const char* label);
+	Handle CreateBuffer(Category category, const char* label);
+	Handle CreateVertexArray(Category category, const char* label);
+	Handle CreateFramebuffer(const char* label);
+	Handle CreateRenderbuffer(Category category, const char* label);
+	Handle CreateSampler(const char* label);
+	// take over a program that has already been linked
+	Handle AdoptProgram(GLuint program, const char* label);
+
+	// fence the frame when it released anything, and delete the
+	// objects of the frames the GPU has finished
+	void EndFrame();
+	// wait for the GPU and delete every released object
+	void Flush();
+
+	// objects and bytes still referenced by a handle
+	int LiveCount(Category category) const { return(m_liveCounts[category]); }
+	size_t LiveBytes(Category category) const { return(m_liveBytes[category]); }
+	// released objects waiting for their frame to finish
+	int PendingCount() const { return((int)m_pending.size()); }
+	static const char* CategoryName(Category category);
+
+	// print the objects and bytes of each category
+	void Print() const;
+	// show the memory of each category as profiler counters
+	void ReportCounters(Profiler* pProfiler) const;
+
+private:
+	// one object, reused through the free list once deleted
+	struct RESOURCE
+	{
+		GLuint name;
+		ObjectType type;
+		Category category;
+		int references;
+		size_t bytes;
+		const char* label;
+	};
+
+	// a released object and the frame it was released in
+	struct PENDING_DELETE
+	{
+		int slot;
+		uint64_t frame;
+	};
+
+	struct FRAME_FENCE
+	{
+		GLsync fence;
+		uint64_t frame;
+	};
+
+	std::vector<RESOURCE> m_resources;
+	std::vector<int> m_freeSlots;
+	std::deque<PENDING_DELETE> m_pending;
+	std::deque<FRAME_FENCE> m_fences;
+	uint64_t m_frame;
+	bool m_bReleasedThisFrame;
+
+	int m_liveCounts[CATEGORY_COUNT];
+	size_t m_liveBytes[CATEGORY_COUNT];
+
+	Handle Add(GLuint name, ObjectType type, Category category, const char* label);
+	void AddReference(int slot);
+	void Release(int slot);
+	void SetSize(int slot, size_t bytes);
+	// delete the released objects up to the passed in frame
+	void DeletePending(uint64_t completedFrame);
+	void DeleteObject(RESOURCE& resource);
+};
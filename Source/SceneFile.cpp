@@ -0,0 +1,855 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.cpp
+// ============
+// describe the scene in a JSON file that is compiled into a mapped binary cache
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFile.h"
+#include "TextureQuality.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	const char g_CacheMagic[4] = { 'S', 'C', 'N', 'B' };
+
+	// names of the meshes in the order of SceneManager::MeshType
+	const char* const g_MeshNames[] =
+	{
+		"box", "box_front", "box_back", "box_bottom", "box_top", "box_right", "box_left",
+		"cone", "cylinder", "plane", "prism", "pyramid3", "pyramid4", "sphere",
+		"tapered_cylinder", "torus"
+	};
+	const int g_MeshCount = sizeof(g_MeshNames) / sizeof(g_MeshNames[0]);
+
+	/***********************************************************
+	 *  JSON_VALUE
+	 *
+	 *  A parsed JSON value.  Only the compiler uses these - the
+	 *  scene itself is read from the binary cache.
+	 ***********************************************************/
+	struct JSON_VALUE
+	{
+		enum Type { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+
+		Type type = JSON_NULL;
+		bool bValue = false;
+		double number = 0.0;
+		std::string text;
+		std::vector<JSON_VALUE> items;
+		std::vector<std::string> keys;
+
+		// member of an object, or NULL when there is none
+		const JSON_VALUE* Find(const char* key) const
+		{
+			for (size_t i = 0; i < keys.size(); i++)
+			{
+				if (keys[i] == key)
+				{
+					return(&items[i]);
+				}
+			}
+			return(NULL);
+		}
+	};
+
+	/***********************************************************
+	 *  JsonParser
+	 *
+	 *  A small recursive descent parser for the JSON subset
+	 *  the scene files use - everything except \u escapes.
+	 ***********************************************************/
+	class JsonParser
+	{
+	public:
+		JsonParser(const std::string& text) : m_text(text), m_position(0), m_line(1) {}
+
+		bool Parse(JSON_VALUE& value)
+		{
+			if (ParseValue(value) == false)
+			{
+				return(false);
+			}
+
+			SkipSpace();
+			if (m_position != m_text.size())
+			{
+				return(Fail("unexpected text after the scene"));
+			}
+			return(true);
+		}
+
+		const std::string& Error() const { return(m_error); }
+
+	private:
+		const std::string& m_text;
+		size_t m_position;
+		int m_line;
+		std::string m_error;
+
+		bool Fail(const char* message)
+		{
+			std::ostringstream error;
+			error << "line " << m_line << ": " << message;
+			m_error = error.str();
+			return(false);
+		}
+
+		void SkipSpace()
+		{
+			while (m_position < m_text.size())
+			{
+				char c = m_text[m_position];
+				if (c == '\n')
+				{
+					m_line++;
+				}
+				if ((c != ' ') && (c != '\t') && (c != '\r') && (c != '\n'))
+				{
+					break;
+				}
+				m_position++;
+			}
+		}
+
+		bool Match(const char* word)
+		{
+			size_t length = strlen(word);
+			if (m_text.compare(m_position, length, word) == 0)
+			{
+				m_position += length;
+				return(true);
+			}
+			return(false);
+		}
+
+		bool ParseValue(JSON_VALUE& value)
+		{
+			SkipSpace();
+			if (m_position >= m_text.size())
+			{
+				return(Fail("unexpected end of file"));
+			}
+
+			char c = m_text[m_position];
+			if (c == '{')
+			{
+				return(ParseObject(value));
+			}
+			if (c == '[')
+			{
+				return(ParseArray(value));
+			}
+			if (c == '"')
+			{
+				value.type = JSON_VALUE::JSON_STRING;
+				return(ParseString(value.text));
+			}
+			if (Match("true") || Match("false"))
+			{
+				value.type = JSON_VALUE::JSON_BOOL;
+				value.bValue = (m_text[m_position - 1] == 'e') && (m_text[m_position - 2] == 'u');
+				return(true);
+			}
+			if (Match("null"))
+			{
+				value.type = JSON_VALUE::JSON_NULL;
+				return(true);
+			}
+
+			const char* start = m_text.c_str() + m_position;
+			char* end = NULL;
+			value.number = strtod(start, &end);
+			if (end == start)
+			{
+				return(Fail("expected a value"));
+			}
+			value.type = JSON_VALUE::JSON_NUMBER;
+			m_position += (size_t)(end - start);
+			return(true);
+		}
+
+		bool ParseString(std::string& text)
+		{
+			// skip the opening quote
+			m_position++;
+			text.clear();
+			while (m_position < m_text.size())
+			{
+				char c = m_text[m_position++];
+				if (c == '"')
+				{
+					return(true);
+				}
+				if ((c == '\\') && (m_position < m_text.size()))
+				{
+					char escaped = m_text[m_position++];
+					switch (escaped)
+					{
+					case 'n': c = '\n'; break;
+					case 't': c = '\t'; break;
+					case 'r': c = '\r'; break;
+					default: c = escaped; break;
+					}
+				}
+				text.push_back(c);
+			}
+			return(Fail("unterminated string"));
+		}
+
+		bool ParseArray(JSON_VALUE& value)
+		{
+			value.type = JSON_VALUE::JSON_ARRAY;
+			m_position++;
+			SkipSpace();
+			if (Match("]"))
+			{
+				return(true);
+			}
+
+			while (true)
+			{
+				value.items.push_back(JSON_VALUE());
+				if (ParseValue(value.items.back()) == false)
+				{
+					return(false);
+				}
+				SkipSpace();
+				if (Match("]"))
+				{
+					return(true);
+				}
+				if (Match(",") == false)
+				{
+					return(Fail("expected , or ] in an array"));
+				}
+			}
+		}
+
+		bool ParseObject(JSON_VALUE& value)
+		{
+			value.type = JSON_VALUE::JSON_OBJECT;
+			m_position++;
+			SkipSpace();
+			if (Match("}"))
+			{
+				return(true);
+			}
+
+			while (true)
+			{
+				SkipSpace();
+				if ((m_position >= m_text.size()) || (m_text[m_position] != '"'))
+				{
+					return(Fail("expected a member name"));
+				}
+				value.keys.push_back(std::string());
+				if (ParseString(value.keys.back()) == false)
+				{
+					return(false);
+				}
+				SkipSpace();
+				if (Match(":") == false)
+				{
+					return(Fail("expected : after a member name"));
+				}
+				value.items.push_back(JSON_VALUE());
+				if (ParseValue(value.items.back()) == false)
+				{
+					return(false);
+				}
+				SkipSpace();
+				if (Match("}"))
+				{
+					return(true);
+				}
+				if (Match(",") == false)
+				{
+					return(Fail("expected , or } in an object"));
+				}
+			}
+		}
+	};
+
+	/***********************************************************
+	 *  SceneCompiler
+	 *
+	 *  Turns the parsed JSON scene into the cache arrays.
+	 *  Missing members take the same defaults as the
+	 *  SceneManager::Add*() helpers.
+	 ***********************************************************/
+	class SceneCompiler
+	{
+	public:
+		std::vector<SceneFile::TEXTURE_RECORD> textures;
+		std::vector<SceneFile::MATERIAL_RECORD> materials;
+		std::vector<SceneFile::LIGHT_RECORD> lights;
+		std::vector<SceneFile::DRAW_RECORD> draws;
+		std::vector<SceneFile::INSTANCE_RECORD> instances;
+		std::vector<char> strings;
+
+		SceneCompiler()
+		{
+			// offset 0 is the empty string
+			strings.push_back('\0');
+		}
+
+		bool Compile(const JSON_VALUE& scene, std::string& error)
+		{
+			if (scene.type != JSON_VALUE::JSON_OBJECT)
+			{
+				error = "the scene must be an object";
+				return(false);
+			}
+
+			const JSON_VALUE* pList = scene.Find("textures");
+			for (size_t i = 0; (NULL != pList) && (i < pList->items.size()); i++)
+			{
+				const JSON_VALUE& texture = pList->items[i];
+				SceneFile::TEXTURE_RECORD record;
+				record.tag = AddString(GetString(texture, "tag", ""));
+				record.file = AddString(GetString(texture, "file", ""));
+				record.quality = (int32_t)TextureQuality::ParseTier(GetString(texture, "quality", "").c_str());
+				textures.push_back(record);
+			}
+
+			pList = scene.Find("materials");
+			for (size_t i = 0; (NULL != pList) && (i < pList->items.size()); i++)
+			{
+				const JSON_VALUE& material = pList->items[i];
+				SceneFile::MATERIAL_RECORD record;
+				GetFloats(material, "diffuse", record.diffuseColor, 3, 0.8f);
+				GetFloats(material, "specular", record.specularColor, 3, 0.0f);
+				record.shininess = GetFloat(material, "shininess", 1.0f);
+				record.tag = AddString(GetString(material, "tag", ""));
+				record.bTransparent = GetBool(material, "transparent", false) ? 1 : 0;
+				materials.push_back(record);
+			}
+
+			pList = scene.Find("lights");
+			for (size_t i = 0; (NULL != pList) && (i < pList->items.size()); i++)
+			{
+				const JSON_VALUE& light = pList->items[i];
+				std::string type = GetString(light, "type", "point");
+				SceneFile::LIGHT_RECORD record;
+				if (type == "point")
+				{
+					record.type = SceneFile::LIGHT_POINT;
+				}
+				else if (type == "directional")
+				{
+					record.type = SceneFile::LIGHT_DIRECTIONAL;
+				}
+				else if (type == "spot")
+				{
+					record.type = SceneFile::LIGHT_SPOT;
+				}
+				else
+				{
+					error = "unknown light type " + type;
+					return(false);
+				}
+				GetFloats(light, "position", record.position, 3, 0.0f);
+				GetFloats(light, "direction", record.direction, 3, 0.0f);
+				GetFloats(light, "ambient", record.ambient, 3, 0.0f);
+				GetFloats(light, "diffuse", record.diffuse, 3, 0.0f);
+				GetFloats(light, "specular", record.specular, 3, 0.0f);
+				record.range = GetFloat(light, "range", 0.0f);
+				record.cutOff = GetFloat(light, "cutOff", 0.0f);
+				record.outerCutOff = GetFloat(light, "outerCutOff", 0.0f);
+				lights.push_back(record);
+			}
+
+			pList = scene.Find("objects");
+			for (size_t i = 0; (NULL != pList) && (i < pList->items.size()); i++)
+			{
+				if (CompileObject(pList->items[i], SceneFile::NO_PARENT, error) == false)
+				{
+					std::ostringstream message;
+					message << "object " << i << ": " << error;
+					error = message.str();
+					return(false);
+				}
+			}
+
+			return(true);
+		}
+
+	private:
+		bool CompileObject(const JSON_VALUE& object, uint32_t parent, std::string& error)
+		{
+			SceneFile::DRAW_RECORD record;
+			memset(&record, 0, sizeof(record));
+			record.parent = parent;
+
+			// a group only places its children
+			const JSON_VALUE* pChildren = object.Find("children");
+			if (NULL != pChildren)
+			{
+				record.kind = SceneFile::DRAW_GROUP;
+				if (GetBool(object, "replicate", false) && (parent == SceneFile::NO_PARENT))
+				{
+					record.flags = SceneFile::DRAW_FLAG_REPLICATE;
+				}
+				GetFloats(object, "scale", record.scale, 3, 1.0f);
+				GetFloats(object, "position", record.position, 3, 0.0f);
+				GetFloats(object, "rotation", record.rotation, 3, 0.0f);
+
+				uint32_t index = (uint32_t)draws.size();
+				draws.push_back(record);
+				for (size_t i = 0; i < pChildren->items.size(); i++)
+				{
+					if (CompileObject(pChildren->items[i], index, error) == false)
+					{
+						return(false);
+					}
+				}
+				return(true);
+			}
+
+			std::string mesh = GetString(object, "mesh", "");
+			int meshIndex = 0;
+			while ((meshIndex < g_MeshCount) && (mesh != g_MeshNames[meshIndex]))
+			{
+				meshIndex++;
+			}
+			if (meshIndex == g_MeshCount)
+			{
+				error = "unknown mesh " + mesh;
+				return(false);
+			}
+			record.mesh = (uint32_t)meshIndex;
+
+			// every part is drawn unless a list is given
+			const JSON_VALUE* pParts = object.Find("parts");
+			if (NULL == pParts)
+			{
+				record.flags = SceneFile::DRAW_FLAG_TOP | SceneFile::DRAW_FLAG_BOTTOM | SceneFile::DRAW_FLAG_SIDES;
+			}
+			for (size_t i = 0; (NULL != pParts) && (i < pParts->items.size()); i++)
+			{
+				const std::string& part = pParts->items[i].text;
+				if (part == "top")
+				{
+					record.flags |= SceneFile::DRAW_FLAG_TOP;
+				}
+				else if (part == "bottom")
+				{
+					record.flags |= SceneFile::DRAW_FLAG_BOTTOM;
+				}
+				else if (part == "sides")
+				{
+					record.flags |= SceneFile::DRAW_FLAG_SIDES;
+				}
+				else
+				{
+					error = "unknown part " + part;
+					return(false);
+				}
+			}
+			if (GetBool(object, "replicate", false) && (parent == SceneFile::NO_PARENT))
+			{
+				record.flags |= SceneFile::DRAW_FLAG_REPLICATE;
+			}
+
+			record.material = AddString(GetString(object, "material", ""));
+			GetFloats(object, "scale", record.scale, 3, 1.0f);
+			GetFloats(object, "position", record.position, 3, 0.0f);
+			GetFloats(object, "rotation", record.rotation, 3, 0.0f);
+			GetFloats(object, "color", record.color, 4, 1.0f);
+			GetFloats(object, "uvTile", record.uvTile, 2, 1.0f);
+
+			const JSON_VALUE* pFaceTextures = object.Find("faceTextures");
+			const JSON_VALUE* pPartTextures = object.Find("partTextures");
+			const JSON_VALUE* pInstances = object.Find("instances");
+
+			if (NULL != pInstances)
+			{
+				record.kind = (NULL != pPartTextures) ? SceneFile::DRAW_INSTANCED_PER_PART : SceneFile::DRAW_INSTANCED;
+				record.firstInstance = (uint32_t)instances.size();
+				record.instanceCount = (uint32_t)pInstances->items.size();
+				for (size_t i = 0; i < pInstances->items.size(); i++)
+				{
+					const JSON_VALUE& instance = pInstances->items[i];
+					SceneFile::INSTANCE_RECORD instanceRecord;
+					GetFloats(instance, "scale", instanceRecord.scale, 3, 1.0f);
+					GetFloats(instance, "position", instanceRecord.position, 3, 0.0f);
+					GetFloats(instance, "rotation", instanceRecord.rotation, 3, 0.0f);
+					GetFloats(instance, "color", instanceRecord.color, 4, 1.0f);
+					instances.push_back(instanceRecord);
+				}
+			}
+			else if (NULL != pFaceTextures)
+			{
+				record.kind = SceneFile::DRAW_FACE_BOX;
+			}
+			else if (NULL != object.Find("texture"))
+			{
+				record.kind = SceneFile::DRAW_TEXTURED_MESH;
+			}
+			else
+			{
+				record.kind = SceneFile::DRAW_MESH;
+			}
+
+			const JSON_VALUE* pTextureList = (NULL != pFaceTextures) ? pFaceTextures : pPartTextures;
+			size_t expected = (NULL != pFaceTextures) ? 6 : 3;
+			if (NULL != pTextureList)
+			{
+				if (pTextureList->items.size() != expected)
+				{
+					error = (NULL != pFaceTextures) ? "faceTextures needs 6 tags" : "partTextures needs 3 tags";
+					return(false);
+				}
+				for (size_t i = 0; i < expected; i++)
+				{
+					record.textures[i] = AddString(pTextureList->items[i].text);
+				}
+			}
+			else
+			{
+				record.textures[0] = AddString(GetString(object, "texture", ""));
+			}
+
+			draws.push_back(record);
+			return(true);
+		}
+
+		uint32_t AddString(const std::string& text)
+		{
+			if (text.empty())
+			{
+				return(0);
+			}
+
+			uint32_t offset = (uint32_t)strings.size();
+			strings.insert(strings.end(), text.begin(), text.end());
+			strings.push_back('\0');
+			return(offset);
+		}
+
+		static std::string GetString(const JSON_VALUE& object, const char* key, const char* fallback)
+		{
+			const JSON_VALUE* pValue = object.Find(key);
+			return(((NULL != pValue) && (pValue->type == JSON_VALUE::JSON_STRING)) ? pValue->text : std::string(fallback));
+		}
+
+		static float GetFloat(const JSON_VALUE& object, const char* key, float fallback)
+		{
+			const JSON_VALUE* pValue = object.Find(key);
+			return(((NULL != pValue) && (pValue->type == JSON_VALUE::JSON_NUMBER)) ? (float)pValue->number : fallback);
+		}
+
+		static bool GetBool(const JSON_VALUE& object, const char* key, bool fallback)
+		{
+			const JSON_VALUE* pValue = object.Find(key);
+			return(((NULL != pValue) && (pValue->type == JSON_VALUE::JSON_BOOL)) ? pValue->bValue : fallback);
+		}
+
+		static void GetFloats(const JSON_VALUE& object, const char* key, float* values, int count, float fallback)
+		{
+			const JSON_VALUE* pValue = object.Find(key);
+			for (int i = 0; i < count; i++)
+			{
+				values[i] = fallback;
+				if ((NULL != pValue) && (i < (int)pValue->items.size()) &&
+					(pValue->items[i].type == JSON_VALUE::JSON_NUMBER))
+				{
+					values[i] = (float)pValue->items[i].number;
+				}
+			}
+		}
+	};
+
+	/***********************************************************
+	 *  WriteArray()
+	 *
+	 *  Write the records of an array at the end of the file
+	 *  and return where they start.
+	 ***********************************************************/
+	template <typename T>
+	uint32_t WriteArray(FILE* file, const std::vector<T>& records)
+	{
+		uint32_t offset = (uint32_t)ftell(file);
+		if (records.empty() == false)
+		{
+			fwrite(records.data(), sizeof(T), records.size(), file);
+		}
+		return(offset);
+	}
+
+	/***********************************************************
+	 *  ArrayFits()
+	 *
+	 *  Check that an array in the cache lies inside the file.
+	 ***********************************************************/
+	bool ArrayFits(uint32_t offset, uint32_t count, size_t recordSize, size_t fileSize)
+	{
+		return((offset <= fileSize) && ((uint64_t)count * recordSize <= fileSize - offset));
+	}
+}
+
+/***********************************************************
+ *  SceneFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneFile::SceneFile()
+{
+	m_pHeader = NULL;
+	m_pTextures = NULL;
+	m_pMaterials = NULL;
+	m_pLights = NULL;
+	m_pDraws = NULL;
+	m_pInstances = NULL;
+	m_pStrings = NULL;
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for mapping the binary cache of a
+ *  scene.  The JSON source is only read when the cache is
+ *  missing, damaged or older than the source.
+ ***********************************************************/
+bool SceneFile::Load(const char* sourcePath, const char* cachePath)
+{
+	if (MapCache(cachePath) && IsCurrent(sourcePath))
+	{
+		std::cout << "Scene: mapped " << cachePath << " (" << DrawCount() << " objects)" << std::endl;
+		return(true);
+	}
+	Close();
+
+	if (Compile(sourcePath, cachePath) == false)
+	{
+		return(false);
+	}
+	if (MapCache(cachePath) == false)
+	{
+		std::cout << "Scene: could not map the compiled cache " << cachePath << std::endl;
+		Close();
+		return(false);
+	}
+
+	std::cout << "Scene: compiled " << sourcePath << " into " << cachePath << " (" << DrawCount() << " objects)" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the cache.
+ ***********************************************************/
+void SceneFile::Close()
+{
+	m_file.Close();
+	m_pHeader = NULL;
+	m_pTextures = NULL;
+	m_pMaterials = NULL;
+	m_pLights = NULL;
+	m_pDraws = NULL;
+	m_pInstances = NULL;
+	m_pStrings = NULL;
+}
+
+/***********************************************************
+ *  Compile()
+ *
+ *  This method is used for parsing a JSON scene and writing
+ *  its binary cache.  The header is written last, so a cache
+ *  left half written never has a valid magic value.
+ ***********************************************************/
+bool SceneFile::Compile(const char* sourcePath, const char* cachePath)
+{
+	std::ifstream source(sourcePath, std::ios::binary);
+	if (!source)
+	{
+		std::cout << "Scene: could not open " << sourcePath << std::endl;
+		return(false);
+	}
+	std::stringstream contents;
+	contents << source.rdbuf();
+	std::string text = contents.str();
+
+	JSON_VALUE scene;
+	JsonParser parser(text);
+	if (parser.Parse(scene) == false)
+	{
+		std::cout << "Scene: " << sourcePath << ", " << parser.Error() << std::endl;
+		return(false);
+	}
+
+	SceneCompiler compiler;
+	std::string error;
+	if (compiler.Compile(scene, error) == false)
+	{
+		std::cout << "Scene: " << sourcePath << ", " << error << std::endl;
+		return(false);
+	}
+
+	FILE* file = fopen(cachePath, "wb");
+	if (NULL == file)
+	{
+		std::cout << "Scene: could not write " << cachePath << std::endl;
+		return(false);
+	}
+
+	CACHE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	fwrite(&header, sizeof(header), 1, file);
+
+	header.version = CACHE_VERSION;
+	MappedFile::GetFileStamp(sourcePath, header.sourceSize, header.sourceWriteTime);
+	FillRecordSizes(header.recordSizes);
+	header.textureCount = (uint32_t)compiler.textures.size();
+	header.textureOffset = WriteArray(file, compiler.textures);
+	header.materialCount = (uint32_t)compiler.materials.size();
+	header.materialOffset = WriteArray(file, compiler.materials);
+	header.lightCount = (uint32_t)compiler.lights.size();
+	header.lightOffset = WriteArray(file, compiler.lights);
+	header.drawCount = (uint32_t)compiler.draws.size();
+	header.drawOffset = WriteArray(file, compiler.draws);
+	header.instanceCount = (uint32_t)compiler.instances.size();
+	header.instanceOffset = WriteArray(file, compiler.instances);
+	header.stringSize = (uint32_t)compiler.strings.size();
+	header.stringOffset = WriteArray(file, compiler.strings);
+
+	memcpy(header.magic, g_CacheMagic, sizeof(header.magic));
+	fseek(file, 0, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, file);
+	bool bWritten = (ferror(file) == 0);
+	fclose(file);
+
+	if (bWritten == false)
+	{
+		std::cout << "Scene: could not write " << cachePath << std::endl;
+		remove(cachePath);
+	}
+
+	return(bWritten);
+}
+
+/***********************************************************
+ *  MapCache()
+ *
+ *  This method is used for mapping a cache and pointing the
+ *  record arrays into it, after checking that the header
+ *  matches this build and every array is inside the file.
+ ***********************************************************/
+bool SceneFile::MapCache(const char* cachePath)
+{
+	Close();
+	if ((m_file.Open(cachePath) == false) || (m_file.Size() < sizeof(CACHE_HEADER)))
+	{
+		return(false);
+	}
+
+	const unsigned char* pData = m_file.Data();
+	size_t size = m_file.Size();
+	const CACHE_HEADER* pHeader = (const CACHE_HEADER*)pData;
+
+	uint32_t recordSizes[5];
+	FillRecordSizes(recordSizes);
+	bool bValid = (memcmp(pHeader->magic, g_CacheMagic, sizeof(g_CacheMagic)) == 0) &&
+		(pHeader->version == CACHE_VERSION) &&
+		(memcmp(pHeader->recordSizes, recordSizes, sizeof(recordSizes)) == 0) &&
+		ArrayFits(pHeader->textureOffset, pHeader->textureCount, sizeof(TEXTURE_RECORD), size) &&
+		ArrayFits(pHeader->materialOffset, pHeader->materialCount, sizeof(MATERIAL_RECORD), size) &&
+		ArrayFits(pHeader->lightOffset, pHeader->lightCount, sizeof(LIGHT_RECORD), size) &&
+		ArrayFits(pHeader->drawOffset, pHeader->drawCount, sizeof(DRAW_RECORD), size) &&
+		ArrayFits(pHeader->instanceOffset, pHeader->instanceCount, sizeof(INSTANCE_RECORD), size) &&
+		ArrayFits(pHeader->stringOffset, pHeader->stringSize, 1, size) &&
+		(pHeader->stringSize > 0) &&
+		(pData[pHeader->stringOffset + pHeader->stringSize - 1] == '\0');
+	if (bValid == false)
+	{
+		Close();
+		return(false);
+	}
+
+	// kinds, meshes, strings and instance ranges are checked once
+	// here, so the records can be used without any further tests
+	const DRAW_RECORD* pDraws = (const DRAW_RECORD*)(pData + pHeader->drawOffset);
+	for (uint32_t i = 0; (i < pHeader->drawCount) && bValid; i++)
+	{
+		bValid = (pDraws[i].kind <= (uint32_t)DRAW_GROUP) &&
+			(pDraws[i].mesh < (uint32_t)g_MeshCount) &&
+			((uint64_t)pDraws[i].firstInstance + pDraws[i].instanceCount <= pHeader->instanceCount) &&
+			(pDraws[i].material < pHeader->stringSize) &&
+			((pDraws[i].parent == NO_PARENT) ||
+			((pDraws[i].parent < i) && (pDraws[pDraws[i].parent].kind == DRAW_GROUP)));
+		for (int t = 0; t < 6; t++)
+		{
+			bValid = bValid && (pDraws[i].textures[t] < pHeader->stringSize);
+		}
+	}
+	const TEXTURE_RECORD* pTextures = (const TEXTURE_RECORD*)(pData + pHeader->textureOffset);
+	for (uint32_t i = 0; (i < pHeader->textureCount) && bValid; i++)
+	{
+		bValid = (pTextures[i].tag < pHeader->stringSize) && (pTextures[i].file < pHeader->stringSize);
+	}
+	const MATERIAL_RECORD* pMaterials = (const MATERIAL_RECORD*)(pData + pHeader->materialOffset);
+	for (uint32_t i = 0; (i < pHeader->materialCount) && bValid; i++)
+	{
+		bValid = (pMaterials[i].tag < pHeader->stringSize);
+	}
+	if (bValid == false)
+	{
+		Close();
+		return(false);
+	}
+
+	m_pHeader = pHeader;
+	m_pTextures = pTextures;
+	m_pMaterials = pMaterials;
+	m_pLights = (const LIGHT_RECORD*)(pData + pHeader->lightOffset);
+	m_pDraws = pDraws;
+	m_pInstances = (const INSTANCE_RECORD*)(pData + pHeader->instanceOffset);
+	m_pStrings = (const char*)(pData + pHeader->stringOffset);
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsCurrent()
+ *
+ *  This method is used for comparing the source stamp kept
+ *  in the mapped cache with the source file on disk.
+ ***********************************************************/
+bool SceneFile::IsCurrent(const char* sourcePath) const
+{
+	uint64_t size = 0;
+	uint64_t writeTime = 0;
+	if (MappedFile::GetFileStamp(sourcePath, size, writeTime) == false)
+	{
+		return(true);
+	}
+
+	return((m_pHeader->sourceSize == size) && (m_pHeader->sourceWriteTime == writeTime));
+}
+
+/***********************************************************
+ *  FillRecordSizes()
+ *
+ *  This method is used for listing the size of each record
+ *  type, as stored in the cache header.
+ ***********************************************************/
+void SceneFile::FillRecordSizes(uint32_t recordSizes[5])
+{
+	recordSizes[0] = (uint32_t)sizeof(TEXTURE_RECORD);
+	recordSizes[1] = (uint32_t)sizeof(MATERIAL_RECORD);
+	recordSizes[2] = (uint32_t)sizeof(LIGHT_RECORD);
+	recordSizes[3] = (uint32_t)sizeof(DRAW_RECORD);
+	recordSizes[4] = (uint32_t)sizeof(INSTANCE_RECORD);
+}
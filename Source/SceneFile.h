@@ -0,0 +1,201 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.h
+// ============
+// describe the scene in a JSON file that is compiled into a mapped binary cache
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <string>
+
+/***********************************************************
+ *  SceneFile
+ *
+ *  This class gives access to the textures, materials,
+ *  lights and objects of a scene.  Scenes are written as
+ *  JSON (see scenes/kitchen.json), where objects can be
+ *  placed in groups with "children", and compiled once into a
+ *  binary cache next to the source.  The cache is a header
+ *  followed by flat arrays of fixed-size records and a table
+ *  of strings, so it is used straight from a memory mapping
+ *  with no parsing.  The cache is compiled again whenever the
+ *  JSON file's size or write time no longer match, and used
+ *  on its own when only the cache is shipped.
+ ***********************************************************/
+class SceneFile
+{
+public:
+	// constructor
+	SceneFile();
+
+	// bumped whenever a record changes
+	static const uint32_t CACHE_VERSION = 3;
+	// parent of an object that is not in a group
+	static const uint32_t NO_PARENT = 0xFFFFFFFFu;
+
+	enum LightType
+	{
+		LIGHT_POINT,
+		LIGHT_DIRECTIONAL,
+		LIGHT_SPOT
+	};
+
+	enum DrawKind
+	{
+		// one object with a flat color
+		DRAW_MESH,
+		// one object with a single texture
+		DRAW_TEXTURED_MESH,
+		// one box with a texture on each face
+		DRAW_FACE_BOX,
+		// a group of instances with one texture or none
+		DRAW_INSTANCED,
+		// a group of instances with a texture per part
+		DRAW_INSTANCED_PER_PART,
+		// a transform the objects that follow it are placed in
+		DRAW_GROUP
+	};
+
+	enum DrawFlags
+	{
+		DRAW_FLAG_TOP = 1,
+		DRAW_FLAG_BOTTOM = 2,
+		DRAW_FLAG_SIDES = 4,
+		// copied onto the stress grid with the other props - only
+		// used on objects that are not in a group
+		DRAW_FLAG_REPLICATE = 8
+	};
+
+	// strings are offsets into the string table - 0 is ""
+	struct TEXTURE_RECORD
+	{
+		uint32_t tag;
+		uint32_t file;
+		// TextureQuality::Tier - -1 to use the global tier
+		int32_t quality;
+	};
+
+	struct MATERIAL_RECORD
+	{
+		float diffuseColor[3];
+		float specularColor[3];
+		float shininess;
+		uint32_t tag;
+		uint32_t bTransparent;
+	};
+
+	struct LIGHT_RECORD
+	{
+		uint32_t type;
+		float position[3];
+		float direction[3];
+		float ambient[3];
+		float diffuse[3];
+		float specular[3];
+		// point light falloff distance - 0 for none
+		float range;
+		// spot light cone, in degrees
+		float cutOff;
+		float outerCutOff;
+	};
+
+	struct DRAW_RECORD
+	{
+		uint32_t kind;
+		// group the object is placed in, or NO_PARENT - objects are
+		// stored depth first, so a group comes before its objects
+		uint32_t parent;
+		// SceneManager::MeshType
+		uint32_t mesh;
+		uint32_t flags;
+		uint32_t material;
+		// DRAW_TEXTURED_MESH and DRAW_INSTANCED use the first,
+		// DRAW_INSTANCED_PER_PART the first three as bottom,
+		// sides, top, and DRAW_FACE_BOX all six in box face order
+		uint32_t textures[6];
+		float scale[3];
+		float position[3];
+		float rotation[3];
+		float color[4];
+		float uvTile[2];
+		// the instances of the instanced kinds
+		uint32_t firstInstance;
+		uint32_t instanceCount;
+	};
+
+	struct INSTANCE_RECORD
+	{
+		float scale[3];
+		float position[3];
+		float rotation[3];
+		float color[4];
+	};
+
+	// map the cache for the scene source, compiling it first when
+	// it is missing or out of date
+	bool Load(const char* sourcePath, const char* cachePath);
+	bool IsLoaded() const { return(NULL != m_pHeader); }
+	void Close();
+
+	// compile a JSON scene into a binary cache
+	static bool Compile(const char* sourcePath, const char* cachePath);
+
+	uint32_t TextureCount() const { return(m_pHeader->textureCount); }
+	uint32_t MaterialCount() const { return(m_pHeader->materialCount); }
+	uint32_t LightCount() const { return(m_pHeader->lightCount); }
+	uint32_t DrawCount() const { return(m_pHeader->drawCount); }
+	const TEXTURE_RECORD& Texture(uint32_t index) const { return(m_pTextures[index]); }
+	const MATERIAL_RECORD& Material(uint32_t index) const { return(m_pMaterials[index]); }
+	const LIGHT_RECORD& Light(uint32_t index) const { return(m_pLights[index]); }
+	const DRAW_RECORD& Draw(uint32_t index) const { return(m_pDraws[index]); }
+	const INSTANCE_RECORD& Instance(uint32_t index) const { return(m_pInstances[index]); }
+	const char* String(uint32_t offset) const { return(m_pStrings + offset); }
+
+private:
+	// where every array is in the cache, in bytes from the start
+	struct CACHE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		// the source the cache was compiled from
+		uint64_t sourceSize;
+		uint64_t sourceWriteTime;
+		// sizes of the records, so a cache written by a build
+		// with a different layout is never used
+		uint32_t recordSizes[5];
+		uint32_t textureCount;
+		uint32_t textureOffset;
+		uint32_t materialCount;
+		uint32_t materialOffset;
+		uint32_t lightCount;
+		uint32_t lightOffset;
+		uint32_t drawCount;
+		uint32_t drawOffset;
+		uint32_t instanceCount;
+		uint32_t instanceOffset;
+		uint32_t stringSize;
+		uint32_t stringOffset;
+	};
+
+	MappedFile m_file;
+	const CACHE_HEADER* m_pHeader;
+	const TEXTURE_RECORD* m_pTextures;
+	const MATERIAL_RECORD* m_pMaterials;
+	const LIGHT_RECORD* m_pLights;
+	const DRAW_RECORD* m_pDraws;
+	const INSTANCE_RECORD* m_pInstances;
+	const char* m_pStrings;
+
+	// map the cache and check its header and array bounds
+	bool MapCache(const char* cachePath);
+	// whether the mapped cache was compiled from the source as
+	// it is now - true when there is no source to compare with
+	bool IsCurrent(const char* sourcePath) const;
+	static void FillRecordSizes(uint32_t recordSizes[5]);
+};
@@ -9,21 +9,66 @@
 
 #include "SceneManager.h"
 
-#ifndef STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-#endif
-
 #include <glm/gtx/transform.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// the texture arrays, the shadow maps and the light clusters each
+// have their own texture units, all within the 16 that OpenGL 3.3
+// guarantees to the fragment shader
+static_assert(1 + TextureLibrary::MAX_ARRAYS <= ShadowMaps::POINT_SHADOW_TEXTURE_UNIT, "Texture arrays overlap the shadow map units");
+static_assert((int)ShadowMaps::DIRECTIONAL_SHADOW_TEXTURE_UNIT < (int)ClusteredLights::LIGHT_TEXTURE_UNIT, "Shadow maps overlap the light cluster units");
+static_assert(ClusteredLights::INDEX_TEXTURE_UNIT < 16, "Light cluster units are above the guaranteed texture units");
+
 // declaration of global variables
 namespace
 {
 	const char* g_ModelName = "model";
+	const char* g_NormalMatrixName = "normalMatrix";
 	const char* g_ColorValueName = "objectColor";
 	const char* g_TextureValueName = "objectTexture";
+	const char* g_TextureLayerName = "textureLayer";
 	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_UseInstancingName = "bUseInstancing";
+	const char* g_UVScaleName = "UVscale";
+	const char* g_MaterialIndexName = "materialIndex";
+	const char* g_ClusterLightsName = "clusterLights";
+	const char* g_ClusterGridName = "clusterGrid";
+	const char* g_ClusterIndicesName = "clusterIndices";
+	const char* g_ClusterTileScaleName = "clusterTileScale";
+	const char* g_UseFaceLayersName = "bUseFaceLayers";
+	const char* g_FaceLayersName = "faceLayers";
+	const char* g_PointShadowMapName = "pointShadowMap";
+	const char* g_PointShadowPositionName = "pointShadowPosition";
+	const char* g_PointShadowPlanesName = "pointShadowPlanes";
+	const char* g_DirectionalShadowMapName = "directionalShadowMap";
+	const char* g_DirectionalShadowMatrixName = "directionalShadowMatrix";
+	const char* g_ShadowFilterQualityName = "shadowFilterQuality";
+
+	// distances past this all get the same depth key - the far plane
+	const float g_DepthSortRange = 100.0f;
+	// the camera can move this far before the queue is sorted again
+	const float g_DepthSortTolerance = 0.25f;
+	// distance between the prop copies on the stress grid, wide
+	// enough that neighbouring copies never overlap
+	const float g_StressSpacingX = 32.0f;
+	const float g_StressSpacingZ = 24.0f;
+	// scene read when none is given on the command line
+	const char* g_DefaultScenePath = "scenes/kitchen.json";
+	// spot light falloff - the scene file only gives the cone
+	const float g_SpotConstant = 1.0f;
+	const float g_SpotLinear = 0.09f;
+	const float g_SpotQuadratic = 0.032f;
+	// items handled by one job of the frame update loops - most
+	// of the items are only checked, so the jobs are kept large
+	const int g_RefreshGrainSize = 256;
+	const int g_RecordGrainSize = 64;
+	// material of the objects whose tag is not defined - the
+	// first one defined, on the instanced and single draws alike
+	const int g_DefaultMaterialIndex = 0;
 }
 
 /***********************************************************
@@ -31,10 +76,65 @@ namespace
  *
  *  The constructor for the class
  ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager)
+SceneManager::SceneManager(ShaderManager *pShaderManager, UniformBlocks* pUniformBlocks, ShaderPermutations* pShaderPermutations, Profiler* pProfiler, ResourceManager* pResources, JobSystem* pJobSystem)
 {
 	m_pShaderManager = pShaderManager;
+	m_pUniformBlocks = pUniformBlocks;
+	m_pShaderPermutations = pShaderPermutations;
+	m_pProfiler = pProfiler;
+	m_pResources = pResources;
+	m_pJobSystem = pJobSystem;
+	m_baseProgram = 0;
+	m_lightingPermutation = 0;
+	m_lights = UniformBlocks::LIGHT_BLOCK();
+	m_bLightsDirty = false;
+	m_shaderGeneration = 0;
 	m_basicMeshes = new ShapeMeshes();
+	m_meshLibrary = new MeshLibrary(pResources);
+	m_textureLibrary = new TextureLibrary(pResources);
+	m_clusteredLights = new ClusteredLights(pResources);
+	m_shadowMaps = new ShadowMaps(pResources);
+	m_bRenderQueueDirty = true;
+	m_viewportHeight = 0;
+	m_stressCopies = 1;
+	m_scenePath = g_DefaultScenePath;
+	m_bDepthPrePass = true;
+	m_bOverdrawView = false;
+	m_sortViewPosition = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_renderStats.drawCalls = 0;
+	m_renderStats.stateChanges = 0;
+	m_renderStats.skippedChanges = 0;
+	m_renderStats.visibleObjects = 0;
+	m_renderStats.culledObjects = 0;
+	m_renderStats.textureBinds = 0;
+	m_renderStats.triangles = 0;
+	m_renderStats.shadowViews = 0;
+	ResetRenderState();
+
+	// register the uniforms used while drawing - the locations
+	// are looked up once the shader program is known
+	m_uniforms.model = m_uniformCache.Register(g_ModelName);
+	m_uniforms.normalMatrix = m_uniformCache.Register(g_NormalMatrixName);
+	m_uniforms.objectColor = m_uniformCache.Register(g_ColorValueName);
+	m_uniforms.objectTexture = m_uniformCache.Register(g_TextureValueName);
+	m_uniforms.textureLayer = m_uniformCache.Register(g_TextureLayerName);
+	m_uniforms.useTexture = m_uniformCache.Register(g_UseTextureName);
+	m_uniforms.useLighting = m_uniformCache.Register(g_UseLightingName);
+	m_uniforms.useInstancing = m_uniformCache.Register(g_UseInstancingName);
+	m_uniforms.uvScale = m_uniformCache.Register(g_UVScaleName);
+	m_uniforms.materialIndex = m_uniformCache.Register(g_MaterialIndexName);
+	m_uniforms.clusterLights = m_uniformCache.Register(g_ClusterLightsName);
+	m_uniforms.clusterGrid = m_uniformCache.Register(g_ClusterGridName);
+	m_uniforms.clusterIndices = m_uniformCache.Register(g_ClusterIndicesName);
+	m_uniforms.clusterTileScale = m_uniformCache.Register(g_ClusterTileScaleName);
+	m_uniforms.useFaceLayers = m_uniformCache.Register(g_UseFaceLayersName);
+	m_uniforms.faceLayers = m_uniformCache.Register(g_FaceLayersName);
+	m_uniforms.pointShadowMap = m_uniformCache.Register(g_PointShadowMapName);
+	m_uniforms.pointShadowPosition = m_uniformCache.Register(g_PointShadowPositionName);
+	m_uniforms.pointShadowPlanes = m_uniformCache.Register(g_PointShadowPlanesName);
+	m_uniforms.directionalShadowMap = m_uniformCache.Register(g_DirectionalShadowMapName);
+	m_uniforms.directionalShadowMatrix = m_uniformCache.Register(g_DirectionalShadowMatrixName);
+	m_uniforms.shadowFilterQuality = m_uniformCache.Register(g_ShadowFilterQualityName);
 }
 
 /***********************************************************
@@ -45,164 +145,111 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 SceneManager::~SceneManager()
 {
 	m_pShaderManager = NULL;
+	m_pUniformBlocks = NULL;
+	m_pShaderPermutations = NULL;
+	m_pResources = NULL;
 	delete m_basicMeshes;
 	m_basicMeshes = NULL;
+	delete m_meshLibrary;
+	m_meshLibrary = NULL;
+	delete m_textureLibrary;
+	m_textureLibrary = NULL;
+	delete m_clusteredLights;
+	m_clusteredLights = NULL;
+	delete m_shadowMaps;
+	m_shadowMaps = NULL;
 }
 
 /***********************************************************
- *  CreateGLTexture()
+ *  ResolveUniforms()
  *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
- ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
-{
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
-
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
-
-		return true;
+ *  This method is used for looking up the locations of all
+ *  the registered uniforms in the base shader program.  It is
+ *  called after the shaders have been loaded or reloaded, so
+ *  no names are looked up while drawing.
+ ***********************************************************/
+void SceneManager::ResolveUniforms()
+{
+	if (NULL != m_pShaderPermutations)
+	{
+		int basePermutation = m_pShaderPermutations->Request(ShaderPermutations::BASE_KEY);
+		m_baseProgram = m_pShaderPermutations->Program(basePermutation);
 	}
+	else
+	{
+		GLint programID = 0;
+		glGetIntegerv(GL_CURRENT_PROGRAM, &programID);
+		m_baseProgram = (GLuint)programID;
+	}
+	m_uniformCache.Resolve(m_baseProgram);
+}
 
-	std::cout << "Could not load image:" << filename << std::endl;
-
-	// Error loading the image
-	return false;
+/***********************************************************
+ *  CreateGLTexture()
+ *
+ *  This method is used for loading textures from image files
+ *  into the texture library.  The image is decoded on a
+ *  worker thread and uploaded over the next few frames -
+ *  draws use a placeholder until then.  Its layer is reserved
+ *  next to the other images of the same size and quality
+ *  tier when BindGLTextures() is called.
+ ***********************************************************/
+bool SceneManager::CreateGLTexture(const char* filename, std::string tag, TextureQuality::Tier tier)
+{
+	return(m_textureLibrary->LoadTexture(filename, tag, tier));
 }
 
 /***********************************************************
  *  BindGLTextures()
  *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
+ *  This method is used for reserving texture array layers for
+ *  the loaded textures and binding each array to its own
+ *  texture unit.  The arrays stay bound, so drawing only
+ *  selects a unit and a layer.
  ***********************************************************/
 void SceneManager::BindGLTextures()
 {
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
-	}
+	m_textureLibrary->Build();
+	m_textureLibrary->Bind();
 }
 
 /***********************************************************
  *  DestroyGLTextures()
  *
  *  This method is used for freeing the memory in all the
- *  used texture memory slots.
+ *  used texture arrays.
  ***********************************************************/
 void SceneManager::DestroyGLTextures()
 {
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		glGenTextures(1, &m_textureIDs[i].ID);
-	}
+	m_textureLibrary->Destroy();
 }
 
 /***********************************************************
  *  FindTextureID()
  *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for getting an ID for the texture array
+ *  holding the loaded texture associated with the passed in tag.
  ***********************************************************/
 int SceneManager::FindTextureID(std::string tag)
 {
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
+	int textureIndex = m_textureLibrary->Find(tag);
+	if (textureIndex < 0)
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
+		return(-1);
 	}
 
-	return(textureID);
+	return((int)m_textureLibrary->TextureArrayID(textureIndex));
 }
 
 /***********************************************************
- *  FindTextureSlot()
+ *  FindTextureIndex()
  *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for getting the texture library index
+ *  of the loaded texture associated with the passed in tag.
  ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
+int SceneManager::FindTextureIndex(std::string tag)
 {
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureSlot = index;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureSlot);
+	return(m_textureLibrary->Find(tag));
 }
 
 /***********************************************************
@@ -211,31 +258,113 @@ int SceneManager::FindTextureSlot(std::string tag)
  *  This method is used for getting a material from the previously
  *  defined materials list that is associated with the passed in tag.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+bool SceneManager::FindMaterial(const std::string& tag, OBJECT_MATERIAL& material)
 {
-	if (m_objectMaterials.size() == 0)
+	int index = FindMaterialIndex(tag);
+	if (index < 0)
 	{
 		return(false);
 	}
 
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
+	material.diffuseColor = m_objectMaterials[index].diffuseColor;
+	material.specularColor = m_objectMaterials[index].specularColor;
+	material.shininess = m_objectMaterials[index].shininess;
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index of a previously
+ *  defined material associated with the passed in tag, or -1
+ *  if no material with that tag has been defined.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(const std::string& tag)
+{
+	for (int index = 0; index < (int)m_objectMaterials.size(); index++)
 	{
 		if (m_objectMaterials[index].tag.compare(tag) == 0)
 		{
-			bFound = true;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
+			return(index);
 		}
 	}
 
-	return(true);
+	return(-1);
+}
+
+/***********************************************************
+ *  ResolveMaterialIndex()
+ *
+ *  This method is used for getting the index of the material
+ *  an object is drawn with - the one with the passed in tag,
+ *  or the default material if that tag is not defined.
+ ***********************************************************/
+int SceneManager::ResolveMaterialIndex(const std::string& tag)
+{
+	int index = FindMaterialIndex(tag);
+	if (index < 0)
+	{
+		return(g_DefaultMaterialIndex);
+	}
+
+	return(index);
+}
+
+/***********************************************************
+ *  BuildModelMatrix()
+ *
+ *  This method is used for building the model matrix from
+ *  the passed in transformation values.
+ ***********************************************************/
+glm::mat4 SceneManager::BuildModelMatrix(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ,
+	glm::vec3 offset)
+{
+	// the three rotations become one quaternion, and the matrix is
+	// written out directly instead of multiplying five matrices -
+	// the result is still translation * rotZ * rotY * rotX * scale
+	glm::quat rotation = TransformHierarchy::EulerRotation(
+		glm::vec3(XrotationDegrees, YrotationDegrees, ZrotationDegrees));
+
+	return(TransformHierarchy::ComposeMatrix(scaleXYZ, rotation, positionXYZ + offset));
+}
+
+/***********************************************************
+ *  BuildNormalMatrix()
+ *
+ *  This method is used for building the matrix that takes
+ *  vertex normals into world space.  When the model matrix
+ *  only rotates and scales evenly on every axis, its upper
+ *  3x3 already points normals the right way (the shader
+ *  normalizes them), so the inverse is skipped.
+ ***********************************************************/
+glm::mat3 SceneManager::BuildNormalMatrix(const glm::mat4& model)
+{
+	glm::mat3 linear = glm::mat3(model);
+
+	float lengthX = glm::dot(linear[0], linear[0]);
+	float lengthY = glm::dot(linear[1], linear[1]);
+	float lengthZ = glm::dot(linear[2], linear[2]);
+	float tolerance = 1.0e-4f * glm::max(lengthX, glm::max(lengthY, lengthZ));
+
+	bool bUniformScale =
+		(glm::abs(lengthX - lengthY) <= tolerance) &&
+		(glm::abs(lengthX - lengthZ) <= tolerance) &&
+		(glm::abs(glm::dot(linear[0], linear[1])) <= tolerance) &&
+		(glm::abs(glm::dot(linear[0], linear[2])) <= tolerance) &&
+		(glm::abs(glm::dot(linear[1], linear[2])) <= tolerance);
+
+	if (bUniformScale)
+	{
+		return(linear);
+	}
+
+	return(glm::transpose(glm::inverse(linear)));
 }
 
 /***********************************************************
@@ -252,28 +381,18 @@ void SceneManager::SetTransformations(
 	glm::vec3 positionXYZ,
 	glm::vec3 offset)
 {
-	// variables for this method
-	glm::mat4 model;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ + offset);
-
-	model = translation * rotationZ * rotationY * rotationX * scale;
+	glm::mat4 model = BuildModelMatrix(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ,
+		offset);
 
 	if (NULL != m_pShaderManager)
 	{
-		m_pShaderManager->setMat4Value(g_ModelName, model);
+		m_uniformCache.SetMat4(m_uniforms.model, model);
+		m_uniformCache.SetMat3(m_uniforms.normalMatrix, BuildNormalMatrix(model));
 	}
 }
 
@@ -299,8 +418,8 @@ void SceneManager::SetShaderColor(
 
 	if (NULL != m_pShaderManager)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+		m_uniformCache.SetBool(m_uniforms.useTexture, false);
+		m_uniformCache.SetVec4(m_uniforms.objectColor, currentColor);
 	}
 }
 
@@ -315,11 +434,11 @@ void SceneManager::SetShaderTexture(
 {
 	if (NULL != m_pShaderManager)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
+		m_uniformCache.SetBool(m_uniforms.useTexture, true);
 
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+		int textureIndex = FindTextureIndex(textureTag);
+		m_uniformCache.SetInt(m_uniforms.objectTexture, m_textureLibrary->TextureUnit(textureIndex));
+		m_uniformCache.SetFloat(m_uniforms.textureLayer, (float)m_textureLibrary->TextureLayer(textureIndex));
 	}
 }
 
@@ -333,32 +452,71 @@ void SceneManager::SetTextureUVScale(float u, float v)
 {
 	if (NULL != m_pShaderManager)
 	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
+		m_uniformCache.SetVec2(m_uniforms.uvScale, glm::vec2(u, v));
 	}
 }
 
 /***********************************************************
  *  SetShaderMaterial()
  *
- *  This method is used for passing the material values
- *  into the shader.
+ *  This method is used for selecting the material with the
+ *  passed in tag from the material table in the shader.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	const std::string& materialTag)
+{
+	SetShaderMaterial(FindMaterialIndex(materialTag));
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for selecting an already resolved
+ *  material index.  The material values themselves live in
+ *  the material block, uploaded once by UploadMaterials().
  ***********************************************************/
 void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+	int materialIndex)
 {
-	if (m_objectMaterials.size() > 0)
+	if ((NULL != m_pShaderManager) &&
+		(materialIndex >= 0) &&
+		(materialIndex < (int)m_objectMaterials.size()))
 	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
+		m_uniformCache.SetInt(m_uniforms.materialIndex, materialIndex);
+	}
+}
 
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
+/***********************************************************
+ *  UploadMaterials()
+ *
+ *  This method is used for copying every defined material
+ *  into the material block, so draws only have to pass the
+ *  index of the material they use.
+ ***********************************************************/
+void SceneManager::UploadMaterials()
+{
+	if (NULL == m_pUniformBlocks)
+	{
+		return;
+	}
+
+	if (m_objectMaterials.size() > TOTAL_MATERIALS)
+	{
+		std::cout << "Only the first " << TOTAL_MATERIALS << " of "
+			<< m_objectMaterials.size() << " materials fit in the material block" << std::endl;
 	}
+
+	UniformBlocks::MATERIAL_BLOCK materials = {};
+	int count = 0;
+	for (size_t i = 0; (i < m_objectMaterials.size()) && (i < TOTAL_MATERIALS); i++)
+	{
+		materials.materials[i].diffuseColor = m_objectMaterials[i].diffuseColor;
+		materials.materials[i].specularColor = m_objectMaterials[i].specularColor;
+		materials.materials[i].shininess = m_objectMaterials[i].shininess;
+		count++;
+	}
+
+	m_pUniformBlocks->UpdateMaterials(materials, count);
 }
 
 /**************************************************************/
@@ -378,25 +536,53 @@ void SceneManager::SetShaderMaterial(
  ***********************************************************/
 void SceneManager::PrepareScene()
 {
+	// look up the uniform locations once for the loaded shaders
+	ResolveUniforms();
+
+	// the scene file replaces the built-in scene below when it loads
+	bool bSceneFile = LoadSceneFile();
 
 	// define the materials for objects in the scene
-	DefineObjectMaterials();
+	if (bSceneFile)
+	{
+		LoadSceneMaterials();
+	}
+	else
+	{
+		DefineObjectMaterials();
+	}
 	// add and define the light sources for the scene
-	SetupSceneLights();
-
-	// All textures
-	CreateGLTexture("textures/saltshaker.png", "shaker");
-	CreateGLTexture("textures/cap_sides.png", "cap_sides");
-	CreateGLTexture("textures/cap_top.png", "cap_top");
-	CreateGLTexture("textures/cap_torus.png", "cap_torus");
-	CreateGLTexture("textures/butter_face.png", "butter_front");
-	CreateGLTexture("textures/butter_side1.png", "butter_left");
-	CreateGLTexture("textures/butter_side2.png", "butter_right");
-	CreateGLTexture("textures/butter_side3.png", "butter_back");
-	CreateGLTexture("textures/butter_top.png", "butter_top");
-	CreateGLTexture("textures/butter_bottom.png", "butter_bottom");
-	CreateGLTexture("textures/Tile.png", "tile");
-	CreateGLTexture("textures/wood_top.png", "wood_tex");
+	m_clusteredLights->Create();
+	m_shadowMaps->Create();
+	if (bSceneFile)
+	{
+		LoadSceneLights();
+	}
+	else
+	{
+		SetupSceneLights();
+	}
+
+	if (bSceneFile)
+	{
+		LoadSceneTextures();
+	}
+	else
+	{
+		// All textures
+		CreateGLTexture("textures/saltshaker.png", "shaker");
+		CreateGLTexture("textures/cap_sides.png", "cap_sides");
+		CreateGLTexture("textures/cap_top.png", "cap_top");
+		CreateGLTexture("textures/cap_torus.png", "cap_torus");
+		CreateGLTexture("textures/butter_face.png", "butter_front");
+		CreateGLTexture("textures/butter_side1.png", "butter_left");
+		CreateGLTexture("textures/butter_side2.png", "butter_right");
+		CreateGLTexture("textures/butter_side3.png", "butter_back");
+		CreateGLTexture("textures/butter_top.png", "butter_top");
+		CreateGLTexture("textures/butter_bottom.png", "butter_bottom");
+		CreateGLTexture("textures/Tile.png", "tile");
+		CreateGLTexture("textures/wood_top.png", "wood_tex");
+	}
 
 	BindGLTextures();
 
@@ -408,259 +594,2326 @@ void SceneManager::PrepareScene()
 	m_basicMeshes->LoadTorusMesh();
 	m_basicMeshes->LoadConeMesh();
 	m_basicMeshes->LoadSphereMesh();
+	// the shapes the built-in scene never uses are only loaded
+	// when the scene file asks for them
+	for (uint32_t i = 0; bSceneFile && (i < m_sceneFile.DrawCount()); i++)
+	{
+		switch ((MeshType)m_sceneFile.Draw(i).mesh)
+		{
+		case MeshType::PRISM:    m_basicMeshes->LoadPrismMesh(); break;
+		case MeshType::PYRAMID3: m_basicMeshes->LoadPyramid3Mesh(); break;
+		case MeshType::PYRAMID4: m_basicMeshes->LoadPyramid4Mesh(); break;
+		default: break;
+		}
+	}
+
+	// indexed shapes that are drawn with instancing
+	m_meshLibrary->LoadMesh(MeshLibrary::ShapeType::CYLINDER);
+	m_meshLibrary->LoadMesh(MeshLibrary::ShapeType::TAPERED_CYLINDER);
+	m_meshLibrary->LoadMesh(MeshLibrary::ShapeType::TORUS);
+	// the round shapes are also drawn from the library for single
+	// objects, so they can switch to a coarser level of detail
+	m_meshLibrary->LoadMesh(MeshLibrary::ShapeType::SPHERE);
+	// boxes and planes share the atlas too, so most of the scene can
+	// go out in a single multi-draw
+	m_meshLibrary->LoadMesh(MeshLibrary::ShapeType::BOX);
+	m_meshLibrary->LoadMesh(MeshLibrary::ShapeType::PLANE);
+
+	// record every object in the scene once - the textures and
+	// materials must already be loaded so they can be resolved
+	BuildDrawList();
+	FitShadowBounds();
 }
 
 /***********************************************************
  *  RenderScene()
  *
  *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
+ *  submitting the retained draw list that was built in
+ *  PrepareScene().  Only objects marked dirty get their
+ *  model matrix rebuilt.
  ***********************************************************/
 void SceneManager::RenderScene()
 {
-	// =========================================================
-	// PLATFORM (plane)
-	// =========================================================
-	DrawTexturedMesh(MeshType::BOX,
-		glm::vec3(60.0f, 1.5f, 15.0f),
-		glm::vec3(0.0f, 0.0f, 0.0f),
-		glm::vec3(0.0f, 0.0f, 0.0f), 
-		"wood_tex", 1.0f, 1.0f, "wood", false, true, false);
+	// upload any textures that finished decoding since the last frame
+	m_textureLibrary->Update();
 
+	// pass on the point lights edited since the last frame
+	if (m_bLightsDirty)
+	{
+		ApplySceneLights();
+	}
 
-	// =========================================================
-	// SALT SHAKERS (left and right)
-	// 1) tapered cylinder = glass body
-	// 2) cylinder         = cap
-	// 3) torus            = base ring
-	// =========================================================
+	// the old programs are gone after a shader reload, so their
+	// uniform locations are looked up again
+	if ((NULL != m_pShaderPermutations) && (m_shaderGeneration != m_pShaderPermutations->Generation()))
+	{
+		m_shaderGeneration = m_pShaderPermutations->Generation();
+		m_uniformCache.Forget();
+		ResolveUniforms();
+		// variants that failed before may compile now, so every
+		// draw picks its permutation again
+		m_bRenderQueueDirty = true;
+	}
 
-	// --- LEFT SALTSHAKER ---
-	// --- Glass body ---
-	DrawTexturedMesh(MeshType::TAPERED_CYLINDER,
-		glm::vec3(2.0f, 4.5f, 2.0f),
-		glm::vec3(-10.0f, 0.75f, 0.0f),
-		glm::vec3(0.0f, 0.0f, 0.0f),
-		"shaker", 1.0f, 1.0f, "glass", false, false, true);
-	// --- Cap ---
-	DrawTexturedMesh(MeshType::CYLINDER,
-		glm::vec3(1.1f, 0.6f, 1.1f),
-		glm::vec3(-10.0f, 4.75f, 0.0f),
-		glm::vec3(0.0f, 0.0f, 0.0f),
-		"cap_sides",1.0f,1.0f, "metal", false, false, true);
-	DrawTexturedMesh(MeshType::CYLINDER,
-		glm::vec3(1.1f, 0.6f, 1.1f),
-		glm::vec3(-10.0f, 4.75f, 0.0f),
-		glm::vec3(0.0f, 0.0f, 0.0f),
-		"cap_top", 1.0f, 1.0f, "metal", true, false, false);
-	// --- Base ring ---
-	DrawMesh(MeshType::TORUS,
-		glm::vec3(1.05f, 1.05f, 1.05f),
-		glm::vec3(-10.0f, 4.7f, 0.0f),
-		glm::vec3(90.0f, 0.0f, 0.0f),
-		glm::vec4(0.447f, 0.447f, 0.447f, 1.0f), "metal");
+	// sort the point lights into the clusters for this camera
+	if (NULL != m_pUniformBlocks)
+	{
+		GLint viewport[4] = { 0, 0, 0, 0 };
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		m_viewportHeight = viewport[3];
+		const UniformBlocks::FRAME_BLOCK& frame = m_pUniformBlocks->Frame();
+		m_clusteredLights->Update(frame.view, frame.projection, viewport[2], viewport[3]);
+
+		// the depth keys go stale once the camera has moved
+		if (glm::length(frame.viewPosition - m_sortViewPosition) > g_DepthSortTolerance)
+		{
+			m_sortViewPosition = frame.viewPosition;
+			m_bRenderQueueDirty = true;
+		}
 
-	// --- RIGHT SALTSHAKER ---
-	// --- Glass body ---
-	DrawTexturedMesh(MeshType::TAPERED_CYLINDER,
-		glm::vec3(2.0f, 4.5f, 2.0f),
-		glm::vec3(10.0f, 0.75f, 0.0f),
-		glm::vec3(0.0f, 0.0f, 0.0f),
-		"shaker", 1.0f, 1.0f, "glass", false, false, true);
-	// --- Cap ---
-	DrawTexturedMesh(MeshType::CYLINDER,
-		glm::vec3(1.1f, 0.6f, 1.1f),
-		glm::vec3(10.0f, 4.75f, 0.0f),
-		glm::vec3(0.0f, 0.0f, 0.0f),
-		"cap_sides", 1.0f, 1.0f, "metal", false, false, true);
-	DrawTexturedMesh(MeshType::CYLINDER,
-		glm::vec3(1.1f, 0.6f, 1.1f),
-		glm::vec3(10.0f, 4.75f, 0.0f),
-		glm::vec3(0.0f, 0.0f, 0.0f),
-		"cap_top", 1.0f, 1.0f, "metal", true, false, false);
-	// --- Base ring ---
-	DrawMesh(MeshType::TORUS,
-		glm::vec3(1.05f, 1.05f, 1.05f),
-		glm::vec3(10.0f, 4.7f, 0.0f),
-		glm::vec3(90.0f, 0.0f, 0.0f),
-		glm::vec4(0.447f, 0.447f, 0.447f, 1.0f), "metal");
+		// moved objects get their matrices and bounds rebuilt before
+		// anything is tested against the frustum - every draw only
+		// touches its own matrices and sphere, so the loop is split
+		// over the job system
+		UpdateTransforms();
+		RunParallel((int)m_drawList.size(), g_RefreshGrainSize,
+			[this](int begin, int end, int)
+			{
+				for (int i = begin; i < end; i++)
+				{
+					RefreshDrawItem(m_drawList[i]);
+				}
+			});
+		m_frustumCuller.Cull(frame.projection * frame.view, m_pJobSystem);
+
+		// casters that moved into a light's reach need its cached
+		// map drawn again, as well as those that moved out of it
+		for (int boundsIndex : m_movedBounds)
+		{
+			m_shadowMaps->InvalidateSphere(m_frustumCuller.Center(boundsIndex), m_frustumCuller.Radius(boundsIndex));
+		}
+	}
+	m_movedBounds.clear();
+	m_clusteredLights->Bind();
+	m_shadowMaps->Bind();
 
-	// =============================
-	// HANGING LAMP 
-	// 1) cylinder = Cord
-	// 2) cone     = Shade
-	// 3) sphere   = Bulb
-	// =============================
-	glm::vec3 lampBase = glm::vec3(0.0f, 18.5f, 0.0f);
-	float drop = 6.0f;    
-	glm::vec3 coneBase = lampBase + glm::vec3(0.0f, -(drop + 0.9f), 0.0f);
-	glm::vec4 cordCol = glm::vec4(0.55f, 0.55f, 0.55f, 1.0f);
-	glm::vec4 shadeCol = glm::vec4(0.65f, 0.65f, 0.65f, 1.0f);
-	glm::vec4 bulbCol = glm::vec4(1.00f, 0.95f, 0.75f, 1.0f);
+	// the queue only needs sorting again when commands are added
+	// or the camera moves
+	if (m_bRenderQueueDirty)
+	{
+		BuildRenderQueue();
+	}
+	// the commands depend on what is visible and on the levels of
+	// detail, so they are recorded again every frame
+	RecordCommands();
+
+	// nothing is known about the shader state at the start of a frame
+	ResetRenderState();
+	m_renderStats.drawCalls = 0;
+	m_renderStats.stateChanges = 0;
+	m_renderStats.skippedChanges = 0;
+	m_renderStats.visibleObjects = m_frustumCuller.VisibleCount();
+	m_renderStats.culledObjects = m_frustumCuller.CulledCount();
+	m_renderStats.textureBinds = 0;
+	m_renderStats.shadowViews = 0;
+	m_meshLibrary->ResetTriangleCount();
+
+	// the shadow maps are cached, so most frames skip this
+	RenderShadowMaps();
+
+	// with the depth laid down, only the nearest fragment of each
+	// pixel passes GL_EQUAL and runs the lighting
+	bool bDepthPrePass = false;
+	if (m_bDepthPrePass)
+	{
+		BeginGpuPass("Depth pre-pass");
+		bDepthPrePass = RenderDepthPrePass();
+		EndGpuPass();
+	}
+	BeginGpuPass("Opaque");
+	if (bDepthPrePass)
+	{
+		glDepthFunc(GL_EQUAL);
+		glDepthMask(GL_FALSE);
+	}
+	// opaque draws replace the pixel, so blending is only switched
+	// on to add up fragments for the overdraw view
+	if (m_bOverdrawView)
+	{
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+	}
 
-	// --- CORD ---
-	DrawMesh(
-		MeshType::CYLINDER,
-		glm::vec3(0.1f, drop, 0.1f),
-		lampBase,
-		glm::vec3(180.0f, 0.0f, 0.0f),
-		cordCol,
-		"metal"
-	);
-	// --- SHADE ---
-	DrawMesh(
-		MeshType::CONE,
-		glm::vec3(1.0f, 1.0f, 1.0f),
-		coneBase,
-		glm::vec3(0.0f, 0.0f, 0.0f),
-		shadeCol,
-		"plastic",
-		false, true, false
-	);
-	// --- BULB ---
-	DrawMesh(
-		MeshType::SPHERE,
-		glm::vec3(0.5f, 0.5f, 0.5f),
-		coneBase,
-		glm::vec3(0.0f, 0.0f, 0.0f),
-		bulbCol,
-		"plastic"
-	);
+	// runs of draws that only differ in their transform, color and
+	// material go out as one multi-draw
+	const std::vector<RenderQueue::ENTRY>& opaqueEntries = m_renderQueue.Entries();
+	size_t entry = 0;
+	while (entry < opaqueEntries.size())
+	{
+		size_t runEnd = MultiDrawRunEnd(opaqueEntries, entry);
+		if (runEnd > entry)
+		{
+			SubmitMultiDrawRun(opaqueEntries, entry, runEnd);
+			entry = runEnd;
+		}
+		else
+		{
+			DrawQueueEntry(opaqueEntries[entry]);
+			entry++;
+		}
+	}
+	EndGpuPass();
 
-	// =============================
-	// WALL (plane)
-	// =============================
-	DrawTexturedMesh(
-		MeshType::PLANE,
-		glm::vec3(30.0f, 1.0f, 18.0f),
-		glm::vec3(0.0f, 17.0f, -7.5f),
-		glm::vec3(90.0f, 0.0f, 0.0f),
-		"tile",
-		12.0f, 6.0f,
-		"tile",
-		true, true, true
-	);
+	// transparent draws test against the opaque depth but do not
+	// write it, and are blended farthest first
+	if (m_transparentOrder.empty() == false)
+	{
+		BeginGpuPass("Transparent");
+		glDepthFunc(GL_LESS);
+		glDepthMask(GL_FALSE);
+		if (m_bOverdrawView == false)
+		{
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		}
 
+		// the inside faces of each object go down before the
+		// outside ones, so a closed glass shape blends in order
+		glEnable(GL_CULL_FACE);
+		const std::vector<RenderQueue::ENTRY>& entries = m_transparentQueue.Entries();
+		for (int i = (int)m_transparentOrder.size() - 1; i >= 0; i--)
+		{
+			const RenderQueue::ENTRY& entry = entries[m_transparentOrder[i]];
+			glCullFace(GL_FRONT);
+			DrawQueueEntry(entry);
+			glCullFace(GL_BACK);
+			DrawQueueEntry(entry);
+		}
+		glDisable(GL_CULL_FACE);
+		EndGpuPass();
+	}
 
-	// =========================================================
-	// BUTTER CHARACTER
-	// 1) box              = main body
-	// 2) cylinder         = legs and arms
-	// =========================================================
+	glDisable(GL_BLEND);
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
 
-	glm::vec3 butterBase = glm::vec3(0.0f, 1.5f + 1.125f, 0.0f);
-	glm::vec3 butterBodSize = glm::vec3(2.0f, 2.25f, 1.5f);
-	glm::vec3 butterBodRot = glm::vec3(0.0f, 0.0f, 0.0f);
-	glm::vec4 butterBaseColor = glm::vec4(0.95f, 0.85f, 0.25f, 1.0f);
+	// leave the base program bound for code outside the queue
+	ApplyShaderState(-1);
 
-	// --- BODY --- defines all sides of the box to add each texture
-	DrawTexturedMesh(
-		MeshType::BOX_FRONT,
-		butterBodSize,
-		butterBase ,
-		butterBodRot,
-		"butter_front",
-		1.0f, 1.0f,
-		"plastic"
-	);
-	DrawTexturedMesh(
-		MeshType::BOX_LEFT,
-		butterBodSize,
-		butterBase,
-		butterBodRot,
-		"butter_left",
-		1.0f, 1.0f,
-		"plastic"
-	);
-	DrawTexturedMesh(
-		MeshType::BOX_RIGHT,
-		butterBodSize,
-		butterBase,
-		butterBodRot,
-		"butter_right",
-		1.0f, 1.0f,
-		"plastic"
-	);
-	DrawTexturedMesh(
-		MeshType::BOX_BACK,
-		butterBodSize,
-		butterBase,
-		butterBodRot,
-		"butter_back",
-		1.0f, 1.0f,
-		"plastic"
-	);
-	DrawTexturedMesh(
-		MeshType::BOX_BOTTOM,
-		butterBodSize,
-		butterBase,
-		butterBodRot,
-		"butter_bottom",
-		1.0f, 1.0f,
-		"plastic"
-	);
-	DrawTexturedMesh(
-		MeshType::BOX_TOP,
-		butterBodSize,
-		butterBase,
-		butterBodRot,
-		"butter_top",
-		1.0f, 1.0f,
-		"plastic"
-	);
+	m_renderStats.triangles = m_meshLibrary->TriangleCount();
+	if (NULL != m_pProfiler)
+	{
+		m_pProfiler->SetCounter("draw calls", m_renderStats.drawCalls);
+		m_pProfiler->SetCounter("uniform uploads", m_renderStats.stateChanges);
+		m_pProfiler->SetCounter("skipped state changes", m_renderStats.skippedChanges);
+		m_pProfiler->SetCounter("texture binds", m_renderStats.textureBinds);
+		m_pProfiler->SetCounter("triangles", m_renderStats.triangles);
+		m_pProfiler->SetCounter("shadow views", m_renderStats.shadowViews);
+		m_pProfiler->SetCounter("visible objects", m_renderStats.visibleObjects);
+		m_pProfiler->SetCounter("culled objects", m_renderStats.culledObjects);
+		// the keyboard toggles, shown in the overlay as 0 or 1
+		m_pProfiler->SetCounter("depth pre-pass", m_bDepthPrePass ? 1 : 0);
+		m_pProfiler->SetCounter("overdraw view", m_bOverdrawView ? 1 : 0);
+	}
+}
 
-	// --- LEGS ---
-	float bodyBottomY = butterBase.y - (butterBodSize.y * 0.5f);
-	glm::vec3 legSize = glm::vec3(0.25f, bodyBottomY, 0.25f);
-	// Leg offsets - spacing under the body
-	float legOffsetX = butterBodSize.x * 0.22f;
-	float legOffsetZ = butterBodSize.z * 0.18f;
+/***********************************************************
+ *  BuildRenderQueue()
+ *
+ *  This method is used for filling the render queues with
+ *  every retained command.  The opaque queue is sorted by
+ *  state, so that draws sharing a texture and material end
+ *  up together, and draws with the same state are ordered
+ *  front-to-back; the pre-pass order is by distance alone.
+ *  The transparent queue is drawn by distance only, farthest
+ *  first, since blending depends on the order.
+ ***********************************************************/
+void SceneManager::BuildRenderQueue()
+{
+	m_renderQueue.Clear();
+	m_transparentQueue.Clear();
 
-	// Left leg
-	DrawMesh(
-		MeshType::CYLINDER,
-		legSize,
-		glm::vec3(butterBase.x - legOffsetX, (legSize.y * 0.5f), butterBase.z + legOffsetZ),
-		glm::vec3(0.0f, 0.0f, 0.0f),
-		butterBaseColor,
-		"plastic"
-	);
-	// Right leg
-	DrawMesh(
-		MeshType::CYLINDER,
-		legSize,
-		glm::vec3(butterBase.x + legOffsetX, (legSize.y * 0.5f), butterBase.z + legOffsetZ),
-		glm::vec3(0.0f, 0.0f, 0.0f),
-		butterBaseColor,
-		"plastic"
-	);
+	for (int i = 0; i < (int)m_drawList.size(); i++)
+	{
+		const DRAW_ITEM& item = m_drawList[i];
+		// nothing is queued for draws whose face flags are all off
+		if (IsEmptyDraw(item.mesh, item.top, item.bottom, item.sides))
+		{
+			continue;
+		}
 
-	// --- ARMS ---
+		RenderQueue::ENTRY entry;
+		entry.type = RenderQueue::EntryType::DRAW_ITEM;
+		entry.index = i;
+		RenderQueue& queue = item.bTransparent ? m_transparentQueue : m_renderQueue;
+		queue.Add(
+			RenderQueue::MakeKey(SelectPermutation(item.textureIndex >= 0) + 1, m_textureLibrary->SortKey(item.textureIndex), item.materialIndex, (int)item.mesh,
+				RenderQueue::DepthKey(DrawDistance(entry), g_DepthSortRange)),
+			RenderQueue::EntryType::DRAW_ITEM,
+			i);
+	}
+
+	// instanced groups use their own vertex arrays, so they get
+	// their own range of mesh values
+	for (int i = 0; i < (int)m_instanceGroups.size(); i++)
+	{
+		INSTANCE_GROUP& group = m_instanceGroups[i];
+		if (group.partMask == 0)
+		{
+			continue;
+		}
+		if (group.bTransparent)
+		{
+			SortInstancesBackToFront(group);
+		}
+
+		RenderQueue::ENTRY entry;
+		entry.type = RenderQueue::EntryType::INSTANCE_GROUP;
+		entry.index = i;
+		RenderQueue& queue = group.bTransparent ? m_transparentQueue : m_renderQueue;
+		queue.Add(
+			RenderQueue::MakeKey(SelectPermutation(group.textureIndex >= 0) + 1, m_textureLibrary->SortKey(group.textureIndex), group.materialIndex, 0x80 | (int)group.mesh,
+				RenderQueue::DepthKey(DrawDistance(entry), g_DepthSortRange)),
+			RenderQueue::EntryType::INSTANCE_GROUP,
+			i);
+	}
+
+	// the keys are built on this thread, since picking a permutation
+	// can compile a program, but the two queues sort on their own
+	RunParallel(2, 1,
+		[this](int begin, int end, int)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				if (i == 0)
+				{
+					m_renderQueue.Sort();
+					m_renderQueue.SortFrontToBack(m_depthOrder);
+				}
+				else
+				{
+					m_transparentQueue.SortFrontToBack(m_transparentOrder);
+				}
+			}
+		});
+	m_bRenderQueueDirty = false;
+}
+
+/***********************************************************
+ *  RunParallel()
+ *
+ *  This method is used for running a loop over count items
+ *  on the job system when there is one, and on this thread
+ *  as a single range otherwise.
+ ***********************************************************/
+void SceneManager::RunParallel(int count, int grainSize, const JobSystem::RangeFunction& function)
+{
+	if (NULL != m_pJobSystem)
+	{
+		m_pJobSystem->ParallelFor(count, grainSize, function);
+	}
+	else if (count > 0)
+	{
+		function(0, count, 0);
+	}
+}
+
+/***********************************************************
+ *  RecordCommands()
+ *
+ *  This method is used for recording the multi-draw commands
+ *  and instance values of every visible opaque draw before
+ *  anything is submitted.  Each thread of the job system
+ *  records into its own command buffer, so nothing is
+ *  shared while recording; the GL thread then only copies
+ *  the recorded slices into the multi-draws in queue order.
+ ***********************************************************/
+void SceneManager::RecordCommands()
+{
+	int threadCount = (NULL != m_pJobSystem) ? m_pJobSystem->ThreadCount() : 1;
+	m_commandBuffers.resize(threadCount);
+	for (MeshLibrary::MULTI_DRAW_LIST& commands : m_commandBuffers)
+	{
+		commands.commands.clear();
+		commands.instances.clear();
+	}
+
+	const std::vector<RenderQueue::ENTRY>& entries = m_renderQueue.Entries();
+	m_recordedDraws.resize(entries.size());
+
+	RunParallel((int)entries.size(), g_RecordGrainSize,
+		[this, &entries](int begin, int end, int thread)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				RECORDED_DRAW& recorded = m_recordedDraws[i];
+				recorded.buffer = thread;
+				recorded.firstCommand = 0;
+				recorded.commandCount = 0;
+				recorded.instance = 0;
+				if (CanMultiDraw(entries[i]) && IsEntryVisible(entries[i]))
+				{
+					RecordMultiDrawItem(m_drawList[entries[i].index], m_commandBuffers[thread], recorded);
+				}
+			}
+		});
+}
+
+/***********************************************************
+ *  DrawQueueEntry()
+ *
+ *  This method is used for binding the program stored in the
+ *  key of a queued command and drawing the command.
+ ***********************************************************/
+void SceneManager::DrawQueueEntry(const RenderQueue::ENTRY& entry)
+{
+	if (IsEntryVisible(entry) == false)
+	{
+		return;
+	}
+
+	// the shader bits of the key hold the permutation + 1
+	ApplyShaderState(RenderQueue::ShaderFromKey(entry.key) - 1);
+
+	if (entry.type == RenderQueue::EntryType::DRAW_ITEM)
+	{
+		DRAW_ITEM& item = m_drawList[entry.index];
+		RefreshDrawItem(item);
+		SubmitDrawItem(item);
+	}
+	else
+	{
+		DrawMeshInstanced(m_instanceGroups[entry.index]);
+	}
+}
+
+/***********************************************************
+ *  LibraryShape()
+ *
+ *  This method is used for getting the mesh library shape
+ *  used to draw a mesh type.  Returns false for the types
+ *  that are only drawn by ShapeMeshes.
+ ***********************************************************/
+bool SceneManager::LibraryShape(MeshType type, MeshLibrary::ShapeType& shape) const
+{
+	switch (type)
+	{
+	case MeshType::BOX:              shape = MeshLibrary::ShapeType::BOX; break;
+	case MeshType::CYLINDER:         shape = MeshLibrary::ShapeType::CYLINDER; break;
+	case MeshType::PLANE:            shape = MeshLibrary::ShapeType::PLANE; break;
+	case MeshType::SPHERE:           shape = MeshLibrary::ShapeType::SPHERE; break;
+	case MeshType::TAPERED_CYLINDER: shape = MeshLibrary::ShapeType::TAPERED_CYLINDER; break;
+	case MeshType::TORUS:            shape = MeshLibrary::ShapeType::TORUS; break;
+	default:
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  LibraryPartMask()
+ *
+ *  This method is used for building the mesh library part
+ *  mask from the face flags.  Only the box and the cylinders
+ *  have caps to leave out, the other shapes are always drawn
+ *  whole.
+ ***********************************************************/
+int SceneManager::LibraryPartMask(MeshType type, bool top, bool bottom, bool sides) const
+{
+	if ((type != MeshType::BOX) && (type != MeshType::CYLINDER) && (type != MeshType::TAPERED_CYLINDER))
+	{
+		return(MeshLibrary::PART_ALL);
+	}
+
+	int partMask = 0;
+	if (top) partMask |= MeshLibrary::PART_TOP;
+	if (bottom) partMask |= MeshLibrary::PART_BOTTOM;
+	if (sides) partMask |= MeshLibrary::PART_SIDES;
+	return(partMask);
+}
+
+/***********************************************************
+ *  IsEmptyDraw()
+ *
+ *  This method is used for checking whether the face flags
+ *  of a draw turn off every part of its mesh, so the draw can
+ *  be skipped completely.
+ ***********************************************************/
+bool SceneManager::IsEmptyDraw(MeshType type, bool top, bool bottom, bool sides) const
+{
+	if ((type != MeshType::BOX) && (type != MeshType::CYLINDER) && (type != MeshType::TAPERED_CYLINDER))
+	{
+		return(false);
+	}
+
+	return((top == false) && (bottom == false) && (sides == false));
+}
+
+/***********************************************************
+ *  CanMultiDraw()
+ *
+ *  This method is used for checking whether a queued command
+ *  is a single draw of a loaded mesh library shape, which
+ *  can be collected into a multi-draw.
+ ***********************************************************/
+bool SceneManager::CanMultiDraw(const RenderQueue::ENTRY& entry) const
+{
+	if ((m_meshLibrary->MultiDrawSupported() == false) || (entry.type != RenderQueue::EntryType::DRAW_ITEM))
+	{
+		return(false);
+	}
+
+	MeshLibrary::ShapeType shape;
+	return(LibraryShape(m_drawList[entry.index].mesh, shape) && m_meshLibrary->IsLoaded(shape));
+}
+
+/***********************************************************
+ *  MultiDrawRunEnd()
+ *
+ *  This method is used for finding the end of the run of
+ *  queued draws, starting at first, that use the same
+ *  program and texture.  The transform, color and material
+ *  come from the instance values, so they may differ.
+ *  Returns first when the draw cannot go into a multi-draw.
+ ***********************************************************/
+size_t SceneManager::MultiDrawRunEnd(const std::vector<RenderQueue::ENTRY>& entries, size_t first) const
+{
+	if (CanMultiDraw(entries[first]) == false)
+	{
+		return(first);
+	}
+
+	const DRAW_ITEM& firstItem = m_drawList[entries[first].index];
+	int shader = RenderQueue::ShaderFromKey(entries[first].key);
+
+	size_t last = first + 1;
+	while (last < entries.size())
+	{
+		const RenderQueue::ENTRY& entry = entries[last];
+		if ((CanMultiDraw(entry) == false) || (RenderQueue::ShaderFromKey(entry.key) != shader))
+		{
+			break;
+		}
+
+		const DRAW_ITEM& item = m_drawList[entry.index];
+		if ((item.textureIndex >= 0) || (firstItem.textureIndex >= 0))
+		{
+			if ((item.textureIndex != firstItem.textureIndex) || (item.uvScale != firstItem.uvScale) ||
+				(item.bFaceTextures != firstItem.bFaceTextures))
+			{
+				break;
+			}
+			if (item.bFaceTextures && (std::equal(item.faceTextures, item.faceTextures + MeshLibrary::BOX_FACE_COUNT, firstItem.faceTextures) == false))
+			{
+				break;
+			}
+		}
+		last++;
+	}
+
+	return(last);
+}
+
+/***********************************************************
+ *  SubmitMultiDrawRun()
+ *
+ *  This method is used for setting the shared state of a run
+ *  of queued draws once and drawing the visible ones with a
+ *  single multi-draw call.
+ ***********************************************************/
+void SceneManager::SubmitMultiDrawRun(const std::vector<RenderQueue::ENTRY>& entries, size_t first, size_t last)
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	// the commands were recorded by RecordCommands(), culled draws
+	// have none
+	m_meshLibrary->BeginMultiDraw();
+	for (size_t i = first; i < last; i++)
+	{
+		AddRecordedDraw(m_recordedDraws[i]);
+	}
+
+	// the shader bits of the key hold the permutation + 1
+	ApplyShaderState(RenderQueue::ShaderFromKey(entries[first].key) - 1);
+
+	const DRAW_ITEM& firstItem = m_drawList[entries[first].index];
+	if (firstItem.textureIndex >= 0)
+	{
+		ApplyDrawTextureState(firstItem.textureIndex, firstItem.uvScale, firstItem.bFaceTextures ? firstItem.faceTextures : NULL);
+	}
+	else
+	{
+		ApplyColorState(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), false);
+	}
+
+	// each draw reads its transform, color and material from the
+	// instance values picked by its base instance
+	ApplyInstancingState(true);
+	m_renderStats.drawCalls += m_meshLibrary->SubmitMultiDraw();
+}
+
+/***********************************************************
+ *  MakeDrawInstance()
+ *
+ *  This method is used for getting the per-instance values
+ *  that a retained draw reads when it is part of a
+ *  multi-draw.
+ ***********************************************************/
+MeshLibrary::INSTANCE_DATA SceneManager::MakeDrawInstance(const DRAW_ITEM& item) const
+{
+	MeshLibrary::INSTANCE_DATA instance;
+	instance.model = item.model;
+	instance.normalMatrix = item.normalMatrix;
+	instance.color = item.color;
+	instance.materialIndex = item.materialIndex;
+
+	return(instance);
+}
+
+/***********************************************************
+ *  RecordMultiDrawItem()
+ *
+ *  This method is used for recording a retained draw into a
+ *  command buffer, at the level of detail picked for its
+ *  size on screen, and noting where its commands went.  Only
+ *  values that stay the same while recording are read.
+ ***********************************************************/
+void SceneManager::RecordMultiDrawItem(const DRAW_ITEM& item, MeshLibrary::MULTI_DRAW_LIST& commands, RECORDED_DRAW& recorded) const
+{
+	MeshLibrary::ShapeType shape;
+	if (LibraryShape(item.mesh, shape) == false)
+	{
+		return;
+	}
+
+	recorded.firstCommand = (int)commands.commands.size();
+	recorded.instance = (int)commands.instances.size();
+	m_meshLibrary->RecordMultiDraw(commands, shape, LibraryPartMask(item.mesh, item.top, item.bottom, item.sides), DrawItemLod(item), MakeDrawInstance(item));
+	recorded.commandCount = (int)commands.commands.size() - recorded.firstCommand;
+}
+
+/***********************************************************
+ *  AddRecordedDraw()
+ *
+ *  This method is used for adding the commands recorded for
+ *  one draw to the multi-draw being collected.
+ ***********************************************************/
+void SceneManager::AddRecordedDraw(const RECORDED_DRAW& recorded)
+{
+	if (recorded.commandCount > 0)
+	{
+		m_meshLibrary->AddRecordedMultiDraw(m_commandBuffers[recorded.buffer], recorded.firstCommand, recorded.commandCount, recorded.instance);
+	}
+}
+
+/***********************************************************
+ *  IsTransparent()
+ *
+ *  This method is used for deciding whether a draw has to be
+ *  blended - when its material is see-through or its color
+ *  is not fully opaque.
+ ***********************************************************/
+bool SceneManager::IsTransparent(int materialIndex, float alpha) const
+{
+	if (alpha < 1.0f)
+	{
+		return(true);
+	}
+	if ((materialIndex >= 0) && (materialIndex < (int)m_objectMaterials.size()))
+	{
+		return(m_objectMaterials[materialIndex].bTransparent);
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  SortInstancesBackToFront()
+ *
+ *  This method is used for ordering the copies in a
+ *  transparent group farthest from the camera first, since
+ *  they are blended in the order they are stored.  The
+ *  instance buffer is only uploaded again when the order
+ *  actually changes.  The transform nodes are reordered with
+ *  the instances, so moved nodes still find their copy.
+ ***********************************************************/
+void SceneManager::SortInstancesBackToFront(INSTANCE_GROUP& group)
+{
+	glm::vec3 viewPosition = m_sortViewPosition;
+	auto fartherFirst = [viewPosition](const MeshLibrary::INSTANCE_DATA& a, const MeshLibrary::INSTANCE_DATA& b)
+	{
+		return(glm::length(glm::vec3(a.model[3]) - viewPosition) > glm::length(glm::vec3(b.model[3]) - viewPosition));
+	};
+
+	if (std::is_sorted(group.instances.begin(), group.instances.end(), fartherFirst))
+	{
+		return;
+	}
+
+	if (group.nodes.size() != group.instances.size())
+	{
+		std::stable_sort(group.instances.begin(), group.instances.end(), fartherFirst);
+		group.bDirty = true;
+		return;
+	}
+
+	std::vector<int> order(group.instances.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		order[i] = (int)i;
+	}
+	std::stable_sort(order.begin(), order.end(), [&group, &fartherFirst](int a, int b)
+	{
+		return(fartherFirst(group.instances[a], group.instances[b]));
+	});
+
+	std::vector<MeshLibrary::INSTANCE_DATA> instances(order.size());
+	std::vector<int> nodes(order.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		instances[i] = group.instances[order[i]];
+		nodes[i] = group.nodes[order[i]];
+	}
+	group.instances.swap(instances);
+	group.nodes.swap(nodes);
+
+	int groupIndex = (int)(&group - m_instanceGroups.data());
+	for (size_t i = 0; i < group.nodes.size(); i++)
+	{
+		NODE_OWNER* pOwner = FindGroupOwner(group.nodes[i], groupIndex);
+		if (NULL != pOwner)
+		{
+			pOwner->instance = (int)i;
+		}
+	}
+	group.bDirty = true;
+}
+
+/***********************************************************
+ *  DrawDistance()
+ *
+ *  This method is used for getting how far a queued command
+ *  is from the camera.  Instance groups use the center of
+ *  their instances.
+ ***********************************************************/
+float SceneManager::DrawDistance(const RenderQueue::ENTRY& entry) const
+{
+	if (entry.type == RenderQueue::EntryType::DRAW_ITEM)
+	{
+		return(glm::length(glm::vec3(m_drawList[entry.index].model[3]) - m_sortViewPosition));
+	}
+
+	const INSTANCE_GROUP& group = m_instanceGroups[entry.index];
+	if (group.instances.empty())
+	{
+		return(g_DepthSortRange);
+	}
+
+	glm::vec3 center = glm::vec3(0.0f, 0.0f, 0.0f);
+	for (const MeshLibrary::INSTANCE_DATA& instance : group.instances)
+	{
+		center += glm::vec3(instance.model[3]);
+	}
+	center /= (float)group.instances.size();
+
+	return(glm::length(center - m_sortViewPosition));
+}
+
+/***********************************************************
+ *  RefreshDrawItem()
+ *
+ *  This method is used for rebuilding the matrices of a draw
+ *  that was moved since it was last drawn.
+ ***********************************************************/
+void SceneManager::RefreshDrawItem(DRAW_ITEM& item)
+{
+	if (item.bDirty == false)
+	{
+		return;
+	}
+
+	item.model = m_transforms.World(item.node);
+	item.normalMatrix = BuildNormalMatrix(item.model);
+	item.bDirty = false;
+	UpdateDrawBounds(item);
+}
+
+/***********************************************************
+ *  MeshLocalBounds()
+ *
+ *  This method is used for getting the box around a mesh in
+ *  its own space.  The instanced shapes are measured from
+ *  their generated vertices; the ShapeMeshes shapes use the
+ *  sizes they are built with, rounded up where unsure.
+ ***********************************************************/
+FrustumCuller::BOUNDS SceneManager::MeshLocalBounds(MeshType type) const
+{
+	FrustumCuller::BOUNDS bounds;
+	bounds.minPoint = glm::vec3(-1.0f, -1.0f, -1.0f);
+	bounds.maxPoint = glm::vec3(1.0f, 1.0f, 1.0f);
+
+	MeshLibrary::ShapeType shape;
+	if (LibraryShape(type, shape) &&
+		m_meshLibrary->GetLocalBounds(shape, bounds.minPoint, bounds.maxPoint))
+	{
+		return(bounds);
+	}
+
+	switch (type)
+	{
+	case MeshType::BOX:
+	case MeshType::BOX_FRONT:
+	case MeshType::BOX_BACK:
+	case MeshType::BOX_BOTTOM:
+	case MeshType::BOX_TOP:
+	case MeshType::BOX_RIGHT:
+	case MeshType::BOX_LEFT:
+		bounds.minPoint = glm::vec3(-0.5f, -0.5f, -0.5f);
+		bounds.maxPoint = glm::vec3(0.5f, 0.5f, 0.5f);
+		break;
+	case MeshType::PLANE:
+		bounds.minPoint = glm::vec3(-1.0f, 0.0f, -1.0f);
+		bounds.maxPoint = glm::vec3(1.0f, 0.0f, 1.0f);
+		break;
+	case MeshType::CONE:
+	case MeshType::CYLINDER:
+	case MeshType::TAPERED_CYLINDER:
+		bounds.minPoint = glm::vec3(-1.0f, 0.0f, -1.0f);
+		bounds.maxPoint = glm::vec3(1.0f, 1.0f, 1.0f);
+		break;
+	case MeshType::TORUS:
+		bounds.minPoint = glm::vec3(-1.1f, -1.1f, -0.1f);
+		bounds.maxPoint = glm::vec3(1.1f, 1.1f, 0.1f);
+		break;
+	default:
+		// sphere, prism and pyramids fit in the default unit box
+		break;
+	}
+
+	return(bounds);
+}
+
+/***********************************************************
+ *  UpdateDrawBounds()
+ *
+ *  This method is used for placing the bounding sphere of a
+ *  draw with its current model matrix.
+ ***********************************************************/
+void SceneManager::UpdateDrawBounds(const DRAW_ITEM& item)
+{
+	glm::vec3 center;
+	float radius = 0.0f;
+	FrustumCuller::TransformBounds(MeshLocalBounds(item.mesh), item.model, center, radius);
+	m_frustumCuller.Set(item.boundsIndex, center, radius);
+}
+
+/***********************************************************
+ *  UpdateGroupBounds()
+ *
+ *  This method is used for placing one bounding sphere
+ *  around every instance of a group.  The whole group is
+ *  culled together, since it is a single draw.
+ ***********************************************************/
+void SceneManager::UpdateGroupBounds(INSTANCE_GROUP& group)
+{
+	if (group.instances.empty())
+	{
+		// nothing to draw - a sphere that is never visible, which
+		// InvalidateSphere() skips as well
+		m_frustumCuller.SetEmpty(group.boundsIndex);
+		group.instanceRadius = 0.0f;
+		return;
+	}
+
+	FrustumCuller::BOUNDS localBounds = MeshLocalBounds(group.mesh);
+	std::vector<glm::vec4> spheres(group.instances.size());
+	glm::vec3 groupCenter = glm::vec3(0.0f, 0.0f, 0.0f);
+	for (size_t i = 0; i < group.instances.size(); i++)
+	{
+		glm::vec3 center;
+		float radius = 0.0f;
+		FrustumCuller::TransformBounds(localBounds, group.instances[i].model, center, radius);
+		spheres[i] = glm::vec4(center, radius);
+		groupCenter += center;
+	}
+	groupCenter /= (float)spheres.size();
+
+	float groupRadius = 0.0f;
+	group.instanceRadius = 0.0f;
+	for (size_t i = 0; i < spheres.size(); i++)
+	{
+		groupRadius = std::max(groupRadius, glm::length(glm::vec3(spheres[i]) - groupCenter) + spheres[i].w);
+		group.instanceRadius = std::max(group.instanceRadius, spheres[i].w);
+	}
+
+	m_frustumCuller.Set(group.boundsIndex, groupCenter, groupRadius);
+}
+
+/***********************************************************
+ *  SelectLod()
+ *
+ *  This method is used for picking the level of detail for
+ *  a bounding sphere from its radius on screen in pixels,
+ *  which comes from the projection (the camera zoom) and the
+ *  distance from the camera.
+ ***********************************************************/
+int SceneManager::SelectLod(const glm::vec3& center, float radius, float nearOffset) const
+{
+	if ((NULL == m_pUniformBlocks) || (m_viewportHeight <= 0) || (radius <= 0.0f))
+	{
+		return(0);
+	}
+
+	const UniformBlocks::FRAME_BLOCK& frame = m_pUniformBlocks->Frame();
+
+	// orthographic projections keep the same size at any distance
+	float depth = 1.0f;
+	if (frame.projection[2][3] != 0.0f)
+	{
+		depth = -(frame.view * glm::vec4(center, 1.0f)).z - nearOffset;
+		if (depth <= radius)
+		{
+			// the camera is at or inside the object
+			return(0);
+		}
+	}
+
+	float screenRadius = radius * frame.projection[1][1] * 0.5f * (float)m_viewportHeight / depth;
+	return(MeshLibrary::SelectLod(screenRadius));
+}
+
+/***********************************************************
+ *  DrawItemLod()
+ *
+ *  This method is used for picking the level of detail of a
+ *  retained draw from its bounding sphere.
+ ***********************************************************/
+int SceneManager::DrawItemLod(const DRAW_ITEM& item) const
+{
+	return(SelectLod(m_frustumCuller.Center(item.boundsIndex), m_frustumCuller.Radius(item.boundsIndex)));
+}
+
+/***********************************************************
+ *  InstanceGroupLod()
+ *
+ *  This method is used for picking one level of detail for
+ *  every copy in a group.  The largest copy is treated as if
+ *  it were at the near edge of the group, so the closest
+ *  copy never gets too coarse.
+ ***********************************************************/
+int SceneManager::InstanceGroupLod(const INSTANCE_GROUP& group) const
+{
+	float groupRadius = m_frustumCuller.Radius(group.boundsIndex);
+	return(SelectLod(m_frustumCuller.Center(group.boundsIndex), group.instanceRadius,
+		std::max(groupRadius - group.instanceRadius, 0.0f)));
+}
+
+/***********************************************************
+ *  IsEntryVisible()
+ *
+ *  This method is used for getting whether the command a
+ *  queue entry refers to was inside the frustum this frame.
+ ***********************************************************/
+bool SceneManager::IsEntryVisible(const RenderQueue::ENTRY& entry) const
+{
+	if (entry.type == RenderQueue::EntryType::DRAW_ITEM)
+	{
+		return(m_frustumCuller.IsVisible(m_drawList[entry.index].boundsIndex));
+	}
+
+	// a group with no instances would issue an empty draw
+	const INSTANCE_GROUP& group = m_instanceGroups[entry.index];
+	if (group.instances.empty())
+	{
+		return(false);
+	}
+
+	return(m_frustumCuller.IsVisible(group.boundsIndex));
+}
+
+/***********************************************************
+ *  RefreshInstanceGroup()
+ *
+ *  This method is used for uploading the instances of a
+ *  group that were replaced since it was last drawn.
+ ***********************************************************/
+void SceneManager::RefreshInstanceGroup(INSTANCE_GROUP& group)
+{
+	if (group.bDirty == false)
+	{
+		return;
+	}
+
+	m_meshLibrary->UpdateInstanceBatch(group.batch, group.instances.data(), (int)group.instances.size());
+	group.bDirty = false;
+}
+
+/***********************************************************
+ *  RenderDepthPrePass()
+ *
+ *  This method is used for drawing every queued command
+ *  nearest first with a depth-only program and the color
+ *  writes masked off.  Nothing but the model matrix changes
+ *  between draws, so the order is by distance alone.
+ ***********************************************************/
+bool SceneManager::RenderDepthPrePass()
+{
+	if ((NULL == m_pShaderPermutations) || (NULL == m_pShaderManager))
+	{
+		return(false);
+	}
+
+	int depthPermutation = m_pShaderPermutations->Request(ShaderPermutations::PERMUTATION_DEPTH_ONLY);
+	if (depthPermutation < 0)
+	{
+		return(false);
+	}
+
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	ApplyShaderState(depthPermutation);
+
+	// no state is needed besides the transform, so every draw that
+	// can be collected goes into one multi-draw, still nearest first
+	m_meshLibrary->BeginMultiDraw();
+
+	const std::vector<RenderQueue::ENTRY>& entries = m_renderQueue.Entries();
+	for (int i = 0; i < (int)m_depthOrder.size(); i++)
+	{
+		const RenderQueue::ENTRY& entry = entries[m_depthOrder[i]];
+		if (IsEntryVisible(entry) == false)
+		{
+			continue;
+		}
+
+		if (CanMultiDraw(entry))
+		{
+			AddRecordedDraw(m_recordedDraws[m_depthOrder[i]]);
+		}
+		else if (entry.type == RenderQueue::EntryType::DRAW_ITEM)
+		{
+			DRAW_ITEM& item = m_drawList[entry.index];
+			RefreshDrawItem(item);
+			ApplyInstancingState(false);
+			m_uniformCache.SetMat4(m_uniforms.model, item.model);
+			m_renderStats.drawCalls += draw(item.mesh, item.top, item.bottom, item.sides, DrawItemLod(item));
+		}
+		else
+		{
+			INSTANCE_GROUP& group = m_instanceGroups[entry.index];
+			RefreshInstanceGroup(group);
+			ApplyInstancingState(true);
+			m_renderStats.drawCalls += m_meshLibrary->DrawInstanceBatch(group.batch, group.partMask, InstanceGroupLod(group));
+		}
+	}
+
+	ApplyInstancingState(true);
+	m_renderStats.drawCalls += m_meshLibrary->SubmitMultiDraw();
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+	return(true);
+}
+
+/***********************************************************
+ *  RenderShadowMaps()
+ *
+ *  This method is used for drawing the shadow maps that are
+ *  out of date with the depth-only program.  The maps are
+ *  drawn through their own framebuffer and camera values,
+ *  and the frame's framebuffer, viewport and camera are put
+ *  back afterwards.
+ ***********************************************************/
+void SceneManager::RenderShadowMaps()
+{
+	if ((NULL == m_pShaderPermutations) || (NULL == m_pUniformBlocks) || (NULL == m_pShaderManager))
+	{
+		return;
+	}
+	if ((m_shadowMaps->NeedsRender(ShadowMaps::POINT_SHADOW) == false) &&
+		(m_shadowMaps->NeedsRender(ShadowMaps::DIRECTIONAL_SHADOW) == false))
+	{
+		return;
+	}
+
+	int depthPermutation = m_pShaderPermutations->Request(ShaderPermutations::PERMUTATION_DEPTH_ONLY);
+	if (depthPermutation < 0)
+	{
+		return;
+	}
+
+	BeginGpuPass("Shadow maps");
+
+	GLint framebuffer = 0;
+	GLint viewport[4] = { 0, 0, 0, 0 };
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	UniformBlocks::FRAME_BLOCK cameraFrame = m_pUniformBlocks->Frame();
+
+	ApplyShaderState(depthPermutation);
+	// push the depth back a little, so lit surfaces do not shadow
+	// themselves
+	glEnable(GL_POLYGON_OFFSET_FILL);
+	glPolygonOffset(2.0f, 4.0f);
+
+	for (int map = 0; map < ShadowMaps::MAP_COUNT; map++)
+	{
+		if (m_shadowMaps->NeedsRender((ShadowMaps::MapType)map))
+		{
+			RenderShadowMap((ShadowMaps::MapType)map);
+		}
+	}
+
+	glDisable(GL_POLYGON_OFFSET_FILL);
+	glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)framebuffer);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	m_pUniformBlocks->UpdateFrame(cameraFrame);
+
+	EndGpuPass();
+}
+
+/***********************************************************
+ *  RenderShadowMap()
+ *
+ *  This method is used for drawing every opaque object that
+ *  can throw a shadow into a map.  The casters are collected
+ *  once - mesh library shapes into one multi-draw - and are
+ *  then drawn into each view of the map at full detail.
+ *  Blended objects do not cast shadows.
+ ***********************************************************/
+void SceneManager::RenderShadowMap(ShadowMaps::MapType map)
+{
+	m_shadowDraws.clear();
+	m_shadowGroups.clear();
+	m_meshLibrary->BeginMultiDraw();
+
+	for (int i = 0; i < (int)m_drawList.size(); i++)
+	{
+		const DRAW_ITEM& item = m_drawList[i];
+		if (item.bTransparent || IsEmptyDraw(item.mesh, item.top, item.bottom, item.sides) ||
+			(m_shadowMaps->IsCaster(map, m_frustumCuller.Center(item.boundsIndex), m_frustumCuller.Radius(item.boundsIndex)) == false))
+		{
+			continue;
+		}
+
+		MeshLibrary::ShapeType shape;
+		if (m_meshLibrary->MultiDrawSupported() && LibraryShape(item.mesh, shape) && m_meshLibrary->IsLoaded(shape))
+		{
+			m_meshLibrary->AddMultiDraw(shape, LibraryPartMask(item.mesh, item.top, item.bottom, item.sides), 0, MakeDrawInstance(item));
+		}
+		else
+		{
+			m_shadowDraws.push_back(i);
+		}
+	}
+	for (int i = 0; i < (int)m_instanceGroups.size(); i++)
+	{
+		const INSTANCE_GROUP& group = m_instanceGroups[i];
+		if ((group.bTransparent == false) && (group.partMask != 0) &&
+			m_shadowMaps->IsCaster(map, m_frustumCuller.Center(group.boundsIndex), m_frustumCuller.Radius(group.boundsIndex)))
+		{
+			m_shadowGroups.push_back(i);
+		}
+	}
+
+	for (int view = 0; view < m_shadowMaps->ViewCount(map); view++)
+	{
+		m_pUniformBlocks->UpdateFrame(m_shadowMaps->BeginView(map, view));
+
+		ApplyInstancingState(true);
+		m_renderStats.drawCalls += m_meshLibrary->SubmitMultiDraw();
+
+		for (int index : m_shadowDraws)
+		{
+			const DRAW_ITEM& item = m_drawList[index];
+			ApplyInstancingState(false);
+			m_uniformCache.SetMat4(m_uniforms.model, item.model);
+			m_renderStats.drawCalls += draw(item.mesh, item.top, item.bottom, item.sides, 0);
+		}
+		for (int index : m_shadowGroups)
+		{
+			INSTANCE_GROUP& group = m_instanceGroups[index];
+			RefreshInstanceGroup(group);
+			ApplyInstancingState(true);
+			m_renderStats.drawCalls += m_meshLibrary->DrawInstanceBatch(group.batch, group.partMask, 0);
+		}
+		m_renderStats.shadowViews++;
+	}
+
+	m_shadowMaps->EndMap(map);
+}
+
+/***********************************************************
+ *  FitShadowBounds()
+ *
+ *  This method is used for placing one sphere around every
+ *  opaque object, which the directional shadow map covers.
+ ***********************************************************/
+void SceneManager::FitShadowBounds()
+{
+	bool bFound = false;
+	glm::vec3 minPoint(0.0f, 0.0f, 0.0f);
+	glm::vec3 maxPoint(0.0f, 0.0f, 0.0f);
+
+	for (int i = 0; i < m_frustumCuller.Count(); i++)
+	{
+		float radius = m_frustumCuller.Radius(i);
+		if (radius < 0.0f)
+		{
+			continue;
+		}
+
+		glm::vec3 center = m_frustumCuller.Center(i);
+		glm::vec3 extent(radius, radius, radius);
+		minPoint = bFound ? glm::min(minPoint, center - extent) : center - extent;
+		maxPoint = bFound ? glm::max(maxPoint, center + extent) : center + extent;
+		bFound = true;
+	}
+
+	if (bFound)
+	{
+		m_shadowMaps->SetSceneBounds((minPoint + maxPoint) * 0.5f, glm::length(maxPoint - minPoint) * 0.5f);
+	}
+}
+
+/***********************************************************
+ *  BeginGpuPass()
+ *
+ *  This method is used for starting the GPU timer of a
+ *  render pass.
+ ***********************************************************/
+void SceneManager::BeginGpuPass(const char* name)
+{
+	if (NULL != m_pProfiler)
+	{
+		m_pProfiler->BeginGpu(name);
+	}
+}
+
+/***********************************************************
+ *  EndGpuPass()
+ *
+ *  This method is used for stopping the GPU timer of the
+ *  current render pass.
+ ***********************************************************/
+void SceneManager::EndGpuPass()
+{
+	if (NULL != m_pProfiler)
+	{
+		m_pProfiler->EndGpu();
+	}
+}
+
+/***********************************************************
+ *  ResetRenderState()
+ *
+ *  This method is used for forgetting the cached shader
+ *  state, so the next draw sets every value again.
+ ***********************************************************/
+void SceneManager::ResetRenderState()
+{
+	m_renderState.permutation = -2;
+	m_renderState.useTexture = -1;
+	m_renderState.textureUnit = -1;
+	m_renderState.textureLayer = -1;
+	m_renderState.uvScale = glm::vec2(0.0f, 0.0f);
+	m_renderState.bUVScaleKnown = false;
+	m_renderState.materialIndex = -1;
+	m_renderState.color = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+	m_renderState.bColorKnown = false;
+	m_renderState.useInstancing = -1;
+	m_renderState.useFaceLayers = -1;
+	m_renderState.bFaceLayersKnown = false;
+}
+
+/***********************************************************
+ *  SelectPermutation()
+ *
+ *  This method is used for getting the shader permutation
+ *  that matches the scene lights and whether the draw is
+ *  textured.  -1 means the base program is used instead,
+ *  either because there are no permutations or because the
+ *  variant did not compile.
+ ***********************************************************/
+int SceneManager::SelectPermutation(bool bTextured)
+{
+	if (NULL == m_pShaderPermutations)
+	{
+		return(-1);
+	}
+
+	// the overdraw view uses one flat program for every draw
+	if (m_bOverdrawView)
+	{
+		return(m_pShaderPermutations->Request(ShaderPermutations::PERMUTATION_OVERDRAW));
+	}
+
+	int key = m_lightingPermutation;
+	if (bTextured)
+	{
+		key |= ShaderPermutations::PERMUTATION_TEXTURE;
+	}
+
+	return(m_pShaderPermutations->Request(key));
+}
+
+/***********************************************************
+ *  ApplyShaderState()
+ *
+ *  This method is used for binding the program of a shader
+ *  permutation.  Uniform values belong to a program, so all
+ *  of the cached state is forgotten when the program changes.
+ ***********************************************************/
+void SceneManager::ApplyShaderState(int permutation)
+{
+	if (m_renderState.permutation == permutation)
+	{
+		m_renderStats.skippedChanges++;
+		return;
+	}
+
+	GLuint programID = m_baseProgram;
+	if ((permutation >= 0) && (NULL != m_pShaderPermutations))
+	{
+		programID = m_pShaderPermutations->Program(permutation);
+	}
+
+	glUseProgram(programID);
+	m_uniformCache.Use(programID);
+	ResetRenderState();
+	m_renderState.permutation = permutation;
+	m_renderStats.stateChanges++;
+
+	// programs without the cluster uniforms skip these
+	m_uniformCache.SetInt(m_uniforms.clusterLights, ClusteredLights::LIGHT_TEXTURE_UNIT);
+	m_uniformCache.SetInt(m_uniforms.clusterGrid, ClusteredLights::GRID_TEXTURE_UNIT);
+	m_uniformCache.SetInt(m_uniforms.clusterIndices, ClusteredLights::INDEX_TEXTURE_UNIT);
+	m_uniformCache.SetVec4(m_uniforms.clusterTileScale, m_clusteredLights->ClusterScale());
+	// and the shadow uniforms
+	m_uniformCache.SetInt(m_uniforms.pointShadowMap, ShadowMaps::POINT_SHADOW_TEXTURE_UNIT);
+	m_uniformCache.SetVec3(m_uniforms.pointShadowPosition, m_shadowMaps->PointLightPosition());
+	m_uniformCache.SetVec2(m_uniforms.pointShadowPlanes, m_shadowMaps->PointShadowPlanes());
+	m_uniformCache.SetInt(m_uniforms.directionalShadowMap, ShadowMaps::DIRECTIONAL_SHADOW_TEXTURE_UNIT);
+	m_uniformCache.SetMat4(m_uniforms.directionalShadowMatrix, m_shadowMaps->DirectionalShadowMatrix());
+	m_uniformCache.SetInt(m_uniforms.shadowFilterQuality, m_shadowMaps->FilterQuality());
+}
+
+/***********************************************************
+ *  ApplyTextureState()
+ *
+ *  This method is used for setting the texture values into
+ *  the shader, skipping any that are already set.
+ ***********************************************************/
+void SceneManager::ApplyTextureState(int textureIndex, glm::vec2 uvScale)
+{
+	if (m_renderState.useTexture != 1)
+	{
+		m_uniformCache.SetBool(m_uniforms.useTexture, true);
+		m_renderState.useTexture = 1;
+		m_renderStats.stateChanges++;
+	}
+	else
+	{
+		m_renderStats.skippedChanges++;
+	}
+
+	// textures of the same size share an array, so switching
+	// between them only changes the layer
+	int textureUnit = m_textureLibrary->TextureUnit(textureIndex);
+	if (m_renderState.textureUnit != textureUnit)
+	{
+		m_uniformCache.SetInt(m_uniforms.objectTexture, textureUnit);
+		m_renderState.textureUnit = textureUnit;
+		m_renderStats.stateChanges++;
+		m_renderStats.textureBinds++;
+	}
+	else
+	{
+		m_renderStats.skippedChanges++;
+	}
+
+	int textureLayer = m_textureLibrary->TextureLayer(textureIndex);
+	if (m_renderState.textureLayer != textureLayer)
+	{
+		m_uniformCache.SetFloat(m_uniforms.textureLayer, (float)textureLayer);
+		m_renderState.textureLayer = textureLayer;
+		m_renderStats.stateChanges++;
+	}
+	else
+	{
+		m_renderStats.skippedChanges++;
+	}
+
+	if ((m_renderState.bUVScaleKnown == false) || (m_renderState.uvScale != uvScale))
+	{
+		m_uniformCache.SetVec2(m_uniforms.uvScale, uvScale);
+		m_renderState.uvScale = uvScale;
+		m_renderState.bUVScaleKnown = true;
+		m_renderStats.stateChanges++;
+	}
+	else
+	{
+		m_renderStats.skippedChanges++;
+	}
+}
+
+/***********************************************************
+ *  ApplyColorState()
+ *
+ *  This method is used for switching the shader to a solid
+ *  color, skipping any values that are already set.  Passing
+ *  false for bSetColor only turns off texturing (instanced
+ *  draws take their colors from the instance buffer).
+ ***********************************************************/
+void SceneManager::ApplyColorState(glm::vec4 color, bool bSetColor)
+{
+	if (m_renderState.useTexture != 0)
+	{
+		m_uniformCache.SetBool(m_uniforms.useTexture, false);
+		m_renderState.useTexture = 0;
+		m_renderStats.stateChanges++;
+	}
+	else
+	{
+		m_renderStats.skippedChanges++;
+	}
+
+	if (bSetColor == false)
+	{
+		return;
+	}
+
+	if ((m_renderState.bColorKnown == false) || (m_renderState.color != color))
+	{
+		m_uniformCache.SetVec4(m_uniforms.objectColor, color);
+		m_renderState.color = color;
+		m_renderState.bColorKnown = true;
+		m_renderStats.stateChanges++;
+	}
+	else
+	{
+		m_renderStats.skippedChanges++;
+	}
+}
+
+/***********************************************************
+ *  ApplyMaterialState()
+ *
+ *  This method is used for setting the material into the
+ *  shader if it is not the one that is already set.
+ ***********************************************************/
+void SceneManager::ApplyMaterialState(int materialIndex)
+{
+	if (m_renderState.materialIndex != materialIndex)
+	{
+		SetShaderMaterial(materialIndex);
+		m_renderState.materialIndex = materialIndex;
+		m_renderStats.stateChanges++;
+	}
+	else
+	{
+		m_renderStats.skippedChanges++;
+	}
+}
+
+/***********************************************************
+ *  ApplyInstancingState()
+ *
+ *  This method is used for switching the vertex shader
+ *  between the model uniform and the instance attributes.
+ ***********************************************************/
+void SceneManager::ApplyInstancingState(bool bInstanced)
+{
+	int useInstancing = bInstanced ? 1 : 0;
+	if (m_renderState.useInstancing != useInstancing)
+	{
+		m_uniformCache.SetBool(m_uniforms.useInstancing, bInstanced);
+		m_renderState.useInstancing = useInstancing;
+		m_renderStats.stateChanges++;
+	}
+	else
+	{
+		m_renderStats.skippedChanges++;
+	}
+}
+
+/***********************************************************
+ *  ApplyDrawTextureState()
+ *
+ *  This method is used for setting the texture of a textured
+ *  draw.  A draw with a texture per face samples the layer
+ *  of each face, once all of its textures have their pixels -
+ *  until then the whole draw uses the placeholder.
+ ***********************************************************/
+void SceneManager::ApplyDrawTextureState(int textureIndex, glm::vec2 uvScale, const int* faceTextures)
+{
+	if (NULL != faceTextures)
+	{
+		for (int face = 0; face < MeshLibrary::BOX_FACE_COUNT; face++)
+		{
+			if (m_textureLibrary->Info(faceTextures[face]).bReady == false)
+			{
+				ApplyTextureState(faceTextures[face], uvScale);
+				ApplyFaceLayerState(NULL);
+				return;
+			}
+		}
+	}
+
+	ApplyTextureState(textureIndex, uvScale);
+	ApplyFaceLayerState(faceTextures);
+}
+
+/***********************************************************
+ *  ApplyFaceLayerState()
+ *
+ *  This method is used for setting the texture layer of each
+ *  box face into the shader, skipping values that are
+ *  already set.  Passing NULL switches back to the single
+ *  texture layer.
+ ***********************************************************/
+void SceneManager::ApplyFaceLayerState(const int* faceTextures)
+{
+	int useFaceLayers = (NULL != faceTextures) ? 1 : 0;
+	if (m_renderState.useFaceLayers != useFaceLayers)
+	{
+		m_uniformCache.SetBool(m_uniforms.useFaceLayers, (useFaceLayers != 0));
+		m_renderState.useFaceLayers = useFaceLayers;
+		m_renderStats.stateChanges++;
+	}
+	else
+	{
+		m_renderStats.skippedChanges++;
+	}
+
+	if (NULL == faceTextures)
+	{
+		return;
+	}
+
+	float faceLayers[MeshLibrary::BOX_FACE_COUNT];
+	bool bChanged = (m_renderState.bFaceLayersKnown == false);
+	for (int face = 0; face < MeshLibrary::BOX_FACE_COUNT; face++)
+	{
+		faceLayers[face] = (float)m_textureLibrary->TextureLayer(faceTextures[face]);
+		if (faceLayers[face] != m_renderState.faceLayers[face])
+		{
+			bChanged = true;
+		}
+	}
+
+	if (bChanged)
+	{
+		m_uniformCache.SetFloatArray(m_uniforms.faceLayers, faceLayers, MeshLibrary::BOX_FACE_COUNT);
+		for (int face = 0; face < MeshLibrary::BOX_FACE_COUNT; face++)
+		{
+			m_renderState.faceLayers[face] = faceLayers[face];
+		}
+		m_renderState.bFaceLayersKnown = true;
+		m_renderStats.stateChanges++;
+	}
+	else
+	{
+		m_renderStats.skippedChanges++;
+	}
+}
+
+/***********************************************************
+ *  SetObjectTransform()
+ *
+ *  This method is used for changing the transform of an
+ *  object in the retained draw list, relative to the
+ *  transform group it was added in.  The model matrix is
+ *  rebuilt the next time the scene is rendered.
+ ***********************************************************/
+void SceneManager::SetObjectTransform(int index, glm::vec3 scale, glm::vec3 pos, glm::vec3 rot)
+{
+	if ((index < 0) || (index >= (int)m_drawList.size()))
+	{
+		return;
+	}
+
+	SetNodeTransform(m_drawList[index].node, scale, pos, rot);
+}
+
+/***********************************************************
+ *  SetNodeTransform()
+ *
+ *  This method is used for changing the transform of a node
+ *  relative to its parent.  Only the node and the nodes below
+ *  it are rebuilt, the next time the scene is rendered.
+ ***********************************************************/
+void SceneManager::SetNodeTransform(int node, glm::vec3 scale, glm::vec3 pos, glm::vec3 rot)
+{
+	if ((node < 0) || (node >= m_transforms.Count()))
+	{
+		return;
+	}
+
+	m_transforms.SetLocal(node, scale, TransformHierarchy::EulerRotation(rot), pos);
+	// the distance used for front-to-back ordering changed
+	m_bRenderQueueDirty = true;
+}
+
+/***********************************************************
+ *  GetObjectNode()
+ *
+ *  This method is used for getting the transform node of an
+ *  object in the retained draw list.
+ ***********************************************************/
+int SceneManager::GetObjectNode(int index) const
+{
+	if ((index < 0) || (index >= (int)m_drawList.size()))
+	{
+		return(-1);
+	}
+
+	return(m_drawList[index].node);
+}
+
+/***********************************************************
+ *  GetInstanceNode()
+ *
+ *  This method is used for getting the transform node of an
+ *  instance in a group.  Transparent groups are reordered
+ *  back to front, so the node of an instance is best looked
+ *  up right after the group is added.
+ ***********************************************************/
+int SceneManager::GetInstanceNode(int group, int instance) const
+{
+	if ((group < 0) || (group >= (int)m_instanceGroups.size()) ||
+		(instance < 0) || (instance >= (int)m_instanceGroups[group].nodes.size()))
+	{
+		return(-1);
+	}
+
+	return(m_instanceGroups[group].nodes[instance]);
+}
+
+/***********************************************************
+ *  GetParentNode()
+ *
+ *  This method is used for getting the node that a transform
+ *  node is placed relative to.
+ ***********************************************************/
+int SceneManager::GetParentNode(int node) const
+{
+	if ((node < 0) || (node >= m_transforms.Count()))
+	{
+		return(-1);
+	}
+
+	return(m_transforms.Parent(node));
+}
+
+/***********************************************************
+ *  AddPointLight()
+ *
+ *  This method is used for adding a point light to the
+ *  scene, returning its index.  There is no limit on the
+ *  number of lights - the shaders only loop over the ones
+ *  that reach each cluster.
+ ***********************************************************/
+int SceneManager::AddPointLight(const ClusteredLights::POINT_LIGHT& light)
+{
+	m_pointLights.push_back(light);
+	m_bLightsDirty = true;
+
+	return((int)m_pointLights.size() - 1);
+}
+
+/***********************************************************
+ *  SetPointLight()
+ *
+ *  This method is used for changing a point light that was
+ *  added before.
+ ***********************************************************/
+void SceneManager::SetPointLight(int index, const ClusteredLights::POINT_LIGHT& light)
+{
+	if ((index < 0) || (index >= (int)m_pointLights.size()))
+	{
+		return;
+	}
+
+	m_pointLights[index] = light;
+	m_bLightsDirty = true;
+}
+
+/***********************************************************
+ *  ClearPointLights()
+ *
+ *  This method is used for removing every point light.
+ ***********************************************************/
+void SceneManager::ClearPointLights()
+{
+	m_pointLights.clear();
+	m_bLightsDirty = true;
+}
+
+/***********************************************************
+ *  SetInstanceData()
+ *
+ *  This method is used for replacing the instances of a
+ *  group.  The instance buffer is uploaded again the next
+ *  time the scene is rendered.
+ ***********************************************************/
+void SceneManager::SetInstanceData(int group, const std::vector<MeshLibrary::INSTANCE_DATA>& instances)
+{
+	if ((group < 0) || (group >= (int)m_instanceGroups.size()))
+	{
+		return;
+	}
+
+	// the new instances no longer follow the transform nodes
+	for (int node : m_instanceGroups[group].nodes)
+	{
+		NODE_OWNER* pOwner = FindGroupOwner(node, group);
+		if (NULL != pOwner)
+		{
+			pOwner->group = -1;
+			pOwner->instance = -1;
+		}
+	}
+	m_instanceGroups[group].nodes.clear();
+
+	// the shadows of the old and the new instances both change
+	int boundsIndex = m_instanceGroups[group].boundsIndex;
+	m_shadowMaps->InvalidateSphere(m_frustumCuller.Center(boundsIndex), m_frustumCuller.Radius(boundsIndex));
+
+	m_instanceGroups[group].instances = instances;
+	m_instanceGroups[group].bDirty = true;
+	m_bRenderQueueDirty = true;
+	UpdateGroupBounds(m_instanceGroups[group]);
+	m_shadowMaps->InvalidateSphere(m_frustumCuller.Center(boundsIndex), m_frustumCuller.Radius(boundsIndex));
+}
+
+/***********************************************************
+ *  SetDepthPrePass()
+ *
+ *  This method is used for switching the depth pre-pass on
+ *  or off.
+ ***********************************************************/
+void SceneManager::SetDepthPrePass(bool bEnabled)
+{
+	m_bDepthPrePass = bEnabled;
+}
+
+/***********************************************************
+ *  SetOverdrawView()
+ *
+ *  This method is used for switching the overdraw view on or
+ *  off.  Every draw picks its program again, so the queue is
+ *  rebuilt.
+ ***********************************************************/
+void SceneManager::SetOverdrawView(bool bEnabled)
+{
+	if (m_bOverdrawView == bEnabled)
+	{
+		return;
+	}
+
+	m_bOverdrawView = bEnabled;
+	m_bRenderQueueDirty = true;
+}
+
+/***********************************************************
+ *  NeedsRedraw()
+ *
+ *  This method is used for getting whether rendering the
+ *  scene again would change the picture, which lets the main
+ *  loop skip frames while nothing moves.
+ ***********************************************************/
+bool SceneManager::NeedsRedraw() const
+{
+	if (m_bRenderQueueDirty || m_bLightsDirty)
+	{
+		return(true);
+	}
+
+	return(IsLoading());
+}
+
+/***********************************************************
+ *  IsLoading()
+ *
+ *  This method is used for getting whether any texture is
+ *  still waiting to be decoded or uploaded.
+ ***********************************************************/
+bool SceneManager::IsLoading() const
+{
+	return((NULL != m_textureLibrary) && (m_textureLibrary->LoadingCount() > 0));
+}
+
+/***********************************************************
+ *  BuildDrawList()
+ *
+ *  This method is used for recording all of the objects in
+ *  the 3D scene into the retained draw list
+ ***********************************************************/
+void SceneManager::BuildDrawList()
+{
+	m_drawList.clear();
+	m_instanceGroups.clear();
+	m_frustumCuller.Clear();
+	m_transforms.Clear();
+	m_nodeOwners.clear();
+	m_sharedOwners.clear();
+	m_transformParents.clear();
+	m_bRenderQueueDirty = true;
+
+	// the objects come from the scene file when there is one
+	if (m_sceneFile.IsLoaded())
+	{
+		BuildSceneDrawList();
+		return;
+	}
+
+	// =========================================================
+	// PLATFORM (plane)
+	// =========================================================
+	AddTexturedMesh(MeshType::BOX,
+		glm::vec3(60.0f, 1.5f, 15.0f),
+		glm::vec3(0.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 0.0f), 
+		"wood_tex", 1.0f, 1.0f, "wood", true, false, true);
+
+
+	// =========================================================
+	// SALT SHAKERS (left and right)
+	// 1) tapered cylinder = glass body
+	// 2) cylinder         = cap
+	// 3) torus            = base ring
+	// =========================================================
+
+	// the props are copied onto a grid for stress testing - the
+	// first copy is the original scene
+	std::vector<glm::vec3> copyOffsets;
+	StressGridOffsets(copyOffsets);
+
+	// both shakers are identical, so each part is drawn as
+	// one instanced group with a copy per shaker position -
+	// every shaker is its own transform group so its parts
+	// move together
+	const float shakerX[2] = { -10.0f, 10.0f };
+	std::vector<SCENE_INSTANCE> bodies;
+	std::vector<SCENE_INSTANCE> caps;
+	std::vector<SCENE_INSTANCE> rings;
+	for (const glm::vec3& offset : copyOffsets)
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			BeginTransformGroup(
+				glm::vec3(1.0f, 1.0f, 1.0f),
+				offset + glm::vec3(shakerX[i], 0.0f, 0.0f),
+				glm::vec3(0.0f, 0.0f, 0.0f));
+			bodies.push_back(MakeInstance(
+				glm::vec3(2.0f, 4.5f, 2.0f),
+				glm::vec3(0.0f, 0.75f, 0.0f),
+				glm::vec3(0.0f, 0.0f, 0.0f)));
+			caps.push_back(MakeInstance(
+				glm::vec3(1.1f, 0.6f, 1.1f),
+				glm::vec3(0.0f, 4.75f, 0.0f),
+				glm::vec3(0.0f, 0.0f, 0.0f)));
+			rings.push_back(MakeInstance(
+				glm::vec3(1.05f, 1.05f, 1.05f),
+				glm::vec3(0.0f, 4.7f, 0.0f),
+				glm::vec3(90.0f, 0.0f, 0.0f),
+				glm::vec4(0.447f, 0.447f, 0.447f, 1.0f)));
+			EndTransformGroup();
+		}
+	}
+
+	// --- Glass body ---
+	AddMeshInstanced(MeshType::TAPERED_CYLINDER, bodies,
+		"shaker", 1.0f, 1.0f, "glass", false, false, true);
+	// --- Cap --- sides and top in one call, each with its texture
+	const std::string capTextures[3] = { "", "cap_sides", "cap_top" };
+	AddMeshInstancedPerPart(MeshType::CYLINDER, caps,
+		capTextures, 1.0f, 1.0f, "metal", true, false, true);
+	// --- Base ring ---
+	AddMeshInstanced(MeshType::TORUS, rings,
+		"", 1.0f, 1.0f, "metal");
+
+	// =============================
+	// HANGING LAMP 
+	// 1) cylinder = Cord
+	// 2) cone     = Shade
+	// 3) sphere   = Bulb
+	// =============================
+	glm::vec3 lampBase = glm::vec3(0.0f, 18.5f, 0.0f);
+	float drop = 6.0f;    
+	// the shade and bulb hang at the end of the cord
+	glm::vec3 coneOffset = glm::vec3(0.0f, -(drop + 0.9f), 0.0f);
+	glm::vec4 cordCol = glm::vec4(0.55f, 0.55f, 0.55f, 1.0f);
+	glm::vec4 shadeCol = glm::vec4(0.65f, 0.65f, 0.65f, 1.0f);
+	glm::vec4 bulbCol = glm::vec4(1.00f, 0.95f, 0.75f, 1.0f);
+
+	for (const glm::vec3& offset : copyOffsets)
+	{
+		BeginTransformGroup(
+			glm::vec3(1.0f, 1.0f, 1.0f),
+			offset + lampBase,
+			glm::vec3(0.0f, 0.0f, 0.0f));
+		// --- CORD ---
+		AddMesh(
+			MeshType::CYLINDER,
+			glm::vec3(0.1f, drop, 0.1f),
+			glm::vec3(0.0f, 0.0f, 0.0f),
+			glm::vec3(180.0f, 0.0f, 0.0f),
+			cordCol,
+			"metal"
+		);
+		// --- SHADE ---
+		AddMesh(
+			MeshType::CONE,
+			glm::vec3(1.0f, 1.0f, 1.0f),
+			coneOffset,
+			glm::vec3(0.0f, 0.0f, 0.0f),
+			shadeCol,
+			"plastic",
+			false, true, false
+		);
+		// --- BULB ---
+		AddMesh(
+			MeshType::SPHERE,
+			glm::vec3(0.5f, 0.5f, 0.5f),
+			coneOffset,
+			glm::vec3(0.0f, 0.0f, 0.0f),
+			bulbCol,
+			"plastic"
+		);
+		EndTransformGroup();
+	}
+
+	// =============================
+	// WALL (plane)
+	// =============================
+	AddTexturedMesh(
+		MeshType::PLANE,
+		glm::vec3(30.0f, 1.0f, 18.0f),
+		glm::vec3(0.0f, 17.0f, -7.5f),
+		glm::vec3(90.0f, 0.0f, 0.0f),
+		"tile",
+		12.0f, 6.0f,
+		"tile",
+		true, true, true
+	);
+
+
+	// =========================================================
+	// BUTTER CHARACTER
+	// 1) box              = main body
+	// 2) cylinder         = legs and arms
+	// =========================================================
+
+	glm::vec3 butterBase = glm::vec3(0.0f, 1.5f + 1.125f, 0.0f);
+	glm::vec3 butterBodSize = glm::vec3(2.0f, 2.25f, 1.5f);
+	glm::vec3 butterBodRot = glm::vec3(0.0f, 0.0f, 0.0f);
+	glm::vec4 butterBaseColor = glm::vec4(0.95f, 0.85f, 0.25f, 1.0f);
+
+	// --- BODY --- one box with a texture on each side
+	const std::string butterFaces[MeshLibrary::BOX_FACE_COUNT] = {
+		"butter_front", "butter_back", "butter_bottom", "butter_top", "butter_right", "butter_left" };
+
+	// --- LEGS ---
+	float bodyBottomY = butterBase.y - (butterBodSize.y * 0.5f);
+	glm::vec3 legSize = glm::vec3(0.25f, bodyBottomY, 0.25f);
+	// Leg offsets - spacing under the body
+	float legOffsetX = butterBodSize.x * 0.22f;
+	float legOffsetZ = butterBodSize.z * 0.18f;
+	// the legs stand on the platform, below the center of the body
+	float legOffsetY = (legSize.y * 0.5f) - butterBase.y;
+
+	// --- ARMS ---
 	glm::vec3 armSize = glm::vec3(0.20f, 1.0f, 0.20f);
 	glm::vec3 armRot = glm::vec3(180.0f, 0.0f, 0.0f);
 	// Arm offsets: arms just outside body width(armOffsetX), forward offset so they are visible from front(armOffsetZ)
 	float armOffsetX = (butterBodSize.x * 0.5f) + (armSize.x * 0.5f) - 0.05f;
 	float armOffsetZ = butterBodSize.z * 0.15f;
 
-	// Left arm
-	DrawMesh(
-		MeshType::CYLINDER,
-		armSize,
-		glm::vec3(butterBase.x - armOffsetX, butterBase.y, butterBase.z + armOffsetZ),
-		armRot,
-		butterBaseColor,
-		"plastic"
-	);
-	// Right arm
-	DrawMesh(
-		MeshType::CYLINDER,
-		armSize,
-		glm::vec3(butterBase.x + armOffsetX, butterBase.y, butterBase.z + armOffsetZ),
-		armRot,
-		butterBaseColor,
-		"plastic"
-	);
+	// the butter is a transform group, so the limbs are placed
+	// from the center of the body and move with it.  Legs and
+	// arms share the mesh, color and material so all four limbs
+	// are drawn as one instanced group
+	std::vector<SCENE_INSTANCE> limbs;
+	for (const glm::vec3& offset : copyOffsets)
+	{
+		BeginTransformGroup(
+			glm::vec3(1.0f, 1.0f, 1.0f),
+			offset + butterBase,
+			butterBodRot);
+		AddFaceTexturedBox(
+			butterBodSize,
+			glm::vec3(0.0f, 0.0f, 0.0f),
+			glm::vec3(0.0f, 0.0f, 0.0f),
+			butterFaces,
+			1.0f, 1.0f,
+			"plastic"
+		);
+		// Left leg
+		limbs.push_back(MakeInstance(
+			legSize,
+			glm::vec3(-legOffsetX, legOffsetY, legOffsetZ),
+			glm::vec3(0.0f, 0.0f, 0.0f),
+			butterBaseColor));
+		// Right leg
+		limbs.push_back(MakeInstance(
+			legSize,
+			glm::vec3(legOffsetX, legOffsetY, legOffsetZ),
+			glm::vec3(0.0f, 0.0f, 0.0f),
+			butterBaseColor));
+		// Left arm
+		limbs.push_back(MakeInstance(
+			armSize,
+			glm::vec3(-armOffsetX, 0.0f, armOffsetZ),
+			armRot,
+			butterBaseColor));
+		// Right arm
+		limbs.push_back(MakeInstance(
+			armSize,
+			glm::vec3(armOffsetX, 0.0f, armOffsetZ),
+			armRot,
+			butterBaseColor));
+		EndTransformGroup();
+	}
+
+	AddMeshInstanced(MeshType::CYLINDER, limbs, "", 1.0f, 1.0f, "plastic");
+
+}
+
+/***********************************************************
+ *  StressGridOffsets()
+ *
+ *  This method is used for getting the position of each copy
+ *  of the props.  The copies fill rows that alternate left
+ *  and right of the original and step back behind the wall,
+ *  so the first copy stays where the scene was designed.
+ ***********************************************************/
+void SceneManager::StressGridOffsets(std::vector<glm::vec3>& offsets) const
+{
+	int columns = (int)std::ceil(std::sqrt((float)m_stressCopies));
+
+	offsets.clear();
+	for (int i = 0; i < m_stressCopies; i++)
+	{
+		int column = i % columns;
+		int row = i / columns;
+		// columns 0, 1, 2, 3, ... go to 0, +1, -1, +2, ...
+		float side = (float)((column + 1) / 2) * (((column % 2) == 1) ? 1.0f : -1.0f);
+
+		offsets.push_back(glm::vec3(side * g_StressSpacingX, 0.0f, -(float)row * g_StressSpacingZ));
+	}
+}
+
+/***********************************************************
+ *  SetStressCopies()
+ *
+ *  This method is used for setting how many copies of the
+ *  shakers, butter and lamp are placed in the scene, from 1
+ *  to MAX_STRESS_COPIES.  It takes effect when the draw list
+ *  is built in PrepareScene().
+ ***********************************************************/
+void SceneManager::SetStressCopies(int copies)
+{
+	m_stressCopies = std::max(1, std::min(copies, MAX_STRESS_COPIES));
+}
+
+/***********************************************************
+ *  ParseArguments()
+ *
+ *  This method is used for reading the scene file and the
+ *  rendering options from the command line.
+ ***********************************************************/
+void SceneManager::ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--scene") == 0) && (i + 1 < argc))
+		{
+			m_scenePath = argv[++i];
+		}
+	}
+
+	m_shadowMaps->ParseArguments(argc, argv);
+	m_textureLibrary->ParseArguments(argc, argv);
+}
+
+/***********************************************************
+ *  LoadSceneFile()
+ *
+ *  This method is used for mapping the binary cache of the
+ *  scene file, which is compiled from the JSON source first
+ *  when it is missing or older.  The cache sits next to the
+ *  source with a .scenebin extension.
+ ***********************************************************/
+bool SceneManager::LoadSceneFile()
+{
+	std::string cachePath = m_scenePath;
+	size_t extension = cachePath.find_last_of('.');
+	if ((extension != std::string::npos) && (cachePath.find_first_of("/\\", extension) == std::string::npos))
+	{
+		cachePath.erase(extension);
+	}
+	cachePath += ".scenebin";
+
+	if (m_sceneFile.Load(m_scenePath.c_str(), cachePath.c_str()) == false)
+	{
+		std::cout << "Scene file " << m_scenePath << " was not loaded, using the built-in scene" << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  LoadSceneTextures()
+ *
+ *  This method is used for loading every texture listed in
+ *  the scene file.
+ ***********************************************************/
+void SceneManager::LoadSceneTextures()
+{
+	for (uint32_t i = 0; i < m_sceneFile.TextureCount(); i++)
+	{
+		const SceneFile::TEXTURE_RECORD& texture = m_sceneFile.Texture(i);
+		CreateGLTexture(m_sceneFile.String(texture.file), m_sceneFile.String(texture.tag), (TextureQuality::Tier)texture.quality);
+	}
+}
+
+/***********************************************************
+ *  LoadSceneMaterials()
+ *
+ *  This method is used for defining the materials listed in
+ *  the scene file.
+ ***********************************************************/
+void SceneManager::LoadSceneMaterials()
+{
+	for (uint32_t i = 0; i < m_sceneFile.MaterialCount(); i++)
+	{
+		const SceneFile::MATERIAL_RECORD& record = m_sceneFile.Material(i);
+		OBJECT_MATERIAL material;
+		material.diffuseColor = glm::vec3(record.diffuseColor[0], record.diffuseColor[1], record.diffuseColor[2]);
+		material.specularColor = glm::vec3(record.specularColor[0], record.specularColor[1], record.specularColor[2]);
+		material.shininess = record.shininess;
+		material.tag = m_sceneFile.String(record.tag);
+		material.bTransparent = (record.bTransparent != 0);
+		m_objectMaterials.push_back(material);
+	}
+
+	// register the whole table with the GPU once
+	UploadMaterials();
+}
+
+/***********************************************************
+ *  LoadSceneLights()
+ *
+ *  This method is used for setting up the lights listed in
+ *  the scene file.  There can be any number of point lights,
+ *  and one directional and one spot light.
+ ***********************************************************/
+void SceneManager::LoadSceneLights()
+{
+	if (NULL == m_pShaderManager) return; // safety check
+
+	m_uniformCache.SetBool(m_uniforms.useLighting, true);
+
+	UniformBlocks::LIGHT_BLOCK& lights = m_lights;
+	lights = UniformBlocks::LIGHT_BLOCK();
+	m_pointLights.clear();
+	for (uint32_t i = 0; i < m_sceneFile.LightCount(); i++)
+	{
+		const SceneFile::LIGHT_RECORD& record = m_sceneFile.Light(i);
+		glm::vec3 position(record.position[0], record.position[1], record.position[2]);
+		glm::vec3 direction(record.direction[0], record.direction[1], record.direction[2]);
+		glm::vec3 ambient(record.ambient[0], record.ambient[1], record.ambient[2]);
+		glm::vec3 diffuse(record.diffuse[0], record.diffuse[1], record.diffuse[2]);
+		glm::vec3 specular(record.specular[0], record.specular[1], record.specular[2]);
+
+		if (record.type == SceneFile::LIGHT_POINT)
+		{
+			ClusteredLights::POINT_LIGHT pointLight;
+			pointLight.position = position;
+			pointLight.range = record.range;
+			pointLight.ambient = ambient;
+			pointLight.diffuse = diffuse;
+			pointLight.specular = specular;
+			m_pointLights.push_back(pointLight);
+		}
+		else if (record.type == SceneFile::LIGHT_DIRECTIONAL)
+		{
+			lights.directionalLight.direction = direction;
+			lights.directionalLight.ambient = ambient;
+			lights.directionalLight.diffuse = diffuse;
+			lights.directionalLight.specular = specular;
+			lights.directionalLight.bActive = true;
+		}
+		else if (record.type == SceneFile::LIGHT_SPOT)
+		{
+			lights.spotLight.position = position;
+			lights.spotLight.direction = direction;
+			lights.spotLight.cutOff = std::cos(glm::radians(record.cutOff));
+			lights.spotLight.outerCutOff = std::cos(glm::radians(record.outerCutOff));
+			lights.spotLight.constant = g_SpotConstant;
+			lights.spotLight.linear = g_SpotLinear;
+			lights.spotLight.quadratic = g_SpotQuadratic;
+			lights.spotLight.ambient = ambient;
+			lights.spotLight.diffuse = diffuse;
+			lights.spotLight.specular = specular;
+			lights.spotLight.bActive = true;
+		}
+		else
+		{
+			std::cout << "Scene light " << i << " was skipped" << std::endl;
+		}
+	}
+
+	ApplySceneLights();
+}
+
+/***********************************************************
+ *  BuildSceneDrawList()
+ *
+ *  This method is used for recording the objects of the
+ *  scene file into the retained draw list.  The tags in the
+ *  records are resolved once here, like the built-in scene.
+ *  Objects and groups marked to replicate get a copy on
+ *  every point of the stress grid.  The instances of each
+ *  instanced record are collected over every copy and added
+ *  as one group at the end.
+ ***********************************************************/
+void SceneManager::BuildSceneDrawList()
+{
+	std::vector<glm::vec3> copyOffsets;
+	StressGridOffsets(copyOffsets);
+	const std::vector<glm::vec3> noOffset(1, glm::vec3(0.0f, 0.0f, 0.0f));
+
+	std::vector<std::vector<SCENE_INSTANCE>> instances(m_sceneFile.DrawCount());
+
+	uint32_t index = 0;
+	while (index < m_sceneFile.DrawCount())
+	{
+		const SceneFile::DRAW_RECORD& record = m_sceneFile.Draw(index);
+		if (record.parent != SceneFile::NO_PARENT)
+		{
+			std::cout << "Scene object " << index << " is not inside its group and was skipped" << std::endl;
+			index++;
+			continue;
+		}
+
+		const std::vector<glm::vec3>& offsets = ((record.flags & SceneFile::DRAW_FLAG_REPLICATE) != 0) ? copyOffsets : noOffset;
+		uint32_t next = index + 1;
+		for (const glm::vec3& offset : offsets)
+		{
+			next = BuildSceneObject(index, offset, instances);
+		}
+		index = next;
+	}
+
+	for (uint32_t i = 0; i < m_sceneFile.DrawCount(); i++)
+	{
+		if (instances[i].empty())
+		{
+			continue;
+		}
+
+		const SceneFile::DRAW_RECORD& record = m_sceneFile.Draw(i);
+		MeshType type = (MeshType)record.mesh;
+		std::string materialTag = m_sceneFile.String(record.material);
+		bool top = (record.flags & SceneFile::DRAW_FLAG_TOP) != 0;
+		bool bottom = (record.flags & SceneFile::DRAW_FLAG_BOTTOM) != 0;
+		bool sides = (record.flags & SceneFile::DRAW_FLAG_SIDES) != 0;
+
+		if (record.kind == SceneFile::DRAW_INSTANCED_PER_PART)
+		{
+			const std::string partTextures[3] = {
+				m_sceneFile.String(record.textures[0]),
+				m_sceneFile.String(record.textures[1]),
+				m_sceneFile.String(record.textures[2]) };
+			AddMeshInstancedPerPart(type, instances[i], partTextures,
+				record.uvTile[0], record.uvTile[1], materialTag, top, bottom, sides);
+		}
+		else
+		{
+			AddMeshInstanced(type, instances[i], m_sceneFile.String(record.textures[0]),
+				record.uvTile[0], record.uvTile[1], materialTag, top, bottom, sides);
+		}
+	}
+}
 
+/***********************************************************
+ *  BuildSceneObject()
+ *
+ *  This method is used for recording one copy of a scene
+ *  file object, and of every object inside it when it is a
+ *  group.  The offset moves the copy onto the stress grid.
+ *  Returns the index of the record after the object and
+ *  everything inside it.
+ ***********************************************************/
+uint32_t SceneManager::BuildSceneObject(uint32_t index, const glm::vec3& offset, std::vector<std::vector<SCENE_INSTANCE>>& instances)
+{
+	const SceneFile::DRAW_RECORD& record = m_sceneFile.Draw(index);
+	glm::vec3 scale(record.scale[0], record.scale[1], record.scale[2]);
+	glm::vec3 position = offset + glm::vec3(record.position[0], record.position[1], record.position[2]);
+	glm::vec3 rotation(record.rotation[0], record.rotation[1], record.rotation[2]);
+
+	if (record.kind == SceneFile::DRAW_GROUP)
+	{
+		BeginTransformGroup(scale, position, rotation);
+		uint32_t next = index + 1;
+		while ((next < m_sceneFile.DrawCount()) && (m_sceneFile.Draw(next).parent == index))
+		{
+			next = BuildSceneObject(next, glm::vec3(0.0f, 0.0f, 0.0f), instances);
+		}
+		EndTransformGroup();
+		return(next);
+	}
+
+	MeshType type = (MeshType)record.mesh;
+	glm::vec4 color(record.color[0], record.color[1], record.color[2], record.color[3]);
+	std::string materialTag = m_sceneFile.String(record.material);
+	bool top = (record.flags & SceneFile::DRAW_FLAG_TOP) != 0;
+	bool bottom = (record.flags & SceneFile::DRAW_FLAG_BOTTOM) != 0;
+	bool sides = (record.flags & SceneFile::DRAW_FLAG_SIDES) != 0;
+
+	if ((record.kind == SceneFile::DRAW_INSTANCED) || (record.kind == SceneFile::DRAW_INSTANCED_PER_PART))
+	{
+		// the instances are placed in the object's group, and the
+		// group itself is added once every copy is collected
+		for (uint32_t n = 0; n < record.instanceCount; n++)
+		{
+			const SceneFile::INSTANCE_RECORD& instance = m_sceneFile.Instance(record.firstInstance + n);
+			instances[index].push_back(MakeInstance(
+				glm::vec3(instance.scale[0], instance.scale[1], instance.scale[2]),
+				offset + glm::vec3(instance.position[0], instance.position[1], instance.position[2]),
+				glm::vec3(instance.rotation[0], instance.rotation[1], instance.rotation[2]),
+				glm::vec4(instance.color[0], instance.color[1], instance.color[2], instance.color[3])));
+		}
+	}
+	else if (record.kind == SceneFile::DRAW_FACE_BOX)
+	{
+		std::string faceTextures[MeshLibrary::BOX_FACE_COUNT];
+		for (int face = 0; face < MeshLibrary::BOX_FACE_COUNT; face++)
+		{
+			faceTextures[face] = m_sceneFile.String(record.textures[face]);
+		}
+		AddFaceTexturedBox(scale, position, rotation, faceTextures,
+			record.uvTile[0], record.uvTile[1], materialTag);
+	}
+	else if (record.kind == SceneFile::DRAW_TEXTURED_MESH)
+	{
+		AddTexturedMesh(type, scale, position, rotation, m_sceneFile.String(record.textures[0]),
+			record.uvTile[0], record.uvTile[1], materialTag, top, bottom, sides);
+	}
+	else
+	{
+		AddMesh(type, scale, position, rotation, color, materialTag, top, bottom, sides);
+	}
+
+	return(index + 1);
 }
 
 // lighting and material setup
@@ -673,6 +2926,7 @@ void SceneManager::DefineObjectMaterials()
 	plastic.specularColor = glm::vec3(0.15f, 0.15f, 0.15f);
 	plastic.shininess = 8.0f;
 	plastic.tag = "plastic";
+	plastic.bTransparent = false;
 	m_objectMaterials.push_back(plastic);
 
 	OBJECT_MATERIAL tileMaterial;
@@ -680,6 +2934,7 @@ void SceneManager::DefineObjectMaterials()
 	tileMaterial.specularColor = glm::vec3(0.75f, 0.75f, 0.75f);
 	tileMaterial.shininess = 32.0f;
 	tileMaterial.tag = "tile";
+	tileMaterial.bTransparent = false;
 	m_objectMaterials.push_back(tileMaterial);
 
 	OBJECT_MATERIAL metal;
@@ -687,6 +2942,7 @@ void SceneManager::DefineObjectMaterials()
 	metal.specularColor = glm::vec3(0.90f, 0.90f, 0.90f);
 	metal.shininess = 64.0f;
 	metal.tag = "metal";
+	metal.bTransparent = false;
 	m_objectMaterials.push_back(metal);
 
 	OBJECT_MATERIAL woodMaterial;
@@ -694,6 +2950,7 @@ void SceneManager::DefineObjectMaterials()
 	woodMaterial.specularColor = glm::vec3(0.1f, 0.2f, 0.2f);
 	woodMaterial.shininess = 1.0;
 	woodMaterial.tag = "wood";
+	woodMaterial.bTransparent = false;
 	m_objectMaterials.push_back(woodMaterial);
 
 	OBJECT_MATERIAL glassMaterial;
@@ -701,8 +2958,13 @@ void SceneManager::DefineObjectMaterials()
 	glassMaterial.specularColor = glm::vec3(0.9f, 0.9f, 0.8f);
 	glassMaterial.shininess = 10.0;
 	glassMaterial.tag = "glass";
+	// the shaker bodies are drawn see-through in the transparent pass
+	glassMaterial.bTransparent = true;
 	m_objectMaterials.push_back(glassMaterial);
 
+	// register the whole table with the GPU once
+	UploadMaterials();
+
 }
 
 void SceneManager::SetupSceneLights()
@@ -710,45 +2972,606 @@ void SceneManager::SetupSceneLights()
 
 	if (NULL == m_pShaderManager) return; // safety check
 
-	m_pShaderManager->setBoolValue(g_UseLightingName, true);
+	m_uniformCache.SetBool(m_uniforms.useLighting, true);
+
+	// every light starts switched off - only the ones set below are used
+	m_lights = UniformBlocks::LIGHT_BLOCK();
+	m_pointLights.clear();
 
 	// Light 0: hanging lamp
-	m_pShaderManager->setVec3Value("pointLights[0].position", 0.0f, 11.05f, 2.0f);
-	m_pShaderManager->setVec3Value("pointLights[0].ambient", 0.05f, 0.04f, 0.03f);
-	m_pShaderManager->setVec3Value("pointLights[0].diffuse", 1.00f, 0.85f, 0.55f); 
-	m_pShaderManager->setVec3Value("pointLights[0].specular", 0.25f, 0.22f, 0.18f);
-	m_pShaderManager->setBoolValue("pointLights[0].bActive", true);
+	ClusteredLights::POINT_LIGHT lamp;
+	lamp.position = glm::vec3(0.0f, 11.05f, 2.0f);
+	lamp.range = 60.0f;
+	lamp.ambient = glm::vec3(0.05f, 0.04f, 0.03f);
+	lamp.diffuse = glm::vec3(1.00f, 0.85f, 0.55f);
+	lamp.specular = glm::vec3(0.25f, 0.22f, 0.18f);
+	m_pointLights.push_back(lamp);
 
 	// Light 1: soft fill
-	m_pShaderManager->setVec3Value("pointLights[1].position", 0.0f, 2.5f, 4.0f);
-	m_pShaderManager->setVec3Value("pointLights[1].ambient", 0.03f, 0.03f, 0.03f);
-	m_pShaderManager->setVec3Value("pointLights[1].diffuse", 0.45f, 0.45f, 0.45f);
-	m_pShaderManager->setVec3Value("pointLights[1].specular", 0.10f, 0.10f, 0.10f);
-	m_pShaderManager->setBoolValue("pointLights[1].bActive", true);
+	ClusteredLights::POINT_LIGHT fill;
+	fill.position = glm::vec3(0.0f, 2.5f, 4.0f);
+	fill.range = 30.0f;
+	fill.ambient = glm::vec3(0.03f, 0.03f, 0.03f);
+	fill.diffuse = glm::vec3(0.45f, 0.45f, 0.45f);
+	fill.specular = glm::vec3(0.10f, 0.10f, 0.10f);
+	m_pointLights.push_back(fill);
+
+	ApplySceneLights();
+
+}
+
+/***********************************************************
+ *  ApplySceneLights()
+ *
+ *  This method is used for handing every point light to the
+ *  clusters, picking the lighting permutation and uploading
+ *  the light block.  The block only has room for the first
+ *  TOTAL_POINT_LIGHTS point lights, which the base program
+ *  falls back to - the permutations read all of them from
+ *  the clusters.
+ ***********************************************************/
+void SceneManager::ApplySceneLights()
+{
+	int lightingFlags = ShaderPermutations::PERMUTATION_LIGHTING;
+	UniformBlocks::LIGHT_BLOCK& lights = m_lights;
+	m_bLightsDirty = false;
+
+	int activePointLights = std::min((int)m_pointLights.size(), TOTAL_POINT_LIGHTS);
+	for (int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+	{
+		lights.pointLights[i] = UniformBlocks::POINT_LIGHT();
+		if (i < activePointLights)
+		{
+			lights.pointLights[i].position = m_pointLights[i].position;
+			lights.pointLights[i].range = m_pointLights[i].range;
+			lights.pointLights[i].ambient = m_pointLights[i].ambient;
+			lights.pointLights[i].diffuse = m_pointLights[i].diffuse;
+			lights.pointLights[i].specular = m_pointLights[i].specular;
+			lights.pointLights[i].bActive = true;
+		}
+	}
+	if (lights.directionalLight.bActive)
+	{
+		lightingFlags |= ShaderPermutations::PERMUTATION_DIRECTIONAL_LIGHT;
+	}
+	if (lights.spotLight.bActive)
+	{
+		lightingFlags |= ShaderPermutations::PERMUTATION_SPOT_LIGHT;
+	}
+
+	// the first point light - the lamp - and the directional light
+	// cast shadows; the maps are kept when the lights have not moved
+	m_shadowMaps->SetPointLight(activePointLights > 0, lights.pointLights[0].position, lights.pointLights[0].range);
+	m_shadowMaps->SetDirectionalLight(lights.directionalLight.bActive != 0, lights.directionalLight.direction);
+	if (m_shadowMaps->HasMap(ShadowMaps::POINT_SHADOW))
+	{
+		lightingFlags |= ShaderPermutations::PERMUTATION_POINT_SHADOW;
+	}
+	if (m_shadowMaps->HasMap(ShadowMaps::DIRECTIONAL_SHADOW))
+	{
+		lightingFlags |= ShaderPermutations::PERMUTATION_DIRECTIONAL_SHADOW;
+	}
 
+	// the permutations read every point light from the clusters
+	m_clusteredLights->Clear();
+	for (size_t i = 0; i < m_pointLights.size(); i++)
+	{
+		m_clusteredLights->AddPointLight(m_pointLights[i]);
+	}
+	if (m_clusteredLights->Count() > 0)
+	{
+		lightingFlags |= ShaderPermutations::PERMUTATION_CLUSTERED_LIGHTS;
+		activePointLights = 0;
+	}
+	m_lightingPermutation = ShaderPermutations::MakeKey(lightingFlags, activePointLights);
+	// the draws pick their permutations again for the new lights
+	m_bRenderQueueDirty = true;
+
+	// upload every light with a single buffer write
+	if (NULL != m_pUniformBlocks)
+	{
+		m_pUniformBlocks->UpdateLights(lights);
+	}
 }
 
 //* Helper functions.
-void SceneManager::DrawTexturedMesh(MeshType type, glm::vec3 scale, glm::vec3 pos, glm::vec3 rot, const std::string& textureTag, float uTile, float vTile, const std::string& materialTag, bool top, bool bottom, bool sides)
+int SceneManager::AddTexturedMesh(MeshType type, glm::vec3 scale, glm::vec3 pos, glm::vec3 rot, const std::string& textureTag, float uTile, float vTile, const std::string& materialTag, bool top, bool bottom, bool sides)
+{
+	DRAW_ITEM item;
+	item.mesh = type;
+	item.node = AddTransformNode(scale, pos, rot);
+	item.model = m_transforms.World(item.node);
+	item.normalMatrix = BuildNormalMatrix(item.model);
+	item.color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	item.uvScale = glm::vec2(uTile, vTile);
+	item.textureIndex = FindTextureIndex(textureTag);
+	item.materialIndex = ResolveMaterialIndex(materialTag);
+	item.bFaceTextures = false;
+	for (int face = 0; face < MeshLibrary::BOX_FACE_COUNT; face++)
+	{
+		item.faceTextures[face] = -1;
+	}
+	item.top = top;
+	item.bottom = bottom;
+	item.sides = sides;
+	item.bDirty = false;
+	item.bTransparent = IsTransparent(item.materialIndex, item.color.a);
+	item.boundsIndex = m_frustumCuller.Add(glm::vec3(0.0f, 0.0f, 0.0f), 0.0f);
+	UpdateDrawBounds(item);
+
+	m_drawList.push_back(item);
+	AddNodeOwner(item.node, (int)m_drawList.size() - 1, -1, -1);
+	m_bRenderQueueDirty = true;
+	return((int)m_drawList.size() - 1);
+}
+
+bool SceneManager::ResolveFaceTextures(const std::string faceTextureTags[MeshLibrary::BOX_FACE_COUNT], int faceTextures[MeshLibrary::BOX_FACE_COUNT])
+{
+	// the faces pick their layer in the shader, so every texture
+	// must be a layer of the same array
+	bool bSameArray = true;
+	for (int face = 0; face < MeshLibrary::BOX_FACE_COUNT; face++)
+	{
+		faceTextures[face] = FindTextureIndex(faceTextureTags[face]);
+		if (faceTextures[face] < 0)
+		{
+			bSameArray = false;
+		}
+		else if ((faceTextures[0] >= 0) &&
+			(m_textureLibrary->Info(faceTextures[face]).arrayIndex != m_textureLibrary->Info(faceTextures[0]).arrayIndex))
+		{
+			bSameArray = false;
+		}
+	}
+
+	return(bSameArray);
+}
+
+int SceneManager::AddFaceTexturedBox(glm::vec3 scale, glm::vec3 pos, glm::vec3 rot, const std::string faceTextureTags[MeshLibrary::BOX_FACE_COUNT], float uTile, float vTile, const std::string& materialTag)
+{
+	int faceTextures[MeshLibrary::BOX_FACE_COUNT];
+	if ((m_meshLibrary->IsLoaded(MeshLibrary::ShapeType::BOX) == false) ||
+		(ResolveFaceTextures(faceTextureTags, faceTextures) == false))
+	{
+		// draw the faces one at a time instead
+		std::cout << "Box face textures " << faceTextureTags[0] << "... are not in one texture array, drawing each face separately" << std::endl;
+		const MeshType faceMeshes[MeshLibrary::BOX_FACE_COUNT] = {
+			MeshType::BOX_FRONT, MeshType::BOX_BACK, MeshType::BOX_BOTTOM, MeshType::BOX_TOP, MeshType::BOX_RIGHT, MeshType::BOX_LEFT };
+		int first = -1;
+		for (int face = 0; face < MeshLibrary::BOX_FACE_COUNT; face++)
+		{
+			int index = AddTexturedMesh(faceMeshes[face], scale, pos, rot, faceTextureTags[face], uTile, vTile, materialTag);
+			if (first < 0)
+			{
+				first = index;
+			}
+		}
+		return(first);
+	}
+
+	int index = AddTexturedMesh(MeshType::BOX, scale, pos, rot, faceTextureTags[0], uTile, vTile, materialTag);
+	DRAW_ITEM& item = m_drawList[index];
+	item.bFaceTextures = true;
+	for (int face = 0; face < MeshLibrary::BOX_FACE_COUNT; face++)
+	{
+		item.faceTextures[face] = faceTextures[face];
+	}
+	return(index);
+}
+
+int SceneManager::AddMesh(MeshType type, glm::vec3 scale, glm::vec3 pos, glm::vec3 rot, glm::vec4 col, const std::string& materialTag, bool top, bool bottom, bool sides)
+{
+	DRAW_ITEM item;
+	item.mesh = type;
+	item.node = AddTransformNode(scale, pos, rot);
+	item.model = m_transforms.World(item.node);
+	item.normalMatrix = BuildNormalMatrix(item.model);
+	item.color = col;
+	item.uvScale = glm::vec2(1.0f, 1.0f);
+	item.textureIndex = -1;
+	item.materialIndex = ResolveMaterialIndex(materialTag);
+	item.bFaceTextures = false;
+	for (int face = 0; face < MeshLibrary::BOX_FACE_COUNT; face++)
+	{
+		item.faceTextures[face] = -1;
+	}
+	item.top = top;
+	item.bottom = bottom;
+	item.sides = sides;
+	item.bDirty = false;
+	item.bTransparent = IsTransparent(item.materialIndex, item.color.a);
+	item.boundsIndex = m_frustumCuller.Add(glm::vec3(0.0f, 0.0f, 0.0f), 0.0f);
+	UpdateDrawBounds(item);
+
+	m_drawList.push_back(item);
+	AddNodeOwner(item.node, (int)m_drawList.size() - 1, -1, -1);
+	m_bRenderQueueDirty = true;
+	return((int)m_drawList.size() - 1);
+}
+
+int SceneManager::AddMeshInstanced(MeshType type, const std::vector<SCENE_INSTANCE>& instances, const std::string& textureTag, float uTile, float vTile, const std::string& materialTag, bool top, bool bottom, bool sides)
+{
+	MeshLibrary::ShapeType shape;
+	if (LibraryShape(type, shape) == false)
+	{
+		std::cout << "Instanced drawing is not implemented for mesh type " << (int)type << std::endl;
+		return(-1);
+	}
+
+	INSTANCE_GROUP group;
+	group.mesh = type;
+	group.batch = m_meshLibrary->CreateInstanceBatch(shape);
+	for (const SCENE_INSTANCE& instance : instances)
+	{
+		group.instances.push_back(instance.data);
+		group.nodes.push_back(instance.node);
+	}
+	group.uvScale = glm::vec2(uTile, vTile);
+	group.textureIndex = textureTag.empty() ? -1 : FindTextureIndex(textureTag);
+	group.materialIndex = ResolveMaterialIndex(materialTag);
+	group.bTransparent = IsTransparent(group.materialIndex, 1.0f);
+	for (size_t i = 0; i < group.instances.size(); i++)
+	{
+		group.instances[i].materialIndex = group.materialIndex;
+		// untextured groups use the per-instance colors
+		if ((group.textureIndex < 0) && (group.instances[i].color.a < 1.0f))
+		{
+			group.bTransparent = true;
+		}
+	}
+	group.partMask = LibraryPartMask(type, top, bottom, sides);
+	group.bFaceTextures = false;
+	for (int face = 0; face < MeshLibrary::BOX_FACE_COUNT; face++)
+	{
+		group.faceTextures[face] = -1;
+	}
+	group.bDirty = true;
+	group.bBoundsDirty = false;
+
+	if (group.batch < 0)
+	{
+		return(-1);
+	}
+
+	group.boundsIndex = m_frustumCuller.Add(glm::vec3(0.0f, 0.0f, 0.0f), 0.0f);
+	UpdateGroupBounds(group);
+
+	m_instanceGroups.push_back(group);
+	int index = (int)m_instanceGroups.size() - 1;
+	for (size_t i = 0; i < group.nodes.size(); i++)
+	{
+		AddNodeOwner(group.nodes[i], -1, index, (int)i);
+	}
+	m_bRenderQueueDirty = true;
+	return(index);
+}
+
+int SceneManager::AddMeshInstancedPerPart(MeshType type, const std::vector<SCENE_INSTANCE>& instances, const std::string partTextureTags[3], float uTile, float vTile, const std::string& materialTag, bool top, bool bottom, bool sides)
+{
+	// a part that is not drawn is never sampled, so it borrows the
+	// texture of one that is
+	const bool bDrawn[3] = { bottom, sides, top };
+	std::string fallbackTag;
+	for (int part = 2; part >= 0; part--)
+	{
+		if (bDrawn[part] && (partTextureTags[part].empty() == false))
+		{
+			fallbackTag = partTextureTags[part];
+		}
+	}
+	std::string tags[3];
+	for (int part = 0; part < 3; part++)
+	{
+		tags[part] = (bDrawn[part] && (partTextureTags[part].empty() == false)) ? partTextureTags[part] : fallbackTag;
+	}
+
+	// the caps sample the bottom and top faces, the sides the rest
+	const std::string faceTextureTags[MeshLibrary::BOX_FACE_COUNT] = {
+		tags[1], tags[1], tags[0], tags[2], tags[1], tags[1] };
+	int faceTextures[MeshLibrary::BOX_FACE_COUNT];
+	if (ResolveFaceTextures(faceTextureTags, faceTextures) == false)
+	{
+		// one group per drawn part instead
+		std::cout << "Part textures " << fallbackTag << "... are not in one texture array, drawing each part separately" << std::endl;
+		int first = -1;
+		for (int part = 0; part < 3; part++)
+		{
+			if (bDrawn[part] == false)
+			{
+				continue;
+			}
+			int index = AddMeshInstanced(type, instances, tags[part], uTile, vTile, materialTag, part == 2, part == 0, part == 1);
+			if (first < 0)
+			{
+				first = index;
+			}
+		}
+		return(first);
+	}
+
+	int index = AddMeshInstanced(type, instances, fallbackTag, uTile, vTile, materialTag, top, bottom, sides);
+	if (index < 0)
+	{
+		return(-1);
+	}
+
+	INSTANCE_GROUP& group = m_instanceGroups[index];
+	group.bFaceTextures = true;
+	for (int face = 0; face < MeshLibrary::BOX_FACE_COUNT; face++)
+	{
+		group.faceTextures[face] = faceTextures[face];
+	}
+	return(index);
+}
+
+SceneManager::SCENE_INSTANCE SceneManager::MakeInstance(glm::vec3 scale, glm::vec3 pos, glm::vec3 rot, glm::vec4 col)
+{
+	SCENE_INSTANCE instance;
+	instance.node = AddTransformNode(scale, pos, rot);
+	instance.data.model = m_transforms.World(instance.node);
+	instance.data.normalMatrix = BuildNormalMatrix(instance.data.model);
+	instance.data.color = col;
+	instance.data.materialIndex = g_DefaultMaterialIndex;
+	return(instance);
+}
+
+/***********************************************************
+ *  BeginTransformGroup()
+ *
+ *  This method is used for adding a transform node that the
+ *  objects and instances added after it are placed relative
+ *  to, until the matching EndTransformGroup().  Groups can
+ *  be nested.
+ ***********************************************************/
+int SceneManager::BeginTransformGroup(glm::vec3 scale, glm::vec3 pos, glm::vec3 rot)
+{
+	int node = AddTransformNode(scale, pos, rot);
+	m_transformParents.push_back(node);
+	return(node);
+}
+
+/***********************************************************
+ *  EndTransformGroup()
+ *
+ *  This method is used for closing the current transform
+ *  group.
+ ***********************************************************/
+void SceneManager::EndTransformGroup()
+{
+	if (m_transformParents.empty() == false)
+	{
+		m_transformParents.pop_back();
+	}
+}
+
+/***********************************************************
+ *  AddTransformNode()
+ *
+ *  This method is used for adding a transform node in the
+ *  current transform group.  Nodes are only ever added below
+ *  the open groups, which keeps the hierarchy in depth-first
+ *  order.
+ ***********************************************************/
+int SceneManager::AddTransformNode(glm::vec3 scale, glm::vec3 pos, glm::vec3 rot)
+{
+	int parent = m_transformParents.empty() ? TransformHierarchy::NO_PARENT : m_transformParents.back();
+	return(m_transforms.AddNode(parent, scale, TransformHierarchy::EulerRotation(rot), pos));
+}
+
+/***********************************************************
+ *  AddNodeOwner()
+ *
+ *  This method is used for recording the draw or instance
+ *  placed by a transform node.  The first owner is kept with
+ *  the node, any others are chained after it.
+ ***********************************************************/
+void SceneManager::AddNodeOwner(int node, int drawItem, int group, int instance)
+{
+	if (node < 0)
+	{
+		return;
+	}
+
+	const NODE_OWNER noOwner = { -1, -1, -1, -1 };
+	if ((int)m_nodeOwners.size() <= node)
+	{
+		m_nodeOwners.resize(m_transforms.Count(), noOwner);
+	}
+
+	NODE_OWNER& owner = m_nodeOwners[node];
+	if ((owner.drawItem < 0) && (owner.group < 0))
+	{
+		owner.drawItem = drawItem;
+		owner.group = group;
+		owner.instance = instance;
+		return;
+	}
+
+	NODE_OWNER shared = { drawItem, group, instance, owner.nextOwner };
+	owner.nextOwner = (int)m_sharedOwners.size();
+	m_sharedOwners.push_back(shared);
+}
+
+/***********************************************************
+ *  FindGroupOwner()
+ *
+ *  This method is used for finding the owner of a transform
+ *  node that places an instance in the passed in group.
+ ***********************************************************/
+SceneManager::NODE_OWNER* SceneManager::FindGroupOwner(int node, int group)
+{
+	if ((node < 0) || (node >= (int)m_nodeOwners.size()))
+	{
+		return(NULL);
+	}
+
+	NODE_OWNER* pOwner = &m_nodeOwners[node];
+	while (NULL != pOwner)
+	{
+		if (pOwner->group == group)
+		{
+			return(pOwner);
+		}
+		pOwner = (pOwner->nextOwner >= 0) ? &m_sharedOwners[pOwner->nextOwner] : NULL;
+	}
+
+	return(NULL);
+}
+
+/***********************************************************
+ *  UpdateTransforms()
+ *
+ *  This method is used for rebuilding the world matrices of
+ *  the nodes that moved, with every node below them, and
+ *  passing them on.  Draws are marked dirty so their normal
+ *  matrix and bounds are rebuilt, and the matrices of moved
+ *  instances are written into their group, which is then
+ *  uploaded once.
+ ***********************************************************/
+void SceneManager::UpdateTransforms()
+{
+	if (m_transforms.Update() == 0)
+	{
+		return;
+	}
+
+	// every node places its own draws and instances, so the matrix
+	// writes are split over the job system
+	const std::vector<int>& changedNodes = m_transforms.ChangedNodes();
+	RunParallel((int)changedNodes.size(), g_RefreshGrainSize,
+		[this, &changedNodes](int begin, int end, int)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				int node = changedNodes[i];
+				if (node >= (int)m_nodeOwners.size())
+				{
+					continue;
+				}
+
+				const NODE_OWNER* pOwner = &m_nodeOwners[node];
+				while (NULL != pOwner)
+				{
+					if (pOwner->drawItem >= 0)
+					{
+						m_drawList[pOwner->drawItem].bDirty = true;
+					}
+					if (pOwner->group >= 0)
+					{
+						MeshLibrary::INSTANCE_DATA& instance = m_instanceGroups[pOwner->group].instances[pOwner->instance];
+						instance.model = m_transforms.World(node);
+						instance.normalMatrix = BuildNormalMatrix(instance.model);
+					}
+					pOwner = (pOwner->nextOwner >= 0) ? &m_sharedOwners[pOwner->nextOwner] : NULL;
+				}
+			}
+		});
+
+	// groups are shared between nodes, so they are marked here -
+	// the bounds still hold where the objects were, which is
+	// where their old shadows are
+	for (int node : changedNodes)
+	{
+		if (node >= (int)m_nodeOwners.size())
+		{
+			continue;
+		}
+
+		const NODE_OWNER* pOwner = &m_nodeOwners[node];
+		while (NULL != pOwner)
+		{
+			int boundsIndex = -1;
+			if (pOwner->drawItem >= 0)
+			{
+				boundsIndex = m_drawList[pOwner->drawItem].boundsIndex;
+			}
+			if (pOwner->group >= 0)
+			{
+				m_instanceGroups[pOwner->group].bDirty = true;
+				m_instanceGroups[pOwner->group].bBoundsDirty = true;
+				boundsIndex = m_instanceGroups[pOwner->group].boundsIndex;
+			}
+			if (boundsIndex >= 0)
+			{
+				m_shadowMaps->InvalidateSphere(m_frustumCuller.Center(boundsIndex), m_frustumCuller.Radius(boundsIndex));
+				m_movedBounds.push_back(boundsIndex);
+			}
+			pOwner = (pOwner->nextOwner >= 0) ? &m_sharedOwners[pOwner->nextOwner] : NULL;
+		}
+	}
+
+	for (INSTANCE_GROUP& group : m_instanceGroups)
+	{
+		if (group.bBoundsDirty)
+		{
+			UpdateGroupBounds(group);
+			group.bBoundsDirty = false;
+		}
+	}
+	m_bRenderQueueDirty = true;
+}
+
+void SceneManager::DrawMeshInstanced(INSTANCE_GROUP& group)
 {
-	SetShaderTexture(textureTag);
-	SetTextureUVScale(uTile, vTile);
-	SetTransformations(scale, rot.x, rot.y, rot.z, pos);
-	draw(type, top, bottom, sides);	
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	RefreshInstanceGroup(group);
+
+	if (group.textureIndex >= 0)
+	{
+		ApplyDrawTextureState(group.textureIndex, group.uvScale, group.bFaceTextures ? group.faceTextures : NULL);
+	}
+	else
+	{
+		ApplyColorState(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), false);
+	}
+
+	// instanced draws read the material index from the instance buffer
+	ApplyInstancingState(true);
+	m_renderStats.drawCalls += m_meshLibrary->DrawInstanceBatch(group.batch, group.partMask, InstanceGroupLod(group));
 }
 
-void SceneManager::DrawMesh(MeshType type, glm::vec3 scale, glm::vec3 pos, glm::vec3 rot, glm::vec4 col, const std::string& materialTag, bool top, bool bottom, bool sides)
+void SceneManager::SubmitDrawItem(const DRAW_ITEM& item)
 {
-	SetTransformations(scale, rot.x, rot.y, rot.z, pos);
-	
-		SetShaderColor(col.r, col.g, col.b, col.a);
-	
-		SetShaderMaterial(materialTag);
-	draw(type);
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	if (item.textureIndex >= 0)
+	{
+		ApplyDrawTextureState(item.textureIndex, item.uvScale, item.bFaceTextures ? item.faceTextures : NULL);
+	}
+	else
+	{
+		ApplyColorState(item.color);
+	}
+
+	ApplyMaterialState(item.materialIndex);
+	ApplyInstancingState(false);
+	m_uniformCache.SetMat4(m_uniforms.model, item.model);
+	m_uniformCache.SetMat3(m_uniforms.normalMatrix, item.normalMatrix);
+	m_renderStats.drawCalls += draw(item.mesh, item.top, item.bottom, item.sides, DrawItemLod(item));
 }
 
-void SceneManager::draw(MeshType type, bool top, bool bottom, bool sides)
+int SceneManager::draw(MeshType type, bool top, bool bottom, bool sides, int lod)
 {
+	if (IsEmptyDraw(type, top, bottom, sides))
+	{
+		return(0);
+	}
+
+	// shapes in the mesh library come from the atlas, with the
+	// round ones at every level of detail
+	MeshLibrary::ShapeType shape;
+	if (LibraryShape(type, shape) && m_meshLibrary->IsLoaded(shape))
+	{
+		return(m_meshLibrary->DrawMesh(shape, LibraryPartMask(type, top, bottom, sides), lod));
+	}
+
 	switch (type)
 	{
 	case MeshType::PLANE:            m_basicMeshes->DrawPlaneMesh(); break;
@@ -768,5 +3591,7 @@ void SceneManager::draw(MeshType type, bool top, bool bottom, bool sides)
 	case MeshType::TAPERED_CYLINDER: m_basicMeshes->DrawTaperedCylinderMesh(top, bottom, sides); break;
 	case MeshType::TORUS:            m_basicMeshes->DrawTorusMesh(); break;
 	}
+
+	return(1);
 }
 
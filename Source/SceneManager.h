@@ -11,6 +11,20 @@
 
 #include "ShaderManager.h"
 #include "ShapeMeshes.h"
+#include "MeshLibrary.h"
+#include "UniformCache.h"
+#include "UniformBlocks.h"
+#include "RenderQueue.h"
+#include "TextureLibrary.h"
+#include "ShaderPermutations.h"
+#include "ClusteredLights.h"
+#include "ShadowMaps.h"
+#include "FrustumCuller.h"
+#include "Profiler.h"
+#include "SceneFile.h"
+#include "TransformHierarchy.h"
+#include "JobSystem.h"
+#include "ResourceManager.h"
 
 #include <string>
 #include <vector>
@@ -25,47 +39,326 @@ class SceneManager
 {
 public:
 	// constructor
-	SceneManager(ShaderManager *pShaderManager);
+	SceneManager(ShaderManager *pShaderManager, UniformBlocks* pUniformBlocks, ShaderPermutations* pShaderPermutations, Profiler* pProfiler, ResourceManager* pResources, JobSystem* pJobSystem = NULL);
 	// destructor
 	~SceneManager();
 
-	struct TEXTURE_INFO
-	{
-		std::string tag;
-		uint32_t ID;
-	};
-
 	struct OBJECT_MATERIAL
 	{
 		glm::vec3 diffuseColor;
 		glm::vec3 specularColor;
 		float shininess;
 		std::string tag;
+		// drawn blended, back-to-front, after every opaque draw
+		bool bTransparent;
+	};
+
+	//* helper enum for neatly drawing shapes
+	enum class MeshType
+	{
+		BOX,
+		BOX_FRONT,
+		BOX_BACK,
+		BOX_BOTTOM,
+		BOX_TOP,
+		BOX_RIGHT,
+		BOX_LEFT,
+		CONE,
+		CYLINDER,
+		PLANE,
+		PRISM,
+		PYRAMID3,
+		PYRAMID4,
+		SPHERE,
+		TAPERED_CYLINDER,
+		TORUS
+	};
+
+	//* NEW: one retained draw command - everything needed to submit
+	//* the object is resolved once when the draw list is built
+	struct DRAW_ITEM
+	{
+		MeshType mesh;
+		// node in the transform hierarchy that places the draw
+		int node;
+		// precomputed model and normal matrices
+		glm::mat4 model;
+		glm::mat3 normalMatrix;
+		glm::vec4 color;
+		glm::vec2 uvScale;
+		// resolved texture in the texture library, -1 when drawn with a solid color
+		int textureIndex;
+		// resolved index into m_objectMaterials, -1 for no material
+		int materialIndex;
+		// boxes with a texture per face, in MeshLibrary::BoxFace order -
+		// all of them are layers of the same texture array
+		bool bFaceTextures;
+		int faceTextures[MeshLibrary::BOX_FACE_COUNT];
+		// which parts of the mesh are drawn
+		bool top;
+		bool bottom;
+		bool sides;
+		// set when the model matrix needs to be rebuilt before drawing
+		bool bDirty;
+		// drawn in the blended transparent pass
+		bool bTransparent;
+		// world-space bounding sphere in the frustum culler
+		int boundsIndex;
+	};
+
+	//* NEW: many copies of one mesh sharing the same texture and
+	//* material, drawn with a single instanced draw call
+	struct INSTANCE_GROUP
+	{
+		MeshType mesh;
+		// batch in the mesh library that owns the instance buffer
+		int batch;
+		std::vector<MeshLibrary::INSTANCE_DATA> instances;
+		// transform node of each instance - empty when the instances
+		// were replaced with SetInstanceData()
+		std::vector<int> nodes;
+		glm::vec2 uvScale;
+		// resolved texture in the texture library, -1 to use the per-instance colors
+		int textureIndex;
+		int materialIndex;
+		// MeshLibrary::ShapePart mask built from the face flags
+		int partMask;
+		// a texture per part, sampled by the face of each vertex - see
+		// DRAW_ITEM::faceTextures
+		bool bFaceTextures;
+		int faceTextures[MeshLibrary::BOX_FACE_COUNT];
+		// set when the instance buffer needs to be uploaded again
+		bool bDirty;
+		// set when instances moved and the bounds need placing again
+		bool bBoundsDirty;
+		// drawn in the blended transparent pass
+		bool bTransparent;
+		// bounding sphere around every instance in the frustum culler
+		int boundsIndex;
+		// bounding radius of the largest single instance
+		float instanceRadius;
+	};
+
+	//* NEW: one copy for an instanced group and the transform node
+	//* that places it - see MakeInstance()
+	struct SCENE_INSTANCE
+	{
+		MeshLibrary::INSTANCE_DATA data;
+		int node;
+	};
+
+	//* NEW: counters for the last rendered frame
+	struct RENDER_STATS
+	{
+		// draw calls issued to OpenGL
+		int drawCalls;
+		// uniform values that had to be changed
+		int stateChanges;
+		// uniform values that were already set and were skipped
+		int skippedChanges;
+		// retained commands inside and outside the view frustum
+		int visibleObjects;
+		int culledObjects;
+		// switches to a different texture array - the arrays stay
+		// bound, so each switch stands in for a texture bind
+		int textureBinds;
+		// triangles drawn, counting every instance and pass
+		int triangles;
+		// shadow map views drawn - 0 while the cached maps are used
+		int shadowViews;
 	};
 
 private:
+	//* NEW: last values set into the shader, used to skip redundant changes
+	struct RENDER_STATE
+	{
+		// shader permutation in use, -1 for the base program, -2 when unknown
+		int permutation;
+		// -1 when unknown, otherwise 0 or 1
+		int useTexture;
+		// texture unit of the sampled array and the layer inside it
+		int textureUnit;
+		int textureLayer;
+		glm::vec2 uvScale;
+		bool bUVScaleKnown;
+		int materialIndex;
+		glm::vec4 color;
+		bool bColorKnown;
+		int useInstancing;
+		// -1 when unknown, otherwise 0 or 1
+		int useFaceLayers;
+		float faceLayers[MeshLibrary::BOX_FACE_COUNT];
+		bool bFaceLayersKnown;
+	};
+
+	//* NEW: the draw or instance a transform node places - a node can
+	//* place copies in more than one group, chained through nextOwner
+	struct NODE_OWNER
+	{
+		// index into m_drawList, -1 for none
+		int drawItem;
+		// index into m_instanceGroups and its instances, -1 for none
+		int group;
+		int instance;
+		// next owner of the same node in m_sharedOwners, -1 for none
+		int nextOwner;
+	};
+
+	//* NEW: the slice of a thread's command buffer recorded for one
+	//* queued draw this frame - commandCount is 0 when nothing was
+	//* recorded because the draw was culled or is drawn on its own
+	struct RECORDED_DRAW
+	{
+		int buffer;
+		int firstCommand;
+		int commandCount;
+		int instance;
+	};
+
+	//* NEW: handles for the uniforms set while drawing
+	struct SHADER_UNIFORMS
+	{
+		int model;
+		int normalMatrix;
+		int objectColor;
+		int objectTexture;
+		int textureLayer;
+		int useTexture;
+		int useLighting;
+		int useInstancing;
+		int uvScale;
+		int materialIndex;
+		int clusterLights;
+		int clusterGrid;
+		int clusterIndices;
+		int clusterTileScale;
+		int useFaceLayers;
+		int faceLayers;
+		int pointShadowMap;
+		int pointShadowPosition;
+		int pointShadowPlanes;
+		int directionalShadowMap;
+		int directionalShadowMatrix;
+		int shadowFilterQuality;
+	};
+
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
+	//* NEW: pointer to the shared frame and light uniform buffers
+	UniformBlocks* m_pUniformBlocks;
+	//* NEW: pointer to the compiled shader variants selected per draw
+	ShaderPermutations* m_pShaderPermutations;
+	//* NEW: times the render passes on the GPU and takes the counters
+	Profiler* m_pProfiler;
+	//* NEW: owns the textures, buffers and maps of the scene
+	ResourceManager* m_pResources;
+	//* NEW: worker threads for the frame update and command recording,
+	//* NULL to do all of it on the calling thread
+	JobSystem* m_pJobSystem;
+	// base program of the permutations, used when no variant compiles
+	GLuint m_baseProgram;
+	// permutation key for the scene lights, without the texture flag
+	int m_lightingPermutation;
+	//* NEW: every point light in the scene, and the directional and
+	//* spot lights - the point lights in m_lights are only the first
+	//* ones, kept for the base program
+	std::vector<ClusteredLights::POINT_LIGHT> m_pointLights;
+	UniformBlocks::LIGHT_BLOCK m_lights;
+	bool m_bLightsDirty;
+	//* NEW: reload count of the permutations the uniform cache was
+	//* resolved against
+	int m_shaderGeneration;
 	// pointer to basic shapes object
 	ShapeMeshes* m_basicMeshes;
-	// total number of loaded textures
-	int m_loadedTextures;
-	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
+	//* NEW: pointer to the indexed shapes used for instanced drawing
+	MeshLibrary* m_meshLibrary;
+	//* NEW: loaded textures packed into texture arrays by size
+	TextureLibrary* m_textureLibrary;
+	//* NEW: point lights sorted into view-space clusters every frame
+	ClusteredLights* m_clusteredLights;
+	//* NEW: cached shadow maps of the lamp and the directional light
+	ShadowMaps* m_shadowMaps;
+	// draws and groups drawn one at a time into a shadow map, and the
+	// bounds moved this frame that may reach a cached map
+	std::vector<int> m_shadowDraws;
+	std::vector<int> m_shadowGroups;
+	std::vector<int> m_movedBounds;
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	//* NEW: uniform locations resolved once after the shaders are loaded
+	UniformCache m_uniformCache;
+	SHADER_UNIFORMS m_uniforms;
+	//* NEW: retained list of draw commands built in PrepareScene()
+	std::vector<DRAW_ITEM> m_drawList;
+	//* NEW: retained list of instanced draws built in PrepareScene()
+	std::vector<INSTANCE_GROUP> m_instanceGroups;
+	//* NEW: transforms of the retained draws and instances, with the
+	//* composite objects placed relative to a parent node
+	TransformHierarchy m_transforms;
+	// owner of each transform node, and the owners past the first
+	std::vector<NODE_OWNER> m_nodeOwners;
+	std::vector<NODE_OWNER> m_sharedOwners;
+	// parents of the transform groups being built
+	std::vector<int> m_transformParents;
+	//* NEW: retained commands sorted by state
+	RenderQueue m_renderQueue;
+	//* NEW: blended commands, drawn back-to-front after the opaque queue
+	RenderQueue m_transparentQueue;
+	std::vector<int> m_transparentOrder;
+	bool m_bRenderQueueDirty;
+	RENDER_STATE m_renderState;
+	RENDER_STATS m_renderStats;
+	//* NEW: bounding spheres of the retained commands, culled every frame
+	FrustumCuller m_frustumCuller;
+	// height of the viewport in pixels, for picking levels of detail
+	int m_viewportHeight;
+	// copies of the props placed on the stress grid
+	int m_stressCopies;
+	//* NEW: scene description, mapped from its binary cache
+	SceneFile m_sceneFile;
+	std::string m_scenePath;
+	//* NEW: lay down depth first, then shade only the visible fragments
+	bool m_bDepthPrePass;
+	//* NEW: draw a flat additive color per fragment to show overdraw
+	bool m_bOverdrawView;
+	// camera position the depth keys in the queue were built for
+	glm::vec3 m_sortViewPosition;
+	// render queue entries ordered nearest first for the pre-pass
+	std::vector<int> m_depthOrder;
+	//* NEW: multi-draw commands recorded this frame, one buffer per
+	//* job system thread, and where each opaque queue entry's are
+	std::vector<MeshLibrary::MULTI_DRAW_LIST> m_commandBuffers;
+	std::vector<RECORDED_DRAW> m_recordedDraws;
 
+	// look up the registered uniforms in the base shader program
+	void ResolveUniforms();
 	// load texture images and convert to OpenGL texture data
-	bool CreateGLTexture(const char* filename, std::string tag);
-	// bind loaded OpenGL textures to slots in memory
+	bool CreateGLTexture(const char* filename, std::string tag, TextureQuality::Tier tier = TextureQuality::TIER_DEFAULT);
+	// pack the loaded textures into arrays and bind them to texture units
 	void BindGLTextures();
 	// free the loaded OpenGL textures
 	void DestroyGLTextures();
 	// find a loaded texture by tag
 	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
+	int FindTextureIndex(std::string tag);
 	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	bool FindMaterial(const std::string& tag, OBJECT_MATERIAL& material);
+	int FindMaterialIndex(const std::string& tag);
+	// the material an object is drawn with - the default one when
+	// the tag is not defined
+	int ResolveMaterialIndex(const std::string& tag);
+
+	// build the model matrix from the passed in transformation values
+	glm::mat4 BuildModelMatrix(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ,
+		glm::vec3 offset = glm::vec3(0.0f, 0.0f, 0.0f));
+
+	// build the matrix that takes normals into world space
+	glm::mat3 BuildNormalMatrix(const glm::mat4& model);
 
 	// set the transformation values 
 	// into the transform buffer
@@ -94,32 +387,144 @@ private:
 
 	// set the object material into the shader
 	void SetShaderMaterial(
-		std::string materialTag);
+		const std::string& materialTag);
+	void SetShaderMaterial(
+		int materialIndex);
+	// copy the defined materials into the shader's material block
+	void UploadMaterials();
 
-	//* helper enum and function for neatly drawing shapes
-	enum class MeshType
-	{
-		BOX,
-		BOX_FRONT,
-		BOX_BACK,
-		BOX_BOTTOM,
-		BOX_TOP,
-		BOX_RIGHT,
-		BOX_LEFT,
-		CONE,
-		CYLINDER,
-		PLANE,
-		PRISM,
-		PYRAMID3,
-		PYRAMID4,
-		SPHERE,
-		TAPERED_CYLINDER,
-		TORUS
-	};
-	void DrawMesh(MeshType type, glm::vec3 scale, glm::vec3 pos, glm::vec3 rot, glm::vec4 col, const std::string& materialTag = "", bool top = true, bool bottom = true, bool sides = true);
-	//* NEW accepts a texture tag, tiling and optional render sides
-	void DrawTexturedMesh(MeshType type, glm::vec3 scale, glm::vec3 pos, glm::vec3 rot, const std::string& textureTag, float uTile, float vTile, const std::string& materialTag = "", bool top = true, bool bottom = true, bool sides = true);
-	void draw(MeshType type, bool top = true, bool bottom = true, bool sides = true);
+	//* NEW: record a solid color object into the retained draw list
+	int AddMesh(MeshType type, glm::vec3 scale, glm::vec3 pos, glm::vec3 rot, glm::vec4 col, const std::string& materialTag = "", bool top = true, bool bottom = true, bool sides = true);
+	//* NEW: record a textured object - accepts a texture tag, tiling and optional render sides
+	int AddTexturedMesh(MeshType type, glm::vec3 scale, glm::vec3 pos, glm::vec3 rot, const std::string& textureTag, float uTile, float vTile, const std::string& materialTag = "", bool top = true, bool bottom = true, bool sides = true);
+	//* NEW: record a box with its own texture on every face, drawn with
+	//* one call - the tags are in MeshLibrary::BoxFace order
+	int AddFaceTexturedBox(glm::vec3 scale, glm::vec3 pos, glm::vec3 rot, const std::string faceTextureTags[MeshLibrary::BOX_FACE_COUNT], float uTile, float vTile, const std::string& materialTag = "");
+	//* NEW: record a group of instances of one mesh - pass an empty
+	//* texture tag to draw each instance with its own color
+	int AddMeshInstanced(MeshType type, const std::vector<SCENE_INSTANCE>& instances, const std::string& textureTag, float uTile, float vTile, const std::string& materialTag = "", bool top = true, bool bottom = true, bool sides = true);
+	//* NEW: record a group of instances with a texture per part, given
+	//* as bottom, sides, top - every drawn part goes out in one call
+	int AddMeshInstancedPerPart(MeshType type, const std::vector<SCENE_INSTANCE>& instances, const std::string partTextureTags[3], float uTile, float vTile, const std::string& materialTag = "", bool top = true, bool bottom = true, bool sides = true);
+	// find the textures for every face, false unless all of them are
+	// layers of the same texture array
+	bool ResolveFaceTextures(const std::string faceTextureTags[MeshLibrary::BOX_FACE_COUNT], int faceTextures[MeshLibrary::BOX_FACE_COUNT]);
+	// build the per-instance values for one copy of a mesh, placed
+	// by a new transform node in the current transform group
+	SCENE_INSTANCE MakeInstance(glm::vec3 scale, glm::vec3 pos, glm::vec3 rot, glm::vec4 col = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+	// start a transform group - the objects added until the matching
+	// EndTransformGroup() are placed relative to it
+	int BeginTransformGroup(glm::vec3 scale, glm::vec3 pos, glm::vec3 rot);
+	void EndTransformGroup();
+	// add a transform node in the current transform group
+	int AddTransformNode(glm::vec3 scale, glm::vec3 pos, glm::vec3 rot);
+	// record the draw or instance that a transform node places
+	void AddNodeOwner(int node, int drawItem, int group, int instance);
+	// find the owner of a node for an instance group, NULL for none
+	NODE_OWNER* FindGroupOwner(int node, int group);
+	// rebuild the world matrices of moved nodes and hand them to the
+	// draws and instances they place
+	void UpdateTransforms();
+	// draw all of the instances in a group with one call per part range
+	void DrawMeshInstanced(INSTANCE_GROUP& group);
+	// fill the retained draw list with the objects in the scene
+	void BuildDrawList();
+	// positions of the prop copies for the stress grid
+	void StressGridOffsets(std::vector<glm::vec3>& offsets) const;
+	// map the scene file - false to use the built-in scene
+	bool LoadSceneFile();
+	// load the textures, materials, lights and objects of the scene file
+	void LoadSceneTextures();
+	void LoadSceneMaterials();
+	void LoadSceneLights();
+	void BuildSceneDrawList();
+	// record one copy of a scene file object and the objects in it,
+	// returning the record after them
+	uint32_t BuildSceneObject(uint32_t index, const glm::vec3& offset, std::vector<std::vector<SCENE_INSTANCE>>& instances);
+	// hand the point lights to the clusters, pick the lighting
+	// permutation and upload the light block
+	void ApplySceneLights();
+	// fill the render queue with the retained commands and sort it
+	void BuildRenderQueue();
+	// run a loop over count items on the job system, or on this
+	// thread when there is none
+	void RunParallel(int count, int grainSize, const JobSystem::RangeFunction& function);
+	// record the multi-draw commands of every visible opaque draw
+	// for this frame, spread over the job system threads
+	void RecordCommands();
+	// forget the cached shader state
+	void ResetRenderState();
+	// get the shader permutation for a draw, -1 for the base program
+	int SelectPermutation(bool bTextured);
+	// rebuild the model matrix of a moved draw or upload moved instances
+	void RefreshDrawItem(DRAW_ITEM& item);
+	void RefreshInstanceGroup(INSTANCE_GROUP& group);
+	// distance from the camera used for front-to-back ordering
+	float DrawDistance(const RenderQueue::ENTRY& entry) const;
+	// local box around a mesh, for frustum culling
+	FrustumCuller::BOUNDS MeshLocalBounds(MeshType type) const;
+	// bounding sphere around moved draws and groups
+	void UpdateDrawBounds(const DRAW_ITEM& item);
+	void UpdateGroupBounds(INSTANCE_GROUP& group);
+	// whether a queued command was inside the frustum this frame
+	bool IsEntryVisible(const RenderQueue::ENTRY& entry) const;
+	// level of detail for a sphere from its size on screen - the
+	// near offset moves the sphere toward the camera
+	int SelectLod(const glm::vec3& center, float radius, float nearOffset = 0.0f) const;
+	int DrawItemLod(const DRAW_ITEM& item) const;
+	int InstanceGroupLod(const INSTANCE_GROUP& group) const;
+	// whether a material or color needs the transparent pass
+	bool IsTransparent(int materialIndex, float alpha) const;
+	// order the copies in a transparent group farthest first
+	void SortInstancesBackToFront(INSTANCE_GROUP& group);
+	// bind the program of a queued command and draw it
+	void DrawQueueEntry(const RenderQueue::ENTRY& entry);
+	// mesh library shape and part mask used for a mesh type - false
+	// when the type is only drawn by ShapeMeshes
+	bool LibraryShape(MeshType type, MeshLibrary::ShapeType& shape) const;
+	int LibraryPartMask(MeshType type, bool top, bool bottom, bool sides) const;
+	// whether the face flags leave nothing of the mesh to draw
+	bool IsEmptyDraw(MeshType type, bool top, bool bottom, bool sides) const;
+	// whether a queued command can go into a multi-draw
+	bool CanMultiDraw(const RenderQueue::ENTRY& entry) const;
+	// end of the run of queued draws that share their shader state
+	// with the first one and can be drawn with one multi-draw
+	size_t MultiDrawRunEnd(const std::vector<RenderQueue::ENTRY>& entries, size_t first) const;
+	// draw the queued draws from first up to last with one call
+	void SubmitMultiDrawRun(const std::vector<RenderQueue::ENTRY>& entries, size_t first, size_t last);
+	// per-instance values of a retained draw in a multi-draw
+	MeshLibrary::INSTANCE_DATA MakeDrawInstance(const DRAW_ITEM& item) const;
+	// record one retained draw into a command buffer - safe to call
+	// from any thread
+	void RecordMultiDrawItem(const DRAW_ITEM& item, MeshLibrary::MULTI_DRAW_LIST& commands, RECORDED_DRAW& recorded) const;
+	// add the commands recorded for a draw to the multi-draw
+	void AddRecordedDraw(const RECORDED_DRAW& recorded);
+	// write depth for every queued draw with color writes off -
+	// false when there is no depth-only program to do it with
+	bool RenderDepthPrePass();
+	// draw the shadow maps that are out of date, and one of them
+	void RenderShadowMaps();
+	void RenderShadowMap(ShadowMaps::MapType map);
+	// fit the directional shadow map around every shadow caster
+	void FitShadowBounds();
+	// time a render pass on the GPU when there is a profiler
+	void BeginGpuPass(const char* name);
+	void EndGpuPass();
+	// set shader state, skipping values that are already set
+	void ApplyShaderState(int permutation);
+	void ApplyTextureState(int textureIndex, glm::vec2 uvScale);
+	void ApplyColorState(glm::vec4 color, bool bSetColor = true);
+	void ApplyMaterialState(int materialIndex);
+	void ApplyInstancingState(bool bInstanced);
+	// set the texture of a textured draw - faceTextures is NULL for
+	// draws with a single texture
+	void ApplyDrawTextureState(int textureIndex, glm::vec2 uvScale, const int* faceTextures);
+	// set the layer of every box face - NULL to use the single layer
+	void ApplyFaceLayerState(const int* faceTextures);
+	// push the shader state for one retained draw command and draw it
+	void SubmitDrawItem(const DRAW_ITEM& item);
+	// returns the number of draw calls issued
+	int draw(MeshType type, bool top = true, bool bottom = true, bool sides = true, int lod = 0);
 
 public:
 
@@ -131,4 +536,51 @@ public:
 	void SetupSceneLights();
 	void DefineObjectMaterials();
 
+	//* NEW: move an object in the retained draw list, relative to the
+	//* transform group it is in - the model matrix is rebuilt the
+	//* next time the scene is rendered
+	void SetObjectTransform(int index, glm::vec3 scale, glm::vec3 pos, glm::vec3 rot);
+	//* NEW: move a transform node, taking every object and instance
+	//* below it along the next time the scene is rendered
+	void SetNodeTransform(int node, glm::vec3 scale, glm::vec3 pos, glm::vec3 rot);
+	//* NEW: transform node of an object or of an instance in a group,
+	//* and the node it is placed relative to - -1 for none
+	int GetObjectNode(int index) const;
+	int GetInstanceNode(int group, int instance) const;
+	int GetParentNode(int node) const;
+	//* NEW: replace the instances of a group - the instance buffer
+	//* is uploaded again the next time the scene is rendered
+	void SetInstanceData(int group, const std::vector<MeshLibrary::INSTANCE_DATA>& instances);
+
+	//* NEW: edit the point lights - there can be any number of them,
+	//* the change is applied the next time the scene is rendered
+	int AddPointLight(const ClusteredLights::POINT_LIGHT& light);
+	void SetPointLight(int index, const ClusteredLights::POINT_LIGHT& light);
+	void ClearPointLights();
+	int PointLightCount() const { return((int)m_pointLights.size()); }
+
+	//* NEW: switch the depth pre-pass and the overdraw view on or off
+	void SetDepthPrePass(bool bEnabled);
+	void SetOverdrawView(bool bEnabled);
+
+	//* NEW: counters for the last rendered frame
+	const RENDER_STATS& GetRenderStats() const { return(m_renderStats); }
+
+	//* NEW: whether the next frame differs from the last one - an
+	//* object moved or a texture is still streaming in
+	bool NeedsRedraw() const;
+	//* NEW: whether textures are still being decoded or uploaded
+	bool IsLoading() const;
+
+	//* NEW: read the scene file from the command line - set before
+	//* PrepareScene():
+	//*   --scene <file>   JSON scene, compiled to <file>.scenebin
+	//* along with the shadow map and texture quality options
+	void ParseArguments(int argc, char* argv[]);
+
+	//* NEW: copy the props onto a grid to stress the renderer - set
+	//* before PrepareScene()
+	static const int MAX_STRESS_COPIES = 10000;
+	void SetStressCopies(int copies);
+
 };
\ No newline at end of file
@@ -0,0 +1,865 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderpermutations.cpp
+// ============
+// compile variants of the scene shaders with #defines selected per draw
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderPermutations.h"
+#include "MappedFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// the point light count is kept above the flag bits in a key
+	const int g_PointLightShift = 10;
+
+	const char g_CacheMagic[4] = { 'S', 'P', 'B', 'N' };
+	// bumped whenever the cache file layout changes
+	const uint32_t g_CacheVersion = 1;
+	// how often the shader files are checked for changes
+	const std::chrono::milliseconds g_WatchInterval(500);
+	// FNV-1a
+	const uint64_t g_HashSeed = 14695981039346656037ull;
+	const uint64_t g_HashPrime = 1099511628211ull;
+
+	uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ bytes[i]) * g_HashPrime;
+		}
+		return(hash);
+	}
+
+	uint64_t HashString(uint64_t hash, const char* text)
+	{
+		if (NULL == text)
+		{
+			return(hash);
+		}
+		// the terminator keeps "ab" + "c" apart from "a" + "bc"
+		return(HashBytes(hash, text, strlen(text) + 1));
+	}
+
+	// succeeds when the directory already exists
+	void MakeDirectory(const std::string& path)
+	{
+#ifdef _WIN32
+		_mkdir(path.c_str());
+#else
+		mkdir(path.c_str(), 0755);
+#endif
+	}
+
+	// start compiling one stage - the result is read later
+	GLuint StartShader(GLenum type, const std::string& source)
+	{
+		GLuint shader = glCreateShader(type);
+		const char* text = source.c_str();
+		glShaderSource(shader, 1, &text, NULL);
+		glCompileShader(shader);
+		return(shader);
+	}
+
+	// print the log of a stage that failed to compile
+	bool CheckShader(GLuint shader, const std::string& path)
+	{
+		GLint success = 0;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			char infoLog[1024];
+			glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
+			std::cout << "ERROR::SHADER_COMPILATION_ERROR in " << path << "\n" << infoLog << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	bool ReadFile(const std::string& path, std::string& contents)
+	{
+		std::ifstream file(path.c_str());
+		if (!file)
+		{
+			return false;
+		}
+
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+		contents = buffer.str();
+		return true;
+	}
+}
+
+/***********************************************************
+ *  ShaderPermutations()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderPermutations::ShaderPermutations(const char* vertexShaderPath, const char* fragmentShaderPath, UniformBlocks* pUniformBlocks, ResourceManager* pResources)
+{
+	m_vertexShaderPath = vertexShaderPath;
+	m_fragmentShaderPath = fragmentShaderPath;
+	m_pUniformBlocks = pUniformBlocks;
+	m_pResources = pResources;
+
+	m_cacheDirectory = "shaders/cache";
+	m_bCacheEnabled = true;
+	m_driverHash = g_HashSeed;
+	m_sourceHash = g_HashSeed;
+
+	m_bHotReload = false;
+	m_bParallelCompile = false;
+	m_vertexStamp[0] = m_vertexStamp[1] = 0;
+	m_fragmentStamp[0] = m_fragmentStamp[1] = 0;
+	m_nextWatchTime = std::chrono::steady_clock::now();
+	m_generation = 0;
+}
+
+/***********************************************************
+ *  ~ShaderPermutations()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderPermutations::~ShaderPermutations()
+{
+	Destroy();
+	m_pUniformBlocks = NULL;
+	m_pResources = NULL;
+}
+
+/***********************************************************
+ *  ParseArguments()
+ *
+ *  This method is used for reading the cache and hot reload
+ *  options from the command line.
+ ***********************************************************/
+void ShaderPermutations::ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--shader-cache") == 0) && (i + 1 < argc))
+		{
+			m_cacheDirectory = argv[++i];
+		}
+		else if (strcmp(argv[i], "--no-shader-cache") == 0)
+		{
+			m_bCacheEnabled = false;
+		}
+		else if (strcmp(argv[i], "--hot-reload-shaders") == 0)
+		{
+			m_bHotReload = true;
+		}
+	}
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for checking that the driver can
+ *  save program binaries, and hashing its name and version
+ *  into every cache key - a binary is only valid for the
+ *  driver that made it.  With hot reload on, the driver is
+ *  also asked to compile on its own threads.
+ ***********************************************************/
+void ShaderPermutations::Create()
+{
+	m_driverHash = g_HashSeed;
+	m_driverHash = HashString(m_driverHash, (const char*)glGetString(GL_VENDOR));
+	m_driverHash = HashString(m_driverHash, (const char*)glGetString(GL_RENDERER));
+	m_driverHash = HashString(m_driverHash, (const char*)glGetString(GL_VERSION));
+	m_driverHash = HashString(m_driverHash, (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION));
+
+	if (m_cacheDirectory.empty())
+	{
+		m_bCacheEnabled = false;
+	}
+	if (m_bCacheEnabled)
+	{
+		GLint formatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+		if (formatCount <= 0)
+		{
+			std::cout << "The driver cannot save program binaries, shaders are compiled on every launch" << std::endl;
+			m_bCacheEnabled = false;
+		}
+		else
+		{
+			MakeDirectory(m_cacheDirectory);
+			std::cout << "Shader cache: " << m_cacheDirectory << std::endl;
+		}
+	}
+
+	if (m_bHotReload)
+	{
+		m_bParallelCompile = (GLEW_ARB_parallel_shader_compile != 0);
+		if (m_bParallelCompile)
+		{
+			// let the driver pick how many threads to use
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+		}
+		std::cout << "Shader hot reload: watching " << m_vertexShaderPath << ", " << m_fragmentShaderPath <<
+			(m_bParallelCompile ? "" : " - rebuilds will stall the frame") << std::endl;
+	}
+}
+
+/***********************************************************
+ *  MakeKey()
+ *
+ *  This method is used for combining the permutation flags
+ *  and the number of active point lights into one key.
+ ***********************************************************/
+int ShaderPermutations::MakeKey(int flags, int pointLightCount)
+{
+	if (pointLightCount < 0)
+	{
+		pointLightCount = 0;
+	}
+	if (pointLightCount > TOTAL_POINT_LIGHTS)
+	{
+		pointLightCount = TOTAL_POINT_LIGHTS;
+	}
+
+	return((flags & ((1 << g_PointLightShift) - 1)) | (pointLightCount << g_PointLightShift));
+}
+
+/***********************************************************
+ *  Request()
+ *
+ *  This method is used for getting the variant compiled for
+ *  the passed in key.  A key that has not been requested
+ *  before is loaded from the binary cache, or compiled and
+ *  linked right away and then saved to it.
+ ***********************************************************/
+int ShaderPermutations::Request(int key)
+{
+	for (int i = 0; i < (int)m_variants.size(); i++)
+	{
+		if (m_variants[i].key == key)
+		{
+			return(m_variants[i].program.IsValid() ? i : -1);
+		}
+	}
+
+	VARIANT variant;
+	variant.key = key;
+	// failed variants are remembered too, so they are not compiled again
+	m_variants.push_back(variant);
+	int index = (int)m_variants.size() - 1;
+	GLuint programID = 0;
+
+	if (LoadSources())
+	{
+		programID = LoadCachedProgram(key);
+		if (programID != 0)
+		{
+			std::cout << "Loaded shader permutation " << index << " (key " << key << ") from the cache" << std::endl;
+		}
+		else
+		{
+			PROGRAM_BUILD build = StartBuild(index, key);
+			programID = FinishBuild(build);
+			if (programID != 0)
+			{
+				SaveCachedProgram(key, programID);
+				std::cout << "Compiled shader permutation " << index << " (key " << key << ")" << std::endl;
+			}
+		}
+	}
+
+	if (programID != 0)
+	{
+		AdoptVariant(index, programID);
+	}
+
+	return((programID != 0) ? index : -1);
+}
+
+/***********************************************************
+ *  Program()
+ *
+ *  This method is used for getting the OpenGL program of a
+ *  compiled variant.
+ ***********************************************************/
+GLuint ShaderPermutations::Program(int index) const
+{
+	if ((index < 0) || (index >= (int)m_variants.size()))
+	{
+		return(0);
+	}
+
+	return(m_variants[index].program.Name());
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for releasing every compiled program.
+ *  The resource manager deletes them once the frames that
+ *  may still use them are finished.  Rebuilds that are still
+ *  running were never used, so they are deleted right away.
+ ***********************************************************/
+void ShaderPermutations::Destroy()
+{
+	for (size_t i = 0; i < m_pendingBuilds.size(); i++)
+	{
+		glDeleteShader(m_pendingBuilds[i].vertexShader);
+		glDeleteShader(m_pendingBuilds[i].fragmentShader);
+		glDeleteProgram(m_pendingBuilds[i].program);
+	}
+	m_pendingBuilds.clear();
+
+	m_variants.clear();
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for checking the shader files for
+ *  changes a couple of times a second and rebuilding every
+ *  variant when one has been saved.  The rebuilt programs
+ *  replace the old ones in place, so the variant indexes in
+ *  the render queue keys stay valid.
+ ***********************************************************/
+bool ShaderPermutations::Update()
+{
+	if (m_bHotReload == false)
+	{
+		return(false);
+	}
+
+	if (m_pendingBuilds.empty() == false)
+	{
+		return(FinishReload());
+	}
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (now < m_nextWatchTime)
+	{
+		return(false);
+	}
+	m_nextWatchTime = now + g_WatchInterval;
+
+	uint64_t vertexStamp[2];
+	uint64_t fragmentStamp[2];
+	// a file can be missing for a moment while an editor saves it
+	if ((MappedFile::GetFileStamp(m_vertexShaderPath.c_str(), vertexStamp[0], vertexStamp[1]) == false) ||
+		(MappedFile::GetFileStamp(m_fragmentShaderPath.c_str(), fragmentStamp[0], fragmentStamp[1]) == false))
+	{
+		return(false);
+	}
+
+	if ((vertexStamp[0] == m_vertexStamp[0]) && (vertexStamp[1] == m_vertexStamp[1]) &&
+		(fragmentStamp[0] == m_fragmentStamp[0]) && (fragmentStamp[1] == m_fragmentStamp[1]))
+	{
+		return(false);
+	}
+	m_vertexStamp[0] = vertexStamp[0];
+	m_vertexStamp[1] = vertexStamp[1];
+	m_fragmentStamp[0] = fragmentStamp[0];
+	m_fragmentStamp[1] = fragmentStamp[1];
+
+	if ((ReloadSources() == false) || m_variants.empty())
+	{
+		return(false);
+	}
+
+	std::cout << "Shader files changed, rebuilding " << m_variants.size() << " shader permutation(s)" << std::endl;
+	StartReload();
+
+	// without parallel compiles the builds are already finished
+	return(FinishReload());
+}
+
+/***********************************************************
+ *  LoadSources()
+ *
+ *  This method is used for reading the shader files once,
+ *  the first time a variant is compiled.  Their stamps are
+ *  kept so the hot reload can tell when they change.
+ ***********************************************************/
+bool ShaderPermutations::LoadSources()
+{
+	if ((m_vertexSource.empty() == false) && (m_fragmentSource.empty() == false))
+	{
+		return true;
+	}
+
+	MappedFile::GetFileStamp(m_vertexShaderPath.c_str(), m_vertexStamp[0], m_vertexStamp[1]);
+	MappedFile::GetFileStamp(m_fragmentShaderPath.c_str(), m_fragmentStamp[0], m_fragmentStamp[1]);
+
+	if ((ReadFile(m_vertexShaderPath, m_vertexSource) == false) ||
+		(ReadFile(m_fragmentShaderPath, m_fragmentSource) == false))
+	{
+		std::cout << "Could not read shader files:" << m_vertexShaderPath << ", " << m_fragmentShaderPath << std::endl;
+		m_vertexSource.clear();
+		m_fragmentSource.clear();
+		return false;
+	}
+
+	HashSources();
+	return true;
+}
+
+/***********************************************************
+ *  ReloadSources()
+ *
+ *  This method is used for reading the shader files again
+ *  after they changed.  Saving a file without changing it
+ *  does not count as a change.
+ ***********************************************************/
+bool ShaderPermutations::ReloadSources()
+{
+	std::string vertexSource;
+	std::string fragmentSource;
+	if ((ReadFile(m_vertexShaderPath, vertexSource) == false) ||
+		(ReadFile(m_fragmentShaderPath, fragmentSource) == false))
+	{
+		std::cout << "Could not read shader files:" << m_vertexShaderPath << ", " << m_fragmentShaderPath << std::endl;
+		return false;
+	}
+
+	if ((vertexSource == m_vertexSource) && (fragmentSource == m_fragmentSource))
+	{
+		return false;
+	}
+
+	m_vertexSource.swap(vertexSource);
+	m_fragmentSource.swap(fragmentSource);
+	HashSources();
+	return true;
+}
+
+/***********************************************************
+ *  HashSources()
+ *
+ *  This method is used for hashing both shader sources onto
+ *  the driver hash - the defines of each key are added on
+ *  top of this by CacheHash().
+ ***********************************************************/
+void ShaderPermutations::HashSources()
+{
+	m_sourceHash = HashString(m_driverHash, m_vertexSource.c_str());
+	m_sourceHash = HashString(m_sourceHash, m_fragmentSource.c_str());
+}
+
+/***********************************************************
+ *  BuildDefines()
+ *
+ *  This method is used for writing the #define lines that
+ *  describe a key.  Every flag is always defined, to 0 or
+ *  1, so the shaders can use it in plain expressions.  The
+ *  base program gets none.
+ ***********************************************************/
+std::string ShaderPermutations::BuildDefines(int key)
+{
+	if (key == BASE_KEY)
+	{
+		return(std::string());
+	}
+
+	std::stringstream defines;
+	defines << "#define SHADER_PERMUTATION 1\n";
+	defines << "#define USE_LIGHTING " << (((key & PERMUTATION_LIGHTING) != 0) ? 1 : 0) << "\n";
+	defines << "#define USE_TEXTURE " << (((key & PERMUTATION_TEXTURE) != 0) ? 1 : 0) << "\n";
+	defines << "#define USE_DIRECTIONAL_LIGHT " << (((key & PERMUTATION_DIRECTIONAL_LIGHT) != 0) ? 1 : 0) << "\n";
+	defines << "#define USE_SPOT_LIGHT " << (((key & PERMUTATION_SPOT_LIGHT) != 0) ? 1 : 0) << "\n";
+	defines << "#define USE_CLUSTERED_LIGHTS " << (((key & PERMUTATION_CLUSTERED_LIGHTS) != 0) ? 1 : 0) << "\n";
+	defines << "#define DEPTH_ONLY " << (((key & PERMUTATION_DEPTH_ONLY) != 0) ? 1 : 0) << "\n";
+	defines << "#define OVERDRAW_VIEW " << (((key & PERMUTATION_OVERDRAW) != 0) ? 1 : 0) << "\n";
+	defines << "#define USE_POINT_SHADOW " << (((key & PERMUTATION_POINT_SHADOW) != 0) ? 1 : 0) << "\n";
+	defines << "#define USE_DIRECTIONAL_SHADOW " << (((key & PERMUTATION_DIRECTIONAL_SHADOW) != 0) ? 1 : 0) << "\n";
+	defines << "#define POINT_LIGHT_COUNT " << (key >> g_PointLightShift) << "\n";
+
+	return(defines.str());
+}
+
+/***********************************************************
+ *  InjectDefines()
+ *
+ *  This method is used for inserting the defines into the
+ *  shader source.  GLSL needs #version to come first, so the
+ *  defines go on the line after it.
+ ***********************************************************/
+std::string ShaderPermutations::InjectDefines(const std::string& source, const std::string& defines)
+{
+	size_t version = source.find("#version");
+	if (version == std::string::npos)
+	{
+		return(defines + source);
+	}
+
+	size_t lineEnd = source.find('\n', version);
+	if (lineEnd == std::string::npos)
+	{
+		return(source + "\n" + defines);
+	}
+
+	return(source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1));
+}
+
+/***********************************************************
+ *  StartBuild()
+ *
+ *  This method is used for making the compile and link calls
+ *  for a variant.  Nothing is read back, so with parallel
+ *  compiles the driver builds the program in the background
+ *  until FinishBuild() asks for the results.
+ ***********************************************************/
+ShaderPermutations::PROGRAM_BUILD ShaderPermutations::StartBuild(int variant, int key)
+{
+	std::string defines = BuildDefines(key);
+
+	PROGRAM_BUILD build;
+	build.variant = variant;
+	build.bFromCache = false;
+	build.vertexShader = StartShader(GL_VERTEX_SHADER, InjectDefines(m_vertexSource, defines));
+	build.fragmentShader = StartShader(GL_FRAGMENT_SHADER, InjectDefines(m_fragmentSource, defines));
+	build.program = glCreateProgram();
+	if (m_bCacheEnabled)
+	{
+		glProgramParameteri(build.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	glAttachShader(build.program, build.vertexShader);
+	glAttachShader(build.program, build.fragmentShader);
+	glLinkProgram(build.program);
+
+	return(build);
+}
+
+/***********************************************************
+ *  IsBuildDone()
+ *
+ *  This method is used for asking the driver whether a
+ *  build has finished, without waiting for it.
+ ***********************************************************/
+bool ShaderPermutations::IsBuildDone(const PROGRAM_BUILD& build) const
+{
+	if ((m_bParallelCompile == false) || build.bFromCache)
+	{
+		return true;
+	}
+
+	GLint bDone = GL_TRUE;
+	glGetProgramiv(build.program, GL_COMPLETION_STATUS_ARB, &bDone);
+	return(bDone != GL_FALSE);
+}
+
+/***********************************************************
+ *  FinishBuild()
+ *
+ *  This method is used for reading the results of a build
+ *  and printing the logs when it failed.  The stages are
+ *  deleted either way.
+ ***********************************************************/
+GLuint ShaderPermutations::FinishBuild(PROGRAM_BUILD& build)
+{
+	GLuint program = build.program;
+
+	GLint success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		// a stage that did not compile explains more than the link log
+		bool bVertexCompiled = (build.vertexShader == 0) || CheckShader(build.vertexShader, m_vertexShaderPath);
+		bool bFragmentCompiled = (build.fragmentShader == 0) || CheckShader(build.fragmentShader, m_fragmentShaderPath);
+		if (bVertexCompiled && bFragmentCompiled)
+		{
+			char infoLog[1024];
+			glGetProgramInfoLog(program, sizeof(infoLog), NULL, infoLog);
+			std::cout << "ERROR::PROGRAM_LINKING_ERROR\n" << infoLog << std::endl;
+		}
+		glDeleteProgram(program);
+		program = 0;
+	}
+	else if (build.bFromCache == false)
+	{
+		glDetachShader(program, build.vertexShader);
+		glDetachShader(program, build.fragmentShader);
+	}
+
+	if (build.bFromCache == false)
+	{
+		glDeleteShader(build.vertexShader);
+		glDeleteShader(build.fragmentShader);
+	}
+	build.vertexShader = 0;
+	build.fragmentShader = 0;
+	build.program = 0;
+
+	return(program);
+}
+
+/***********************************************************
+ *  AdoptVariant()
+ *
+ *  This method is used for handing a linked program to the
+ *  resource manager and connecting the shared uniform
+ *  blocks to it.  A program the variant had before is
+ *  released once the frames using it are finished.
+ ***********************************************************/
+void ShaderPermutations::AdoptVariant(int variant, GLuint programID)
+{
+	if (NULL != m_pUniformBlocks)
+	{
+		// connect the shared uniform blocks to the new program
+		m_pUniformBlocks->BindProgram(programID);
+	}
+
+	m_variants[variant].program = m_pResources->AdoptProgram(programID, "shader permutation");
+}
+
+/***********************************************************
+ *  StartReload()
+ *
+ *  This method is used for starting a rebuild of every
+ *  variant from the new sources.  Variants that are in the
+ *  cache already, such as after an edit is undone, are
+ *  loaded from it instead.
+ ***********************************************************/
+void ShaderPermutations::StartReload()
+{
+	for (int i = 0; i < (int)m_variants.size(); i++)
+	{
+		GLuint cached = LoadCachedProgram(m_variants[i].key);
+		if (cached != 0)
+		{
+			PROGRAM_BUILD build;
+			build.variant = i;
+			build.bFromCache = true;
+			build.vertexShader = 0;
+			build.fragmentShader = 0;
+			build.program = cached;
+			m_pendingBuilds.push_back(build);
+		}
+		else
+		{
+			m_pendingBuilds.push_back(StartBuild(i, m_variants[i].key));
+		}
+	}
+}
+
+/***********************************************************
+ *  FinishReload()
+ *
+ *  This method is used for swapping in the rebuilt programs
+ *  once the driver has finished all of them.  If a variant
+ *  that has a working program fails, all of them are thrown
+ *  away and the old programs stay in use, so the scene keeps
+ *  drawing while the shader is fixed.  Variants that never
+ *  compiled are rebuilt too, but do not hold the others back
+ *  - they pick up their program as soon as the fix builds.
+ ***********************************************************/
+bool ShaderPermutations::FinishReload()
+{
+	if (m_pendingBuilds.empty())
+	{
+		return(false);
+	}
+
+	for (size_t i = 0; i < m_pendingBuilds.size(); i++)
+	{
+		if (IsBuildDone(m_pendingBuilds[i]) == false)
+		{
+			return(false);
+		}
+	}
+
+	std::vector<PROGRAM_BUILD> builds;
+	builds.swap(m_pendingBuilds);
+	std::vector<GLuint> programs(builds.size(), 0);
+	bool bLinked = true;
+	for (size_t i = 0; i < builds.size(); i++)
+	{
+		programs[i] = FinishBuild(builds[i]);
+		if (m_variants[builds[i].variant].program.IsValid())
+		{
+			bLinked = bLinked && (programs[i] != 0);
+		}
+	}
+
+	if (bLinked == false)
+	{
+		for (size_t i = 0; i < programs.size(); i++)
+		{
+			if (programs[i] != 0)
+			{
+				glDeleteProgram(programs[i]);
+			}
+		}
+		std::cout << "Shader reload failed, keeping the previous programs" << std::endl;
+		return(false);
+	}
+
+	int reloaded = 0;
+	for (size_t i = 0; i < builds.size(); i++)
+	{
+		// a variant that failed before and still fails stays empty
+		if (programs[i] == 0)
+		{
+			continue;
+		}
+		if (builds[i].bFromCache == false)
+		{
+			SaveCachedProgram(m_variants[builds[i].variant].key, programs[i]);
+		}
+		AdoptVariant(builds[i].variant, programs[i]);
+		reloaded++;
+	}
+	m_generation++;
+
+	std::cout << "Reloaded " << reloaded << " of " << builds.size() << " shader permutation(s)" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  CacheHash()
+ *
+ *  This method is used for getting the hash that names the
+ *  cache file of a key - the defines on top of the sources
+ *  and the driver.
+ ***********************************************************/
+uint64_t ShaderPermutations::CacheHash(int key) const
+{
+	return(HashString(m_sourceHash, BuildDefines(key).c_str()));
+}
+
+/***********************************************************
+ *  CachePath()
+ *
+ *  This method is used for getting the path of the cache
+ *  file of a key.
+ ***********************************************************/
+std::string ShaderPermutations::CachePath(int key) const
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.shaderbin", (unsigned long long)CacheHash(key));
+
+	return(m_cacheDirectory + "/" + name);
+}
+
+/***********************************************************
+ *  LoadCachedProgram()
+ *
+ *  This method is used for creating a program from its
+ *  cached binary.  The driver may still refuse a binary
+ *  that matches, after an update that kept its version
+ *  string, and the variant is then compiled from source
+ *  and saved again.
+ ***********************************************************/
+GLuint ShaderPermutations::LoadCachedProgram(int key)
+{
+	if (m_bCacheEnabled == false)
+	{
+		return(0);
+	}
+
+	std::string path = CachePath(key);
+	MappedFile file;
+	if (file.Open(path.c_str()) == false)
+	{
+		return(0);
+	}
+
+	const CACHE_HEADER* pHeader = (const CACHE_HEADER*)file.Data();
+	bool bValid = (file.Size() >= sizeof(CACHE_HEADER)) &&
+		(memcmp(pHeader->magic, g_CacheMagic, sizeof(g_CacheMagic)) == 0) &&
+		(pHeader->version == g_CacheVersion) &&
+		(pHeader->hash == CacheHash(key)) &&
+		(pHeader->binaryLength <= file.Size() - sizeof(CACHE_HEADER));
+	if (bValid == false)
+	{
+		std::cout << "Ignoring shader cache file:" << path << std::endl;
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	glProgramBinary(programID, pHeader->binaryFormat, file.Data() + sizeof(CACHE_HEADER), (GLsizei)pHeader->binaryLength);
+
+	GLint success = 0;
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		std::cout << "The driver rejected shader cache file:" << path << std::endl;
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	return(programID);
+}
+
+/***********************************************************
+ *  SaveCachedProgram()
+ *
+ *  This method is used for writing the binary of a linked
+ *  program to its cache file.  The header goes in last, so
+ *  a file that was cut short is never loaded.
+ ***********************************************************/
+void ShaderPermutations::SaveCachedProgram(int key, GLuint programID)
+{
+	if (m_bCacheEnabled == false)
+	{
+		return;
+	}
+
+	GLint length = 0;
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+	{
+		return;
+	}
+
+	std::vector<unsigned char> binary((size_t)length);
+	GLsizei written = 0;
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(programID, length, &written, &binaryFormat, binary.data());
+	if (written <= 0)
+	{
+		return;
+	}
+
+	std::string path = CachePath(key);
+	FILE* file = fopen(path.c_str(), "wb");
+	if (NULL == file)
+	{
+		std::cout << "Could not write shader cache file:" << path << std::endl;
+		return;
+	}
+
+	CACHE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	fwrite(&header, sizeof(header), 1, file);
+	fwrite(binary.data(), 1, (size_t)written, file);
+
+	memcpy(header.magic, g_CacheMagic, sizeof(header.magic));
+	header.version = g_CacheVersion;
+	header.hash = CacheHash(key);
+	header.binaryFormat = (uint32_t)binaryFormat;
+	header.binaryLength = (uint32_t)written;
+	fseek(file, 0, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, file);
+	bool bWritten = (ferror(file) == 0);
+	fclose(file);
+
+	if (bWritten == false)
+	{
+		std::cout << "Could not write shader cache file:" << path << std::endl;
+		remove(path.c_str());
+	}
+}
@@ -0,0 +1,199 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderpermutations.h
+// ============
+// compile variants of the scene shaders with #defines selected per draw
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "ResourceManager.h"
+#include "UniformBlocks.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  ShaderPermutations
+ *
+ *  This class compiles variants of the vertex and fragment
+ *  shader files with a set of #defines injected after the
+ *  #version line.  Each variant is described by a key made
+ *  from the permutation flags and the number of active
+ *  point lights, so features that are off are removed by the
+ *  compiler instead of being skipped with uniform branches.
+ *
+ *  Variants are compiled the first time they are requested
+ *  and are then found again by a small index, which fits in
+ *  the shader bits of a render queue key.  The base program,
+ *  the shader files with no defines at all, is requested and
+ *  cached the same way, so it is reloaded with the variants.
+ *
+ *  Linked programs are saved to disk with glGetProgramBinary
+ *  and loaded back with glProgramBinary on the next launch,
+ *  so a variant is only compiled from source once.  A cache
+ *  file is named by a hash of both sources, the defines and
+ *  the driver's vendor, renderer and version strings, so an
+ *  edited shader or a new driver misses the cache instead of
+ *  loading a stale binary.
+ *
+ *  With hot reload on, the shader files are watched and every
+ *  variant is rebuilt when one changes.  The new programs are
+ *  compiled on the driver's own threads where it supports
+ *  that, and only replace the old ones once all of them have
+ *  linked, so a typo keeps the last working shaders.
+ ***********************************************************/
+class ShaderPermutations
+{
+public:
+	// constructor
+	ShaderPermutations(const char* vertexShaderPath, const char* fragmentShaderPath, UniformBlocks* pUniformBlocks, ResourceManager* pResources);
+	// destructor
+	~ShaderPermutations();
+
+	// features that can be compiled in or out
+	enum PermutationFlag
+	{
+		PERMUTATION_LIGHTING = 1,
+		PERMUTATION_TEXTURE = 2,
+		PERMUTATION_DIRECTIONAL_LIGHT = 4,
+		PERMUTATION_SPOT_LIGHT = 8,
+		// point lights are read from the cluster buffers
+		PERMUTATION_CLUSTERED_LIGHTS = 16,
+		// only writes depth - used for the depth pre-pass
+		PERMUTATION_DEPTH_ONLY = 32,
+		// writes a flat color per fragment to show overdraw
+		PERMUTATION_OVERDRAW = 64,
+		// the first point light and the directional light are
+		// shadowed by the maps in ShadowMaps
+		PERMUTATION_POINT_SHADOW = 128,
+		PERMUTATION_DIRECTIONAL_SHADOW = 256
+	};
+
+	// read the options from the command line:
+	//   --shader-cache <dir>    where program binaries are kept (default shaders/cache)
+	//   --no-shader-cache       always compile from source
+	//   --hot-reload-shaders    rebuild the variants when a shader file changes
+	void ParseArguments(int argc, char* argv[]);
+	// check what the driver supports for the cache and the hot
+	// reload - needs a current OpenGL context
+	void Create();
+
+	// build the key for a combination of flags and active point lights
+	static int MakeKey(int flags, int pointLightCount);
+	// key of the base program - nothing is injected, so every
+	// feature is left to the uniforms
+	static const int BASE_KEY = -1;
+
+	// get the index of the variant for a key, compiling it the
+	// first time - -1 if it does not compile
+	int Request(int key);
+	// OpenGL program of a variant returned by Request()
+	GLuint Program(int index) const;
+	int Count() const { return((int)m_variants.size()); }
+
+	// watch the shader files and swap in rebuilt programs - called
+	// once per frame, returns true when the programs were replaced
+	bool Update();
+	// counts the reloads, so users of the old programs can tell
+	// their uniform locations are stale
+	int Generation() const { return(m_generation); }
+
+	// release every compiled program
+	void Destroy();
+
+private:
+	struct VARIANT
+	{
+		int key;
+		// empty when the variant failed to compile
+		ResourceManager::Handle program;
+	};
+
+	// a program whose compile and link calls have been made, but
+	// whose results have not been read yet
+	struct PROGRAM_BUILD
+	{
+		int variant;
+		GLuint vertexShader;
+		GLuint fragmentShader;
+		GLuint program;
+		// loaded from the cache, so there is nothing to save
+		bool bFromCache;
+	};
+
+	// first bytes of a program binary cache file - the magic is
+	// written last, so a file cut short is never loaded
+	struct CACHE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t hash;
+		uint32_t binaryFormat;
+		uint32_t binaryLength;
+	};
+
+	std::string m_vertexShaderPath;
+	std::string m_fragmentShaderPath;
+	std::string m_vertexSource;
+	std::string m_fragmentSource;
+	UniformBlocks* m_pUniformBlocks;
+	ResourceManager* m_pResources;
+	std::vector<VARIANT> m_variants;
+
+	// program binary cache - off when the directory is empty or
+	// the driver has no binary formats
+	std::string m_cacheDirectory;
+	bool m_bCacheEnabled;
+	// hash of the driver strings, and of them with both sources
+	uint64_t m_driverHash;
+	uint64_t m_sourceHash;
+
+	// hot reload of the shader files
+	bool m_bHotReload;
+	bool m_bParallelCompile;
+	uint64_t m_vertexStamp[2];
+	uint64_t m_fragmentStamp[2];
+	std::chrono::steady_clock::time_point m_nextWatchTime;
+	std::vector<PROGRAM_BUILD> m_pendingBuilds;
+	int m_generation;
+
+	// read the shader files the first time a variant is compiled
+	bool LoadSources();
+	// read the sources again after a change - the old ones are
+	// kept when a file cannot be read
+	bool ReloadSources();
+	void HashSources();
+	// the #define lines for a key
+	static std::string BuildDefines(int key);
+	// put the defines right after the #version line
+	static std::string InjectDefines(const std::string& source, const std::string& defines);
+
+	// make the compile and link calls for a key without waiting
+	// for their results
+	PROGRAM_BUILD StartBuild(int variant, int key);
+	// whether the driver has finished a build started above
+	bool IsBuildDone(const PROGRAM_BUILD& build) const;
+	// read the results of a build and print the logs when it
+	// failed - the linked program, or 0
+	GLuint FinishBuild(PROGRAM_BUILD& build);
+	// give a linked program to the resource manager and connect
+	// it to the uniform blocks
+	void AdoptVariant(int variant, GLuint programID);
+	// start rebuilding every variant after the sources changed
+	void StartReload();
+	// swap in the rebuilt programs once all of them are done
+	bool FinishReload();
+
+	// program binary cache file of a key
+	std::string CachePath(int key) const;
+	uint64_t CacheHash(int key) const;
+	GLuint LoadCachedProgram(int key);
+	void SaveCachedProgram(int key, GLuint programID);
+};
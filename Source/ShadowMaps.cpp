@@ -0,0 +1,440 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadowmaps.cpp
+// ============
+// cached depth maps for the shadows of the lamp and the directional light
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShadowMaps.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const int g_DefaultMapSize = 1024;
+	const int g_MinMapSize = 256;
+	const int g_MaxMapSize = 4096;
+	const int g_DefaultFilterQuality = 1;
+	// near plane of the cube map faces, and the far plane used
+	// for point lights that never fade out
+	const float g_PointShadowNear = 0.1f;
+	const float g_PointShadowFar = 100.0f;
+
+	// look direction and up vector of each cube map face, in the
+	// order of GL_TEXTURE_CUBE_MAP_POSITIVE_X and the faces after it
+	const glm::vec3 g_FaceDirections[6] =
+	{
+		glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+	};
+	const glm::vec3 g_FaceUps[6] =
+	{
+		glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+		glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)
+	};
+}
+
+/***********************************************************
+ *  ShadowMaps()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShadowMaps::ShadowMaps(ResourceManager* pResources)
+{
+	m_pResources = pResources;
+	m_bEnabled = true;
+	m_mapSize = g_DefaultMapSize;
+	m_filterQuality = g_DefaultFilterQuality;
+	for (int map = 0; map < MAP_COUNT; map++)
+	{
+		m_bDirty[map] = true;
+	}
+
+	m_bPointActive = false;
+	m_pointPosition = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_pointRange = 0.0f;
+
+	m_bDirectionalActive = false;
+	m_direction = glm::vec3(0.0f, -1.0f, 0.0f);
+	m_sceneCenter = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_sceneRadius = 0.0f;
+	m_directionalView = glm::mat4(1.0f);
+	m_directionalProjection = glm::mat4(1.0f);
+	m_directionalMatrix = glm::mat4(1.0f);
+}
+
+/***********************************************************
+ *  ~ShadowMaps()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShadowMaps::~ShadowMaps()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  ParseArguments()
+ *
+ *  This method is used for reading the shadow options from
+ *  the command line.  The map size is rounded down to a
+ *  power of two.
+ ***********************************************************/
+void ShadowMaps::ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--no-shadows") == 0)
+		{
+			m_bEnabled = false;
+		}
+		else if ((strcmp(argv[i], "--shadow-size") == 0) && (i + 1 < argc))
+		{
+			int size = std::max(g_MinMapSize, std::min(atoi(argv[++i]), g_MaxMapSize));
+			m_mapSize = g_MinMapSize;
+			while (m_mapSize * 2 <= size)
+			{
+				m_mapSize *= 2;
+			}
+		}
+		else if ((strcmp(argv[i], "--shadow-filter") == 0) && (i + 1 < argc))
+		{
+			SetFilterQuality(atoi(argv[++i]));
+		}
+	}
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the framebuffer the maps
+ *  are drawn through.  The depth textures themselves are
+ *  only allocated once a light needs them.
+ ***********************************************************/
+void ShadowMaps::Create()
+{
+	if ((m_bEnabled == false) || m_framebuffer.IsValid())
+	{
+		return;
+	}
+
+	m_framebuffer = m_pResources->CreateFramebuffer("shadow map framebuffer");
+	// filtered lookups near a cube edge blend across faces
+	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+	std::cout << "Shadow maps: " << m_mapSize << "x" << m_mapSize << ", filter quality " << m_filterQuality << std::endl;
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the maps and the
+ *  framebuffer.
+ ***********************************************************/
+void ShadowMaps::Destroy()
+{
+	for (int map = 0; map < MAP_COUNT; map++)
+	{
+		m_maps[map].Reset();
+		m_bDirty[map] = true;
+	}
+	m_framebuffer.Reset();
+}
+
+/***********************************************************
+ *  CreateMap()
+ *
+ *  This method is used for allocating the depth texture of a
+ *  map.  Comparison is switched on, so a lookup returns how
+ *  much of the filtered footprint is lit.
+ ***********************************************************/
+void ShadowMaps::CreateMap(MapType map)
+{
+	if ((m_framebuffer.IsValid() == false) || m_maps[map].IsValid())
+	{
+		return;
+	}
+
+	GLenum target = (map == POINT_SHADOW) ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+	m_maps[map] = m_pResources->CreateTexture(ResourceManager::CATEGORY_RENDER_TARGETS, "shadow map");
+	// 24 bit depth is stored in 4 bytes per texel
+	m_maps[map].SetSize((size_t)m_mapSize * m_mapSize * 4 * ViewCount(map));
+	glBindTexture(target, m_maps[map].Name());
+	if (map == POINT_SHADOW)
+	{
+		for (int face = 0; face < 6; face++)
+		{
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_DEPTH_COMPONENT24, m_mapSize, m_mapSize, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+		}
+		glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	}
+	else
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, m_mapSize, m_mapSize, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+		// outside of the map is always lit
+		GLfloat border[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+		glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+		glTexParameterfv(target, GL_TEXTURE_BORDER_COLOR, border);
+	}
+	glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(target, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(target, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	glBindTexture(target, 0);
+
+	m_bDirty[map] = true;
+}
+
+/***********************************************************
+ *  SetPointLight()
+ *
+ *  This method is used for setting the point light that
+ *  casts shadows into the cube map.  The cached map is only
+ *  thrown away when the light has moved or changed reach.
+ ***********************************************************/
+void ShadowMaps::SetPointLight(bool bActive, const glm::vec3& position, float range)
+{
+	if (range <= 0.0f)
+	{
+		range = g_PointShadowFar;
+	}
+
+	if ((bActive != m_bPointActive) || (position != m_pointPosition) || (range != m_pointRange))
+	{
+		m_bPointActive = bActive;
+		m_pointPosition = position;
+		m_pointRange = range;
+		m_bDirty[POINT_SHADOW] = true;
+	}
+	if (m_bPointActive && m_bEnabled)
+	{
+		CreateMap(POINT_SHADOW);
+	}
+}
+
+/***********************************************************
+ *  SetDirectionalLight()
+ *
+ *  This method is used for setting the direction of the
+ *  light that casts shadows into the orthographic map.
+ ***********************************************************/
+void ShadowMaps::SetDirectionalLight(bool bActive, const glm::vec3& direction)
+{
+	glm::vec3 normalized = (glm::length(direction) > 0.0f) ? glm::normalize(direction) : glm::vec3(0.0f, -1.0f, 0.0f);
+	if ((bActive != m_bDirectionalActive) || (normalized != m_direction))
+	{
+		m_bDirectionalActive = bActive;
+		m_direction = normalized;
+		m_bDirty[DIRECTIONAL_SHADOW] = true;
+		FitDirectionalView();
+	}
+	if (m_bDirectionalActive && m_bEnabled)
+	{
+		CreateMap(DIRECTIONAL_SHADOW);
+	}
+}
+
+/***********************************************************
+ *  SetSceneBounds()
+ *
+ *  This method is used for setting the sphere around every
+ *  shadow caster.  The directional map covers the sphere, so
+ *  its texels are spread over the scene and nothing else.
+ ***********************************************************/
+void ShadowMaps::SetSceneBounds(const glm::vec3& center, float radius)
+{
+	if ((center != m_sceneCenter) || (radius != m_sceneRadius))
+	{
+		m_sceneCenter = center;
+		m_sceneRadius = radius;
+		m_bDirty[DIRECTIONAL_SHADOW] = true;
+		FitDirectionalView();
+	}
+}
+
+/***********************************************************
+ *  FitDirectionalView()
+ *
+ *  This method is used for placing the directional light's
+ *  orthographic camera outside the scene sphere, looking
+ *  along the light, with the sphere just inside its box.
+ ***********************************************************/
+void ShadowMaps::FitDirectionalView()
+{
+	float radius = std::max(m_sceneRadius, 1.0f);
+	glm::vec3 eye = m_sceneCenter - m_direction * (radius * 2.0f);
+	// any up vector works as long as it is not along the light
+	glm::vec3 up = (std::abs(m_direction.y) > 0.99f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+	m_directionalView = glm::lookAt(eye, m_sceneCenter, up);
+	m_directionalProjection = glm::ortho(-radius, radius, -radius, radius, radius, radius * 3.0f);
+
+	// clip space to texture space, so the shader can use the
+	// result as the lookup straight away
+	glm::mat4 bias = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.5f, 0.5f, 0.5f)), glm::vec3(0.5f, 0.5f, 0.5f));
+	m_directionalMatrix = bias * m_directionalProjection * m_directionalView;
+}
+
+/***********************************************************
+ *  HasMap()
+ *
+ *  This method is used for checking whether a map is used
+ *  for the current lights.
+ ***********************************************************/
+bool ShadowMaps::HasMap(MapType map) const
+{
+	if ((m_bEnabled == false) || (m_maps[map].IsValid() == false))
+	{
+		return(false);
+	}
+
+	return((map == POINT_SHADOW) ? m_bPointActive : m_bDirectionalActive);
+}
+
+/***********************************************************
+ *  InvalidateSphere()
+ *
+ *  This method is used for marking the maps that an object
+ *  which moved can throw a shadow into.  It is called with
+ *  both the old and the new bounds, so moving out of a
+ *  light's reach clears the old shadow too.
+ ***********************************************************/
+void ShadowMaps::InvalidateSphere(const glm::vec3& center, float radius)
+{
+	if (radius < 0.0f)
+	{
+		return;
+	}
+
+	if (HasMap(POINT_SHADOW) && (glm::length(center - m_pointPosition) < radius + m_pointRange))
+	{
+		m_bDirty[POINT_SHADOW] = true;
+	}
+	if (HasMap(DIRECTIONAL_SHADOW) && (glm::length(center - m_sceneCenter) < radius + m_sceneRadius))
+	{
+		m_bDirty[DIRECTIONAL_SHADOW] = true;
+	}
+}
+
+/***********************************************************
+ *  InvalidateAll()
+ *
+ *  This method is used for marking every map for drawing.
+ ***********************************************************/
+void ShadowMaps::InvalidateAll()
+{
+	for (int map = 0; map < MAP_COUNT; map++)
+	{
+		m_bDirty[map] = true;
+	}
+}
+
+/***********************************************************
+ *  IsCaster()
+ *
+ *  This method is used for checking whether an object with
+ *  the passed in bounding sphere is drawn into a map.
+ ***********************************************************/
+bool ShadowMaps::IsCaster(MapType map, const glm::vec3& center, float radius) const
+{
+	if (radius < 0.0f)
+	{
+		return(false);
+	}
+	if (map == DIRECTIONAL_SHADOW)
+	{
+		return(true);
+	}
+
+	float distance = glm::length(center - m_pointPosition);
+	return((distance >= radius) && (distance < radius + m_pointRange));
+}
+
+/***********************************************************
+ *  BeginView()
+ *
+ *  This method is used for attaching one face of a map to
+ *  the framebuffer, clearing it and returning the camera
+ *  values of the face.  The caller restores its own
+ *  framebuffer and viewport when the map is done.
+ ***********************************************************/
+UniformBlocks::FRAME_BLOCK ShadowMaps::BeginView(MapType map, int view)
+{
+	UniformBlocks::FRAME_BLOCK frame;
+	frame.time = 0.0f;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.Name());
+	if (map == POINT_SHADOW)
+	{
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + view, m_maps[map].Name(), 0);
+		frame.view = glm::lookAt(m_pointPosition, m_pointPosition + g_FaceDirections[view], g_FaceUps[view]);
+		frame.projection = glm::perspective(glm::radians(90.0f), 1.0f, g_PointShadowNear, m_pointRange);
+		frame.viewPosition = m_pointPosition;
+	}
+	else
+	{
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_maps[map].Name(), 0);
+		frame.view = m_directionalView;
+		frame.projection = m_directionalProjection;
+		frame.viewPosition = m_sceneCenter - m_direction * (std::max(m_sceneRadius, 1.0f) * 2.0f);
+	}
+	// depth only - there is no color buffer to write
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+
+	glViewport(0, 0, m_mapSize, m_mapSize);
+	glClear(GL_DEPTH_BUFFER_BIT);
+
+	return(frame);
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used for binding the maps to their
+ *  texture units.
+ ***********************************************************/
+void ShadowMaps::Bind() const
+{
+	glActiveTexture(GL_TEXTURE0 + POINT_SHADOW_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, m_maps[POINT_SHADOW].Name());
+	glActiveTexture(GL_TEXTURE0 + DIRECTIONAL_SHADOW_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_maps[DIRECTIONAL_SHADOW].Name());
+	glActiveTexture(GL_TEXTURE0);
+}
+
+/***********************************************************
+ *  PointShadowPlanes()
+ *
+ *  This method is used for getting the near and far plane
+ *  of the cube map faces, which the shader needs to turn a
+ *  distance into the depth stored in the map.
+ ***********************************************************/
+glm::vec2 ShadowMaps::PointShadowPlanes() const
+{
+	return(glm::vec2(g_PointShadowNear, m_pointRange));
+}
+
+/***********************************************************
+ *  SetFilterQuality()
+ *
+ *  This method is used for picking how many taps the shader
+ *  averages for each shadow lookup.
+ ***********************************************************/
+void ShadowMaps::SetFilterQuality(int quality)
+{
+	m_filterQuality = std::max(0, std::min(quality, MAX_FILTER_QUALITY));
+}
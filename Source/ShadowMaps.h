@@ -0,0 +1,140 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadowmaps.h
+// ============
+// cached depth maps for the shadows of the lamp and the directional light
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "ResourceManager.h"
+#include "UniformBlocks.h"
+
+/***********************************************************
+ *  ShadowMaps
+ *
+ *  This class owns the depth maps used for shadows: a cube
+ *  map around the first point light - the hanging lamp - and
+ *  an orthographic map for the directional light, fitted
+ *  around the whole scene.  The maps are depth textures with
+ *  comparison on, so every lookup is already filtered by the
+ *  hardware, and the shader adds more taps for the filter
+ *  quality that was picked.
+ *
+ *  Rendering a cube map costs six passes over the casters,
+ *  so the maps are cached.  A map is only marked for drawing
+ *  again when its light changes or when an object moves in
+ *  or out of the light's reach.
+ ***********************************************************/
+class ShadowMaps
+{
+public:
+	// constructor
+	ShadowMaps(ResourceManager* pResources);
+	// destructor
+	~ShadowMaps();
+
+	// texture units the maps are bound to - above the texture
+	// arrays, below the cluster buffers
+	enum TextureUnit
+	{
+		POINT_SHADOW_TEXTURE_UNIT = 11,
+		DIRECTIONAL_SHADOW_TEXTURE_UNIT = 12
+	};
+
+	enum MapType
+	{
+		POINT_SHADOW,
+		DIRECTIONAL_SHADOW,
+		MAP_COUNT
+	};
+
+	// highest PCF filter quality - 0 is a single hardware filtered
+	// lookup, each step adds a ring of taps
+	static const int MAX_FILTER_QUALITY = 2;
+
+	// read the options from the command line:
+	//   --no-shadows            draw without shadows
+	//   --shadow-size <n>       size of the map faces (default 1024)
+	//   --shadow-filter <0-2>   PCF filter quality (default 1)
+	void ParseArguments(int argc, char* argv[]);
+
+	// create the framebuffer - needs a current OpenGL context
+	void Create();
+	// free the maps and the framebuffer
+	void Destroy();
+
+	// the light casting each kind of shadow - the maps are kept
+	// when the values have not changed
+	void SetPointLight(bool bActive, const glm::vec3& position, float range);
+	void SetDirectionalLight(bool bActive, const glm::vec3& direction);
+	// sphere around every shadow caster, which the directional
+	// map is fitted to
+	void SetSceneBounds(const glm::vec3& center, float radius);
+
+	bool Enabled() const { return(m_bEnabled); }
+	// whether a map is in use for the current lights
+	bool HasMap(MapType map) const;
+	// which maps have to be drawn again before they are sampled
+	bool NeedsRender(MapType map) const { return(HasMap(map) && m_bDirty[map]); }
+	// mark the maps a moving caster's bounding sphere reaches
+	void InvalidateSphere(const glm::vec3& center, float radius);
+	// mark every map for drawing again
+	void InvalidateAll();
+
+	// whether a caster's bounding sphere can throw a shadow into a
+	// map - objects the point light sits inside, like the lamp's
+	// own bulb, are left out so they do not cover everything
+	bool IsCaster(MapType map, const glm::vec3& center, float radius) const;
+
+	// views rendered into a map - six faces for the cube map
+	int ViewCount(MapType map) const { return((map == POINT_SHADOW) ? 6 : 1); }
+	// bind one view of a map for drawing, cleared, and get the
+	// camera values to draw it with
+	UniformBlocks::FRAME_BLOCK BeginView(MapType map, int view);
+	// mark the map as drawn
+	void EndMap(MapType map) { m_bDirty[map] = false; }
+
+	// bind the maps to their texture units
+	void Bind() const;
+
+	// values the shader needs to look up the maps
+	glm::vec3 PointLightPosition() const { return(m_pointPosition); }
+	// near and far plane of the cube map faces
+	glm::vec2 PointShadowPlanes() const;
+	// world space to directional map texture space
+	const glm::mat4& DirectionalShadowMatrix() const { return(m_directionalMatrix); }
+	int FilterQuality() const { return(m_filterQuality); }
+	void SetFilterQuality(int quality);
+
+private:
+	ResourceManager* m_pResources;
+	bool m_bEnabled;
+	int m_mapSize;
+	int m_filterQuality;
+	ResourceManager::Handle m_framebuffer;
+	ResourceManager::Handle m_maps[MAP_COUNT];
+	bool m_bDirty[MAP_COUNT];
+
+	bool m_bPointActive;
+	glm::vec3 m_pointPosition;
+	float m_pointRange;
+
+	bool m_bDirectionalActive;
+	glm::vec3 m_direction;
+	glm::vec3 m_sceneCenter;
+	float m_sceneRadius;
+	glm::mat4 m_directionalView;
+	glm::mat4 m_directionalProjection;
+	glm::mat4 m_directionalMatrix;
+
+	// allocate the depth texture of a map the first time it is used
+	void CreateMap(MapType map);
+	// place the directional light's camera around the scene
+	void FitDirectionalView();
+};
@@ -0,0 +1,876 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturelibrary.cpp
+// ============
+// load texture images and pack them into OpenGL texture arrays
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureLibrary.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"      // Image loading Utility functions
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// most decode threads started - decoding is limited by the disk
+	// and memory bandwidth well before every core is busy
+	const unsigned int g_MaxDecodeThreads = 4;
+	// default bytes of pixels uploaded per frame
+	const size_t g_DefaultUploadBudget = 8 * 1024 * 1024;
+	// color of the placeholder texture - a neutral gray
+	const unsigned char g_PlaceholderPixel[4] = { 128, 128, 128, 255 };
+}
+
+/***********************************************************
+ *  TextureLibrary()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureLibrary::TextureLibrary(ResourceManager* pResources)
+{
+	m_pResources = pResources;
+	m_loadingCount = 0;
+	m_nextUploadBuffer = 0;
+	m_uploadBudget = g_DefaultUploadBudget;
+	m_bStopping = false;
+}
+
+/***********************************************************
+ *  ~TextureLibrary()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureLibrary::~TextureLibrary()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  ParseArguments()
+ *
+ *  This method is used for reading the texture quality
+ *  options from the command line.
+ ***********************************************************/
+void TextureLibrary::ParseArguments(int argc, char* argv[])
+{
+	m_quality.ParseArguments(argc, argv);
+}
+
+/***********************************************************
+ *  LoadTexture()
+ *
+ *  This method is used for requesting a texture from an
+ *  image file.  Only the image header is read here, so the
+ *  call returns right away, and the pixels are decoded on a
+ *  worker thread.  Every image is expanded to RGBA so that
+ *  all images of one size can share an array.  The size is
+ *  reduced here when the texture's tier drops mip levels.
+ ***********************************************************/
+bool TextureLibrary::LoadTexture(const char* filename, const std::string& tag, TextureQuality::Tier tier)
+{
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	if (Find(tag) >= 0)
+	{
+		std::cout << "Texture tag already in use:" << tag << std::endl;
+		return false;
+	}
+
+	DECODE_JOB job;
+	job.filename = filename;
+	job.bCompressed = false;
+	job.droppedLevels = 0;
+
+	// use a precompressed copy of the image when there is one
+	std::string ddsFilename = filename;
+	size_t extension = ddsFilename.find_last_of('.');
+	if (extension != std::string::npos)
+	{
+		ddsFilename = ddsFilename.substr(0, extension);
+	}
+	ddsFilename += ".dds";
+
+	if (DDSLoader::ReadHeader(ddsFilename.c_str(), job.dds))
+	{
+		if (DDSLoader::IsFormatSupported(job.dds.format))
+		{
+			job.filename = ddsFilename;
+			job.bCompressed = true;
+		}
+		else
+		{
+			std::cout << "Compressed format not supported, using the image instead:" << ddsFilename << std::endl;
+		}
+	}
+
+	GLenum format = GL_RGBA8;
+	int mipLevels = 1;
+	if (job.bCompressed)
+	{
+		width = job.dds.width;
+		height = job.dds.height;
+		format = job.dds.format;
+		mipLevels = job.dds.mipLevels;
+		std::cout << "Queued image:" << job.filename << ", width:" << width << ", height:" << height << ", mip levels:" << mipLevels << std::endl;
+	}
+	else
+	{
+		// the header is enough to reserve a layer of the right size
+		if (stbi_info(filename, &width, &height, &colorChannels) == 0)
+		{
+			std::cout << "Could not load image:" << filename << std::endl;
+			return false;
+		}
+
+		if ((colorChannels != 3) && (colorChannels != 4))
+		{
+			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
+			return false;
+		}
+
+		std::cout << "Queued image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
+	}
+
+	tier = m_quality.Resolve(tier);
+	job.droppedLevels = m_quality.DroppedLevels(tier, width, height, job.bCompressed ? mipLevels : 0);
+	if (job.droppedLevels > 0)
+	{
+		width >>= job.droppedLevels;
+		height >>= job.droppedLevels;
+		if (job.bCompressed)
+		{
+			mipLevels -= job.droppedLevels;
+		}
+		std::cout << "Dropped " << job.droppedLevels << " mip level(s) for " << TextureQuality::TierName(tier) << " quality:" << job.filename << std::endl;
+	}
+
+	TEXTURE_INFO info;
+	info.tag = tag;
+	info.filename = job.filename;
+	info.arrayIndex = -1;
+	info.layer = -1;
+	info.width = width;
+	info.height = height;
+	info.format = format;
+	info.mipLevels = mipLevels;
+	info.tier = tier;
+	info.droppedLevels = job.droppedLevels;
+	info.bReady = false;
+	info.bRejected = false;
+	m_textures.push_back(info);
+	m_lookup[tag] = (int)m_textures.size() - 1;
+	m_loadingCount++;
+
+	StartWorkers();
+
+	job.texture = (int)m_textures.size() - 1;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(job);
+	}
+	m_jobsReady.notify_one();
+
+	return true;
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for reserving texture array layers
+ *  for every texture that does not have one yet.  Images
+ *  with the same size, format, number of mip levels and
+ *  quality tier go into the same array, split across
+ *  several arrays if there are more of them than the driver
+ *  allows layers.  The layers are filled in by Update() as
+ *  the images finish decoding.  Textures that would need
+ *  more than MAX_ARRAYS arrays are left on the placeholder.
+ ***********************************************************/
+void TextureLibrary::Build()
+{
+	if (m_placeholder.IsValid() == false)
+	{
+		CreatePlaceholder();
+		m_quality.Create(m_pResources);
+	}
+
+	GLint maxLayers = 256;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+	for (size_t first = 0; first < m_textures.size(); first++)
+	{
+		if ((m_textures[first].arrayIndex >= 0) || m_textures[first].bRejected)
+		{
+			continue;
+		}
+
+		// the units above the arrays belong to the shadow maps and
+		// the light clusters
+		if ((int)m_arrays.size() >= MAX_ARRAYS)
+		{
+			std::cout << "No texture unit left for a texture array, using the placeholder for:" << m_textures[first].filename << std::endl;
+			m_textures[first].bRejected = true;
+			continue;
+		}
+
+		TEXTURE_ARRAY textureArray;
+		textureArray.width = m_textures[first].width;
+		textureArray.height = m_textures[first].height;
+		textureArray.format = m_textures[first].format;
+		textureArray.mipLevels = m_textures[first].mipLevels;
+		textureArray.tier = m_textures[first].tier;
+		textureArray.layers = 0;
+
+		// gather the textures that can share an array with this one
+		for (size_t i = first; (i < m_textures.size()) && (textureArray.layers < maxLayers); i++)
+		{
+			TEXTURE_INFO& info = m_textures[i];
+			if ((info.arrayIndex < 0) && (info.width == textureArray.width) && (info.height == textureArray.height) &&
+				(info.format == textureArray.format) && (info.mipLevels == textureArray.mipLevels) &&
+				(info.tier == textureArray.tier))
+			{
+				info.arrayIndex = (int)m_arrays.size();
+				info.layer = textureArray.layers;
+				textureArray.layers++;
+			}
+		}
+		textureArray.pendingLayers = textureArray.layers;
+
+		textureArray.texture = m_pResources->CreateTexture(ResourceManager::CATEGORY_TEXTURES, "texture array");
+		textureArray.texture.SetSize(ArrayBytes(textureArray));
+		glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray.texture.Name());
+
+		// set the texture wrapping parameters
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		// set texture filtering parameters - the tier's sampler
+		// overrides these while drawing
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		// reserve the storage - the pixels arrive later
+		if (textureArray.format == GL_RGBA8)
+		{
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8,
+				textureArray.width, textureArray.height, textureArray.layers,
+				0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+			// only the first level exists until the mipmaps are
+			// generated, so keep the array complete without them
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+		}
+		else
+		{
+			// every mip level comes from the file, none are generated
+			DDSLoader::DDS_INFO levels;
+			levels.width = textureArray.width;
+			levels.height = textureArray.height;
+			levels.blockBytes = (textureArray.format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16;
+			for (int level = 0; level < textureArray.mipLevels; level++)
+			{
+				int levelWidth = (textureArray.width >> level) > 0 ? (textureArray.width >> level) : 1;
+				int levelHeight = (textureArray.height >> level) > 0 ? (textureArray.height >> level) : 1;
+				glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, textureArray.format,
+					levelWidth, levelHeight, textureArray.layers, 0,
+					(GLsizei)(DDSLoader::LevelSize(levels, level) * textureArray.layers), NULL);
+			}
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, textureArray.mipLevels - 1);
+		}
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+		std::cout << "Reserved " << textureArray.layers << " texture(s) of " << textureArray.width << "x" << textureArray.height << " at " << TextureQuality::TierName(textureArray.tier) << " quality in texture array " << m_arrays.size() << std::endl;
+
+		m_arrays.push_back(textureArray);
+	}
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used for binding the placeholder to
+ *  texture unit 0 and each texture array to the unit after
+ *  its index, along with the sampler of the array's tier.
+ ***********************************************************/
+void TextureLibrary::Bind() const
+{
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_placeholder.Name());
+
+	for (size_t i = 0; i < m_arrays.size(); i++)
+	{
+		glActiveTexture(GL_TEXTURE1 + (GLenum)i);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_arrays[i].texture.Name());
+		glBindSampler(1 + (GLuint)i, m_quality.Sampler(m_arrays[i].tier));
+	}
+	glActiveTexture(GL_TEXTURE0);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for uploading the images that the
+ *  worker threads have finished decoding.  It is called once
+ *  per frame and stops after the upload budget is used, so
+ *  a large batch of textures is spread over several frames
+ *  instead of stalling one.
+ ***********************************************************/
+void TextureLibrary::Update()
+{
+	if (m_loadingCount == 0)
+	{
+		return;
+	}
+
+	std::vector<DECODED_IMAGE> decoded;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		decoded.swap(m_decoded);
+	}
+
+	if (decoded.empty())
+	{
+		return;
+	}
+
+	std::vector<DECODED_IMAGE> waiting;
+	size_t uploadedBytes = 0;
+	for (size_t i = 0; i < decoded.size(); i++)
+	{
+		const DECODED_IMAGE& image = decoded[i];
+
+		// images that did not get an array are never uploaded
+		if (m_textures[image.texture].bRejected)
+		{
+			FreeImage(decoded[i]);
+			m_loadingCount--;
+			continue;
+		}
+
+		// images without a layer yet, or over the budget, wait for a later frame
+		if ((m_textures[image.texture].arrayIndex < 0) ||
+			((uploadedBytes > 0) && (uploadedBytes >= m_uploadBudget)))
+		{
+			waiting.push_back(image);
+			continue;
+		}
+
+		if (image.pixels == NULL)
+		{
+			// the header could be read but the pixels could not
+			std::cout << "Could not load image:" << m_textures[image.texture].filename << std::endl;
+			FinishLayer(m_textures[image.texture]);
+			continue;
+		}
+
+		UploadImage(image);
+		uploadedBytes += image.size;
+
+		// free the image data from local memory
+		FreeImage(decoded[i]);
+	}
+
+	if (waiting.empty() == false)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_decoded.insert(m_decoded.end(), waiting.begin(), waiting.end());
+	}
+
+	if (m_loadingCount == 0)
+	{
+		std::cout << "All textures loaded" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for stopping the worker threads and
+ *  freeing every texture array and any decoded images that
+ *  were never uploaded.
+ ***********************************************************/
+void TextureLibrary::Destroy()
+{
+	StopWorkers();
+
+	for (size_t i = 0; i < m_decoded.size(); i++)
+	{
+		FreeImage(m_decoded[i]);
+	}
+	m_decoded.clear();
+	m_jobs.clear();
+
+	// the handles hand the objects back to the resource manager,
+	// which deletes them once the GPU is done with them
+	m_arrays.clear();
+	m_placeholder.Reset();
+	m_uploadBuffers[0].Reset();
+	m_uploadBuffers[1].Reset();
+	m_quality.Destroy();
+
+	m_textures.clear();
+	m_lookup.clear();
+	m_loadingCount = 0;
+}
+
+/***********************************************************
+ *  Find()
+ *
+ *  This method is used for getting the index of the loaded
+ *  texture associated with the passed in tag.
+ ***********************************************************/
+int TextureLibrary::Find(const std::string& tag) const
+{
+	std::unordered_map<std::string, int>::const_iterator found = m_lookup.find(tag);
+	if (found == m_lookup.end())
+	{
+		return(-1);
+	}
+
+	return(found->second);
+}
+
+/***********************************************************
+ *  TextureUnit()
+ *
+ *  This method is used for getting the texture unit to
+ *  sample for the passed in texture.  Until the texture's
+ *  pixels have been uploaded this is the placeholder unit.
+ ***********************************************************/
+int TextureLibrary::TextureUnit(int texture) const
+{
+	if ((texture < 0) || (texture >= (int)m_textures.size()))
+	{
+		return(-1);
+	}
+
+	if ((m_textures[texture].bReady == false) || (m_textures[texture].arrayIndex < 0))
+	{
+		return(0);
+	}
+
+	return(m_textures[texture].arrayIndex + 1);
+}
+
+/***********************************************************
+ *  TextureLayer()
+ *
+ *  This method is used for getting the layer to sample for
+ *  the passed in texture.
+ ***********************************************************/
+int TextureLibrary::TextureLayer(int texture) const
+{
+	if ((texture < 0) || (texture >= (int)m_textures.size()) || (m_textures[texture].bReady == false))
+	{
+		return(0);
+	}
+
+	return(m_textures[texture].layer);
+}
+
+/***********************************************************
+ *  TextureArrayID()
+ *
+ *  This method is used for getting the OpenGL texture name
+ *  of the array holding the passed in texture.
+ ***********************************************************/
+GLuint TextureLibrary::TextureArrayID(int texture) const
+{
+	if ((texture < 0) || (texture >= (int)m_textures.size()))
+	{
+		return(0);
+	}
+
+	int arrayIndex = m_textures[texture].arrayIndex;
+	if ((arrayIndex < 0) || (arrayIndex >= (int)m_arrays.size()))
+	{
+		return(0);
+	}
+
+	return(m_arrays[arrayIndex].texture.Name());
+}
+
+/***********************************************************
+ *  SortKey()
+ *
+ *  This method is used for getting a value that orders the
+ *  textures by array first, so that draws sampling the same
+ *  array are sorted next to each other.  The value fits in
+ *  15 bits: 5 bits of array and 10 bits of layer.  It does
+ *  not change when the real pixels replace the placeholder.
+ ***********************************************************/
+int TextureLibrary::SortKey(int texture) const
+{
+	if ((texture < 0) || (texture >= (int)m_textures.size()) || (m_textures[texture].arrayIndex < 0))
+	{
+		return(-1);
+	}
+
+	return(((m_textures[texture].arrayIndex & 0x1F) << 10) | (m_textures[texture].layer & 0x3FF));
+}
+
+/***********************************************************
+ *  StartWorkers()
+ *
+ *  This method is used for starting the decode threads the
+ *  first time a texture is requested.
+ ***********************************************************/
+void TextureLibrary::StartWorkers()
+{
+	if (m_workers.empty() == false)
+	{
+		return;
+	}
+
+	// indicate to always flip images vertically when loaded - set
+	// before any thread starts, since stb_image keeps it globally
+	stbi_set_flip_vertically_on_load(true);
+
+	unsigned int threadCount = std::thread::hardware_concurrency();
+	// leave one core for the render thread
+	threadCount = (threadCount > 1) ? threadCount - 1 : 1;
+	if (threadCount > g_MaxDecodeThreads)
+	{
+		threadCount = g_MaxDecodeThreads;
+	}
+
+	m_bStopping = false;
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		m_workers.push_back(std::thread(&TextureLibrary::DecodeWorker, this));
+	}
+}
+
+/***********************************************************
+ *  StopWorkers()
+ *
+ *  This method is used for stopping the decode threads and
+ *  waiting for them to finish the image each one is on.
+ ***********************************************************/
+void TextureLibrary::StopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_jobsReady.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+	m_workers.clear();
+}
+
+/***********************************************************
+ *  DecodeWorker()
+ *
+ *  This method is run by each decode thread.  It takes jobs
+ *  off the queue and decodes the image files into memory.
+ *  No OpenGL calls are made here - the results are handed
+ *  back to the render thread through m_decoded.
+ ***********************************************************/
+void TextureLibrary::DecodeWorker()
+{
+	for (;;)
+	{
+		DECODE_JOB job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobsReady.wait(lock, [this]() { return(m_bStopping || (m_jobs.empty() == false)); });
+			if (m_bStopping)
+			{
+				return;
+			}
+			job = m_jobs.front();
+			m_jobs.pop_front();
+		}
+
+		DECODED_IMAGE image;
+		int colorChannels = 0;
+		image.texture = job.texture;
+		image.bCompressed = job.bCompressed;
+		if (job.bCompressed)
+		{
+			// compressed blocks are uploaded exactly as stored
+			image.width = job.dds.width;
+			image.height = job.dds.height;
+			image.size = job.dds.dataSize;
+			image.pixels = DDSLoader::ReadData(job.filename.c_str(), job.dds);
+		}
+		else
+		{
+			image.width = 0;
+			image.height = 0;
+			// always ask for four channels
+			image.pixels = stbi_load(
+				job.filename.c_str(),
+				&image.width,
+				&image.height,
+				&colorChannels,
+				4);
+			image.size = (size_t)image.width * (size_t)image.height * 4;
+		}
+		DropLevels(image, job);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_decoded.push_back(image);
+	}
+}
+
+/***********************************************************
+ *  CreatePlaceholder()
+ *
+ *  This method is used for creating the 1x1 texture array
+ *  that is sampled while the real textures are loading, and
+ *  the pixel buffers used to stream the real pixels.
+ ***********************************************************/
+void TextureLibrary::CreatePlaceholder()
+{
+	m_placeholder = m_pResources->CreateTexture(ResourceManager::CATEGORY_TEXTURES, "placeholder texture");
+	m_placeholder.SetSize(sizeof(g_PlaceholderPixel));
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_placeholder.Name());
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 1, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, g_PlaceholderPixel);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	m_uploadBuffers[0] = m_pResources->CreateBuffer(ResourceManager::CATEGORY_BUFFERS, "texture upload buffer");
+	m_uploadBuffers[1] = m_pResources->CreateBuffer(ResourceManager::CATEGORY_BUFFERS, "texture upload buffer");
+}
+
+/***********************************************************
+ *  UploadImage()
+ *
+ *  This method is used for copying a decoded image into its
+ *  texture array layer through a pixel buffer object.  The
+ *  buffer is orphaned before it is written, so the copy does
+ *  not wait for the previous transfer to finish, and the
+ *  driver moves the pixels to the texture asynchronously.
+ ***********************************************************/
+void TextureLibrary::UploadImage(const DECODED_IMAGE& image)
+{
+	TEXTURE_INFO& info = m_textures[image.texture];
+	TEXTURE_ARRAY& textureArray = m_arrays[info.arrayIndex];
+
+	if ((image.width != textureArray.width) || (image.height != textureArray.height))
+	{
+		std::cout << "Image size changed while loading:" << info.filename << std::endl;
+		FinishLayer(info);
+		return;
+	}
+
+	GLsizeiptr size = (GLsizeiptr)image.size;
+	const unsigned char* pixels = image.pixels;
+
+	ResourceManager::Handle& uploadBuffer = m_uploadBuffers[m_nextUploadBuffer];
+	m_nextUploadBuffer = (m_nextUploadBuffer + 1) % 2;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffer.Name());
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+	uploadBuffer.SetSize((size_t)size);
+	void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (mapped != NULL)
+	{
+		memcpy(mapped, image.pixels, (size_t)size);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		// the pixels now come from offsets into the bound buffer
+		pixels = NULL;
+	}
+	else
+	{
+		// fall back to a plain upload from client memory
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	// work on the array's own unit so the other bindings are left alone
+	glActiveTexture(GL_TEXTURE1 + (GLenum)info.arrayIndex);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray.texture.Name());
+	if (image.bCompressed)
+	{
+		DDSLoader::DDS_INFO levels;
+		levels.width = image.width;
+		levels.height = image.height;
+		levels.blockBytes = (textureArray.format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16;
+
+		// the mip levels are stored one after the other
+		size_t offset = 0;
+		for (int level = 0; level < textureArray.mipLevels; level++)
+		{
+			int levelWidth = (image.width >> level) > 0 ? (image.width >> level) : 1;
+			int levelHeight = (image.height >> level) > 0 ? (image.height >> level) : 1;
+			size_t levelSize = DDSLoader::LevelSize(levels, level);
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level,
+				0, 0, info.layer,
+				levelWidth, levelHeight, 1,
+				textureArray.format, (GLsizei)levelSize, (const void*)((uintptr_t)pixels + offset));
+			offset += levelSize;
+		}
+	}
+	else
+	{
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0,
+			0, 0, info.layer,
+			image.width, image.height, 1,
+			GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glActiveTexture(GL_TEXTURE0);
+
+	std::cout << "Uploaded image:" << info.filename << ", width:" << image.width << ", height:" << image.height << std::endl;
+
+	info.bReady = true;
+	FinishLayer(info);
+}
+
+/***********************************************************
+ *  FinishLayer()
+ *
+ *  This method is used for counting off a texture whose
+ *  upload is over, whether its pixels arrived or not.  The
+ *  mipmaps of an array are generated once its last layer is
+ *  done, so an image that fails to load does not keep them
+ *  from the other textures in the array - its own layer is
+ *  never sampled, since the placeholder is used instead.
+ ***********************************************************/
+void TextureLibrary::FinishLayer(TEXTURE_INFO& info)
+{
+	TEXTURE_ARRAY& textureArray = m_arrays[info.arrayIndex];
+
+	textureArray.pendingLayers--;
+	if ((textureArray.pendingLayers == 0) && (textureArray.format == GL_RGBA8))
+	{
+		// work on the array's own unit so the other bindings are left alone
+		glActiveTexture(GL_TEXTURE1 + (GLenum)info.arrayIndex);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray.texture.Name());
+		// generate the texture mipmaps for mapping textures to lower resolutions
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 1000);
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+	m_loadingCount--;
+}
+
+/***********************************************************
+ *  FreeImage()
+ *
+ *  This method is used for freeing the pixels of a decoded
+ *  image with the allocator that made them.
+ ***********************************************************/
+void TextureLibrary::FreeImage(DECODED_IMAGE& image)
+{
+	if (image.pixels == NULL)
+	{
+		return;
+	}
+
+	if (image.bCompressed)
+	{
+		delete[] image.pixels;
+	}
+	else
+	{
+		stbi_image_free(image.pixels);
+	}
+	image.pixels = NULL;
+}
+
+/***********************************************************
+ *  DropLevels()
+ *
+ *  This method is used for leaving out the largest mip
+ *  levels of a loaded image for its quality tier.  Stored
+ *  levels are skipped over, and decoded images are halved
+ *  with a 2x2 box filter once per level.  Both are done in
+ *  place, since the result is never larger than the source.
+ ***********************************************************/
+void TextureLibrary::DropLevels(DECODED_IMAGE& image, const DECODE_JOB& job)
+{
+	if ((image.pixels == NULL) || (job.droppedLevels <= 0))
+	{
+		return;
+	}
+
+	if (image.bCompressed)
+	{
+		size_t offset = 0;
+		for (int level = 0; level < job.droppedLevels; level++)
+		{
+			offset += DDSLoader::LevelSize(job.dds, level);
+		}
+		image.size -= offset;
+		memmove(image.pixels, image.pixels + offset, image.size);
+		image.width >>= job.droppedLevels;
+		image.height >>= job.droppedLevels;
+		return;
+	}
+
+	for (int level = 0; level < job.droppedLevels; level++)
+	{
+		int sourceWidth = image.width;
+		image.width /= 2;
+		image.height /= 2;
+
+		// each output pixel is written after the ones it reads from
+		for (int y = 0; y < image.height; y++)
+		{
+			for (int x = 0; x < image.width; x++)
+			{
+				const unsigned char* row0 = image.pixels + ((size_t)(y * 2) * sourceWidth + x * 2) * 4;
+				const unsigned char* row1 = row0 + (size_t)sourceWidth * 4;
+				unsigned char* output = image.pixels + ((size_t)y * image.width + x) * 4;
+				for (int channel = 0; channel < 4; channel++)
+				{
+					output[channel] = (unsigned char)((row0[channel] + row0[channel + 4] + row1[channel] + row1[channel + 4] + 2) / 4);
+				}
+			}
+		}
+	}
+	image.size = (size_t)image.width * (size_t)image.height * 4;
+}
+
+/***********************************************************
+ *  ArrayBytes()
+ *
+ *  This method is used for adding up the size of every mip
+ *  level of a texture array - the levels of decoded images
+ *  are generated once their pixels arrive, down to 1x1.
+ ***********************************************************/
+size_t TextureLibrary::ArrayBytes(const TEXTURE_ARRAY& textureArray)
+{
+	size_t bytes = 0;
+	if (textureArray.format == GL_RGBA8)
+	{
+		int levelWidth = textureArray.width;
+		int levelHeight = textureArray.height;
+		while (true)
+		{
+			bytes += (size_t)levelWidth * levelHeight * 4;
+			if ((levelWidth == 1) && (levelHeight == 1))
+			{
+				break;
+			}
+			levelWidth = (levelWidth > 1) ? (levelWidth / 2) : 1;
+			levelHeight = (levelHeight > 1) ? (levelHeight / 2) : 1;
+		}
+	}
+	else
+	{
+		DDSLoader::DDS_INFO levels;
+		levels.width = textureArray.width;
+		levels.height = textureArray.height;
+		levels.blockBytes = (textureArray.format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16;
+		for (int level = 0; level < textureArray.mipLevels; level++)
+		{
+			bytes += DDSLoader::LevelSize(levels, level);
+		}
+	}
+
+	return(bytes * textureArray.layers);
+}
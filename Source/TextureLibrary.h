@@ -0,0 +1,198 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturelibrary.h
+// ============
+// load texture images and pack them into OpenGL texture arrays
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "DDSLoader.h"
+#include "ResourceManager.h"
+#include "TextureQuality.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  TextureLibrary
+ *
+ *  This class loads texture images and stores every image
+ *  of the same size as one layer of a GL_TEXTURE_2D_ARRAY.
+ *  Each array is bound to its own texture unit once, so a
+ *  draw selects a texture by setting the array's unit and a
+ *  layer number instead of rebinding textures.  There is no
+ *  fixed limit on the number of textures.
+ *
+ *  Images are decoded on a pool of worker threads.  Only the
+ *  image header is read when a texture is requested, which is
+ *  enough to reserve its layer.  Decoded pixels are streamed
+ *  to the GPU through pixel buffer objects by Update(), a few
+ *  textures per frame, and until then the texture samples a
+ *  1x1 placeholder on texture unit 0.
+ *
+ *  If a .dds file with the same name sits next to an image,
+ *  it is loaded instead.  Its BC1, BC3 or BC7 blocks and its
+ *  mip levels are uploaded as stored, so there is no decode
+ *  or mipmap generation at run time.
+ *
+ *  Each texture is sampled at a quality tier (see
+ *  TextureQuality), and only textures of the same tier share
+ *  an array, since the sampler is bound per array.  Low tiers
+ *  leave out the largest mip levels while loading.
+ ***********************************************************/
+class TextureLibrary
+{
+public:
+	// constructor
+	TextureLibrary(ResourceManager* pResources);
+	// destructor
+	~TextureLibrary();
+
+	// arrays are bound to units 1 to MAX_ARRAYS - the shadow maps
+	// and the light clusters use the units above them
+	static const int MAX_ARRAYS = 10;
+
+	struct TEXTURE_INFO
+	{
+		std::string tag;
+		std::string filename;
+		// texture array holding the image, -1 until Build() is called
+		int arrayIndex;
+		// layer of the image inside the texture array
+		int layer;
+		int width;
+		int height;
+		// GL_RGBA8 for decoded images, otherwise the compressed format
+		GLenum format;
+		// mip levels stored in the file - 1 when they are generated
+		int mipLevels;
+		// quality tier the texture is sampled with, and how many
+		// of the largest mip levels were left out for it - the
+		// size and levels above are what is kept
+		TextureQuality::Tier tier;
+		int droppedLevels;
+		// set once the real pixels have been uploaded
+		bool bReady;
+		// set when every texture unit is taken, so the image is
+		// dropped and the placeholder is used for good
+		bool bRejected;
+	};
+
+	// read the texture quality options from the command line
+	void ParseArguments(int argc, char* argv[]);
+
+	// read an image header and queue the image to be decoded - the
+	// global quality tier is used unless the texture names its own
+	bool LoadTexture(const char* filename, const std::string& tag, TextureQuality::Tier tier = TextureQuality::TIER_DEFAULT);
+	// reserve texture array layers for every queued image
+	void Build();
+	// bind every texture array to its texture unit
+	void Bind() const;
+	// upload decoded images, stopping once the byte budget is used
+	void Update();
+	// free all of the texture arrays and stop the worker threads
+	void Destroy();
+
+	// bytes of pixels uploaded per Update() - at least one image is always uploaded
+	void SetUploadBudget(size_t bytes) { m_uploadBudget = bytes; }
+	// number of textures still waiting for their pixels
+	int LoadingCount() const { return(m_loadingCount); }
+
+	// find a loaded texture by tag, -1 if not found
+	int Find(const std::string& tag) const;
+	int Count() const { return((int)m_textures.size()); }
+	const TEXTURE_INFO& Info(int texture) const { return(m_textures[texture]); }
+
+	// texture unit and layer used to sample a loaded texture -
+	// the placeholder until the texture's pixels have arrived
+	int TextureUnit(int texture) const;
+	int TextureLayer(int texture) const;
+	// OpenGL name of the array holding a loaded texture
+	GLuint TextureArrayID(int texture) const;
+	// value that orders textures by array, then layer - -1 if not loaded
+	int SortKey(int texture) const;
+
+private:
+	struct TEXTURE_ARRAY
+	{
+		ResourceManager::Handle texture;
+		int width;
+		int height;
+		int layers;
+		GLenum format;
+		int mipLevels;
+		TextureQuality::Tier tier;
+		// layers still waiting for their pixels
+		int pendingLayers;
+	};
+
+	// image waiting on a worker thread
+	struct DECODE_JOB
+	{
+		int texture;
+		std::string filename;
+		// read the blocks as stored instead of decoding an image
+		bool bCompressed;
+		DDSLoader::DDS_INFO dds;
+		// largest mip levels to leave out
+		int droppedLevels;
+	};
+
+	// image decoded by a worker thread, waiting to be uploaded
+	struct DECODED_IMAGE
+	{
+		int texture;
+		int width;
+		int height;
+		// bytes of pixels, for all mip levels of a compressed image
+		size_t size;
+		bool bCompressed;
+		unsigned char* pixels;
+	};
+
+	ResourceManager* m_pResources;
+	TextureQuality m_quality;
+	std::vector<TEXTURE_INFO> m_textures;
+	std::vector<TEXTURE_ARRAY> m_arrays;
+	std::unordered_map<std::string, int> m_lookup;
+	int m_loadingCount;
+
+	// 1x1 texture array sampled until the real pixels arrive
+	ResourceManager::Handle m_placeholder;
+	// pixel buffers used in turn, so filling one never waits on the other
+	ResourceManager::Handle m_uploadBuffers[2];
+	int m_nextUploadBuffer;
+	size_t m_uploadBudget;
+
+	// worker threads and the queues shared with them
+	std::vector<std::thread> m_workers;
+	std::deque<DECODE_JOB> m_jobs;
+	std::vector<DECODED_IMAGE> m_decoded;
+	std::mutex m_mutex;
+	std::condition_variable m_jobsReady;
+	bool m_bStopping;
+
+	void StartWorkers();
+	void StopWorkers();
+	void DecodeWorker();
+	void CreatePlaceholder();
+	void UploadImage(const DECODED_IMAGE& image);
+	// count off a texture that was uploaded or failed, generating
+	// the array's mipmaps after its last layer
+	void FinishLayer(TEXTURE_INFO& info);
+	static void FreeImage(DECODED_IMAGE& image);
+	// leave out the largest mip levels of a loaded image
+	static void DropLevels(DECODED_IMAGE& image, const DECODE_JOB& job);
+	// bytes of GPU memory an array holds, with all of its mip levels
+	static size_t ArrayBytes(const TEXTURE_ARRAY& textureArray);
+};
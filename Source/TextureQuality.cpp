@@ -0,0 +1,223 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturequality.cpp
+// ============
+// sampler objects and mip level budgets for each texture quality tier
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureQuality.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// the settings of one tier
+	struct TIER_SETTINGS
+	{
+		const char* name;
+		GLint minFilter;
+		float anisotropy;
+		int droppedLevels;
+	};
+
+	const TIER_SETTINGS g_TierSettings[TextureQuality::TIER_COUNT] =
+	{
+		{ "low", GL_LINEAR_MIPMAP_NEAREST, 1.0f, 2 },
+		{ "medium", GL_LINEAR_MIPMAP_LINEAR, 4.0f, 1 },
+		{ "high", GL_LINEAR_MIPMAP_LINEAR, 8.0f, 0 },
+		{ "ultra", GL_LINEAR_MIPMAP_LINEAR, 16.0f, 0 }
+	};
+
+	const float g_MaxAnisotropy = 16.0f;
+	// mip levels are only dropped while the texture stays at
+	// least this size, so small images keep their detail
+	const int g_MinDroppedSize = 128;
+}
+
+/***********************************************************
+ *  TextureQuality()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureQuality::TextureQuality()
+{
+	m_globalTier = TIER_HIGH;
+	m_anisotropyOverride = 0.0f;
+}
+
+/***********************************************************
+ *  ParseArguments()
+ *
+ *  This method is used for reading the texture quality
+ *  options from the command line.
+ ***********************************************************/
+void TextureQuality::ParseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--texture-quality") == 0) && (i + 1 < argc))
+		{
+			Tier tier = ParseTier(argv[++i]);
+			if (tier == TIER_DEFAULT)
+			{
+				std::cout << "Unknown texture quality, using " << TierName(m_globalTier) << ":" << argv[i] << std::endl;
+			}
+			else
+			{
+				m_globalTier = tier;
+			}
+		}
+		else if ((strcmp(argv[i], "--anisotropy") == 0) && (i + 1 < argc))
+		{
+			float anisotropy = (float)atof(argv[++i]);
+			m_anisotropyOverride = std::max(1.0f, std::min(anisotropy, g_MaxAnisotropy));
+		}
+	}
+}
+
+/***********************************************************
+ *  ParseTier()
+ *
+ *  This method is used for finding a tier by its name.
+ ***********************************************************/
+TextureQuality::Tier TextureQuality::ParseTier(const char* name)
+{
+	for (int tier = 0; tier < TIER_COUNT; tier++)
+	{
+		if (strcmp(name, g_TierSettings[tier].name) == 0)
+		{
+			return((Tier)tier);
+		}
+	}
+
+	return(TIER_DEFAULT);
+}
+
+/***********************************************************
+ *  TierName()
+ *
+ *  This method is used for getting the printed name of a
+ *  tier.
+ ***********************************************************/
+const char* TextureQuality::TierName(Tier tier)
+{
+	if ((tier < 0) || (tier >= TIER_COUNT))
+	{
+		return("default");
+	}
+
+	return(g_TierSettings[tier].name);
+}
+
+/***********************************************************
+ *  Resolve()
+ *
+ *  This method is used for getting the tier a texture is
+ *  sampled with.
+ ***********************************************************/
+TextureQuality::Tier TextureQuality::Resolve(Tier tier) const
+{
+	if ((tier < 0) || (tier >= TIER_COUNT))
+	{
+		return(m_globalTier);
+	}
+
+	return(tier);
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the sampler objects.
+ *  Anisotropy is clamped to what the driver supports, and
+ *  left out when it has no anisotropic filtering at all.
+ ***********************************************************/
+void TextureQuality::Create(ResourceManager* pResources)
+{
+	if (m_samplers[0].IsValid())
+	{
+		return;
+	}
+
+	bool bAnisotropic = (GLEW_VERSION_4_6 != 0) ||
+		(GLEW_ARB_texture_filter_anisotropic != 0) || (GLEW_EXT_texture_filter_anisotropic != 0);
+	GLfloat maxAnisotropy = 1.0f;
+	if (bAnisotropic)
+	{
+		glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy);
+	}
+
+	for (int tier = 0; tier < TIER_COUNT; tier++)
+	{
+		const TIER_SETTINGS& settings = g_TierSettings[tier];
+		m_samplers[tier] = pResources->CreateSampler("texture sampler");
+
+		GLuint sampler = m_samplers[tier].Name();
+		glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, settings.minFilter);
+		glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		if (bAnisotropic)
+		{
+			float anisotropy = (m_anisotropyOverride > 0.0f) ? m_anisotropyOverride : settings.anisotropy;
+			glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(anisotropy, (float)maxAnisotropy));
+		}
+	}
+
+	std::cout << "Texture quality: " << TierName(m_globalTier) << ", max anisotropy " << maxAnisotropy << std::endl;
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for releasing the sampler objects.
+ ***********************************************************/
+void TextureQuality::Destroy()
+{
+	for (int tier = 0; tier < TIER_COUNT; tier++)
+	{
+		m_samplers[tier].Reset();
+	}
+}
+
+/***********************************************************
+ *  Sampler()
+ *
+ *  This method is used for getting the sampler object of a
+ *  tier - 0 before Create() is called.
+ ***********************************************************/
+GLuint TextureQuality::Sampler(Tier tier) const
+{
+	return(m_samplers[Resolve(tier)].Name());
+}
+
+/***********************************************************
+ *  DroppedLevels()
+ *
+ *  This method is used for deciding how many of the largest
+ *  mip levels a texture loses at a tier.  Levels are only
+ *  dropped while the next one is at least the minimum size,
+ *  and an image with stored levels always keeps one of them.
+ ***********************************************************/
+int TextureQuality::DroppedLevels(Tier tier, int width, int height, int storedLevels) const
+{
+	int maxDropped = g_TierSettings[Resolve(tier)].droppedLevels;
+
+	int dropped = 0;
+	while ((dropped < maxDropped) &&
+		((width >> (dropped + 1)) >= g_MinDroppedSize) &&
+		((height >> (dropped + 1)) >= g_MinDroppedSize) &&
+		((storedLevels == 0) || (dropped + 1 < storedLevels)))
+	{
+		dropped++;
+	}
+
+	return(dropped);
+}
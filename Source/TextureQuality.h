@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturequality.h
+// ============
+// sampler objects and mip level budgets for each texture quality tier
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "ResourceManager.h"
+
+/***********************************************************
+ *  TextureQuality
+ *
+ *  This class describes how textures are sampled at each
+ *  quality tier.  Every tier has a sampler object with its
+ *  own mip filter and anisotropy, and a number of top mip
+ *  levels that are left out when a texture is loaded, which
+ *  saves memory on low end GPUs.  All textures use the global
+ *  tier from the command line unless they ask for their own.
+ *
+ *  The texture arrays are bound to their units once, and the
+ *  sampler of each array's tier is bound next to it, so the
+ *  tiers cost nothing while drawing.
+ ***********************************************************/
+class TextureQuality
+{
+public:
+	// constructor
+	TextureQuality();
+
+	enum Tier
+	{
+		// use the global tier
+		TIER_DEFAULT = -1,
+		// bilinear between mip levels, no anisotropy, the two top
+		// mip levels dropped
+		TIER_LOW,
+		// trilinear, 4x anisotropy, the top mip level dropped
+		TIER_MEDIUM,
+		// trilinear, 8x anisotropy
+		TIER_HIGH,
+		// trilinear, 16x anisotropy
+		TIER_ULTRA,
+		TIER_COUNT
+	};
+
+	// read the options from the command line:
+	//   --texture-quality <tier>   low, medium, high or ultra (default high)
+	//   --anisotropy <n>           anisotropy for every tier, 1 to 16
+	void ParseArguments(int argc, char* argv[]);
+
+	// the tier from a name in the scene file or on the command
+	// line - TIER_DEFAULT when the name is unknown
+	static Tier ParseTier(const char* name);
+	static const char* TierName(Tier tier);
+
+	Tier GlobalTier() const { return(m_globalTier); }
+	// the tier a texture is sampled with - its own, or the global one
+	Tier Resolve(Tier tier) const;
+
+	// create a sampler object for every tier - needs a current
+	// OpenGL context
+	void Create(ResourceManager* pResources);
+	// release the sampler objects
+	void Destroy();
+	GLuint Sampler(Tier tier) const;
+
+	// number of top mip levels to leave out of a texture - stored
+	// levels is 0 for images whose mip levels are generated
+	int DroppedLevels(Tier tier, int width, int height, int storedLevels) const;
+
+private:
+	Tier m_globalTier;
+	// from --anisotropy, 0 to use each tier's own
+	float m_anisotropyOverride;
+	ResourceManager::Handle m_samplers[TIER_COUNT];
+};
@@ -0,0 +1,176 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformhierarchy.cpp
+// ============
+// parent and child transforms with cached world matrices
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformHierarchy.h"
+
+#include <algorithm>
+#include <iostream>
+
+/***********************************************************
+ *  TransformHierarchy()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransformHierarchy::TransformHierarchy()
+{
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every node.
+ ***********************************************************/
+void TransformHierarchy::Clear()
+{
+	m_parents.clear();
+	m_subtreeEnds.clear();
+	m_scales.clear();
+	m_rotations.clear();
+	m_positions.clear();
+	m_worlds.clear();
+	m_dirty.clear();
+	m_dirtyNodes.clear();
+	m_changedNodes.clear();
+}
+
+/***********************************************************
+ *  AddNode()
+ *
+ *  This method is used for adding a node below a parent, or
+ *  at the top with NO_PARENT.  Only the last node and its
+ *  ancestors can take new children, so the nodes below any
+ *  node always follow it in one run.
+ ***********************************************************/
+int TransformHierarchy::AddNode(int parent, const glm::vec3& scale, const glm::quat& rotation, const glm::vec3& position)
+{
+	int node = (int)m_parents.size();
+	if ((parent != NO_PARENT) &&
+		((parent < 0) || (parent >= node) || (m_subtreeEnds[parent] != node)))
+	{
+		std::cout << "Transform node " << parent << " cannot take a child once other nodes follow it" << std::endl;
+		return(-1);
+	}
+
+	glm::mat4 local = ComposeMatrix(scale, rotation, position);
+
+	m_parents.push_back(parent);
+	m_subtreeEnds.push_back(node + 1);
+	m_scales.push_back(scale);
+	m_rotations.push_back(rotation);
+	m_positions.push_back(position);
+	m_worlds.push_back((parent == NO_PARENT) ? local : m_worlds[parent] * local);
+	m_dirty.push_back(0);
+
+	// the new node extends the run of every ancestor
+	for (int ancestor = parent; ancestor != NO_PARENT; ancestor = m_parents[ancestor])
+	{
+		m_subtreeEnds[ancestor] = node + 1;
+	}
+
+	return(node);
+}
+
+/***********************************************************
+ *  SetLocal()
+ *
+ *  This method is used for changing the transform of a node
+ *  relative to its parent and marking it dirty.
+ ***********************************************************/
+void TransformHierarchy::SetLocal(int node, const glm::vec3& scale, const glm::quat& rotation, const glm::vec3& position)
+{
+	if ((node < 0) || (node >= (int)m_parents.size()))
+	{
+		return;
+	}
+
+	m_scales[node] = scale;
+	m_rotations[node] = rotation;
+	m_positions[node] = position;
+	if (m_dirty[node] == 0)
+	{
+		m_dirty[node] = 1;
+		m_dirtyNodes.push_back(node);
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for rebuilding the world matrices of
+ *  the dirty nodes and every node below them.  The dirty
+ *  nodes are taken in order and each one rebuilds its run,
+ *  skipping dirty nodes inside a run that is already done.
+ *  Nodes that did not change are never touched.
+ ***********************************************************/
+int TransformHierarchy::Update()
+{
+	m_changedNodes.clear();
+	if (m_dirtyNodes.empty())
+	{
+		return(0);
+	}
+
+	std::sort(m_dirtyNodes.begin(), m_dirtyNodes.end());
+
+	int doneUntil = 0;
+	for (int dirtyNode : m_dirtyNodes)
+	{
+		m_dirty[dirtyNode] = 0;
+		if (dirtyNode < doneUntil)
+		{
+			continue;
+		}
+
+		int end = m_subtreeEnds[dirtyNode];
+		for (int node = dirtyNode; node < end; node++)
+		{
+			glm::mat4 local = ComposeMatrix(m_scales[node], m_rotations[node], m_positions[node]);
+			int parent = m_parents[node];
+			m_worlds[node] = (parent == NO_PARENT) ? local : m_worlds[parent] * local;
+			m_changedNodes.push_back(node);
+		}
+		doneUntil = end;
+	}
+	m_dirtyNodes.clear();
+
+	return((int)m_changedNodes.size());
+}
+
+/***********************************************************
+ *  EulerRotation()
+ *
+ *  This method is used for building the rotation made by
+ *  turning about the x axis, then y, then z - the same order
+ *  the scene has always used for its rotation angles.
+ ***********************************************************/
+glm::quat TransformHierarchy::EulerRotation(const glm::vec3& degrees)
+{
+	// the quaternion from euler angles is z * y * x, which
+	// applies x first
+	return(glm::quat(glm::radians(degrees)));
+}
+
+/***********************************************************
+ *  ComposeMatrix()
+ *
+ *  This method is used for building the matrix that scales,
+ *  rotates and then translates.  The rotation columns are
+ *  scaled in place, so there are no matrix products at all.
+ ***********************************************************/
+glm::mat4 TransformHierarchy::ComposeMatrix(const glm::vec3& scale, const glm::quat& rotation, const glm::vec3& position)
+{
+	glm::mat3 rotationMatrix = glm::mat3_cast(rotation);
+
+	glm::mat4 matrix;
+	matrix[0] = glm::vec4(rotationMatrix[0] * scale.x, 0.0f);
+	matrix[1] = glm::vec4(rotationMatrix[1] * scale.y, 0.0f);
+	matrix[2] = glm::vec4(rotationMatrix[2] * scale.z, 0.0f);
+	matrix[3] = glm::vec4(position, 1.0f);
+	return(matrix);
+}
@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformhierarchy.h
+// ============
+// parent and child transforms with cached world matrices
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  TransformHierarchy
+ *
+ *  This class keeps a tree of transform nodes.  Each node has
+ *  a scale, rotation and position relative to its parent, and
+ *  a cached world matrix.
+ *
+ *  The nodes are stored as separate arrays (structure of
+ *  arrays) in depth-first order, so every node comes after
+ *  its parent and the nodes below it follow it in one run.
+ *  Changing a node only marks it dirty - Update() then
+ *  rebuilds the world matrices of the dirty runs alone, in a
+ *  single pass where each parent is always done before its
+ *  children.
+ ***********************************************************/
+class TransformHierarchy
+{
+public:
+	// constructor
+	TransformHierarchy();
+
+	static const int NO_PARENT = -1;
+
+	// remove every node
+	void Clear();
+
+	// add a node - the parent must be the last node added or one
+	// of its ancestors, which keeps the depth-first order.  The
+	// world matrix is ready straight away.  Returns -1 when the
+	// parent breaks the order.
+	int AddNode(int parent, const glm::vec3& scale, const glm::quat& rotation, const glm::vec3& position);
+
+	// change the transform of a node relative to its parent - the
+	// world matrices are rebuilt in the next Update()
+	void SetLocal(int node, const glm::vec3& scale, const glm::quat& rotation, const glm::vec3& position);
+
+	// rebuild the world matrices of the dirty nodes and the nodes
+	// below them - returns how many were rebuilt
+	int Update();
+	// nodes rebuilt by the last Update(), in order
+	const std::vector<int>& ChangedNodes() const { return(m_changedNodes); }
+
+	int Count() const { return((int)m_parents.size()); }
+	int Parent(int node) const { return(m_parents[node]); }
+	const glm::mat4& World(int node) const { return(m_worlds[node]); }
+
+	// rotation from angles in degrees about x, then y, then z
+	static glm::quat EulerRotation(const glm::vec3& degrees);
+	// matrix that scales, then rotates, then translates
+	static glm::mat4 ComposeMatrix(const glm::vec3& scale, const glm::quat& rotation, const glm::vec3& position);
+
+private:
+	std::vector<int> m_parents;
+	// one past the last node below each node
+	std::vector<int> m_subtreeEnds;
+	std::vector<glm::vec3> m_scales;
+	std::vector<glm::quat> m_rotations;
+	std::vector<glm::vec3> m_positions;
+	std::vector<glm::mat4> m_worlds;
+	std::vector<uint8_t> m_dirty;
+	// nodes changed since the last update
+	std::vector<int> m_dirtyNodes;
+	std::vector<int> m_changedNodes;
+};
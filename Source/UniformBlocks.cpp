@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformblocks.cpp
+// ============
+// manage the uniform buffer objects shared by every shader program
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UniformBlocks.h"
+
+#include <iostream>
+
+// the C++ structs must have exactly the std140 size of the GLSL blocks
+static_assert(sizeof(UniformBlocks::FRAME_BLOCK) == 144, "FrameBlock does not match std140 layout");
+static_assert(sizeof(UniformBlocks::DIRECTIONAL_LIGHT) == 64, "DirectionalLight does not match std140 layout");
+static_assert(sizeof(UniformBlocks::POINT_LIGHT) == 64, "PointLight does not match std140 layout");
+static_assert(sizeof(UniformBlocks::SPOT_LIGHT) == 96, "SpotLight does not match std140 layout");
+static_assert(sizeof(UniformBlocks::MATERIAL) == 32, "Material does not match std140 layout");
+
+// declaration of global variables
+namespace
+{
+	const char* g_FrameBlockName = "FrameBlock";
+	const char* g_LightBlockName = "LightBlock";
+	const char* g_MaterialBlockName = "MaterialBlock";
+}
+
+/***********************************************************
+ *  UniformBlocks()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+UniformBlocks::UniformBlocks()
+{
+	m_frameBuffer = 0;
+	m_lightBuffer = 0;
+	m_materialBuffer = 0;
+	m_frame.view = glm::mat4(1.0f);
+	m_frame.projection = glm::mat4(1.0f);
+	m_frame.viewPosition = glm::vec3(0.0f);
+	m_frame.time = 0.0f;
+}
+
+/***********************************************************
+ *  ~UniformBlocks()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+UniformBlocks::~UniformBlocks()
+{
+	if (m_frameBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_frameBuffer);
+		m_frameBuffer = 0;
+	}
+	if (m_lightBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_lightBuffer);
+		m_lightBuffer = 0;
+	}
+	if (m_materialBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_materialBuffer);
+		m_materialBuffer = 0;
+	}
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for allocating the uniform buffers
+ *  and attaching them to their binding points.
+ ***********************************************************/
+void UniformBlocks::Create()
+{
+	if (m_frameBuffer != 0)
+	{
+		return;
+	}
+
+	glGenBuffers(1, &m_frameBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_frameBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FRAME_BLOCK), NULL, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, m_frameBuffer);
+
+	// start with every light switched off
+	LIGHT_BLOCK lights = {};
+	glGenBuffers(1, &m_lightBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_lightBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(LIGHT_BLOCK), &lights, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, m_lightBuffer);
+
+	glGenBuffers(1, &m_materialBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_materialBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(MATERIAL_BLOCK), NULL, GL_STATIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, MATERIAL_BLOCK_BINDING, m_materialBuffer);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  BindProgram()
+ *
+ *  This method is used for connecting the uniform blocks
+ *  declared in a shader program to the shared binding
+ *  points.  Blocks the program does not use are skipped.
+ ***********************************************************/
+void UniformBlocks::BindProgram(GLuint programID)
+{
+	GLuint frameIndex = glGetUniformBlockIndex(programID, g_FrameBlockName);
+	if (frameIndex != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(programID, frameIndex, FRAME_BLOCK_BINDING);
+	}
+
+	GLuint lightIndex = glGetUniformBlockIndex(programID, g_LightBlockName);
+	if (lightIndex != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(programID, lightIndex, LIGHT_BLOCK_BINDING);
+	}
+
+	GLuint materialIndex = glGetUniformBlockIndex(programID, g_MaterialBlockName);
+	if (materialIndex != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(programID, materialIndex, MATERIAL_BLOCK_BINDING);
+	}
+}
+
+/***********************************************************
+ *  UpdateFrame()
+ *
+ *  This method is used for writing the per-frame camera
+ *  values into the frame block.
+ ***********************************************************/
+void UniformBlocks::UpdateFrame(const FRAME_BLOCK& frame)
+{
+	m_frame = frame;
+
+	if (m_frameBuffer == 0)
+	{
+		return;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_frameBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FRAME_BLOCK), &frame);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  UpdateLights()
+ *
+ *  This method is used for writing all of the scene lights
+ *  into the light block.
+ ***********************************************************/
+void UniformBlocks::UpdateLights(const LIGHT_BLOCK& lights)
+{
+	if (m_lightBuffer == 0)
+	{
+		return;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_lightBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LIGHT_BLOCK), &lights);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  UpdateMaterials()
+ *
+ *  This method is used for writing the defined materials
+ *  into the material table.  Only the used entries are
+ *  copied.
+ ***********************************************************/
+void UniformBlocks::UpdateMaterials(const MATERIAL_BLOCK& materials, int count)
+{
+	if ((m_materialBuffer == 0) || (count <= 0))
+	{
+		return;
+	}
+
+	if (count > TOTAL_MATERIALS)
+	{
+		count = TOTAL_MATERIALS;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_materialBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, count * sizeof(MATERIAL), materials.materials);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformblocks.h
+// ============
+// manage the uniform buffer objects shared by every shader program
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// must match TOTAL_POINT_LIGHTS in the fragment shader
+#define TOTAL_POINT_LIGHTS 5
+// must match TOTAL_MATERIALS in the fragment shader
+#define TOTAL_MATERIALS 64
+
+/***********************************************************
+ *  UniformBlocks
+ *
+ *  This class owns the std140 uniform buffers for the values
+ *  that are the same for every draw: the per-frame camera
+ *  block, the scene lights block and the material table.  Each block is written
+ *  with a single glBufferSubData() call and is bound to a
+ *  fixed binding point, so any number of shader programs can
+ *  share it without uploading the values again.
+ *
+ *  The structs below mirror the std140 layout of the blocks
+ *  in the GLSL files, including the padding after each vec3.
+ ***********************************************************/
+class UniformBlocks
+{
+public:
+	// constructor
+	UniformBlocks();
+	// destructor
+	~UniformBlocks();
+
+	// binding points used for the blocks
+	enum BlockBinding
+	{
+		FRAME_BLOCK_BINDING = 0,
+		LIGHT_BLOCK_BINDING = 1,
+		MATERIAL_BLOCK_BINDING = 2
+	};
+
+	// layout (std140) uniform FrameBlock
+	struct FRAME_BLOCK
+	{
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec3 viewPosition;
+		float time;
+	};
+
+	struct DIRECTIONAL_LIGHT
+	{
+		glm::vec3 direction;
+		float pad0;
+		glm::vec3 ambient;
+		float pad1;
+		glm::vec3 diffuse;
+		float pad2;
+		glm::vec3 specular;
+		int bActive;
+	};
+
+	struct POINT_LIGHT
+	{
+		glm::vec3 position;
+		// distance at which the light fades out - 0 for no falloff
+		float range;
+		glm::vec3 ambient;
+		float pad1;
+		glm::vec3 diffuse;
+		float pad2;
+		glm::vec3 specular;
+		int bActive;
+	};
+
+	struct SPOT_LIGHT
+	{
+		glm::vec3 position;
+		float pad0;
+		glm::vec3 direction;
+		float cutOff;
+		float outerCutOff;
+		float constant;
+		float linear;
+		float quadratic;
+		glm::vec3 ambient;
+		float pad1;
+		glm::vec3 diffuse;
+		float pad2;
+		glm::vec3 specular;
+		int bActive;
+	};
+
+	// layout (std140) uniform LightBlock
+	struct LIGHT_BLOCK
+	{
+		DIRECTIONAL_LIGHT directionalLight;
+		POINT_LIGHT pointLights[TOTAL_POINT_LIGHTS];
+		SPOT_LIGHT spotLight;
+	};
+
+	struct MATERIAL
+	{
+		glm::vec3 diffuseColor;
+		float pad0;
+		glm::vec3 specularColor;
+		float shininess;
+	};
+
+	// layout (std140) uniform MaterialBlock
+	struct MATERIAL_BLOCK
+	{
+		MATERIAL materials[TOTAL_MATERIALS];
+	};
+
+	// create the buffers - needs a current OpenGL context
+	void Create();
+	// connect the blocks in a shader program to the binding points
+	void BindProgram(GLuint programID);
+
+	// write the whole block into its buffer
+	void UpdateFrame(const FRAME_BLOCK& frame);
+	void UpdateLights(const LIGHT_BLOCK& lights);
+	// write the first count materials into the material table
+	void UpdateMaterials(const MATERIAL_BLOCK& materials, int count);
+
+	// the frame block written by the last UpdateFrame()
+	const FRAME_BLOCK& Frame() const { return(m_frame); }
+
+private:
+	FRAME_BLOCK m_frame;
+	GLuint m_frameBuffer;
+	GLuint m_lightBuffer;
+	GLuint m_materialBuffer;
+};
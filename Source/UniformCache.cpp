@@ -0,0 +1,200 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformcache.cpp
+// ============
+// resolve shader uniform locations once and reuse them every frame
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UniformCache.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+/***********************************************************
+ *  UniformCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+UniformCache::UniformCache()
+{
+	m_current = -1;
+	m_programID = 0;
+}
+
+/***********************************************************
+ *  Register()
+ *
+ *  This method is used for adding a uniform name to the
+ *  table.  Registering the same name twice returns the
+ *  same handle.  The new name is looked up right away in
+ *  every program that has already been resolved.
+ ***********************************************************/
+int UniformCache::Register(const char* name)
+{
+	for (int i = 0; i < (int)m_names.size(); i++)
+	{
+		if (m_names[i].compare(name) == 0)
+		{
+			return(i);
+		}
+	}
+
+	m_names.push_back(name);
+	for (size_t i = 0; i < m_programs.size(); i++)
+	{
+		m_programs[i].locations.push_back(glGetUniformLocation(m_programs[i].programID, name));
+	}
+
+	return((int)m_names.size() - 1);
+}
+
+/***********************************************************
+ *  Resolve()
+ *
+ *  This method is used for looking up the location of every
+ *  registered uniform in the passed in shader program.  It
+ *  needs to be called again whenever the program is relinked.
+ ***********************************************************/
+void UniformCache::Resolve(GLuint programID)
+{
+	int index = FindProgram(programID);
+	if (index < 0)
+	{
+		PROGRAM_TABLE table;
+		table.programID = programID;
+		m_programs.push_back(table);
+		index = (int)m_programs.size() - 1;
+	}
+
+	PROGRAM_TABLE& table = m_programs[index];
+	table.locations.resize(m_names.size());
+	for (size_t i = 0; i < m_names.size(); i++)
+	{
+		table.locations[i] = glGetUniformLocation(programID, m_names[i].c_str());
+	}
+
+	m_current = index;
+	m_programID = programID;
+}
+
+/***********************************************************
+ *  Use()
+ *
+ *  This method is used for making the table of an already
+ *  resolved program current.  A program that has not been
+ *  seen before is resolved first.  It does not bind the
+ *  program - that is left to the caller.
+ ***********************************************************/
+void UniformCache::Use(GLuint programID)
+{
+	if (programID == m_programID)
+	{
+		return;
+	}
+
+	int index = FindProgram(programID);
+	if (index < 0)
+	{
+		Resolve(programID);
+		return;
+	}
+
+	m_current = index;
+	m_programID = programID;
+}
+
+/***********************************************************
+ *  Forget()
+ *
+ *  This method is used for dropping the tables of every
+ *  program.  Each one is resolved again by Use() the next
+ *  time it is made current.
+ ***********************************************************/
+void UniformCache::Forget()
+{
+	m_programs.clear();
+	m_current = -1;
+	m_programID = 0;
+}
+
+/***********************************************************
+ *  FindProgram()
+ *
+ *  This method is used for getting the index of the table
+ *  for a program, -1 if it has not been resolved.
+ ***********************************************************/
+int UniformCache::FindProgram(GLuint programID) const
+{
+	for (int i = 0; i < (int)m_programs.size(); i++)
+	{
+		if (m_programs[i].programID == programID)
+		{
+			return(i);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  Location()
+ *
+ *  This method is used for getting the resolved location
+ *  for a handle.  Unknown handles and uniforms the compiler
+ *  removed both return -1, which glUniform*() ignores.
+ ***********************************************************/
+GLint UniformCache::Location(int handle) const
+{
+	if ((m_current < 0) || (handle < 0) || (handle >= (int)m_names.size()))
+	{
+		return(-1);
+	}
+
+	return(m_programs[m_current].locations[handle]);
+}
+
+void UniformCache::SetBool(int handle, bool value) const
+{
+	glUniform1i(Location(handle), (int)value);
+}
+
+void UniformCache::SetInt(int handle, int value) const
+{
+	glUniform1i(Location(handle), value);
+}
+
+void UniformCache::SetFloat(int handle, float value) const
+{
+	glUniform1f(Location(handle), value);
+}
+
+void UniformCache::SetVec2(int handle, const glm::vec2& value) const
+{
+	glUniform2fv(Location(handle), 1, glm::value_ptr(value));
+}
+
+void UniformCache::SetVec3(int handle, const glm::vec3& value) const
+{
+	glUniform3fv(Location(handle), 1, glm::value_ptr(value));
+}
+
+void UniformCache::SetVec4(int handle, const glm::vec4& value) const
+{
+	glUniform4fv(Location(handle), 1, glm::value_ptr(value));
+}
+
+void UniformCache::SetMat3(int handle, const glm::mat3& value) const
+{
+	glUniformMatrix3fv(Location(handle), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void UniformCache::SetMat4(int handle, const glm::mat4& value) const
+{
+	glUniformMatrix4fv(Location(handle), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void UniformCache::SetFloatArray(int handle, const float* values, int count) const
+{
+	glUniform1fv(Location(handle), count, values);
+}
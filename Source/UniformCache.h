@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformcache.h
+// ============
+// resolve shader uniform locations once and reuse them every frame
+//
+//  AUTHOR: agent
+//	Created for CS-330-Computational Graphics and Visualization, Oct. 14th, 2026
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  UniformCache
+ *
+ *  This class keeps a table of uniform names and their
+ *  locations in a shader program.  Names are registered
+ *  once and return a small integer handle; the locations
+ *  are looked up with glGetUniformLocation() only when the
+ *  program is resolved, never while drawing.
+ *
+ *  A table of locations is kept for every resolved program,
+ *  so switching between shader permutations only selects
+ *  another table with Use().
+ ***********************************************************/
+class UniformCache
+{
+public:
+	// constructor
+	UniformCache();
+
+	// register a uniform name and get back its handle
+	int Register(const char* name);
+	// look up the location of every registered name in the program
+	// and make it the current program
+	void Resolve(GLuint programID);
+	// make a program current, resolving it the first time it is used
+	void Use(GLuint programID);
+	// forget every resolved program - needed once programs have been
+	// deleted, since their names can be given to new ones
+	void Forget();
+
+	// get the resolved location for a handle, -1 if not active
+	GLint Location(int handle) const;
+	GLuint Program() const { return(m_programID); }
+
+	// set values into the currently bound program
+	void SetBool(int handle, bool value) const;
+	void SetInt(int handle, int value) const;
+	void SetFloat(int handle, float value) const;
+	void SetVec2(int handle, const glm::vec2& value) const;
+	void SetVec3(int handle, const glm::vec3& value) const;
+	void SetVec4(int handle, const glm::vec4& value) const;
+	void SetMat3(int handle, const glm::mat3& value) const;
+	void SetMat4(int handle, const glm::mat4& value) const;
+	void SetFloatArray(int handle, const float* values, int count) const;
+
+private:
+	// locations of every registered name in one program
+	struct PROGRAM_TABLE
+	{
+		GLuint programID;
+		std::vector<GLint> locations;
+	};
+
+	std::vector<std::string> m_names;
+	std::vector<PROGRAM_TABLE> m_programs;
+	// index of the current table in m_programs, -1 for none
+	int m_current;
+	GLuint m_programID;
+
+	int FindProgram(GLuint programID) const;
+};
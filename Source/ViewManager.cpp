@@ -17,11 +17,18 @@
 // declaration of the global variables and defines
 namespace
 {
-	// Variables for window width and height
+	// Variables for window width and height - the size the window
+	// opens at, in screen coordinates
 	const int WINDOW_WIDTH = 1000;
 	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
+
+	//* NEW: size of the window's framebuffer in pixels, which can
+	//* differ from the window size on high DPI displays, and the
+	//* aspect ratio of the last size that was not minimized
+	int g_FramebufferWidth = WINDOW_WIDTH;
+	int g_FramebufferHeight = WINDOW_HEIGHT;
+	float g_AspectRatio = (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT;
+	bool g_bFramebufferResized = false;
 
 	// camera object used for viewing and interacting with
 	// the 3D scene
@@ -51,6 +58,30 @@ namespace
 
 	//* NEW: allows switching between projection modes (default to perspective)
 	ViewManager::ProjectionMode g_ProjectionMode = ViewManager::ProjectionMode::Perspective;
+
+	//* NEW: render debug toggles - F1 for the depth pre-pass and F2
+	//* for the overdraw view, switched once per press and release
+	bool g_bDepthPrePass = true;
+	bool g_bOverdrawView = false;
+	bool bF1Pressed = false;
+	bool bF2Pressed = false;
+
+	//* NEW: F3 shows the profiler overlay
+	bool g_bProfilerOverlay = false;
+	bool bF3Pressed = false;
+	bool g_bLastProfilerOverlay = false;
+
+	//* NEW: matrices and toggles of the last frame, compared to tell
+	//* the frame pacer whether anything on screen has moved
+	glm::mat4 g_LastView = glm::mat4(0.0f);
+	glm::mat4 g_LastProjection = glm::mat4(0.0f);
+	bool g_bLastDepthPrePass = true;
+	bool g_bLastOverdrawView = false;
+	bool g_bViewChanged = true;
+
+	//* NEW: the camera follows a script instead of the mouse and
+	//* keyboard, e.g. while benchmarking
+	bool g_bScriptedCamera = false;
 }
 
 /***********************************************************
@@ -59,10 +90,12 @@ namespace
  *  The constructor for the class
  ***********************************************************/
 ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
+	ShaderManager *pShaderManager,
+	UniformBlocks* pUniformBlocks)
 {
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
+	m_pUniformBlocks = pUniformBlocks;
 	m_pWindow = NULL;
 	g_pCamera = new Camera();
 	// default camera view parameters
@@ -82,6 +115,7 @@ ViewManager::~ViewManager()
 {
 	// free up allocated memory
 	m_pShaderManager = NULL;
+	m_pUniformBlocks = NULL;
 	m_pWindow = NULL;
 	if (NULL != g_pCamera)
 	{
@@ -99,6 +133,10 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 {
 	GLFWwindow* window = nullptr;
 
+	//* NEW: keep the window the same size on screen when the
+	//* monitor's content is scaled up
+	glfwWindowHint(GLFW_SCALE_TO_MONITOR, GLFW_TRUE);
+
 	// try to create the displayed OpenGL window
 	window = glfwCreateWindow(
 		WINDOW_WIDTH,
@@ -113,17 +151,28 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 	}
 	glfwMakeContextCurrent(window);
 
-	// tell GLFW to capture all mouse events
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	// tell GLFW to capture all mouse events - a scripted camera
+	// leaves the cursor alone
+	if (g_bScriptedCamera == false)
+	{
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	}
 
 	// this callback is used to receive mouse moving events
 	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
 
 	glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Callback);
 
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	//* NEW: follow the framebuffer's size as the window is resized
+	//* or moved to a monitor with a different scale
+	int framebufferWidth = 0;
+	int framebufferHeight = 0;
+	glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+	Framebuffer_Size_Callback(window, framebufferWidth, framebufferHeight);
+	glfwSetFramebufferSizeCallback(window, &ViewManager::Framebuffer_Size_Callback);
+
+	// blending is switched on by the scene manager only for the
+	// transparent pass, so opaque draws do not pay for it
 
 	m_pWindow = window;
 
@@ -138,7 +187,12 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
  ***********************************************************/
 void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
 {
-	
+	//* NEW: a scripted camera ignores the mouse
+	if (g_bScriptedCamera)
+	{
+		return;
+	}
+
 	// when the first mouse move event is received, this needs to be recorded so that
 	// all subsequent mouse moves can correctly calculate the X position offset and Y
 	// position offset for proper operation
@@ -175,9 +229,30 @@ void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos,
  ***********************************************************/
 void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xOffset, double yOffset)
 {
+	if (g_bScriptedCamera) return;
 	if (g_pCamera) g_pCamera->ProcessMouseScroll(yOffset);
 }
 
+/***********************************************************
+ *  Framebuffer_Size_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the size of the window's framebuffer changes.  A minimized
+ *  window has no size, so the aspect ratio is kept from
+ *  before.  The viewport is set by the main loop, which knows
+ *  the framebuffer being drawn into.
+ ***********************************************************/
+void ViewManager::Framebuffer_Size_Callback(GLFWwindow* window, int width, int height)
+{
+	g_FramebufferWidth = width;
+	g_FramebufferHeight = height;
+	if ((width > 0) && (height > 0))
+	{
+		g_AspectRatio = (float)width / (float)height;
+	}
+	g_bFramebufferResized = true;
+}
+
 /***********************************************************
  *  ProcessKeyboardEvents()
  *
@@ -191,6 +266,12 @@ void ViewManager::ProcessKeyboardEvents()
 	{
 		glfwSetWindowShouldClose(m_pWindow, true);
 	}
+
+	//* NEW: a scripted camera only listens for the escape key
+	if (g_bScriptedCamera)
+	{
+		return;
+	}
 	
 	// enable or disable the cursor to the window
 	// code has been updated to release one ball per spacebar press and release
@@ -262,6 +343,68 @@ void ViewManager::ProcessKeyboardEvents()
 		// Setting this flag will prevent a mouse jump when switching back perspective
 		gFirstMouse = true;
 	}
+
+	//* NEW: toggle the depth pre-pass and the overdraw view
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F1) == GLFW_PRESS)
+	{
+		bF1Pressed = true;
+	}
+	if (bF1Pressed && (glfwGetKey(m_pWindow, GLFW_KEY_F1) == GLFW_RELEASE))
+	{
+		bF1Pressed = false;
+		g_bDepthPrePass = !g_bDepthPrePass;
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F2) == GLFW_PRESS)
+	{
+		bF2Pressed = true;
+	}
+	if (bF2Pressed && (glfwGetKey(m_pWindow, GLFW_KEY_F2) == GLFW_RELEASE))
+	{
+		bF2Pressed = false;
+		g_bOverdrawView = !g_bOverdrawView;
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F3) == GLFW_PRESS)
+	{
+		bF3Pressed = true;
+	}
+	if (bF3Pressed && (glfwGetKey(m_pWindow, GLFW_KEY_F3) == GLFW_RELEASE))
+	{
+		bF3Pressed = false;
+		g_bProfilerOverlay = !g_bProfilerOverlay;
+	}
+}
+
+/***********************************************************
+ *  DepthPrePassEnabled()
+ *
+ *  This method is used for getting whether the depth
+ *  pre-pass has been switched on with the F1 key.
+ ***********************************************************/
+bool ViewManager::DepthPrePassEnabled() const
+{
+	return(g_bDepthPrePass);
+}
+
+/***********************************************************
+ *  OverdrawViewEnabled()
+ *
+ *  This method is used for getting whether the overdraw view
+ *  has been switched on with the F2 key.
+ ***********************************************************/
+bool ViewManager::OverdrawViewEnabled() const
+{
+	return(g_bOverdrawView);
+}
+
+/***********************************************************
+ *  ProfilerOverlayEnabled()
+ *
+ *  This method is used for getting whether the profiler
+ *  overlay was switched on with the F3 key.
+ ***********************************************************/
+bool ViewManager::ProfilerOverlayEnabled() const
+{
+	return(g_bProfilerOverlay);
 }
 
 /***********************************************************
@@ -293,8 +436,8 @@ void ViewManager::PrepareSceneView()
 	{
 	case ProjectionMode::Orthographic:
 		projection = glm::ortho(
-			-10.0f * (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT,
-			10.0f * (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT,
+			-10.0f * g_AspectRatio,
+			10.0f * g_AspectRatio,
 			-10.0f,
 			10.0f,
 			0.1f,
@@ -302,18 +445,111 @@ void ViewManager::PrepareSceneView()
 		);
 		break;
 	case ProjectionMode::Perspective:
-		projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
+		projection = glm::perspective(glm::radians(g_pCamera->Zoom), g_AspectRatio, 0.1f, 100.0f);
 		break;
 	}
 
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
+	// if the uniform buffers are valid
+	if (NULL != m_pUniformBlocks)
+	{
+		// every shader program reads the camera values from the
+		// shared frame block, so they are written only once
+		UniformBlocks::FRAME_BLOCK frame;
+		frame.view = view;
+		frame.projection = projection;
+		frame.viewPosition = g_pCamera->Position;
+		frame.time = currentFrame;
+		m_pUniformBlocks->UpdateFrame(frame);
+	}
+
+	// note whether the picture differs from the last frame
+	g_bViewChanged = (view != g_LastView) || (projection != g_LastProjection) ||
+		(g_bDepthPrePass != g_bLastDepthPrePass) || (g_bOverdrawView != g_bLastOverdrawView) ||
+		(g_bProfilerOverlay != g_bLastProfilerOverlay) || g_bFramebufferResized;
+	g_LastView = view;
+	g_LastProjection = projection;
+	g_bLastDepthPrePass = g_bDepthPrePass;
+	g_bLastOverdrawView = g_bOverdrawView;
+	g_bLastProfilerOverlay = g_bProfilerOverlay;
+	g_bFramebufferResized = false;
+}
+
+/***********************************************************
+ *  SetScriptedCamera()
+ *
+ *  This method is used for handing the camera to a script.
+ *  Mouse and keyboard input, other than escape, are ignored
+ *  and the cursor is not captured when the window is made.
+ ***********************************************************/
+void ViewManager::SetScriptedCamera(bool bEnabled)
+{
+	g_bScriptedCamera = bEnabled;
+	if (bEnabled)
 	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+		bCursorDisabled = false;
 	}
+}
+
+/***********************************************************
+ *  SetCameraPose()
+ *
+ *  This method is used for placing the camera at a position
+ *  looking along the passed in yaw and pitch, in degrees.
+ ***********************************************************/
+void ViewManager::SetCameraPose(const glm::vec3& position, float yaw, float pitch)
+{
+	g_pCamera->Position = position;
+	g_pCamera->Yaw = yaw;
+	g_pCamera->Pitch = pitch;
+	// rebuilds the front, right and up vectors from the angles
+	g_pCamera->ProcessMouseMovement(0.0f, 0.0f);
+}
+
+/***********************************************************
+ *  GetCameraPose()
+ *
+ *  This method is used for getting the camera position, yaw
+ *  and pitch, e.g. to record a camera path.
+ ***********************************************************/
+void ViewManager::GetCameraPose(glm::vec3& position, float& yaw, float& pitch) const
+{
+	position = g_pCamera->Position;
+	yaw = g_pCamera->Yaw;
+	pitch = g_pCamera->Pitch;
+}
+
+/***********************************************************
+ *  ViewChanged()
+ *
+ *  This method is used for getting whether the camera, the
+ *  projection or a render toggle changed in the last
+ *  PrepareSceneView() call.
+ ***********************************************************/
+bool ViewManager::ViewChanged() const
+{
+	return(g_bViewChanged);
+}
+
+/***********************************************************
+ *  GetFramebufferSize()
+ *
+ *  This method is used for getting the size of the window's
+ *  framebuffer in pixels - zero while it is minimized.
+ ***********************************************************/
+void ViewManager::GetFramebufferSize(int& width, int& height) const
+{
+	width = g_FramebufferWidth;
+	height = g_FramebufferHeight;
+}
+
+/***********************************************************
+ *  ResetFrameTimer()
+ *
+ *  This method is used for restarting the frame timing after
+ *  the main loop has been waiting for events, so the camera
+ *  does not jump by the whole time spent waiting.
+ ***********************************************************/
+void ViewManager::ResetFrameTimer()
+{
+	gLastFrame = glfwGetTime();
 }
\ No newline at end of file
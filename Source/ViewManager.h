@@ -10,6 +10,7 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "UniformBlocks.h"
 #include "camera.h"
 
 // GLFW library
@@ -20,7 +21,8 @@ class ViewManager
 public:
 	// constructor
 	ViewManager(
-		ShaderManager* pShaderManager);
+		ShaderManager* pShaderManager,
+		UniformBlocks* pUniformBlocks);
 	// destructor
 	~ViewManager();
 
@@ -30,6 +32,9 @@ public:
 	//* NEW: for mouse scrolling input
 	static void Mouse_Scroll_Callback(GLFWwindow* window, double xOffset, double yOffset);
 
+	//* NEW: for window resizing and display scale changes
+	static void Framebuffer_Size_Callback(GLFWwindow* window, int width, int height);
+
 	//* NEW: enum for swapping between projection modes
 	enum class ProjectionMode { Orthographic, Perspective };
 
@@ -38,6 +43,8 @@ private:
 	ShaderManager* m_pShaderManager;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	//* NEW: pointer to the shared frame uniform buffer
+	UniformBlocks* m_pUniformBlocks;
 
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
@@ -48,4 +55,24 @@ public:
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+
+	//* NEW: render debug toggles set from the keyboard
+	bool DepthPrePassEnabled() const;
+	bool OverdrawViewEnabled() const;
+	bool ProfilerOverlayEnabled() const;
+
+	//* NEW: frame pacing support - whether the last PrepareSceneView()
+	//* moved anything, and restarting the frame timer after idling
+	bool ViewChanged() const;
+	void ResetFrameTimer();
+
+	//* NEW: size of the window's framebuffer in pixels, kept up to
+	//* date by the framebuffer size callback
+	void GetFramebufferSize(int& width, int& height) const;
+
+	//* NEW: drive the camera from a script instead of live input -
+	//* set before the window is created to leave the cursor free
+	void SetScriptedCamera(bool bEnabled);
+	void SetCameraPose(const glm::vec3& position, float yaw, float pitch);
+	void GetCameraPose(glm::vec3& position, float& yaw, float& pitch) const;
 };
\ No newline at end of file
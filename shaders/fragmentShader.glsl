@@ -4,6 +4,9 @@ out vec4 fragmentColor;
 in vec3 fragmentPosition;
 in vec3 fragmentVertexNormal;
 in vec2 fragmentTextureCoordinate;
+in vec4 fragmentObjectColor;
+flat in int fragmentMaterialIndex;
+flat in int fragmentFaceIndex;
 
 struct Material {
     vec3 diffuseColor;
@@ -23,6 +26,8 @@ struct DirectionalLight {
 
 struct PointLight {
     vec3 position;
+    // distance at which the light has faded out - 0 for no falloff
+    float range;
     
     vec3 ambient;
     vec3 diffuse;
@@ -49,34 +54,183 @@ struct SpotLight {
 };
 
 #define TOTAL_POINT_LIGHTS 5
+#define TOTAL_MATERIALS 64
+// must match CLUSTER_COUNT_* in ClusteredLights.h
+#define CLUSTER_COUNT_X 16
+#define CLUSTER_COUNT_Y 9
+#define CLUSTER_COUNT_Z 24
+
+// per-frame camera values shared by every shader program
+layout (std140) uniform FrameBlock
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPosition;
+    float time;
+};
+
+// scene lights shared by every shader program
+layout (std140) uniform LightBlock
+{
+    DirectionalLight directionalLight;
+    PointLight pointLights[TOTAL_POINT_LIGHTS];
+    SpotLight spotLight;
+};
+
+// every material in the scene, selected by index per draw or per instance
+layout (std140) uniform MaterialBlock
+{
+    Material materials[TOTAL_MATERIALS];
+};
 
 uniform bool bUseTexture=false;
 uniform bool bUseLighting=false;
-uniform vec4 objectColor = vec4(1.0f);
-uniform vec3 viewPosition;
-uniform DirectionalLight directionalLight;
-uniform PointLight pointLights[TOTAL_POINT_LIGHTS];
-uniform SpotLight spotLight;
-uniform Material material;
-uniform sampler2D objectTexture;
+// every texture lives in a layer of a texture array
+uniform sampler2DArray objectTexture;
+uniform float textureLayer = 0.0f;
+// boxes with a texture per face pick the layer by the face instead
+uniform bool bUseFaceLayers = false;
+uniform float faceLayers[6];
 uniform vec2 UVscale = vec2(1.0f, 1.0f);
 
+#ifndef USE_CLUSTERED_LIGHTS
+#define USE_CLUSTERED_LIGHTS 0
+#endif
+#ifndef DEPTH_ONLY
+#define DEPTH_ONLY 0
+#endif
+#ifndef OVERDRAW_VIEW
+#define OVERDRAW_VIEW 0
+#endif
+#ifndef USE_POINT_SHADOW
+#define USE_POINT_SHADOW 0
+#endif
+#ifndef USE_DIRECTIONAL_SHADOW
+#define USE_DIRECTIONAL_SHADOW 0
+#endif
+
+#if USE_CLUSTERED_LIGHTS
+// every point light in the scene - position and range, ambient,
+// diffuse and specular as four texels per light
+uniform samplerBuffer clusterLights;
+// offset and count into clusterIndices for every cluster
+uniform usamplerBuffer clusterGrid;
+// the lights listed for each cluster, one after the other
+uniform usamplerBuffer clusterIndices;
+// 1 / tile width, 1 / tile height, depth slice scale and bias
+uniform vec4 clusterTileScale;
+#endif
+
+// 0 is one hardware filtered lookup, 1 and 2 add rings of PCF taps
+uniform int shadowFilterQuality = 1;
+#if USE_POINT_SHADOW
+// depth cube map around the first point light
+uniform samplerCubeShadow pointShadowMap;
+uniform vec3 pointShadowPosition;
+// near and far plane of the cube map faces
+uniform vec2 pointShadowPlanes;
+#endif
+#if USE_DIRECTIONAL_SHADOW
+// orthographic depth map of the directional light
+uniform sampler2DShadow directionalShadowMap;
+// world space to shadow map texture space
+uniform mat4 directionalShadowMatrix;
+#endif
+
+// == =====================================================
+// Shader permutations: the program can be compiled with these
+// defines injected after the #version line
+//    SHADER_PERMUTATION     set for every permutation
+//    USE_LIGHTING           0 or 1
+//    USE_TEXTURE            0 or 1
+//    USE_DIRECTIONAL_LIGHT  0 or 1
+//    USE_SPOT_LIGHT         0 or 1
+//    POINT_LIGHT_COUNT      active point lights, packed at the front
+//    USE_CLUSTERED_LIGHTS   point lights come from the cluster
+//                           buffers instead of the light block
+//    DEPTH_ONLY             no shading - for the depth pre-pass
+//    OVERDRAW_VIEW          a flat color that is added up per
+//                           fragment to show how often pixels are shaded
+//    USE_POINT_SHADOW       the first point light is shadowed by
+//                           the cube map
+//    USE_DIRECTIONAL_SHADOW the directional light is shadowed by
+//                           the orthographic map
+// so every branch below folds away at compile time.  Without them
+// the same choices are made at run time from the uniforms.
+// == =====================================================
+#ifdef SHADER_PERMUTATION
+#define LIGHTING_ENABLED (USE_LIGHTING != 0)
+#define TEXTURE_ENABLED (USE_TEXTURE != 0)
+#define DIRECTIONAL_LIGHT_ENABLED (USE_DIRECTIONAL_LIGHT != 0)
+#define SPOT_LIGHT_ENABLED (USE_SPOT_LIGHT != 0)
+#define ACTIVE_POINT_LIGHTS POINT_LIGHT_COUNT
+#define POINT_LIGHT_ENABLED(i) true
+#else
+#define LIGHTING_ENABLED bUseLighting
+#define TEXTURE_ENABLED bUseTexture
+#define DIRECTIONAL_LIGHT_ENABLED directionalLight.bActive
+#define SPOT_LIGHT_ENABLED spotLight.bActive
+#define ACTIVE_POINT_LIGHTS TOTAL_POINT_LIGHTS
+#define POINT_LIGHT_ENABLED(i) pointLights[i].bActive
+#endif
+
 // the scaled texture coordinate to use in calculations
 vec2 fragmentTextureCoordinateScaled = fragmentTextureCoordinate * UVscale;
+// the texture array lookup - scaled coordinate plus layer
+vec3 fragmentTextureLookup = vec3(fragmentTextureCoordinateScaled,
+    bUseFaceLayers ? faceLayers[fragmentFaceIndex] : textureLayer);
+
+// the material for this fragment, fetched once from the material table
+Material material = materials[fragmentMaterialIndex];
 
-// function prototypes
-vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir);
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+// function prototypes - shadow is 1 where the light is not blocked
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir, vec3 baseColor, float shadow);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor, float shadow);
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor);
+#if USE_CLUSTERED_LIGHTS
+vec3 CalcClusteredLights(vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor, float firstLightShadow);
+#endif
+#if USE_POINT_SHADOW
+float CalcPointShadow(vec3 normal, vec3 fragPos);
+#endif
+#if USE_DIRECTIONAL_SHADOW
+float CalcDirectionalShadow(vec3 normal, vec3 fragPos);
+#endif
 
 void main()
 {   
-    if(bUseLighting == true)
+#if DEPTH_ONLY
+    // only the depth is wanted, the color writes are masked off
+    fragmentColor = vec4(0.0f);
+    return;
+#elif OVERDRAW_VIEW
+    // blended additively - brighter pixels were shaded more often
+    fragmentColor = vec4(0.125f, 0.0625f, 0.03125f, 1.0f);
+    return;
+#endif
+
+    // the surface color is sampled once and shared by every light
+    vec4 baseColor = fragmentObjectColor;
+    if(TEXTURE_ENABLED)
+    {
+        baseColor = texture(objectTexture, fragmentTextureLookup);
+    }
+
+    if(LIGHTING_ENABLED)
     {
         vec3 phongResult = vec3(0.0f);
         // properties
         vec3 norm = normalize(fragmentVertexNormal);
         vec3 viewDir = normalize(viewPosition - fragmentPosition);
+        // how much of the shadowed lights reaches the fragment
+        float pointShadow = 1.0f;
+        float directionalShadow = 1.0f;
+#if USE_POINT_SHADOW
+        pointShadow = CalcPointShadow(norm, fragmentPosition);
+#endif
+#if USE_DIRECTIONAL_SHADOW
+        directionalShadow = CalcDirectionalShadow(norm, fragmentPosition);
+#endif
     
         // == =====================================================
         // Our lighting is set up in 3 phases: directional, point lights and an optional flashlight
@@ -85,53 +239,39 @@ void main()
         // up for this fragment's final color.
         // == =====================================================
         // phase 1: directional lighting
-        if(directionalLight.bActive == true)
+        if(DIRECTIONAL_LIGHT_ENABLED)
         {
-            phongResult += CalcDirectionalLight(directionalLight, norm, viewDir);
+            phongResult += CalcDirectionalLight(directionalLight, norm, viewDir, baseColor.rgb, directionalShadow);
         }
         // phase 2: point lights
-        for(int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+        for(int i = 0; i < ACTIVE_POINT_LIGHTS; i++)
         {
-	    if(pointLights[i].bActive == true)
+            if(POINT_LIGHT_ENABLED(i))
             {
-                phongResult += CalcPointLight(pointLights[i], norm, fragmentPosition, viewDir);   
+                phongResult += CalcPointLight(pointLights[i], norm, fragmentPosition, viewDir, baseColor.rgb, (i == 0) ? pointShadow : 1.0f);
             }
         } 
+#if USE_CLUSTERED_LIGHTS
+        // only the lights that reach this fragment's cluster
+        phongResult += CalcClusteredLights(norm, fragmentPosition, viewDir, baseColor.rgb, pointShadow);
+#endif
         // phase 3: spot light
-        if(spotLight.bActive == true)
+        if(SPOT_LIGHT_ENABLED)
         {
-            phongResult += CalcSpotLight(spotLight, norm, fragmentPosition, viewDir);    
+            phongResult += CalcSpotLight(spotLight, norm, fragmentPosition, viewDir, baseColor.rgb);    
         }
     
-        if(bUseTexture == true)
-        {
-            fragmentColor = vec4(phongResult, (texture(objectTexture, fragmentTextureCoordinateScaled)).a);
-        }
-        else
-        {
-            fragmentColor = vec4(phongResult, objectColor.a);
-        }
+        fragmentColor = vec4(phongResult, baseColor.a);
     }
     else
     {
-        if(bUseTexture == true)
-        {
-            fragmentColor = texture(objectTexture, fragmentTextureCoordinateScaled);
-        }
-        else
-        {
-            fragmentColor = objectColor;
-        }
+        fragmentColor = baseColor;
     }
 }
 
 // calculates the color when using a directional light.
-vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir)
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir, vec3 baseColor, float shadow)
 {
-    vec3 ambient = vec3(0.0f);
-    vec3 diffuse = vec3(0.0f);
-    vec3 specular = vec3(0.0f);
-
     vec3 lightDirection = normalize(-light.direction);
     // diffuse shading
     float diff = max(dot(normal, lightDirection), 0.0);
@@ -139,30 +279,32 @@ vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir)
     vec3 reflectDir = reflect(-lightDirection, normal);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
     // combine results
-    if(bUseTexture == true)
-    {
-        ambient = light.ambient * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        specular = light.specular * spec * material.specularColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-    }
-    else
+    vec3 ambient = light.ambient * baseColor;
+    vec3 diffuse = light.diffuse * diff * material.diffuseColor * baseColor;
+    vec3 specular = light.specular * spec * material.specularColor * baseColor;
+    
+    // the ambient part still reaches shadowed surfaces
+    return (ambient + (diffuse + specular) * shadow);
+}
+
+// smooth falloff that reaches zero at the light's range
+float RangeAttenuation(float distance, float range)
+{
+    if(range <= 0.0)
     {
-        ambient = light.ambient * vec3(objectColor);
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
-        specular = light.specular * spec * material.specularColor * vec3(objectColor);
+        return 1.0;
     }
-    
-    return (ambient + diffuse + specular);
+    float ratio = distance / range;
+    float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return window * window;
 }
 
 // calculates the color when using a point light.
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor, float shadow)
 {
-    vec3 ambient = vec3(0.0f);
-    vec3 diffuse = vec3(0.0f);
-    vec3 specular= vec3(0.0f);
-
     vec3 lightDir = normalize(light.position - fragPos);
+    // fade the light out before its range
+    float attenuation = RangeAttenuation(length(light.position - fragPos), light.range);
     // diffuse shading
     float diff = max(dot(normal, lightDir), 0.0);
     // specular shading
@@ -170,30 +312,123 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     // Calculate specular component
     float specularComponent = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
    
-    // combine results
-    if(bUseTexture == true)
+    // combine results - the highlight keeps the light's own color
+    vec3 ambient = light.ambient * baseColor;
+    vec3 diffuse = light.diffuse * diff * material.diffuseColor * baseColor;
+    vec3 specular = light.specular * specularComponent * material.specularColor;
+    
+    return (ambient + (diffuse + specular) * shadow) * attenuation;
+}
+
+#if USE_CLUSTERED_LIGHTS
+// adds up the point lights listed for the cluster the fragment is in.
+vec3 CalcClusteredLights(vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor, float firstLightShadow)
+{
+    // screen tile from the window position, depth slice from the view depth
+    float viewDepth = max(-(view * vec4(fragPos, 1.0)).z, 0.0001);
+    int clusterX = clamp(int(gl_FragCoord.x * clusterTileScale.x), 0, CLUSTER_COUNT_X - 1);
+    int clusterY = clamp(int(gl_FragCoord.y * clusterTileScale.y), 0, CLUSTER_COUNT_Y - 1);
+    int clusterZ = clamp(int(log(viewDepth) * clusterTileScale.z + clusterTileScale.w), 0, CLUSTER_COUNT_Z - 1);
+    int cluster = clusterX + CLUSTER_COUNT_X * (clusterY + CLUSTER_COUNT_Y * clusterZ);
+
+    uvec2 clusterRange = texelFetch(clusterGrid, cluster).rg;
+    vec3 result = vec3(0.0f);
+    for(uint i = 0u; i < clusterRange.y; i++)
     {
-        ambient = light.ambient * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        specular = light.specular * specularComponent * material.specularColor;
+        int lightIndex = int(texelFetch(clusterIndices, int(clusterRange.x + i)).r);
+        int lightTexel = lightIndex * 4;
+
+        PointLight light;
+        vec4 positionRange = texelFetch(clusterLights, lightTexel);
+        light.position = positionRange.xyz;
+        light.range = positionRange.w;
+        light.ambient = texelFetch(clusterLights, lightTexel + 1).rgb;
+        light.diffuse = texelFetch(clusterLights, lightTexel + 2).rgb;
+        light.specular = texelFetch(clusterLights, lightTexel + 3).rgb;
+        light.bActive = true;
+
+        // the cube map belongs to the first light in the scene
+        result += CalcPointLight(light, normal, fragPos, viewDir, baseColor, (lightIndex == 0) ? firstLightShadow : 1.0f);
     }
-    else
+    return result;
+}
+#endif
+
+#if USE_POINT_SHADOW
+// depth the cube map holds for a point - every face is a 90 degree
+// perspective view, and the largest axis is the view depth of the
+// face the direction falls on
+float PointShadowDepth(vec3 toFragment)
+{
+    vec3 axes = abs(toFragment);
+    float viewDepth = max(axes.x, max(axes.y, axes.z));
+    float n = pointShadowPlanes.x;
+    float f = pointShadowPlanes.y;
+    float ndcDepth = (f + n) / (f - n) - (2.0 * f * n) / ((f - n) * viewDepth);
+    return ndcDepth * 0.5 + 0.5;
+}
+
+// directions added to the lookup for the PCF taps - the cube corners
+// first, then the edge centers
+const vec3 pointShadowTaps[20] = vec3[](
+    vec3( 1,  1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1,  1,  1),
+    vec3( 1,  1, -1), vec3( 1, -1, -1), vec3(-1, -1, -1), vec3(-1,  1, -1),
+    vec3( 1,  1,  0), vec3( 1, -1,  0), vec3(-1, -1,  0), vec3(-1,  1,  0),
+    vec3( 1,  0,  1), vec3(-1,  0,  1), vec3( 1,  0, -1), vec3(-1,  0, -1),
+    vec3( 0,  1,  1), vec3( 0, -1,  1), vec3( 0, -1, -1), vec3( 0,  1, -1));
+
+// how much of the first point light reaches the fragment.
+float CalcPointShadow(vec3 normal, vec3 fragPos)
+{
+    vec3 toFragment = fragPos - pointShadowPosition;
+    float distance = length(toFragment);
+    // a texel covers more of the surface further from the light, so
+    // the lookup is pushed off the surface by about one texel
+    float texelWorld = 2.0 * distance / float(textureSize(pointShadowMap, 0).x);
+    toFragment += normal * texelWorld * 1.5;
+
+    float depth = PointShadowDepth(toFragment);
+    int taps = (shadowFilterQuality <= 0) ? 0 : ((shadowFilterQuality == 1) ? 8 : 20);
+    float lit = texture(pointShadowMap, vec4(toFragment, depth));
+    for(int i = 0; i < taps; i++)
     {
-        ambient = light.ambient * vec3(objectColor);
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
-        specular = light.specular * specularComponent * material.specularColor;
+        vec3 tap = toFragment + pointShadowTaps[i] * texelWorld;
+        lit += texture(pointShadowMap, vec4(tap, PointShadowDepth(tap)));
     }
-    
-    return (ambient + diffuse + specular);
+    return lit / float(taps + 1);
 }
+#endif
 
-// calculates the color when using a spot light.
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+#if USE_DIRECTIONAL_SHADOW
+// how much of the directional light reaches the fragment.
+float CalcDirectionalShadow(vec3 normal, vec3 fragPos)
 {
-    vec3 ambient = vec3(0.0f);
-    vec3 diffuse = vec3(0.0f);
-    vec3 specular = vec3(0.0f);
+    vec2 texelSize = 1.0 / vec2(textureSize(directionalShadowMap, 0));
+    vec3 shadowCoord = vec3(directionalShadowMatrix * vec4(fragPos + normal * 0.02, 1.0));
+    // past the far side of the map nothing blocks the light
+    if(shadowCoord.z > 1.0)
+    {
+        return 1.0;
+    }
+
+    // a square of (2 * quality + 1) taps on each side
+    int radius = clamp(shadowFilterQuality, 0, 2);
+    float lit = 0.0;
+    for(int y = -radius; y <= radius; y++)
+    {
+        for(int x = -radius; x <= radius; x++)
+        {
+            lit += texture(directionalShadowMap, vec3(shadowCoord.xy + vec2(x, y) * texelSize, shadowCoord.z));
+        }
+    }
+    float side = float(2 * radius + 1);
+    return lit / (side * side);
+}
+#endif
 
+// calculates the color when using a spot light.
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor)
+{
     vec3 lightDir = normalize(light.position - fragPos);
     // diffuse shading
     float diff = max(dot(normal, lightDir), 0.0);
@@ -208,18 +443,9 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float epsilon = light.cutOff - light.outerCutOff;
     float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
     // combine results
-    if(bUseTexture == true)
-    {
-        ambient = light.ambient * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        specular = light.specular * spec * material.specularColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-    }
-    else
-    {
-        ambient = light.ambient * vec3(objectColor);
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
-        specular = light.specular * spec * material.specularColor * vec3(objectColor);
-    }
+    vec3 ambient = light.ambient * baseColor;
+    vec3 diffuse = light.diffuse * diff * material.diffuseColor * baseColor;
+    vec3 specular = light.specular * spec * material.specularColor * baseColor;
     
     ambient *= attenuation * intensity;
     diffuse *= attenuation * intensity;
@@ -2,19 +2,59 @@
 layout (location = 0) in vec3 inVertexPosition;
 layout (location = 1) in vec3 inVertexNormal;
 layout (location = 2) in vec2 inTextureCoordinate;
+// per-instance attributes, only read when bUseInstancing is set
+layout (location = 3) in mat4 inInstanceModel;
+layout (location = 7) in vec4 inInstanceColor;
+layout (location = 8) in mat3 inInstanceNormalMatrix;
+layout (location = 11) in int inInstanceMaterial;
+// face of a box vertex, 0 for every other mesh
+layout (location = 12) in float inFaceIndex;
 
 out vec3 fragmentPosition;
 out vec3 fragmentVertexNormal;
 out vec2 fragmentTextureCoordinate;
+out vec4 fragmentObjectColor;
+flat out int fragmentMaterialIndex;
+flat out int fragmentFaceIndex;
+
+// per-frame camera values shared by every shader program
+layout (std140) uniform FrameBlock
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPosition;
+    float time;
+};
+
+// the depth pre-pass and the shaded pass are separate programs, so the
+// positions must come out bit-identical for GL_EQUAL depth testing
+invariant gl_Position;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// transforms normals into world space - computed once per object on the CPU
+uniform mat3 normalMatrix;
+uniform vec4 objectColor = vec4(1.0f);
+uniform bool bUseInstancing = false;
+// index into the material table for non-instanced draws
+uniform int materialIndex = 0;
 
 void main()
 {
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
-   fragmentVertexNormal = mat3(transpose(inverse(model))) * inVertexNormal;
+   mat4 worldModel = model;
+   mat3 worldNormal = normalMatrix;
+   fragmentObjectColor = objectColor;
+   fragmentMaterialIndex = materialIndex;
+   if (bUseInstancing == true)
+   {
+      worldModel = inInstanceModel;
+      worldNormal = inInstanceNormalMatrix;
+      fragmentObjectColor = inInstanceColor;
+      fragmentMaterialIndex = inInstanceMaterial;
+   }
+
+   fragmentPosition = vec3(worldModel * vec4(inVertexPosition, 1.0));
+   gl_Position = projection * view * worldModel * vec4(inVertexPosition, 1.0f);
+   fragmentVertexNormal = worldNormal * inVertexNormal;
    fragmentTextureCoordinate = inTextureCoordinate;
+   fragmentFaceIndex = int(inFaceIndex + 0.5f);
 }
\ No newline at end of file
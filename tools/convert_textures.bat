@@ -0,0 +1,40 @@
+@echo off
+rem ///////////////////////////////////////////////////////////////////////////
+rem convert_textures.bat
+rem ============
+rem offline conversion of the PNG textures into precompressed DDS files
+rem
+rem  Uses texconv from DirectXTex (https://github.com/microsoft/DirectXTex),
+rem  which must be on the PATH.  Each textures\name.png gets a
+rem  textures\name.dds with a full mip chain next to it, and the
+rem  TextureLibrary loads the .dds instead of the .png when it is there.
+rem
+rem  usage:  tools\convert_textures.bat [BC7_UNORM | BC3_UNORM | BC1_UNORM]
+rem
+rem  BC7 (the default) keeps the most detail, BC3 suits older drivers
+rem  without BPTC, and BC1 is half the size of both but has only 1-bit
+rem  alpha.  The images are flipped vertically to match stb_image, which
+rem  flips the PNG files when they are loaded.
+rem ///////////////////////////////////////////////////////////////////////////
+
+setlocal
+
+set FORMAT=%1
+if "%FORMAT%"=="" set FORMAT=BC7_UNORM
+
+set TEXTURE_DIR=%~dp0..\textures
+
+where texconv >nul 2>nul
+if errorlevel 1 (
+	echo texconv was not found on the PATH
+	exit /b 1
+)
+
+texconv -nologo -y -f %FORMAT% -m 0 -vflip -o "%TEXTURE_DIR%" "%TEXTURE_DIR%\*.png"
+if errorlevel 1 (
+	echo texture conversion failed
+	exit /b 1
+)
+
+echo converted the textures to %FORMAT%
+endlocal